@@ -1,32 +1,49 @@
-// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.   
-
-
-#include "ModifyReplayObject.h"
-#include "NetworkReplayStreaming.h"
-#include "Components/CapsuleComponent.h"
-
-
-void UModifyReplayObject::RenameReplay(const FString& ReplayName, const FString& NewName, const int32 UserIndex,bool bIsNormalName)
-{
-	EnumerateStreamsPtr = FNetworkReplayStreaming::Get().GetFactory().CreateReplayStreamer();
-
-	OnRenameReplayCompleteDel = FRenameReplayCallback::CreateUObject(this, &UModifyReplayObject::OnRenameReplayComplete);
-
-	if (EnumerateStreamsPtr.Get())
-	{
-		if (bIsNormalName)
-		{
-			EnumerateStreamsPtr.Get()->RenameReplay(ReplayName,NewName,UserIndex, OnRenameReplayCompleteDel);
-		}
-		else
-		{
-			EnumerateStreamsPtr.Get()->RenameReplayFriendlyName(ReplayName, NewName,UserIndex, OnRenameReplayCompleteDel);
-		}
-	}
-}
-
-void UModifyReplayObject::OnRenameReplayComplete(const FRenameReplayResult& Result)
-{
-	bool WasSuccessful = Result.WasSuccessful();
-	//OnRenameComplete.Broadcast(WasSuccessful);
-}
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.   
+
+
+#include "ModifyReplayObject.h"
+#include "NetworkReplayStreaming.h"
+#include "ReplayIntegrity.h"
+#include "ReplaySearchIndex.h"
+#include "Components/CapsuleComponent.h"
+
+
+void UModifyReplayObject::RenameReplay(const FString& ReplayName, const FString& NewName, const int32 UserIndex,bool bIsNormalName)
+{
+	EnumerateStreamsPtr = FNetworkReplayStreaming::Get().GetFactory().CreateReplayStreamer();
+
+	// Only a rename on disk moves the search index entry and checksums, a friendly name rename keeps them
+	RenamedReplayName.Reset();
+	NewReplayName.Reset();
+
+	OnRenameReplayCompleteDel = FRenameReplayCallback::CreateUObject(this, &UModifyReplayObject::OnRenameReplayComplete);
+
+	if (EnumerateStreamsPtr.Get())
+	{
+		if (bIsNormalName)
+		{
+			RenamedReplayName = ReplayName;
+			NewReplayName = NewName;
+			EnumerateStreamsPtr.Get()->RenameReplay(ReplayName,NewName,UserIndex, OnRenameReplayCompleteDel);
+		}
+		else
+		{
+			EnumerateStreamsPtr.Get()->RenameReplayFriendlyName(ReplayName, NewName,UserIndex, OnRenameReplayCompleteDel);
+		}
+	}
+}
+
+void UModifyReplayObject::OnRenameReplayComplete(const FRenameReplayResult& Result)
+{
+	bool WasSuccessful = Result.WasSuccessful();
+
+	if (WasSuccessful && !RenamedReplayName.IsEmpty())
+	{
+		FReplaySearchIndex::Get().RenameReplay(RenamedReplayName, NewReplayName);
+		FReplayIntegrity::RenameChecksums(RenamedReplayName, NewReplayName);
+	}
+
+	RenamedReplayName.Reset();
+	NewReplayName.Reset();
+	//OnRenameComplete.Broadcast(WasSuccessful);
+}
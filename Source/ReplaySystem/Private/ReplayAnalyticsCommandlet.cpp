@@ -0,0 +1,169 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayAnalyticsCommandlet.h"
+
+#include "ReplaySystem.h"
+#include "ReplaySystemBPLibrary.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+namespace ReplayAnalytics
+{
+	struct FWorker
+	{
+		FString ReplayName;
+		FProcHandle Handle;
+		double StartTime = 0.0;
+	};
+}
+
+UReplayAnalyticsCommandlet::UReplayAnalyticsCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UReplayAnalyticsCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Replays;
+
+	FString ReplayList;
+	if (FParse::Value(*Params, TEXT("Replays="), ReplayList, false))
+	{
+		ReplayList.ParseIntoArray(Replays, TEXT("+"));
+	}
+	else
+	{
+		TArray<FString> Files;
+		IFileManager::Get().FindFiles(Files, *(UReplaySystemBPLibrary::GetReplaySavePath() / TEXT("*.replay")), true,
+		                              false);
+		for (const FString& File : Files)
+		{
+			Replays.Add(FPaths::GetBaseFilename(File));
+		}
+	}
+
+	if (Replays.Num() == 0)
+	{
+		UE_LOG(LogReplaySystem, Warning, TEXT("No replays to analyse"));
+		return 0;
+	}
+
+	int32 Jobs = FMath::Max(1, FPlatformMisc::NumberOfCoresIncludingHyperthreads() / 2);
+	FParse::Value(*Params, TEXT("Jobs="), Jobs);
+	Jobs = FMath::Max(1, Jobs);
+
+	float Speed = 64.0f;
+	FParse::Value(*Params, TEXT("Speed="), Speed);
+
+	int32 Fps = 30;
+	FParse::Value(*Params, TEXT("Fps="), Fps);
+
+	float Timeout = 3600.0f;
+	FParse::Value(*Params, TEXT("Timeout="), Timeout);
+
+	FString OutputDirectory = FPaths::ProjectSavedDir() / TEXT("ReplayAnalytics");
+	FParse::Value(*Params, TEXT("Out="), OutputDirectory);
+	OutputDirectory = FPaths::ConvertRelativePathToFull(OutputDirectory);
+	IFileManager::Get().MakeDirectory(*OutputDirectory, true);
+
+	FString Map;
+	FParse::Value(*Params, TEXT("Map="), Map);
+
+	FString Hooks;
+	FParse::Value(*Params, TEXT("Hooks="), Hooks, false);
+
+	// -benchmark with -fps makes the engine use a fixed time step and never wait, so replays run as fast as the CPU allows
+	FString SharedArgs = FString::Printf(
+		TEXT("\"%s\" %s -game -nullrhi -nosound -nosplash -unattended -NoVerifyGC -benchmark -fps=%d -ReplayAnalyticsSpeed=%f -ReplayAnalyticsOut=\"%s\""),
+		*FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath()), *Map, Fps, Speed, *OutputDirectory);
+
+	if (!Hooks.IsEmpty())
+	{
+		SharedArgs += FString::Printf(TEXT(" -ReplayAnalyticsHooks=\"%s\""), *Hooks);
+	}
+
+	UE_LOG(LogReplaySystem, Display, TEXT("Analysing %d replay(s) with %d job(s)"), Replays.Num(), Jobs);
+
+	TArray<ReplayAnalytics::FWorker> Running;
+	TArray<FString> Failed;
+	int32 NextReplay = 0;
+	int32 Succeeded = 0;
+
+	while (NextReplay < Replays.Num() || Running.Num() > 0)
+	{
+		while (Running.Num() < Jobs && NextReplay < Replays.Num())
+		{
+			const FString& ReplayName = Replays[NextReplay++];
+			const FString Args = FString::Printf(TEXT("%s -ReplayAnalytics=\"%s\" -abslog=\"%s\""), *SharedArgs,
+			                                     *ReplayName, *(OutputDirectory / (ReplayName + TEXT(".log"))));
+
+			ReplayAnalytics::FWorker Worker;
+			Worker.ReplayName = ReplayName;
+			Worker.StartTime = FPlatformTime::Seconds();
+			Worker.Handle = FPlatformProcess::CreateProc(FPlatformProcess::ExecutablePath(), *Args, false, true, true,
+			                                             nullptr, 0, nullptr, nullptr);
+
+			if (!Worker.Handle.IsValid())
+			{
+				UE_LOG(LogReplaySystem, Error, TEXT("Could not start a worker for %s"), *ReplayName);
+				Failed.Add(ReplayName);
+				continue;
+			}
+
+			Running.Add(MoveTemp(Worker));
+		}
+
+		for (int32 Index = Running.Num() - 1; Index >= 0; --Index)
+		{
+			ReplayAnalytics::FWorker& Worker = Running[Index];
+
+			if (FPlatformProcess::IsProcRunning(Worker.Handle))
+			{
+				if (FPlatformTime::Seconds() - Worker.StartTime > Timeout)
+				{
+					UE_LOG(LogReplaySystem, Error, TEXT("Worker for %s timed out"), *Worker.ReplayName);
+					FPlatformProcess::TerminateProc(Worker.Handle, true);
+					FPlatformProcess::CloseProc(Worker.Handle);
+					Failed.Add(Worker.ReplayName);
+					Running.RemoveAtSwap(Index);
+				}
+				continue;
+			}
+
+			int32 ReturnCode = -1;
+			FPlatformProcess::GetProcReturnCode(Worker.Handle, &ReturnCode);
+			FPlatformProcess::CloseProc(Worker.Handle);
+
+			if (ReturnCode == 0)
+			{
+				++Succeeded;
+				UE_LOG(LogReplaySystem, Display, TEXT("Analysed %s in %.1fs"), *Worker.ReplayName,
+				       FPlatformTime::Seconds() - Worker.StartTime);
+			}
+			else
+			{
+				UE_LOG(LogReplaySystem, Error, TEXT("Worker for %s exited with %d"), *Worker.ReplayName, ReturnCode);
+				Failed.Add(Worker.ReplayName);
+			}
+
+			Running.RemoveAtSwap(Index);
+		}
+
+		FPlatformProcess::Sleep(0.1f);
+	}
+
+	UE_LOG(LogReplaySystem, Display, TEXT("Replay analytics done, %d succeeded, %d failed. Results in %s"), Succeeded,
+	       Failed.Num(), *OutputDirectory);
+
+	for (const FString& ReplayName : Failed)
+	{
+		UE_LOG(LogReplaySystem, Display, TEXT("  failed: %s"), *ReplayName);
+	}
+
+	return Failed.Num() > 0 ? 1 : 0;
+}
@@ -0,0 +1,29 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayAnalyticsHook.h"
+
+#include "Engine/World.h"
+
+UWorld* UReplayAnalyticsHook::GetWorld() const
+{
+	// The CDO has no world, which also keeps Blueprint from offering world context nodes where they cannot work
+	if (HasAnyFlags(RF_ClassDefaultObject))
+	{
+		return nullptr;
+	}
+
+	return ReplayWorld.Get();
+}
+
+void UReplayAnalyticsHook::OnReplayStarted_Implementation(const FString& ReplayName)
+{
+}
+
+void UReplayAnalyticsHook::OnSample_Implementation(float ReplayTime)
+{
+}
+
+FString UReplayAnalyticsHook::OnReplayFinished_Implementation(const FString& ReplayName)
+{
+	return FString();
+}
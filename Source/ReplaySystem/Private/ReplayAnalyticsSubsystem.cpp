@@ -0,0 +1,226 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayAnalyticsSubsystem.h"
+
+#include "ReplayAnalyticsHook.h"
+#include "ReplayStateSubsystem.h"
+#include "ReplaySystem.h"
+#include "ReplaySystemBPLibrary.h"
+#include "Dom/JsonObject.h"
+#include "Engine/GameInstance.h"
+#include "Engine/GameViewportClient.h"
+#include "Engine/World.h"
+#include "HAL/PlatformMisc.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+bool UReplayAnalyticsSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	FString Name;
+	return FParse::Value(FCommandLine::Get(), TEXT("ReplayAnalytics="), Name) && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UReplayAnalyticsSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+
+	FParse::Value(CommandLine, TEXT("ReplayAnalytics="), ReplayName);
+
+	if (!FParse::Value(CommandLine, TEXT("ReplayAnalyticsOut="), OutputDirectory))
+	{
+		OutputDirectory = FPaths::ProjectSavedDir() / TEXT("ReplayAnalytics");
+	}
+
+	FParse::Value(CommandLine, TEXT("ReplayAnalyticsSpeed="), PlaybackSpeed);
+
+	FString HookList;
+	if (FParse::Value(CommandLine, TEXT("ReplayAnalyticsHooks="), HookList, false))
+	{
+		TArray<FString> HookPaths;
+		HookList.ParseIntoArray(HookPaths, TEXT("+"));
+
+		HookClasses.Reset();
+		for (const FString& HookPath : HookPaths)
+		{
+			HookClasses.Add(TSoftClassPtr<UReplayAnalyticsHook>(FSoftObjectPath(HookPath)));
+		}
+	}
+
+	StartTime = FPlatformTime::Seconds();
+
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateUObject(this, &UReplayAnalyticsSubsystem::Tick));
+
+	UE_LOG(LogReplaySystem, Display, TEXT("Replay analytics worker running %s with %d hook(s) at %.1fx"), *ReplayName,
+	       HookClasses.Num(), PlaybackSpeed);
+}
+
+void UReplayAnalyticsSubsystem::Deinitialize()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	TickerHandle.Reset();
+
+	Hooks.Reset();
+
+	Super::Deinitialize();
+}
+
+bool UReplayAnalyticsSubsystem::Tick(float DeltaTime)
+{
+	UWorld* World = GetGameInstance()->GetWorld();
+
+	switch (State)
+	{
+	case EState::WaitingForWorld:
+		if (World && World->HasBegunPlay())
+		{
+			LoadStartTime = FPlatformTime::Seconds();
+
+			if (!UReplaySystemBPLibrary::PlayRecordedReplay(World, ReplayName))
+			{
+				UE_LOG(LogReplaySystem, Error, TEXT("Replay analytics could not play %s"), *ReplayName);
+				Finish(false);
+				break;
+			}
+
+			State = EState::Loading;
+		}
+		break;
+
+	case EState::Loading:
+		if (World && World->HasBegunPlay() && UReplaySystemBPLibrary::IsPlayingReplay(World))
+		{
+			StartPlaying(World);
+		}
+		else if (FPlatformTime::Seconds() - LoadStartTime > LoadTimeoutSeconds)
+		{
+			UE_LOG(LogReplaySystem, Error, TEXT("Replay analytics timed out loading %s"), *ReplayName);
+			Finish(false);
+		}
+		break;
+
+	case EState::Playing:
+		{
+			if (!World || !UReplaySystemBPLibrary::IsPlayingReplay(World))
+			{
+				Finish(bReachedEnd);
+				break;
+			}
+
+			const float ReplayTime = UReplaySystemBPLibrary::GetCurrentReplayTime(World);
+
+			for (UReplayAnalyticsHook* Hook : Hooks)
+			{
+				if (ReplayTime >= Hook->NextSampleTime)
+				{
+					Hook->OnSample(ReplayTime);
+					Hook->NextSampleTime = ReplayTime + Hook->SampleInterval;
+				}
+			}
+
+			if (bReachedEnd)
+			{
+				Finish(true);
+			}
+		}
+		break;
+
+	case EState::Finished:
+		break;
+	}
+
+	return State != EState::Finished;
+}
+
+void UReplayAnalyticsSubsystem::StartPlaying(UWorld* World)
+{
+	State = EState::Playing;
+
+	if (UGameViewportClient* Viewport = World->GetGameViewport())
+	{
+		Viewport->bDisableWorldRendering = true;
+	}
+
+	UReplaySystemBPLibrary::SetPlaybackSpeed(World, PlaybackSpeed);
+
+	if (UReplayStateSubsystem* StateSubsystem = World->GetSubsystem<UReplayStateSubsystem>())
+	{
+		StateSubsystem->OnReplayComplete.AddDynamic(this, &UReplayAnalyticsSubsystem::HandleReplayComplete);
+	}
+
+	for (const TSoftClassPtr<UReplayAnalyticsHook>& HookClass : HookClasses)
+	{
+		UClass* LoadedClass = HookClass.LoadSynchronous();
+
+		if (!LoadedClass)
+		{
+			UE_LOG(LogReplaySystem, Warning, TEXT("Replay analytics hook %s could not be loaded"),
+			       *HookClass.ToString());
+			continue;
+		}
+
+		UReplayAnalyticsHook* Hook = NewObject<UReplayAnalyticsHook>(this, LoadedClass);
+		Hook->ReplayWorld = World;
+		Hook->NextSampleTime = 0.0f;
+		Hooks.Add(Hook);
+	}
+
+	for (UReplayAnalyticsHook* Hook : Hooks)
+	{
+		Hook->OnReplayStarted(ReplayName);
+	}
+}
+
+void UReplayAnalyticsSubsystem::Finish(bool bWasSuccessful)
+{
+	if (State == EState::Finished)
+	{
+		return;
+	}
+
+	State = EState::Finished;
+
+	const TSharedRef<FJsonObject> Result = MakeShared<FJsonObject>();
+	Result->SetStringField(TEXT("Replay"), ReplayName);
+	Result->SetBoolField(TEXT("Success"), bWasSuccessful);
+	Result->SetNumberField(TEXT("WallSeconds"), FPlatformTime::Seconds() - StartTime);
+
+	if (const UWorld* World = GetGameInstance()->GetWorld())
+	{
+		Result->SetNumberField(TEXT("ReplaySeconds"), UReplaySystemBPLibrary::GetCurrentReplayTime(World));
+	}
+
+	const TSharedRef<FJsonObject> HookResults = MakeShared<FJsonObject>();
+	for (UReplayAnalyticsHook* Hook : Hooks)
+	{
+		HookResults->SetStringField(Hook->GetClass()->GetName(), Hook->OnReplayFinished(ReplayName));
+	}
+	Result->SetObjectField(TEXT("Hooks"), HookResults);
+
+	FString Json;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Result, Writer);
+
+	const FString OutputFile = OutputDirectory / (ReplayName + TEXT(".json"));
+	if (!FFileHelper::SaveStringToFile(Json, *OutputFile))
+	{
+		UE_LOG(LogReplaySystem, Error, TEXT("Replay analytics could not write %s"), *OutputFile);
+		bWasSuccessful = false;
+	}
+
+	UE_LOG(LogReplaySystem, Display, TEXT("Replay analytics finished %s (%s)"), *ReplayName,
+	       bWasSuccessful ? TEXT("success") : TEXT("failure"));
+
+	FPlatformMisc::RequestExitWithStatus(false, bWasSuccessful ? 0 : 1);
+}
+
+void UReplayAnalyticsSubsystem::HandleReplayComplete()
+{
+	bReachedEnd = true;
+}
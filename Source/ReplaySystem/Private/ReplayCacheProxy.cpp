@@ -0,0 +1,560 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayCacheProxy.h"
+
+#include "HttpModule.h"
+#include "HttpPath.h"
+#include "HttpServerModule.h"
+#include "HttpServerRequest.h"
+#include "HttpServerResponse.h"
+#include "IHttpRouter.h"
+#include "ReplayMemory.h"
+#include "ReplaySystem.h"
+#include "Async/Async.h"
+#include "Dom/JsonObject.h"
+#include "GenericPlatform/GenericPlatformHttp.h"
+#include "HAL/FileManager.h"
+#include "Interfaces/IHttpRequest.h"
+#include "Interfaces/IHttpResponse.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace ReplayCacheProxy
+{
+	//Paths the HTTP replay streamer uses, relative to its server URL
+	const TCHAR* StreamChunkMarker = TEXT("/file/stream.");
+	const TCHAR* EventMarker = TEXT("/event/");
+
+	//Headers that describe the connection rather than the content and are not passed on
+	bool IsHopHeader(const FString& Name)
+	{
+		return Name == TEXT("Host") || Name == TEXT("Connection") || Name == TEXT("Content-Length") || Name ==
+			TEXT("Transfer-Encoding") || Name == TEXT("Keep-Alive");
+	}
+
+	//Whether a request is one the HTTP replay streamer makes to play a replay. Nothing else is passed on, so anyone who
+	//can reach the port cannot record, change or delete replays on the server through it
+	bool IsPlaybackRequest(EHttpServerRequestVerbs Verb, const FString& Path)
+	{
+		if (Verb == EHttpServerRequestVerbs::VERB_GET)
+		{
+			return true;
+		}
+
+		// Starting to download a replay and registering or refreshing a viewer
+		return Verb == EHttpServerRequestVerbs::VERB_POST && (Path.Contains(TEXT("/startDownloading")) || Path.Contains(
+			TEXT("/viewer")));
+	}
+}
+
+FReplayCacheProxy::FReplayCacheProxy(FSettings&& InSettings)
+	: Settings(MoveTemp(InSettings))
+{
+	Settings.UpstreamURL.RemoveFromEnd(TEXT("/"));
+
+	// What was cached by earlier runs counts towards the size, oldest first
+	TArray<FString> Filenames;
+	IFileManager::Get().FindFiles(Filenames, *Settings.CacheDirectory, TEXT(".cache"));
+
+	for (const FString& Filename : Filenames)
+	{
+		const FString FullPath = FPaths::Combine(Settings.CacheDirectory, Filename);
+
+		FCacheEntry& Entry = Cache.Add(FPaths::GetBaseFilename(Filename));
+		Entry.Size = IFileManager::Get().FileSize(*FullPath);
+		Entry.LastUsed = (IFileManager::Get().GetTimeStamp(*FullPath) - FDateTime::UtcNow()).GetTotalSeconds();
+		CacheSize += Entry.Size;
+	}
+
+	TrimCache();
+}
+
+bool FReplayCacheProxy::Start()
+{
+	Router = FHttpServerModule::Get().GetHttpRouter(Settings.ListenPort, true);
+
+	if (!Router.IsValid())
+	{
+		UE_LOG(LogReplaySystem, Warning, TEXT("Replay cache could not listen on port %d"), Settings.ListenPort);
+		return false;
+	}
+
+	TWeakPtr<FReplayCacheProxy> WeakThis = AsShared();
+
+	RouteHandle = Router->BindRoute(FHttpPath(TEXT("/")),
+	                                EHttpServerRequestVerbs::VERB_GET | EHttpServerRequestVerbs::VERB_POST,
+	                                FHttpRequestHandler::CreateLambda(
+		                                [WeakThis](const FHttpServerRequest& Request,
+		                                           const FHttpResultCallback& OnComplete)
+		                                {
+			                                const TSharedPtr<FReplayCacheProxy> This = WeakThis.Pin();
+			                                return This.IsValid() && This->HandleRequest(Request, OnComplete);
+		                                }));
+
+	FHttpServerModule::Get().StartAllListeners();
+
+	UE_LOG(LogReplaySystem, Log, TEXT("Replay cache listening on %s for %s"), *GetURL(), *Settings.UpstreamURL);
+	return true;
+}
+
+void FReplayCacheProxy::Stop()
+{
+	if (Router.IsValid() && RouteHandle.IsValid())
+	{
+		Router->UnbindRoute(RouteHandle);
+	}
+
+	RouteHandle.Reset();
+	Router.Reset();
+	Waiting.Reset();
+	ReadAheadQueue.Reset();
+}
+
+FString FReplayCacheProxy::GetURL() const
+{
+	return Router.IsValid() ? FString::Printf(TEXT("http://127.0.0.1:%d/"), Settings.ListenPort) : FString();
+}
+
+void FReplayCacheProxy::ClearCache()
+{
+	for (const TPair<FString, FCacheEntry>& Pair : Cache)
+	{
+		IFileManager::Get().Delete(*GetCacheFilename(Pair.Key), false, true, true);
+	}
+
+	Cache.Reset();
+	CacheSize = 0;
+}
+
+bool FReplayCacheProxy::HandleRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	LLM_SCOPE_BYTAG(ReplaySystem_Cache);
+
+	FString Path = Request.RelativePath.GetPath();
+	if (!Path.StartsWith(TEXT("/")))
+	{
+		Path = TEXT("/") + Path;
+	}
+
+	if (!ReplayCacheProxy::IsPlaybackRequest(Request.Verb, Path))
+	{
+		OnComplete(FHttpServerResponse::Error(EHttpServerResponseCodes::Forbidden, TEXT("Playback"),
+		                                      TEXT("The replay cache only passes on playback requests")));
+		return true;
+	}
+
+	if (Request.QueryParams.Num() > 0)
+	{
+		// The server hands the parameters over decoded
+		TArray<FString> Query;
+		for (const TPair<FString, FString>& Param : Request.QueryParams)
+		{
+			Query.Add(FGenericPlatformHttp::UrlEncode(Param.Key) + TEXT("=") + FGenericPlatformHttp::UrlEncode(
+				Param.Value));
+		}
+		Path += TEXT("?") + FString::Join(Query, TEXT("&"));
+	}
+
+	TMap<FString, FString> Headers;
+	for (const TPair<FString, TArray<FString>>& Header : Request.Headers)
+	{
+		if (!ReplayCacheProxy::IsHopHeader(Header.Key) && Header.Value.Num() > 0)
+		{
+			Headers.Add(Header.Key, FString::Join(Header.Value, TEXT(",")));
+		}
+	}
+
+	if (Request.Verb == EHttpServerRequestVerbs::VERB_GET && IsCacheable(Path))
+	{
+		Fetch(Path, Headers, OnComplete);
+		ReadAhead(Path, Headers);
+		return true;
+	}
+
+	TWeakPtr<FReplayCacheProxy> WeakThis = AsShared();
+
+	Forward(Request.Verb == EHttpServerRequestVerbs::VERB_POST ? TEXT("POST") : TEXT("GET"), Path, Headers, Request.Body,
+	        [WeakThis, Path, OnComplete](FResponse&& Response)
+	        {
+		        if (const TSharedPtr<FReplayCacheProxy> This = WeakThis.Pin())
+		        {
+			        This->TrackLiveState(Path, Response);
+		        }
+
+		        OnComplete(MakeResponse(Response));
+	        });
+
+	return true;
+}
+
+void FReplayCacheProxy::Fetch(const FString& Path, const TMap<FString, FString>& Headers, FHttpResultCallback OnComplete)
+{
+	const FString Key = GetCacheKey(Path);
+
+	// Already on its way, from a read ahead or another request
+	if (TArray<FWaiter>* Waiters = Waiting.Find(Key))
+	{
+		if (OnComplete)
+		{
+			Waiters->Add({Headers, MoveTemp(OnComplete)});
+		}
+		return;
+	}
+
+	TArray<FWaiter>& Waiters = Waiting.Add(Key);
+	if (OnComplete)
+	{
+		Waiters.Add({Headers, MoveTemp(OnComplete)});
+	}
+
+	TWeakPtr<FReplayCacheProxy> WeakThis = AsShared();
+
+	if (FCacheEntry* Entry = Cache.Find(Key))
+	{
+		Entry->LastUsed = FPlatformTime::Seconds();
+
+		Async(EAsyncExecution::ThreadPool, [WeakThis, Key, Path, Filename = GetCacheFilename(Key)]()
+		{
+			LLM_SCOPE_BYTAG(ReplaySystem_Cache);
+
+			TArray<uint8> Data;
+			FResponse Response;
+			FReplayMemory::FCounter MemoryCounter(EReplayMemoryCategory::Cache);
+
+			if (FFileHelper::LoadFileToArray(Data, *Filename, FILEREAD_Silent))
+			{
+				MemoryCounter.Set(Data.GetAllocatedSize());
+
+				FMemoryReader Reader(Data);
+				Reader << Response;
+
+				if (Reader.IsError())
+				{
+					Response = FResponse();
+				}
+			}
+
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, Key, Path, Response = MoveTemp(Response)]() mutable
+			{
+				if (const TSharedPtr<FReplayCacheProxy> This = WeakThis.Pin())
+				{
+					This->OnFetched(Key, Path, MoveTemp(Response), true);
+				}
+			});
+		});
+		return;
+	}
+
+	Forward(TEXT("GET"), Path, Headers, TArray<uint8>(), [WeakThis, Key, Path](FResponse&& Response)
+	{
+		if (const TSharedPtr<FReplayCacheProxy> This = WeakThis.Pin())
+		{
+			This->OnFetched(Key, Path, MoveTemp(Response), false);
+		}
+	});
+}
+
+void FReplayCacheProxy::OnFetched(const FString& Key, const FString& Path, FResponse&& Response, bool bFromCache)
+{
+	if (bFromCache && Response.Code == 0)
+	{
+		// The cache file went missing or is damaged, drop it and ask the server instead
+		if (const FCacheEntry* Entry = Cache.Find(Key))
+		{
+			CacheSize -= Entry->Size;
+			Cache.Remove(Key);
+		}
+
+		TArray<FWaiter> Waiters;
+		Waiting.RemoveAndCopyValue(Key, Waiters);
+
+		// With the headers each request came with, the server may need their authorization
+		for (FWaiter& Waiter : Waiters)
+		{
+			Fetch(Path, Waiter.Headers, MoveTemp(Waiter.OnComplete));
+		}
+		return;
+	}
+
+	if (!bFromCache && Response.Code == 200 && !LiveSessions.Contains(GetSession(Path)))
+	{
+		AddToCache(Key, Response);
+	}
+
+	TArray<FWaiter> Waiters;
+	Waiting.RemoveAndCopyValue(Key, Waiters);
+
+	for (const FWaiter& Waiter : Waiters)
+	{
+		Waiter.OnComplete(MakeResponse(Response));
+	}
+}
+
+void FReplayCacheProxy::Forward(const FString& Verb, const FString& Path, const TMap<FString, FString>& Headers,
+                                const TArray<uint8>& Body, TFunction<void(FResponse&&)> OnResponse)
+{
+	const TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+	Request->SetURL(Settings.UpstreamURL + Path);
+	Request->SetVerb(Verb);
+
+	for (const TPair<FString, FString>& Header : Headers)
+	{
+		Request->SetHeader(Header.Key, Header.Value);
+	}
+
+	if (Body.Num() > 0)
+	{
+		Request->SetContent(Body);
+	}
+
+	Request->OnProcessRequestComplete().BindLambda(
+		[OnResponse = MoveTemp(OnResponse)](FHttpRequestPtr, FHttpResponsePtr HttpResponse, bool bConnectedSuccessfully)
+		{
+			LLM_SCOPE_BYTAG(ReplaySystem_Cache);
+
+			FResponse Response;
+
+			if (bConnectedSuccessfully && HttpResponse.IsValid())
+			{
+				Response.Code = HttpResponse->GetResponseCode();
+				Response.Body = HttpResponse->GetContent();
+
+				for (const FString& Header : HttpResponse->GetAllHeaders())
+				{
+					FString Name;
+					FString Value;
+					if (Header.Split(TEXT(":"), &Name, &Value) && !ReplayCacheProxy::IsHopHeader(Name.TrimStartAndEnd()))
+					{
+						Response.Headers.Add(Name.TrimStartAndEnd(), Value.TrimStartAndEnd());
+					}
+				}
+			}
+
+			OnResponse(MoveTemp(Response));
+		});
+
+	Request->ProcessRequest();
+}
+
+void FReplayCacheProxy::ReadAhead(const FString& Path, const TMap<FString, FString>& Headers)
+{
+	FString Prefix;
+	FString Session;
+	int32 ChunkIndex = 0;
+
+	if (Settings.ReadAheadChunks <= 0 || !ParseStreamChunk(Path, Prefix, Session, ChunkIndex) ||
+		LiveSessions.Contains(Session))
+	{
+		return;
+	}
+
+	// Playback at 4x needs the next chunks four times as soon
+	const float Speed = Settings.GetPlaybackSpeed ? FMath::Max(Settings.GetPlaybackSpeed(), 1.0f) : 1.0f;
+	const int32 NumChunks = FMath::CeilToInt(Settings.ReadAheadChunks * Speed);
+
+	// Read ahead for an earlier position is no longer useful once playback has moved
+	ReadAheadQueue.RemoveAll([&Prefix](const FReadAhead& Queued)
+	{
+		return Queued.Path.StartsWith(Prefix);
+	});
+
+	for (int32 Index = ChunkIndex + 1; Index <= ChunkIndex + NumChunks; ++Index)
+	{
+		FReadAhead& Queued = ReadAheadQueue.AddDefaulted_GetRef();
+		Queued.Path = Prefix + LexToString(Index);
+		Queued.Headers = Headers;
+	}
+
+	PumpReadAheads();
+}
+
+void FReplayCacheProxy::PumpReadAheads()
+{
+	while (NumReadAheadsInFlight < FMath::Max(Settings.MaxConcurrentReadAheads, 1) && ReadAheadQueue.Num() > 0)
+	{
+		const FReadAhead Queued = ReadAheadQueue[0];
+		ReadAheadQueue.RemoveAt(0);
+
+		const FString Key = GetCacheKey(Queued.Path);
+		if (Cache.Contains(Key) || Waiting.Contains(Key))
+		{
+			continue;
+		}
+
+		++NumReadAheadsInFlight;
+
+		TWeakPtr<FReplayCacheProxy> WeakThis = AsShared();
+
+		Fetch(Queued.Path, Queued.Headers, [WeakThis](TUniquePtr<FHttpServerResponse>&&)
+		{
+			if (const TSharedPtr<FReplayCacheProxy> This = WeakThis.Pin())
+			{
+				--This->NumReadAheadsInFlight;
+				This->PumpReadAheads();
+			}
+		});
+	}
+}
+
+void FReplayCacheProxy::TrackLiveState(const FString& Path, const FResponse& Response)
+{
+	// The streamer learns whether a replay is live when it starts downloading it
+	if (!Path.Contains(TEXT("/startDownloading")) || Response.Code != 200)
+	{
+		return;
+	}
+
+	TSharedPtr<FJsonObject> Json;
+	FString State;
+
+	const FString Content = FString(FUTF8ToTCHAR(reinterpret_cast<const ANSICHAR*>(Response.Body.GetData()),
+	                                             Response.Body.Num()));
+
+	if (FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Content), Json) && Json.IsValid() && Json->
+		TryGetStringField(TEXT("State"), State) && State.Equals(TEXT("Live"), ESearchCase::IgnoreCase))
+	{
+		LiveSessions.Add(GetSession(Path));
+	}
+	else
+	{
+		LiveSessions.Remove(GetSession(Path));
+	}
+}
+
+bool FReplayCacheProxy::IsCacheable(const FString& Path) const
+{
+	return Path.Contains(ReplayCacheProxy::StreamChunkMarker) || Path.Contains(ReplayCacheProxy::EventMarker);
+}
+
+void FReplayCacheProxy::AddToCache(const FString& Key, const FResponse& Response)
+{
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+	Writer << const_cast<FResponse&>(Response);
+
+	if (Settings.MaxCacheBytes <= 0 || Data.Num() > Settings.MaxCacheBytes / 4)
+	{
+		return;
+	}
+
+	FCacheEntry& Entry = Cache.FindOrAdd(Key);
+	CacheSize += Data.Num() - Entry.Size;
+	Entry.Size = Data.Num();
+	Entry.LastUsed = FPlatformTime::Seconds();
+
+	// Held until it is on disk
+	const int64 DataSize = Data.GetAllocatedSize();
+	FReplayMemory::Add(EReplayMemoryCategory::Cache, DataSize);
+
+	// Written through a temp file so a reader never sees half a response
+	Async(EAsyncExecution::ThreadPool, [Data = MoveTemp(Data), DataSize, Filename = GetCacheFilename(Key)]()
+	{
+		const FString TempFilename = Filename + TEXT(".tmp");
+		if (!FFileHelper::SaveArrayToFile(Data, *TempFilename) || !IFileManager::Get().Move(
+			*Filename, *TempFilename, true, true))
+		{
+			IFileManager::Get().Delete(*TempFilename, false, true, true);
+		}
+
+		FReplayMemory::Add(EReplayMemoryCategory::Cache, -DataSize);
+	});
+
+	TrimCache();
+}
+
+void FReplayCacheProxy::TrimCache()
+{
+	if (CacheSize <= Settings.MaxCacheBytes)
+	{
+		return;
+	}
+
+	TArray<TPair<FString, FCacheEntry>> Entries = Cache.Array();
+	Entries.Sort([](const TPair<FString, FCacheEntry>& A, const TPair<FString, FCacheEntry>& B)
+	{
+		return A.Value.LastUsed < B.Value.LastUsed;
+	});
+
+	// Trim a little further than needed so every new response does not trigger another sort
+	const int64 TargetSize = Settings.MaxCacheBytes - Settings.MaxCacheBytes / 10;
+
+	for (const TPair<FString, FCacheEntry>& Entry : Entries)
+	{
+		if (CacheSize <= TargetSize)
+		{
+			break;
+		}
+
+		IFileManager::Get().Delete(*GetCacheFilename(Entry.Key), false, true, true);
+		Cache.Remove(Entry.Key);
+		CacheSize -= Entry.Value.Size;
+	}
+}
+
+FString FReplayCacheProxy::GetCacheFilename(const FString& Key) const
+{
+	return FPaths::Combine(Settings.CacheDirectory, Key + TEXT(".cache"));
+}
+
+FString FReplayCacheProxy::GetCacheKey(const FString& Path)
+{
+	return FMD5::HashAnsiString(*Path);
+}
+
+bool FReplayCacheProxy::ParseStreamChunk(const FString& Path, FString& OutPrefix, FString& OutSession,
+                                         int32& OutChunkIndex)
+{
+	const int32 Marker = Path.Find(ReplayCacheProxy::StreamChunkMarker);
+	if (Marker == INDEX_NONE)
+	{
+		return false;
+	}
+
+	OutPrefix = Path.Left(Marker + FCString::Strlen(ReplayCacheProxy::StreamChunkMarker));
+	OutSession = GetSession(Path);
+
+	FString Index = Path.Mid(OutPrefix.Len());
+	Index.Split(TEXT("?"), &Index, nullptr);
+
+	return Index.IsNumeric() && LexTryParseString(OutChunkIndex, *Index);
+}
+
+FString FReplayCacheProxy::GetSession(const FString& Path)
+{
+	// Paths look like /replay/<Session>/...
+	TArray<FString> Parts;
+	Path.ParseIntoArray(Parts, TEXT("/"));
+
+	const int32 ReplayIndex = Parts.IndexOfByKey(TEXT("replay"));
+	return Parts.IsValidIndex(ReplayIndex + 1) ? Parts[ReplayIndex + 1] : FString();
+}
+
+TUniquePtr<FHttpServerResponse> FReplayCacheProxy::MakeResponse(const FResponse& Response)
+{
+	if (Response.Code == 0)
+	{
+		return FHttpServerResponse::Error(EHttpServerResponseCodes::BadGateway, TEXT("Upstream"),
+		                                  TEXT("The replay server could not be reached"));
+	}
+
+	const FString* ContentType = Response.Headers.Find(TEXT("Content-Type"));
+
+	TArray<uint8> Body = Response.Body;
+	TUniquePtr<FHttpServerResponse> ServerResponse = FHttpServerResponse::Create(
+		MoveTemp(Body), ContentType ? *ContentType : FString(TEXT("application/octet-stream")));
+	ServerResponse->Code = static_cast<EHttpServerResponseCodes>(Response.Code);
+
+	for (const TPair<FString, FString>& Header : Response.Headers)
+	{
+		if (Header.Key != TEXT("Content-Type"))
+		{
+			ServerResponse->Headers.FindOrAdd(Header.Key).Add(Header.Value);
+		}
+	}
+
+	return ServerResponse;
+}
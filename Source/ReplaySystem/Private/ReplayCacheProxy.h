@@ -0,0 +1,156 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HttpResultCallback.h"
+#include "HttpRouteHandle.h"
+
+class IHttpRouter;
+struct FHttpServerRequest;
+
+/**
+ *  The HTTP proxy behind UReplayCacheSubsystem. Runs on the game thread, cache files are read and written on worker
+ *  threads.
+ */
+class FReplayCacheProxy : public TSharedFromThis<FReplayCacheProxy>
+{
+public:
+	struct FSettings
+	{
+		FString UpstreamURL;
+
+		int32 ListenPort = 0;
+
+		int64 MaxCacheBytes = 0;
+
+		int32 ReadAheadChunks = 0;
+
+		int32 MaxConcurrentReadAheads = 1;
+
+		FString CacheDirectory;
+
+		//The current playback speed, read ahead scales with it
+		TFunction<float()> GetPlaybackSpeed;
+	};
+
+	explicit FReplayCacheProxy(FSettings&& InSettings);
+
+	/**
+	 *  Starts listening
+	 * @return False if the port could not be bound
+	 */
+	bool Start();
+
+	void Stop();
+
+	FString GetURL() const;
+
+	void ClearCache();
+
+	int64 GetCacheSize() const { return CacheSize; }
+
+private:
+	struct FResponse
+	{
+		//0 if the server could not be reached
+		int32 Code = 0;
+
+		TMap<FString, FString> Headers;
+
+		TArray<uint8> Body;
+
+		friend FArchive& operator<<(FArchive& Ar, FResponse& Response)
+		{
+			Ar << Response.Code;
+			Ar << Response.Headers;
+			Ar << Response.Body;
+			return Ar;
+		}
+	};
+
+	struct FCacheEntry
+	{
+		int64 Size = 0;
+
+		double LastUsed = 0.0;
+	};
+
+	struct FReadAhead
+	{
+		FString Path;
+
+		TMap<FString, FString> Headers;
+	};
+
+	struct FWaiter
+	{
+		//The headers of the request, used again if the path has to be fetched from the server after all
+		TMap<FString, FString> Headers;
+
+		FHttpResultCallback OnComplete;
+	};
+
+	bool HandleRequest(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+
+	/**
+	 *  Fetches a path from the cache or the replay server, calling every waiter on the same path once it is there
+	 */
+	void Fetch(const FString& Path, const TMap<FString, FString>& Headers, FHttpResultCallback OnComplete);
+
+	void Forward(const FString& Verb, const FString& Path, const TMap<FString, FString>& Headers,
+	             const TArray<uint8>& Body, TFunction<void(FResponse&&)> OnResponse);
+
+	void OnFetched(const FString& Key, const FString& Path, FResponse&& Response, bool bFromCache);
+
+	/**
+	 *  Queues the stream chunks after the one at Path
+	 */
+	void ReadAhead(const FString& Path, const TMap<FString, FString>& Headers);
+
+	void PumpReadAheads();
+
+	/**
+	 *  Remembers which sessions are live from the responses that say so, their chunks may still change
+	 */
+	void TrackLiveState(const FString& Path, const FResponse& Response);
+
+	bool IsCacheable(const FString& Path) const;
+
+	void AddToCache(const FString& Key, const FResponse& Response);
+
+	void TrimCache();
+
+	FString GetCacheFilename(const FString& Key) const;
+
+	static FString GetCacheKey(const FString& Path);
+
+	/**
+	 *  Splits a stream chunk path into the session and the chunk index
+	 */
+	static bool ParseStreamChunk(const FString& Path, FString& OutPrefix, FString& OutSession, int32& OutChunkIndex);
+
+	static FString GetSession(const FString& Path);
+
+	static TUniquePtr<FHttpServerResponse> MakeResponse(const FResponse& Response);
+
+	FSettings Settings;
+
+	TMap<FString, FCacheEntry> Cache;
+
+	int64 CacheSize = 0;
+
+	//Requests waiting for a path being fetched, by cache key
+	TMap<FString, TArray<FWaiter>> Waiting;
+
+	TArray<FReadAhead> ReadAheadQueue;
+
+	int32 NumReadAheadsInFlight = 0;
+
+	//Sessions still being recorded, their chunks are not cached
+	TSet<FString> LiveSessions;
+
+	TSharedPtr<IHttpRouter> Router;
+
+	FHttpRouteHandle RouteHandle;
+};
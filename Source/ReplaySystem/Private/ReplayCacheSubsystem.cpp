@@ -0,0 +1,94 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayCacheSubsystem.h"
+
+#include "ReplayCacheProxy.h"
+#include "ReplayStateSubsystem.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Misc/Paths.h"
+
+void UReplayCacheSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	if (UpstreamURL.IsEmpty())
+	{
+		return;
+	}
+
+	FReplayCacheProxy::FSettings Settings;
+	Settings.UpstreamURL = UpstreamURL;
+	Settings.ListenPort = ListenPort;
+	Settings.MaxCacheBytes = static_cast<int64>(FMath::Max(MaxCacheMB, 0)) * 1024 * 1024;
+	Settings.ReadAheadChunks = ReadAheadChunks;
+	Settings.MaxConcurrentReadAheads = MaxConcurrentReadAheads;
+	Settings.CacheDirectory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ReplayCache"));
+	Settings.GetPlaybackSpeed = [WeakThis = TWeakObjectPtr<UReplayCacheSubsystem>(this)]()
+	{
+		return WeakThis.IsValid() ? WeakThis->GetPlaybackSpeed() : 1.0f;
+	};
+
+	Proxy = MakeShared<FReplayCacheProxy>(MoveTemp(Settings));
+
+	if (!Proxy->Start())
+	{
+		Proxy.Reset();
+	}
+}
+
+void UReplayCacheSubsystem::Deinitialize()
+{
+	if (Proxy.IsValid())
+	{
+		Proxy->Stop();
+		Proxy.Reset();
+	}
+
+	Super::Deinitialize();
+}
+
+UReplayCacheSubsystem* UReplayCacheSubsystem::Get(const UObject* WorldContextObject)
+{
+	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
+	{
+		if (const UGameInstance* GI = World->GetGameInstance())
+		{
+			return GI->GetSubsystem<UReplayCacheSubsystem>();
+		}
+	}
+
+	return nullptr;
+}
+
+FString UReplayCacheSubsystem::GetProxyURL() const
+{
+	return Proxy.IsValid() ? Proxy->GetURL() : FString();
+}
+
+void UReplayCacheSubsystem::ClearCache()
+{
+	if (Proxy.IsValid())
+	{
+		Proxy->ClearCache();
+	}
+}
+
+int64 UReplayCacheSubsystem::GetCacheSize() const
+{
+	return Proxy.IsValid() ? Proxy->GetCacheSize() : 0;
+}
+
+float UReplayCacheSubsystem::GetPlaybackSpeed() const
+{
+	if (const UGameInstance* GI = GetGameInstance())
+	{
+		if (const UReplayStateSubsystem* StateSubsystem = UReplayStateSubsystem::Get(GI->GetWorld()))
+		{
+			return StateSubsystem->GetPlaybackState().PlaybackSpeed;
+		}
+	}
+
+	return 1.0f;
+}
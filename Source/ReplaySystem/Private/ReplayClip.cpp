@@ -0,0 +1,267 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayClip.h"
+
+#include "ReplayEventIndex.h"
+#include "ReplayEventIndexSubsystem.h"
+#include "ReplayFileUtils.h"
+#include "ReplayIntegrity.h"
+#include "ReplayMemory.h"
+#include "ReplaySearchIndex.h"
+#include "ReplaySystem.h"
+#include "Async/Async.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+
+const FString FReplayClip::ClipGroup = TEXT("ReplayClip");
+
+namespace ReplayClip
+{
+	const TCHAR* StartKey = TEXT("StartTimeInMS");
+	const TCHAR* EndKey = TEXT("EndTimeInMS");
+	const TCHAR* SourceKey = TEXT("SourceReplay");
+
+	TUniquePtr<IFileHandle> OpenRead(const FString& ReplayName)
+	{
+		return TUniquePtr<IFileHandle>(FPlatformFileManager::Get().GetPlatformFile().OpenRead(
+			*ReplayFileUtils::GetReplayFilename(ReplayName), true));
+	}
+
+	FReplayMetadataValue MakeValue(const FString& Key, int64 Value)
+	{
+		FReplayMetadataValue MetadataValue;
+		MetadataValue.Key = Key;
+		MetadataValue.Type = EReplayMetadataType::Int;
+		MetadataValue.IntValue = Value;
+		return MetadataValue;
+	}
+}
+
+void FReplayClip::Extract(const FString& ReplayName, const FString& ClipName, float StartTime, float EndTime,
+                          TFunction<void(bool)> OnComplete)
+{
+	Async(EAsyncExecution::ThreadPool, [ReplayName, ClipName, StartTime, EndTime, OnComplete = MoveTemp(OnComplete)]()
+	{
+		LLM_SCOPE_BYTAG(ReplaySystem);
+
+		const bool bWasSuccessful = ExtractClip(ReplayName, ClipName, StartTime, EndTime);
+
+		AsyncTask(ENamedThreads::GameThread, [ClipName, bWasSuccessful, OnComplete]()
+		{
+			if (bWasSuccessful)
+			{
+				FReplayIntegrity::UpdateChecksums(ClipName);
+
+				// What was indexed for a replay the clip replaced no longer applies
+				FReplaySearchIndex::Get().RemoveReplay(ClipName);
+
+				for (const FWorldContext& WorldContext : GEngine->GetWorldContexts())
+				{
+					const UWorld* World = WorldContext.World();
+					UReplayEventIndexSubsystem* EventIndexSubsystem =
+						World ? World->GetSubsystem<UReplayEventIndexSubsystem>() : nullptr;
+
+					if (EventIndexSubsystem)
+					{
+						EventIndexSubsystem->InvalidateIndex(ClipName);
+					}
+				}
+			}
+
+			OnComplete(bWasSuccessful);
+		});
+	});
+}
+
+bool FReplayClip::ExtractClip(const FString& ReplayName, const FString& ClipName, float StartTime, float EndTime)
+{
+	if (ClipName.IsEmpty() || ClipName == ReplayName || StartTime < 0.0f || EndTime <= StartTime)
+	{
+		UE_LOG(LogReplaySystem, Warning, TEXT("Invalid clip %s of replay %s from %.2f to %.2f"), *ClipName,
+		       *ReplayName, StartTime, EndTime);
+		return false;
+	}
+
+	const TUniquePtr<IFileHandle> File = ReplayClip::OpenRead(ReplayName);
+	ReplayFileUtils::FReplayFileLayout Layout;
+
+	if (!File.IsValid() || !ReplayFileUtils::ReadLayout(*File, Layout))
+	{
+		UE_LOG(LogReplaySystem, Warning, TEXT("Could not read replay %s to clip it"), *ReplayName);
+		return false;
+	}
+
+	// Without chunk times there is no telling which stream data belongs to the range
+	if (Layout.bIsLive || Layout.FileVersion < static_cast<uint32>(ELocalFileVersionHistory::HISTORY_STREAM_CHUNK_TIMES))
+	{
+		UE_LOG(LogReplaySystem, Warning, TEXT("Replay %s is still recording or too old to be clipped"), *ReplayName);
+		return false;
+	}
+
+	const uint32 StartTimeInMS = static_cast<uint32>(StartTime * 1000.0f);
+	const uint32 EndTimeInMS = FMath::Min(static_cast<uint32>(EndTime * 1000.0f),
+	                                      static_cast<uint32>(FMath::Max(Layout.LengthInMS, 0)));
+
+	if (EndTimeInMS <= StartTimeInMS)
+	{
+		UE_LOG(LogReplaySystem, Warning, TEXT("Clip %s starts after the end of replay %s"), *ClipName, *ReplayName);
+		return false;
+	}
+
+	// Checkpoints are only kept from the last one before the start of the range, earlier ones are never needed
+	TArray<ReplayFileUtils::FEventHeader> EventHeaders;
+	EventHeaders.SetNum(Layout.Chunks.Num());
+
+	uint32 FirstCheckpointTimeInMS = 0;
+	for (int32 Index = 0; Index < Layout.Chunks.Num(); ++Index)
+	{
+		const ReplayFileUtils::FChunk& Chunk = Layout.Chunks[Index];
+		if ((Chunk.ChunkType == ELocalFileChunkType::Checkpoint || Chunk.ChunkType == ELocalFileChunkType::Event) &&
+			ReplayFileUtils::ReadEventHeader(*File, Chunk, EventHeaders[Index]) && Chunk.ChunkType ==
+			ELocalFileChunkType::Checkpoint && EventHeaders[Index].Time1 <= StartTimeInMS)
+		{
+			FirstCheckpointTimeInMS = FMath::Max(FirstCheckpointTimeInMS, EventHeaders[Index].Time1);
+		}
+	}
+
+	TArray<const ReplayFileUtils::FChunk*> ClipChunks;
+	for (int32 Index = 0; Index < Layout.Chunks.Num(); ++Index)
+	{
+		const ReplayFileUtils::FChunk& Chunk = Layout.Chunks[Index];
+		const ReplayFileUtils::FEventHeader& EventHeader = EventHeaders[Index];
+
+		bool bKeep = false;
+		switch (Chunk.ChunkType)
+		{
+		case ELocalFileChunkType::Header:
+			bKeep = true;
+			break;
+		case ELocalFileChunkType::ReplayData:
+			// Checkpoints find their data by stream offset, so the stream is only cut at the end
+			bKeep = Chunk.StartTimeInMS <= EndTimeInMS;
+			break;
+		case ELocalFileChunkType::Checkpoint:
+			bKeep = EventHeader.Time1 >= FirstCheckpointTimeInMS && EventHeader.Time1 <= EndTimeInMS;
+			break;
+		case ELocalFileChunkType::Event:
+			bKeep = EventHeader.Time1 >= StartTimeInMS && EventHeader.Time1 <= EndTimeInMS && EventHeader.Group !=
+				ClipGroup;
+			break;
+		default:
+			break;
+		}
+
+		if (bKeep)
+		{
+			ClipChunks.Add(&Chunk);
+		}
+	}
+
+	TArray<uint8> Header;
+	if (!ReplayFileUtils::ReadPatchedHeader(*File, Layout, static_cast<int32>(EndTimeInMS), false, Header))
+	{
+		UE_LOG(LogReplaySystem, Warning, TEXT("Could not read the header of replay %s"), *ReplayName);
+		return false;
+	}
+
+	ReplayFileUtils::FEventHeader MarkerHeader;
+	MarkerHeader.Id = ClipName + TEXT("_") + ClipGroup;
+	MarkerHeader.Group = ClipGroup;
+	MarkerHeader.Time1 = StartTimeInMS;
+	MarkerHeader.Time2 = StartTimeInMS;
+
+	TArray<FReplayMetadataValue> MarkerValues;
+	MarkerValues.Add(ReplayClip::MakeValue(ReplayClip::StartKey, StartTimeInMS));
+	MarkerValues.Add(ReplayClip::MakeValue(ReplayClip::EndKey, EndTimeInMS));
+	FReplayMetadataValue& Source = MarkerValues.AddDefaulted_GetRef();
+	Source.Key = ReplayClip::SourceKey;
+	Source.StringValue = ReplayName;
+	MarkerHeader.Metadata = ReplayEventMetadata::Encode(MarkerValues);
+
+	const TArray<uint8> MarkerChunk = ReplayFileUtils::MakeEventChunk(MarkerHeader, TArray<uint8>());
+
+	const FString Filename = ReplayFileUtils::GetReplayFilename(ClipName);
+	const FString TempFilename = Filename + TEXT(".clip");
+
+	bool bWritten = false;
+	{
+		const TUniquePtr<IFileHandle> Clip(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*TempFilename));
+		bWritten = Clip.IsValid() && Clip->Write(Header.GetData(), Header.Num());
+
+		for (int32 Index = 0; bWritten && Index < ClipChunks.Num(); ++Index)
+		{
+			// Runs of chunks that are next to each other in the source are copied in one go
+			const int64 Offset = ClipChunks[Index]->TypeOffset;
+			int64 End = ClipChunks[Index]->DataOffset + ClipChunks[Index]->SizeInBytes;
+
+			while (Index + 1 < ClipChunks.Num() && ClipChunks[Index + 1]->TypeOffset == End)
+			{
+				++Index;
+				End = ClipChunks[Index]->DataOffset + ClipChunks[Index]->SizeInBytes;
+			}
+
+			bWritten = ReplayFileUtils::CopyRange(*File, *Clip, Offset, End - Offset);
+		}
+
+		bWritten = bWritten && Clip->Write(MarkerChunk.GetData(), MarkerChunk.Num()) && Clip->Flush();
+	}
+
+	if (!bWritten || !IFileManager::Get().Move(*Filename, *TempFilename, true, true))
+	{
+		UE_LOG(LogReplaySystem, Warning, TEXT("Could not write clip %s of replay %s"), *ClipName, *ReplayName);
+		IFileManager::Get().Delete(*TempFilename, false, true, true);
+		return false;
+	}
+
+	// Checksums of a replay that was replaced no longer apply
+	IFileManager::Get().Delete(*ReplayFileUtils::GetChecksumFilename(ClipName), false, true, true);
+
+	UE_LOG(LogReplaySystem, Log, TEXT("Wrote clip %s of replay %s from %u to %u ms, kept %d of %d chunks"), *ClipName,
+	       *ReplayName, StartTimeInMS, EndTimeInMS, ClipChunks.Num(), Layout.Chunks.Num());
+	return true;
+}
+
+bool FReplayClip::GetClipRange(const FString& ReplayName, float& OutStartTime, float& OutEndTime)
+{
+	const TUniquePtr<IFileHandle> File = ReplayClip::OpenRead(ReplayName);
+	ReplayFileUtils::FReplayFileLayout Layout;
+
+	if (!File.IsValid() || !ReplayFileUtils::ReadLayout(*File, Layout))
+	{
+		return false;
+	}
+
+	// The marker is written last
+	for (int32 Index = Layout.Chunks.Num() - 1; Index >= 0; --Index)
+	{
+		ReplayFileUtils::FEventHeader EventHeader;
+		TArray<FReplayMetadataValue> Values;
+
+		if (Layout.Chunks[Index].ChunkType != ELocalFileChunkType::Event || !ReplayFileUtils::ReadEventHeader(
+			*File, Layout.Chunks[Index], EventHeader) || EventHeader.Group != ClipGroup || !ReplayEventMetadata::Decode(
+			EventHeader.Metadata, Values))
+		{
+			continue;
+		}
+
+		const FReplayMetadataValue* Start = Values.FindByPredicate([](const FReplayMetadataValue& Value)
+		{
+			return Value.Key == ReplayClip::StartKey;
+		});
+		const FReplayMetadataValue* End = Values.FindByPredicate([](const FReplayMetadataValue& Value)
+		{
+			return Value.Key == ReplayClip::EndKey;
+		});
+
+		if (Start && End)
+		{
+			OutStartTime = static_cast<float>(Start->GetNumber() / 1000.0);
+			OutEndTime = static_cast<float>(End->GetNumber() / 1000.0);
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,109 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayEventBatch.h"
+
+#include "NetworkReplayStreaming.h"
+#include "Containers/Ticker.h"
+
+void FReplayEventBatch::Start(const TArray<FString>& ReplayNames, const FString& Group, int32 MaxConcurrent,
+                              FOnEventListReady OnEventListReady, FOnComplete OnComplete)
+{
+	const TSharedRef<FReplayEventBatch> Batch = MakeShared<FReplayEventBatch>();
+	Batch->Group = Group;
+	Batch->OnEventListReady = MoveTemp(OnEventListReady);
+	Batch->OnComplete = MoveTemp(OnComplete);
+	Batch->NumRemaining = ReplayNames.Num();
+
+	Batch->Results.SetNum(ReplayNames.Num());
+	for (int32 Index = 0; Index < ReplayNames.Num(); ++Index)
+	{
+		Batch->Results[Index].ReplayName = ReplayNames[Index];
+	}
+
+	if (ReplayNames.Num() == 0)
+	{
+		Batch->Finish();
+		return;
+	}
+
+	const int32 NumLanes = FMath::Clamp(MaxConcurrent, 1, ReplayNames.Num());
+	for (int32 Lane = 0; Lane < NumLanes; ++Lane)
+	{
+		Batch->Streamers.Add(FNetworkReplayStreaming::Get().GetFactory().CreateReplayStreamer());
+	}
+
+	for (int32 Lane = 0; Lane < NumLanes; ++Lane)
+	{
+		Batch->StartNext(Lane);
+	}
+}
+
+void FReplayEventBatch::StartNext(int32 Lane)
+{
+	if (NextReplay >= Results.Num())
+	{
+		return;
+	}
+
+	const int32 ReplayIndex = NextReplay++;
+	const TSharedPtr<INetworkReplayStreamer>& Streamer = Streamers[Lane];
+
+	if (!Streamer.IsValid())
+	{
+		HandleEnumerated(Lane, ReplayIndex, false, {});
+		return;
+	}
+
+	// The streamers hold this callback which holds the batch, Finish breaks the cycle
+	Streamer->EnumerateEvents(Results[ReplayIndex].ReplayName, Group, INDEX_NONE, FEnumerateEventsCallback::CreateLambda(
+		                          [This = AsShared(), Lane, ReplayIndex](const FEnumerateEventsResult& Result)
+		                          {
+			                          TArray<FReplayEvent> Events;
+
+			                          if (Result.WasSuccessful())
+			                          {
+				                          Events.Reserve(Result.ReplayEventList.ReplayEvents.Num());
+				                          for (const FReplayEventListItem& EventItem : Result.ReplayEventList.ReplayEvents)
+				                          {
+					                          FReplayEvent& Event = Events.AddDefaulted_GetRef();
+					                          Event.EventID = EventItem.ID;
+					                          Event.Group = EventItem.Group;
+					                          Event.TimeInMs = static_cast<int32>(EventItem.Time1);
+					                          Event.Metadata = EventItem.Metadata;
+				                          }
+			                          }
+
+			                          This->HandleEnumerated(Lane, ReplayIndex, Result.WasSuccessful(), Events);
+		                          }));
+}
+
+void FReplayEventBatch::HandleEnumerated(int32 Lane, int32 ReplayIndex, bool bWasSuccessful,
+                                         const TArray<FReplayEvent>& Events)
+{
+	FReplayEventList& EventList = Results[ReplayIndex];
+	EventList.bWasSuccessful = bWasSuccessful;
+	EventList.Events = Events;
+
+	OnEventListReady.ExecuteIfBound(EventList);
+
+	if (--NumRemaining == 0)
+	{
+		Finish();
+		return;
+	}
+
+	StartNext(Lane);
+}
+
+void FReplayEventBatch::Finish()
+{
+	OnComplete.ExecuteIfBound(Results);
+
+	// Released on the next tick, we may still be inside a streamer's callback
+	FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda(
+		[Streamers = MoveTemp(Streamers)](float) mutable
+		{
+			Streamers.Reset();
+			return false;
+		}));
+}
@@ -0,0 +1,435 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayEventIndex.h"
+
+#include "Algo/BinarySearch.h"
+#include "Misc/Base64.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace ReplayEventIndex
+{
+	enum class EVersion : uint8
+	{
+		Initial = 1,
+
+		LatestPlusOne,
+		Latest = LatestPlusOne - 1
+	};
+
+	//Every serialized element takes at least a byte, a count larger than what is left to read is corrupt
+	bool IsValidCount(FArchive& Ar, int32 Count)
+	{
+		if (Count < 0 || Count > Ar.TotalSize() - Ar.Tell())
+		{
+			Ar.SetError();
+			return false;
+		}
+		return true;
+	}
+}
+
+FArchive& operator<<(FArchive& Ar, FReplayMetadataValue& Value)
+{
+	Ar << Value.Key;
+
+	uint8 Type = static_cast<uint8>(Value.Type);
+	Ar << Type;
+
+	if (Ar.IsLoading())
+	{
+		if (Type > static_cast<uint8>(EReplayMetadataType::String))
+		{
+			Ar.SetError();
+			return Ar;
+		}
+		Value.Type = static_cast<EReplayMetadataType>(Type);
+	}
+
+	switch (Value.Type)
+	{
+	case EReplayMetadataType::Int:
+		{
+			// Zigzag so small negative values stay small
+			uint64 Packed = (static_cast<uint64>(Value.IntValue) << 1) ^ static_cast<uint64>(Value.IntValue >> 63);
+			Ar.SerializeIntPacked64(Packed);
+			Value.IntValue = static_cast<int64>(Packed >> 1) ^ -static_cast<int64>(Packed & 1);
+			break;
+		}
+	case EReplayMetadataType::Float:
+		Ar << Value.FloatValue;
+		break;
+	case EReplayMetadataType::String:
+		Ar << Value.StringValue;
+		break;
+	}
+
+	return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FReplayIndexedEvent& Event)
+{
+	Ar << Event.EventID;
+	Ar << Event.Group;
+
+	uint32 TimeInMs = static_cast<uint32>(FMath::Max(Event.TimeInMs, 0));
+	Ar.SerializeIntPacked(TimeInMs);
+	Event.TimeInMs = static_cast<int32>(TimeInMs);
+
+	int32 NumValues = Event.Metadata.Num();
+	Ar << NumValues;
+
+	if (Ar.IsLoading())
+	{
+		if (!ReplayEventIndex::IsValidCount(Ar, NumValues))
+		{
+			return Ar;
+		}
+		Event.Metadata.SetNum(NumValues);
+	}
+
+	for (int32 Index = 0; Index < NumValues && !Ar.IsError(); ++Index)
+	{
+		Ar << Event.Metadata[Index];
+	}
+
+	return Ar;
+}
+
+FString ReplayEventMetadata::Encode(TConstArrayView<FReplayMetadataValue> Values)
+{
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+
+	int32 NumValues = Values.Num();
+	Writer << NumValues;
+	for (FReplayMetadataValue Value : Values)
+	{
+		Writer << Value;
+	}
+
+	return Prefix + FBase64::Encode(Data);
+}
+
+bool ReplayEventMetadata::Decode(const FString& Metadata, TArray<FReplayMetadataValue>& OutValues)
+{
+	OutValues.Reset();
+
+	if (!Metadata.StartsWith(Prefix, ESearchCase::CaseSensitive))
+	{
+		return false;
+	}
+
+	TArray<uint8> Data;
+	if (!FBase64::Decode(Metadata.RightChop(FCString::Strlen(Prefix)), Data))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+
+	int32 NumValues = 0;
+	Reader << NumValues;
+
+	// Every value takes at least two bytes
+	if (NumValues < 0 || NumValues > Data.Num() / 2)
+	{
+		return false;
+	}
+
+	OutValues.SetNum(NumValues);
+	for (int32 Index = 0; Index < NumValues && !Reader.IsError(); ++Index)
+	{
+		Reader << OutValues[Index];
+	}
+
+	if (Reader.IsError())
+	{
+		OutValues.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+void FReplayEventIndex::Add(const FReplayIndexedEvent& Event, const TSet<FName>& IndexedKeys)
+{
+	int32 Slot = INDEX_NONE;
+
+	if (const int32* ExistingSlot = EventSlots.Find(Event.EventID))
+	{
+		// The event was updated, drop what was indexed for its old metadata
+		Slot = *ExistingSlot;
+		for (TPair<FName, FKeyIndex>& Key : Keys)
+		{
+			Key.Value.Numbers.RemoveAll([Slot](const TPair<double, int32>& Entry) { return Entry.Value == Slot; });
+			Key.Value.Strings.RemoveAll([Slot](const TPair<FString, int32>& Entry) { return Entry.Value == Slot; });
+		}
+		Events[Slot] = Event;
+	}
+	else
+	{
+		Slot = Events.Add(Event);
+		EventSlots.Add(Event.EventID, Slot);
+	}
+
+	for (const FReplayMetadataValue& Value : Event.Metadata)
+	{
+		const FName Key(*Value.Key);
+		if (!IndexedKeys.Contains(Key))
+		{
+			continue;
+		}
+
+		FKeyIndex& KeyIndex = Keys.FindOrAdd(Key);
+		if (Value.Type == EReplayMetadataType::String)
+		{
+			KeyIndex.Strings.Emplace(Value.StringValue, Slot);
+		}
+		else
+		{
+			KeyIndex.Numbers.Emplace(Value.GetNumber(), Slot);
+		}
+		KeyIndex.bSorted = false;
+	}
+}
+
+void FReplayEventIndex::FindEqual(const FReplayMetadataValue& Value, TArray<FReplayIndexedEvent>& OutEvents) const
+{
+	if (Value.Type != EReplayMetadataType::String)
+	{
+		FindInRange(FName(*Value.Key, FNAME_Find), Value.GetNumber(), Value.GetNumber(), OutEvents);
+		return;
+	}
+
+	const FKeyIndex* KeyIndex = Keys.Find(FName(*Value.Key, FNAME_Find));
+	if (!KeyIndex)
+	{
+		return;
+	}
+
+	TArray<int32> Slots;
+
+	if (KeyIndex->bSorted)
+	{
+		const auto Projection = [](const TPair<FString, int32>& Entry) -> const FString& { return Entry.Key; };
+		const int32 First = Algo::LowerBoundBy(KeyIndex->Strings, Value.StringValue, Projection);
+		const int32 Last = Algo::UpperBoundBy(KeyIndex->Strings, Value.StringValue, Projection);
+		for (int32 Index = First; Index < Last; ++Index)
+		{
+			Slots.Add(KeyIndex->Strings[Index].Value);
+		}
+	}
+	else
+	{
+		for (const TPair<FString, int32>& Entry : KeyIndex->Strings)
+		{
+			if (Entry.Key == Value.StringValue)
+			{
+				Slots.Add(Entry.Value);
+			}
+		}
+	}
+
+	AddSlots(Slots, OutEvents);
+}
+
+void FReplayEventIndex::FindInRange(const FName Key, double Min, double Max, TArray<FReplayIndexedEvent>& OutEvents) const
+{
+	const FKeyIndex* KeyIndex = Keys.Find(Key);
+	if (!KeyIndex)
+	{
+		return;
+	}
+
+	TArray<int32> Slots;
+
+	if (KeyIndex->bSorted)
+	{
+		const auto Projection = [](const TPair<double, int32>& Entry) { return Entry.Key; };
+		const int32 First = Algo::LowerBoundBy(KeyIndex->Numbers, Min, Projection);
+		const int32 Last = Algo::UpperBoundBy(KeyIndex->Numbers, Max, Projection);
+		for (int32 Index = First; Index < Last; ++Index)
+		{
+			Slots.Add(KeyIndex->Numbers[Index].Value);
+		}
+	}
+	else
+	{
+		for (const TPair<double, int32>& Entry : KeyIndex->Numbers)
+		{
+			if (Entry.Key >= Min && Entry.Key <= Max)
+			{
+				Slots.Add(Entry.Value);
+			}
+		}
+	}
+
+	AddSlots(Slots, OutEvents);
+}
+
+void FReplayEventIndex::Serialize(FArchive& Ar)
+{
+	uint8 Version = static_cast<uint8>(ReplayEventIndex::EVersion::Latest);
+	Ar << Version;
+
+	if (Ar.IsLoading() && Version > static_cast<uint8>(ReplayEventIndex::EVersion::Latest))
+	{
+		Ar.SetError();
+		return;
+	}
+
+	if (Ar.IsSaving())
+	{
+		SortKeys();
+	}
+	else
+	{
+		Reset();
+	}
+
+	int32 NumEvents = Events.Num();
+	Ar << NumEvents;
+
+	if (Ar.IsLoading())
+	{
+		if (!ReplayEventIndex::IsValidCount(Ar, NumEvents))
+		{
+			return;
+		}
+		Events.SetNum(NumEvents);
+	}
+
+	for (int32 Slot = 0; Slot < NumEvents && !Ar.IsError(); ++Slot)
+	{
+		Ar << Events[Slot];
+		if (Ar.IsLoading())
+		{
+			EventSlots.Add(Events[Slot].EventID, Slot);
+		}
+	}
+
+	int32 NumKeys = Keys.Num();
+	Ar << NumKeys;
+
+	if (Ar.IsSaving())
+	{
+		for (TPair<FName, FKeyIndex>& Key : Keys)
+		{
+			FString Name = Key.Key.ToString();
+			Ar << Name;
+			Ar << Key.Value.Numbers;
+			Ar << Key.Value.Strings;
+		}
+		return;
+	}
+
+	if (!ReplayEventIndex::IsValidCount(Ar, NumKeys))
+	{
+		return;
+	}
+
+	for (int32 Index = 0; Index < NumKeys && !Ar.IsError(); ++Index)
+	{
+		FString Name;
+		Ar << Name;
+
+		FKeyIndex& KeyIndex = Keys.FindOrAdd(FName(*Name));
+		Ar << KeyIndex.Numbers;
+		Ar << KeyIndex.Strings;
+		KeyIndex.bSorted = false;
+	}
+
+	// Slots pointing outside the events mean the data is corrupt
+	for (const TPair<FName, FKeyIndex>& Key : Keys)
+	{
+		for (const TPair<double, int32>& Entry : Key.Value.Numbers)
+		{
+			if (!Events.IsValidIndex(Entry.Value))
+			{
+				Ar.SetError();
+			}
+		}
+		for (const TPair<FString, int32>& Entry : Key.Value.Strings)
+		{
+			if (!Events.IsValidIndex(Entry.Value))
+			{
+				Ar.SetError();
+			}
+		}
+	}
+
+	SortKeys();
+}
+
+void FReplayEventIndex::Append(const FReplayEventIndex& Other)
+{
+	TSet<FName> OtherKeys;
+	Other.Keys.GetKeys(OtherKeys);
+
+	for (const FReplayIndexedEvent& Event : Other.Events)
+	{
+		Add(Event, OtherKeys);
+	}
+}
+
+void FReplayEventIndex::Reset()
+{
+	Events.Reset();
+	EventSlots.Reset();
+	Keys.Reset();
+}
+
+SIZE_T FReplayEventIndex::GetAllocatedSize() const
+{
+	SIZE_T Size = Events.GetAllocatedSize() + EventSlots.GetAllocatedSize() + Keys.GetAllocatedSize();
+
+	for (const FReplayIndexedEvent& Event : Events)
+	{
+		Size += Event.GetAllocatedSize();
+	}
+
+	for (const TPair<FString, int32>& Slot : EventSlots)
+	{
+		Size += Slot.Key.GetAllocatedSize();
+	}
+
+	for (const TPair<FName, FKeyIndex>& Key : Keys)
+	{
+		Size += Key.Value.Numbers.GetAllocatedSize() + Key.Value.Strings.GetAllocatedSize();
+		for (const TPair<FString, int32>& Entry : Key.Value.Strings)
+		{
+			Size += Entry.Key.GetAllocatedSize();
+		}
+	}
+
+	return Size;
+}
+
+void FReplayEventIndex::SortKeys()
+{
+	for (TPair<FName, FKeyIndex>& Key : Keys)
+	{
+		if (!Key.Value.bSorted)
+		{
+			Key.Value.Numbers.StableSort([](const TPair<double, int32>& A, const TPair<double, int32>& B)
+			{
+				return A.Key < B.Key;
+			});
+			Key.Value.Strings.StableSort([](const TPair<FString, int32>& A, const TPair<FString, int32>& B)
+			{
+				return A.Key < B.Key;
+			});
+			Key.Value.bSorted = true;
+		}
+	}
+}
+
+void FReplayEventIndex::AddSlots(const TArray<int32>& Slots, TArray<FReplayIndexedEvent>& OutEvents) const
+{
+	OutEvents.Reserve(OutEvents.Num() + Slots.Num());
+	for (const int32 Slot : Slots)
+	{
+		OutEvents.Add(Events[Slot]);
+	}
+}
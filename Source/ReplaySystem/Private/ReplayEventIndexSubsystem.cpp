@@ -0,0 +1,406 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayEventIndexSubsystem.h"
+
+#include "NetworkReplayStreaming.h"
+#include "ReplaySearchIndex.h"
+#include "ReplayStateSubsystem.h"
+#include "ReplaySystem.h"
+#include "Containers/Ticker.h"
+#include "Engine/DemoNetDriver.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace ReplayEventIndex
+{
+	//The replay event group the index is stored under
+	const TCHAR* EventGroup = TEXT("ReplayEventIndex");
+
+	struct FPendingLoad
+	{
+		TSharedPtr<INetworkReplayStreamer> Streamer;
+
+		//Chunk index and data
+		TArray<TPair<int32, TArray<uint8>>> Chunks;
+
+		int32 NumPending = 0;
+
+		bool bFailed = false;
+	};
+}
+
+void UReplayEventIndexSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	IndexedKeySet = TSet<FName>(IndexedKeys);
+
+	// However the recording stops, the events since the last flush are written while the replay still takes them
+	if (UReplayStateSubsystem* StateSubsystem = Collection.InitializeDependency<UReplayStateSubsystem>())
+	{
+		RecordingStoppingHandle = StateSubsystem->OnRecordingStopping.AddUObject(
+			this, &UReplayEventIndexSubsystem::FlushIndex);
+	}
+}
+
+void UReplayEventIndexSubsystem::Deinitialize()
+{
+	FlushIndex();
+	PublishRecordingIndex();
+
+	if (UReplayStateSubsystem* StateSubsystem = GetWorld()->GetSubsystem<UReplayStateSubsystem>())
+	{
+		StateSubsystem->OnRecordingStopping.Remove(RecordingStoppingHandle);
+	}
+	RecordingStoppingHandle.Reset();
+
+	RecordingIndex.Reset();
+	PendingIndex.Reset();
+	LoadedIndexes.Reset();
+	MemoryCounter.Set(0);
+
+	Super::Deinitialize();
+}
+
+void UReplayEventIndexSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	LLM_SCOPE_BYTAG(ReplaySystem_Index);
+
+	if (bMemoryDirty && FPlatformTime::Seconds() - LastMemoryUpdateTime >= 1.0)
+	{
+		UpdateMemory();
+	}
+
+	const UDemoNetDriver* DemoDriver = GetWorld()->GetDemoNetDriver();
+
+	// The index of a recording that stopped was flushed by OnRecordingStopping
+	if (!DemoDriver || !DemoDriver->IsRecording())
+	{
+		PublishRecordingIndex();
+		bMemoryDirty |= !RecordingIndex.IsEmpty();
+		RecordingIndex.Reset();
+		PendingIndex.Reset();
+		RecordingReplayName.Reset();
+		NextChunkIndex = 0;
+		return;
+	}
+
+	const FString& ActiveReplayName = DemoDriver->GetActiveReplayName();
+
+	if (ActiveReplayName != RecordingReplayName)
+	{
+		// Events added before the first tick of a recording belong to it, only those of an earlier one are dropped
+		if (!RecordingReplayName.IsEmpty())
+		{
+			PublishRecordingIndex();
+			RecordingIndex.Reset();
+			PendingIndex.Reset();
+			NextChunkIndex = 0;
+		}
+
+		RecordingReplayName = ActiveReplayName;
+		bMemoryDirty = true;
+		LastFlushTime = 0.0f;
+		InvalidateIndex(ActiveReplayName);
+	}
+
+	// Only the events since the last chunk are written, flushing more often does not rewrite earlier ones
+	if (!PendingIndex.IsEmpty() && DemoDriver->GetDemoCurrentTime() - LastFlushTime >=
+		UReplayStateSubsystem::GetFlushInterval(FlushInterval))
+	{
+		FlushIndex();
+	}
+}
+
+TStatId UReplayEventIndexSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UReplayEventIndexSubsystem, STATGROUP_Tickables);
+}
+
+UReplayEventIndexSubsystem* UReplayEventIndexSubsystem::Get(const UObject* WorldContextObject)
+{
+	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
+	{
+		return World->GetSubsystem<UReplayEventIndexSubsystem>();
+	}
+
+	return nullptr;
+}
+
+bool UReplayEventIndexSubsystem::AddEvent(const FString& EventId, const FString& Group,
+                                          const TArray<FReplayMetadataValue>& Metadata, const TArray<uint8>& Data)
+{
+	UDemoNetDriver* DemoDriver = GetWorld()->GetDemoNetDriver();
+
+	if (!DemoDriver || !DemoDriver->IsRecording())
+	{
+		return false;
+	}
+
+	LLM_SCOPE_BYTAG(ReplaySystem_Index);
+
+	DemoDriver->AddOrUpdateEvent(EventId, Group, ReplayEventMetadata::Encode(Metadata), Data);
+
+	if (EventId.IsEmpty())
+	{
+		return true;
+	}
+
+	FReplayIndexedEvent Event;
+	Event.EventID = EventId;
+	Event.Group = Group;
+	Event.TimeInMs = static_cast<int32>(DemoDriver->GetDemoCurrentTimeInMS());
+	Event.Metadata = Metadata;
+
+	RecordingIndex.Add(Event, IndexedKeySet);
+	PendingIndex.Add(Event, IndexedKeySet);
+	bMemoryDirty = true;
+	return true;
+}
+
+void UReplayEventIndexSubsystem::IndexEvent(const FString& EventId, const FString& Group)
+{
+	const UDemoNetDriver* DemoDriver = GetWorld()->GetDemoNetDriver();
+
+	// The streamer makes up a new ID for every event added without one, there is nothing to index it by
+	if (!DemoDriver || !DemoDriver->IsRecording() || EventId.IsEmpty())
+	{
+		return;
+	}
+
+	LLM_SCOPE_BYTAG(ReplaySystem_Index);
+
+	// AddOrUpdateEvent replaced the event and its metadata, so does the index. Its typed metadata is dropped with it
+	FReplayIndexedEvent Event;
+	Event.EventID = EventId;
+	Event.Group = Group;
+	Event.TimeInMs = static_cast<int32>(DemoDriver->GetDemoCurrentTimeInMS());
+
+	RecordingIndex.Add(Event, IndexedKeySet);
+	PendingIndex.Add(Event, IndexedKeySet);
+	bMemoryDirty = true;
+}
+
+void UReplayEventIndexSubsystem::SetIndexedKeys(const TArray<FName>& Keys)
+{
+	IndexedKeys = Keys;
+	IndexedKeySet = TSet<FName>(IndexedKeys);
+}
+
+void UReplayEventIndexSubsystem::FlushIndex()
+{
+	const UWorld* World = GetWorld();
+	UDemoNetDriver* DemoDriver = World ? World->GetDemoNetDriver() : nullptr;
+
+	if (!DemoDriver || !DemoDriver->IsRecording())
+	{
+		return;
+	}
+
+	LastFlushTime = DemoDriver->GetDemoCurrentTime();
+
+	if (PendingIndex.IsEmpty())
+	{
+		return;
+	}
+
+	LLM_SCOPE_BYTAG(ReplaySystem_Index);
+
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+	PendingIndex.Serialize(Writer);
+
+	// Each chunk only holds what changed since the previous one, loading applies them in order
+	const int32 ChunkIndex = NextChunkIndex++;
+
+	DemoDriver->AddOrUpdateEvent(FString::Printf(TEXT("EventIndex_%06d"), ChunkIndex), ReplayEventIndex::EventGroup,
+	                             FString::FromInt(ChunkIndex), Data);
+
+	PendingIndex.Reset();
+	bMemoryDirty = true;
+	InvalidateIndex(DemoDriver->GetActiveReplayName());
+}
+
+void UReplayEventIndexSubsystem::FindEvents(const FString& ReplayName, const FReplayMetadataValue& Value,
+                                            FOnQueryReplayEventsComplete OnComplete)
+{
+	LoadIndex(ReplayName, [Value, OnComplete](TSharedPtr<const FReplayEventIndex> Index)
+	{
+		TArray<FReplayIndexedEvent> Events;
+		if (Index.IsValid())
+		{
+			Index->FindEqual(Value, Events);
+		}
+		OnComplete.ExecuteIfBound(Index.IsValid(), Events);
+	});
+}
+
+void UReplayEventIndexSubsystem::FindEventsInRange(const FString& ReplayName, FName Key, double Min, double Max,
+                                                   FOnQueryReplayEventsComplete OnComplete)
+{
+	LoadIndex(ReplayName, [Key, Min, Max, OnComplete](TSharedPtr<const FReplayEventIndex> Index)
+	{
+		TArray<FReplayIndexedEvent> Events;
+		if (Index.IsValid())
+		{
+			Index->FindInRange(Key, Min, Max, Events);
+		}
+		OnComplete.ExecuteIfBound(Index.IsValid(), Events);
+	});
+}
+
+void UReplayEventIndexSubsystem::LoadIndex(const FString& ReplayName,
+                                           TFunction<void(TSharedPtr<const FReplayEventIndex>)> OnComplete)
+{
+	if (const TSharedPtr<const FReplayEventIndex>* Cached = LoadedIndexes.Find(ReplayName))
+	{
+		OnComplete(*Cached);
+		return;
+	}
+
+	LLM_SCOPE_BYTAG(ReplaySystem_Index);
+
+	const TSharedRef<ReplayEventIndex::FPendingLoad> Load = MakeShared<ReplayEventIndex::FPendingLoad>();
+	Load->Streamer = FNetworkReplayStreaming::Get().GetFactory().CreateReplayStreamer();
+
+	if (!Load->Streamer.IsValid())
+	{
+		OnComplete(nullptr);
+		return;
+	}
+
+	TWeakObjectPtr<UReplayEventIndexSubsystem> WeakThis = this;
+
+	const auto Finish = [WeakThis, ReplayName, OnComplete](const TSharedRef<ReplayEventIndex::FPendingLoad>& Load)
+	{
+		// The streamer holds the callbacks that hold the load, release it once we are out of its callback
+		FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([Load](float)
+		{
+			Load->Streamer.Reset();
+			return false;
+		}));
+
+		if (Load->bFailed || Load->Chunks.Num() == 0)
+		{
+			OnComplete(nullptr);
+			return;
+		}
+
+		LLM_SCOPE_BYTAG(ReplaySystem_Index);
+
+		// Later chunks replace the events of earlier ones that were updated in between
+		Load->Chunks.Sort([](const TPair<int32, TArray<uint8>>& A, const TPair<int32, TArray<uint8>>& B)
+		{
+			return A.Key < B.Key;
+		});
+
+		const TSharedRef<FReplayEventIndex> Index = MakeShared<FReplayEventIndex>();
+
+		for (const TPair<int32, TArray<uint8>>& Chunk : Load->Chunks)
+		{
+			FReplayEventIndex ChunkIndex;
+			FMemoryReader Reader(Chunk.Value);
+			ChunkIndex.Serialize(Reader);
+
+			if (Reader.IsError())
+			{
+				UE_LOG(LogReplaySystem, Warning, TEXT("Event index chunk %d of replay %s is corrupt"), Chunk.Key,
+				       *ReplayName);
+				OnComplete(nullptr);
+				return;
+			}
+
+			Index->Append(ChunkIndex);
+		}
+
+		if (UReplayEventIndexSubsystem* This = WeakThis.Get())
+		{
+			This->LoadedIndexes.Add(ReplayName, Index);
+			This->bMemoryDirty = true;
+		}
+
+		OnComplete(Index);
+	};
+
+	Load->Streamer->EnumerateEvents(ReplayName, ReplayEventIndex::EventGroup, INDEX_NONE,
+	                                FEnumerateEventsCallback::CreateLambda(
+		                                [Load, ReplayName, Finish](const FEnumerateEventsResult& Results)
+		                                {
+			                                if (!Results.WasSuccessful())
+			                                {
+				                                Load->bFailed = true;
+				                                Finish(Load);
+				                                return;
+			                                }
+
+			                                Load->NumPending = Results.ReplayEventList.ReplayEvents.Num();
+
+			                                if (Load->NumPending == 0)
+			                                {
+				                                Finish(Load);
+				                                return;
+			                                }
+
+			                                for (const FReplayEventListItem& EventItem : Results.ReplayEventList.
+			                                     ReplayEvents)
+			                                {
+				                                // Replays recorded before indexes were chunked have one event without
+				                                // metadata, it reads as chunk 0
+				                                const int32 ChunkIndex = FCString::Atoi(*EventItem.Metadata);
+
+				                                Load->Streamer->RequestEventData(
+					                                ReplayName, EventItem.ID, INDEX_NONE,
+					                                FRequestEventDataCallback::CreateLambda(
+						                                [Load, ChunkIndex, Finish](const FRequestEventDataResult& Result)
+						                                {
+							                                LLM_SCOPE_BYTAG(ReplaySystem_Index);
+
+							                                if (Result.WasSuccessful())
+							                                {
+								                                Load->Chunks.Emplace(
+									                                ChunkIndex, Result.ReplayEventListItem);
+							                                }
+							                                else
+							                                {
+								                                Load->bFailed = true;
+							                                }
+
+							                                if (--Load->NumPending == 0)
+							                                {
+								                                Finish(Load);
+							                                }
+						                                }));
+			                                }
+		                                }));
+}
+
+void UReplayEventIndexSubsystem::InvalidateIndex(const FString& ReplayName)
+{
+	bMemoryDirty |= LoadedIndexes.Remove(ReplayName) > 0;
+}
+
+void UReplayEventIndexSubsystem::PublishRecordingIndex()
+{
+	if (!RecordingReplayName.IsEmpty() && !RecordingIndex.IsEmpty())
+	{
+		FReplaySearchIndex::Get().UpdateReplay(RecordingReplayName, RecordingIndex, IndexedKeySet);
+	}
+}
+
+void UReplayEventIndexSubsystem::UpdateMemory()
+{
+	SIZE_T Size = RecordingIndex.GetAllocatedSize() + PendingIndex.GetAllocatedSize() +
+	              LoadedIndexes.GetAllocatedSize();
+	for (const TPair<FString, TSharedPtr<const FReplayEventIndex>>& Pair : LoadedIndexes)
+	{
+		Size += Pair.Value->GetAllocatedSize();
+	}
+
+	MemoryCounter.Set(Size);
+	bMemoryDirty = false;
+	LastMemoryUpdateTime = FPlatformTime::Seconds();
+}
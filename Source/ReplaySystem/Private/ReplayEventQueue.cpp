@@ -0,0 +1,90 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayEventQueue.h"
+
+#include "NetworkReplayStreaming.h"
+#include "ReplayMemory.h"
+
+FReplayEventQueue& FReplayEventQueue::Get()
+{
+	static FReplayEventQueue Queue;
+	return Queue;
+}
+
+bool FReplayEventQueue::Enqueue(FString EventId, FString Group, FString Metadata, TArray<uint8> Data)
+{
+	if (!IsRecording())
+	{
+		return false;
+	}
+
+	LLM_SCOPE_BYTAG(ReplaySystem_Events);
+
+	FQueuedReplayEvent Event;
+	Event.TimeInMS = GetRecordingTimeInMS();
+	Event.RecordingSerial = RecordingSerial.load(std::memory_order_acquire);
+	Event.EventId = MoveTemp(EventId);
+	Event.Group = MoveTemp(Group);
+	Event.Metadata = MoveTemp(Metadata);
+	Event.Data = MoveTemp(Data);
+
+	FReplayMemory::Add(EReplayMemoryCategory::Events, Event.GetAllocatedSize());
+
+	return Events.Enqueue(MoveTemp(Event));
+}
+
+void FReplayEventQueue::StartRecording(uint32 TimeInMS)
+{
+	check(IsInGameThread());
+
+	RecordingSerial.fetch_add(1, std::memory_order_acq_rel);
+	RecordingTimeInMS.store(TimeInMS, std::memory_order_relaxed);
+	bIsRecording.store(true, std::memory_order_release);
+}
+
+void FReplayEventQueue::SetRecordingTime(uint32 TimeInMS)
+{
+	RecordingTimeInMS.store(TimeInMS, std::memory_order_relaxed);
+}
+
+void FReplayEventQueue::StopRecording()
+{
+	check(IsInGameThread());
+
+	bIsRecording.store(false, std::memory_order_release);
+	// Anything queued after this belongs to no recording and is dropped by the next drain
+	RecordingSerial.fetch_add(1, std::memory_order_acq_rel);
+
+	FQueuedReplayEvent Event;
+	while (Events.Dequeue(Event))
+	{
+		FReplayMemory::Add(EReplayMemoryCategory::Events, -static_cast<int64>(Event.GetAllocatedSize()));
+	}
+}
+
+int32 FReplayEventQueue::Drain(INetworkReplayStreamer& Streamer)
+{
+	check(IsInGameThread());
+
+	// The streamer's copies of the events are tagged too
+	LLM_SCOPE_BYTAG(ReplaySystem_Events);
+
+	const uint32 Serial = RecordingSerial.load(std::memory_order_acquire);
+	int32 NumWritten = 0;
+
+	FQueuedReplayEvent Event;
+	while (Events.Dequeue(Event))
+	{
+		FReplayMemory::Add(EReplayMemoryCategory::Events, -static_cast<int64>(Event.GetAllocatedSize()));
+
+		if (Event.RecordingSerial != Serial)
+		{
+			continue;
+		}
+
+		Streamer.AddOrUpdateEvent(Event.TimeInMS, Event.Group, Event.EventId, Event.Metadata, Event.Data);
+		++NumWritten;
+	}
+
+	return NumWritten;
+}
@@ -0,0 +1,351 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayFileUtils.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/CustomVersion.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace ReplayFileUtils
+{
+	//Written in front of the checksums so an unrelated file is never taken for them
+	constexpr uint32 ChecksumMagic = 0x52534352;
+
+	//Copies are done in blocks of this size
+	constexpr int64 CopyBlockSize = 1024 * 1024;
+}
+
+FString ReplayFileUtils::GetReplayFilename(const FString& ReplayName)
+{
+	return FPaths::Combine(FLocalFileNetworkReplayStreamer::GetDefaultDemoSavePath(), ReplayName + TEXT(".replay"));
+}
+
+FString ReplayFileUtils::GetChecksumFilename(const FString& ReplayName)
+{
+	return GetReplayFilename(ReplayName) + TEXT(".crc");
+}
+
+bool ReplayFileUtils::ReadLayout(IFileHandle& File, FReplayFileLayout& OutLayout)
+{
+	OutLayout = FReplayFileLayout();
+	OutLayout.FileSize = File.Size();
+
+	// The header is small, anything larger than this before the first chunk is not a replay
+	TArray<uint8> Header;
+	Header.SetNumUninitialized(static_cast<int32>(FMath::Min<int64>(OutLayout.FileSize, 64 * 1024)));
+
+	if (Header.Num() == 0 || !File.Seek(0) || !File.Read(Header.GetData(), Header.Num()))
+	{
+		return false;
+	}
+
+	// Mirrors the order the local file streamer writes its header in
+	FMemoryReader Reader(Header);
+
+	uint32 MagicNumber = 0;
+	Reader << MagicNumber;
+	Reader << OutLayout.FileVersion;
+
+	if (MagicNumber != FLocalFileNetworkReplayStreamer::FileMagic)
+	{
+		return false;
+	}
+
+	if (OutLayout.FileVersion >= static_cast<uint32>(ELocalFileVersionHistory::HISTORY_CUSTOM_VERSIONS))
+	{
+		FCustomVersionContainer CustomVersions;
+		CustomVersions.Serialize(Reader);
+	}
+
+	OutLayout.LengthInMSOffset = Reader.Tell();
+
+	uint32 NetworkVersion = 0;
+	uint32 Changelist = 0;
+	FString FriendlyName;
+	Reader << OutLayout.LengthInMS;
+	Reader << NetworkVersion;
+	Reader << Changelist;
+	Reader << FriendlyName;
+
+	OutLayout.IsLiveOffset = Reader.Tell();
+
+	uint32 IsLive = 0;
+	Reader << IsLive;
+	OutLayout.bIsLive = IsLive != 0;
+
+	if (OutLayout.FileVersion >= static_cast<uint32>(ELocalFileVersionHistory::HISTORY_RECORDED_TIMESTAMP))
+	{
+		FDateTime Timestamp;
+		Reader << Timestamp;
+	}
+
+	if (OutLayout.FileVersion >= static_cast<uint32>(ELocalFileVersionHistory::HISTORY_COMPRESSION))
+	{
+		uint32 Compressed = 0;
+		Reader << Compressed;
+	}
+
+	if (OutLayout.FileVersion >= static_cast<uint32>(ELocalFileVersionHistory::HISTORY_ENCRYPTION))
+	{
+		uint32 Encrypted = 0;
+		TArray<uint8> EncryptionKey;
+		Reader << Encrypted;
+		Reader << EncryptionKey;
+	}
+
+	if (Reader.IsError())
+	{
+		return false;
+	}
+
+	OutLayout.HeaderSize = Reader.Tell();
+
+	// Walk the chunk headers, stopping at the first one that runs past the end of the file
+	int64 Offset = OutLayout.HeaderSize;
+
+	while (Offset < OutLayout.FileSize)
+	{
+		uint32 ChunkType = 0;
+		int32 SizeInBytes = 0;
+
+		if (Offset + 8 > OutLayout.FileSize || !File.Seek(Offset) || !File.Read(reinterpret_cast<uint8*>(&ChunkType), 4) ||
+			!File.Read(reinterpret_cast<uint8*>(&SizeInBytes), 4))
+		{
+			OutLayout.bTruncated = true;
+			break;
+		}
+
+		FChunk Chunk;
+		Chunk.ChunkType = static_cast<ELocalFileChunkType>(ChunkType);
+		Chunk.SizeInBytes = SizeInBytes;
+		Chunk.TypeOffset = Offset;
+		Chunk.DataOffset = Offset + 8;
+
+		if (SizeInBytes < 0 || Chunk.DataOffset + SizeInBytes > OutLayout.FileSize)
+		{
+			OutLayout.bTruncated = true;
+			break;
+		}
+
+		if (Chunk.ChunkType == ELocalFileChunkType::ReplayData && SizeInBytes >= 8 && OutLayout.FileVersion >=
+			static_cast<uint32>(ELocalFileVersionHistory::HISTORY_STREAM_CHUNK_TIMES))
+		{
+			uint32 Times[2] = {0, 0};
+			if (File.Read(reinterpret_cast<uint8*>(Times), sizeof(Times)))
+			{
+				Chunk.StartTimeInMS = Times[0];
+				Chunk.EndTimeInMS = Times[1];
+			}
+		}
+
+		OutLayout.Chunks.Add(Chunk);
+		Offset = Chunk.DataOffset + SizeInBytes;
+	}
+
+	return true;
+}
+
+bool ReplayFileUtils::ReadPatchedHeader(IFileHandle& File, const FReplayFileLayout& Layout, int32 LengthInMS,
+                                        bool bIsLive, TArray<uint8>& OutHeader)
+{
+	OutHeader.SetNumUninitialized(static_cast<int32>(Layout.HeaderSize));
+
+	if (!File.Seek(0) || !File.Read(OutHeader.GetData(), OutHeader.Num()))
+	{
+		return false;
+	}
+
+	FMemoryWriter Writer(OutHeader);
+
+	Writer.Seek(Layout.LengthInMSOffset);
+	Writer << LengthInMS;
+
+	uint32 IsLive = bIsLive ? 1 : 0;
+	Writer.Seek(Layout.IsLiveOffset);
+	Writer << IsLive;
+
+	return !Writer.IsError() && OutHeader.Num() == Layout.HeaderSize;
+}
+
+bool ReplayFileUtils::ChecksumChunk(IFileHandle& File, const FChunk& Chunk, uint32& OutCrc)
+{
+	if (Chunk.SizeInBytes < 0 || Chunk.DataOffset < 0 || Chunk.DataOffset + Chunk.SizeInBytes > File.Size())
+	{
+		return false;
+	}
+
+	if (!File.Seek(Chunk.DataOffset))
+	{
+		return false;
+	}
+
+	TArray<uint8> Buffer;
+	Buffer.SetNumUninitialized(static_cast<int32>(FMath::Min<int64>(Chunk.SizeInBytes, CopyBlockSize)));
+
+	uint32 Crc = 0;
+	int64 Remaining = Chunk.SizeInBytes;
+
+	while (Remaining > 0)
+	{
+		const int64 BlockSize = FMath::Min<int64>(Remaining, Buffer.Num());
+		if (!File.Read(Buffer.GetData(), BlockSize))
+		{
+			return false;
+		}
+
+		Crc = FCrc::MemCrc32(Buffer.GetData(), static_cast<int32>(BlockSize), Crc);
+		Remaining -= BlockSize;
+	}
+
+	OutCrc = Crc;
+	return true;
+}
+
+bool ReplayFileUtils::ReadEventHeader(IFileHandle& File, const FChunk& Chunk, FEventHeader& OutHeader)
+{
+	if (Chunk.ChunkType != ELocalFileChunkType::Event && Chunk.ChunkType != ELocalFileChunkType::Checkpoint)
+	{
+		return false;
+	}
+
+	// Ids and groups are short, the metadata is the only field that can be large
+	TArray<uint8> Data;
+	Data.SetNumUninitialized(static_cast<int32>(FMath::Min<int64>(Chunk.SizeInBytes, 256 * 1024)));
+
+	if (Data.Num() == 0 || !File.Seek(Chunk.DataOffset) || !File.Read(Data.GetData(), Data.Num()))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+	Reader << OutHeader;
+
+	return !Reader.IsError();
+}
+
+TArray<uint8> ReplayFileUtils::MakeEventChunk(FEventHeader Header, const TArray<uint8>& Data)
+{
+	TArray<uint8> Chunk;
+	FMemoryWriter Writer(Chunk);
+
+	uint32 ChunkType = static_cast<uint32>(ELocalFileChunkType::Event);
+	int32 SizeInBytes = 0;
+	Writer << ChunkType;
+	Writer << SizeInBytes;
+
+	int32 DataSize = Data.Num();
+	Writer << Header;
+	Writer << DataSize;
+	Writer.Serialize(const_cast<uint8*>(Data.GetData()), DataSize);
+
+	// Patch the size now that it is known
+	SizeInBytes = Chunk.Num() - 8;
+	Writer.Seek(4);
+	Writer << SizeInBytes;
+
+	return Chunk;
+}
+
+bool ReplayFileUtils::CopyRange(IFileHandle& From, IFileHandle& To, int64 Offset, int64 Size)
+{
+	if (Size < 0 || Offset < 0 || Offset + Size > From.Size() || !From.Seek(Offset))
+	{
+		return false;
+	}
+
+	TArray<uint8> Buffer;
+	Buffer.SetNumUninitialized(static_cast<int32>(FMath::Min<int64>(FMath::Max<int64>(Size, 1), CopyBlockSize)));
+
+	int64 Remaining = Size;
+
+	while (Remaining > 0)
+	{
+		const int64 BlockSize = FMath::Min<int64>(Remaining, Buffer.Num());
+		if (!From.Read(Buffer.GetData(), BlockSize) || !To.Write(Buffer.GetData(), BlockSize))
+		{
+			return false;
+		}
+
+		Remaining -= BlockSize;
+	}
+
+	return true;
+}
+
+bool ReplayFileUtils::LoadChecksums(const FString& ReplayName, TArray<FChunkChecksum>& OutChecksums)
+{
+	OutChecksums.Reset();
+
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *GetChecksumFilename(ReplayName), FILEREAD_Silent))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+
+	uint32 Magic = 0;
+	Reader << Magic;
+
+	int32 NumChecksums = 0;
+	Reader << NumChecksums;
+
+	// Each checksum takes 16 bytes
+	if (Magic != ChecksumMagic || NumChecksums < 0 || NumChecksums > Data.Num() / 16)
+	{
+		return false;
+	}
+
+	OutChecksums.SetNum(NumChecksums);
+	for (FChunkChecksum& Checksum : OutChecksums)
+	{
+		Reader << Checksum;
+	}
+
+	if (Reader.IsError())
+	{
+		OutChecksums.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+bool ReplayFileUtils::SaveChecksums(const FString& ReplayName, const TArray<FChunkChecksum>& Checksums)
+{
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+
+	uint32 Magic = ChecksumMagic;
+	Writer << Magic;
+
+	int32 NumChecksums = Checksums.Num();
+	Writer << NumChecksums;
+
+	for (FChunkChecksum Checksum : Checksums)
+	{
+		Writer << Checksum;
+	}
+
+	const FString Filename = GetChecksumFilename(ReplayName);
+	const FString TempFilename = Filename + TEXT(".tmp");
+
+	return FFileHelper::SaveArrayToFile(Data, *TempFilename) && IFileManager::Get().Move(
+		*Filename, *TempFilename, true, true);
+}
+
+uint32 ReplayFileUtils::GetDataLengthInMS(const FReplayFileLayout& Layout, int32 NumChunks)
+{
+	uint32 LengthInMS = 0;
+
+	for (int32 Index = 0; Index < FMath::Min(NumChunks, Layout.Chunks.Num()); ++Index)
+	{
+		LengthInMS = FMath::Max(LengthInMS, Layout.Chunks[Index].EndTimeInMS);
+	}
+
+	return LengthInMS;
+}
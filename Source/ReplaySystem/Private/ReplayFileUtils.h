@@ -0,0 +1,149 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LocalFileNetworkReplayStreaming.h"
+
+class IFileHandle;
+
+/**
+ *  Helpers working directly on the files written by the local file replay streamer
+ */
+namespace ReplayFileUtils
+{
+	struct FChunkChecksum
+	{
+		//Offset of the chunk in the replay file
+		int64 TypeOffset = 0;
+
+		int32 SizeInBytes = 0;
+
+		uint32 Crc = 0;
+
+		friend FArchive& operator<<(FArchive& Ar, FChunkChecksum& Checksum)
+		{
+			Ar << Checksum.TypeOffset;
+			Ar << Checksum.SizeInBytes;
+			Ar << Checksum.Crc;
+			return Ar;
+		}
+	};
+
+	struct FChunk
+	{
+		ELocalFileChunkType ChunkType = ELocalFileChunkType::Unknown;
+
+		int32 SizeInBytes = 0;
+
+		//Where the chunk's type is stored, the start of the chunk
+		int64 TypeOffset = 0;
+
+		//Where the chunk's data starts
+		int64 DataOffset = 0;
+
+		//Replay time covered by a replay data chunk
+		uint32 StartTimeInMS = 0;
+
+		uint32 EndTimeInMS = 0;
+	};
+
+	/**
+	 *  The fields in front of the data of an event or checkpoint chunk
+	 */
+	struct FEventHeader
+	{
+		FString Id;
+
+		FString Group;
+
+		FString Metadata;
+
+		uint32 Time1 = 0;
+
+		uint32 Time2 = 0;
+
+		friend FArchive& operator<<(FArchive& Ar, FEventHeader& Header)
+		{
+			Ar << Header.Id;
+			Ar << Header.Group;
+			Ar << Header.Metadata;
+			Ar << Header.Time1;
+			Ar << Header.Time2;
+			return Ar;
+		}
+	};
+
+	/**
+	 *  The layout of a replay file. Unlike the streamer's own reader this also describes files whose last chunk was cut
+	 *  off, so they can be repaired.
+	 */
+	struct FReplayFileLayout
+	{
+		uint32 FileVersion = 0;
+
+		int64 FileSize = 0;
+
+		//Where the header fields that change while recording are stored
+		int64 LengthInMSOffset = INDEX_NONE;
+
+		int64 IsLiveOffset = INDEX_NONE;
+
+		int32 LengthInMS = 0;
+
+		bool bIsLive = false;
+
+		//The bytes before the first chunk
+		int64 HeaderSize = 0;
+
+		//Every complete chunk
+		TArray<FChunk> Chunks;
+
+		//True if the file ends inside a chunk
+		bool bTruncated = false;
+	};
+
+	FString GetReplayFilename(const FString& ReplayName);
+
+	//Per chunk checksums written next to the replay
+	FString GetChecksumFilename(const FString& ReplayName);
+
+	/**
+	 *  Reads the header and chunk table of a replay file. Safe on any thread
+	 * @return False if the file is missing or its header is unreadable
+	 */
+	bool ReadLayout(IFileHandle& File, FReplayFileLayout& OutLayout);
+
+	/**
+	 *  Reads the bytes before the first chunk with the length and live flag rewritten
+	 */
+	bool ReadPatchedHeader(IFileHandle& File, const FReplayFileLayout& Layout, int32 LengthInMS, bool bIsLive,
+	                       TArray<uint8>& OutHeader);
+
+	/**
+	 *  CRC of a chunk's data
+	 * @return False if the chunk runs past the end of the file
+	 */
+	bool ChecksumChunk(IFileHandle& File, const FChunk& Chunk, uint32& OutCrc);
+
+	/**
+	 *  Reads the id, group, metadata and times of an event or checkpoint chunk
+	 */
+	bool ReadEventHeader(IFileHandle& File, const FChunk& Chunk, FEventHeader& OutHeader);
+
+	/**
+	 *  Builds an event chunk the way the streamer writes them, type and size included
+	 */
+	TArray<uint8> MakeEventChunk(FEventHeader Header, const TArray<uint8>& Data);
+
+	bool CopyRange(IFileHandle& From, IFileHandle& To, int64 Offset, int64 Size);
+
+	bool LoadChecksums(const FString& ReplayName, TArray<FChunkChecksum>& OutChecksums);
+
+	bool SaveChecksums(const FString& ReplayName, const TArray<FChunkChecksum>& Checksums);
+
+	/**
+	 *  Replay time covered by the stream data of the first NumChunks chunks
+	 */
+	uint32 GetDataLengthInMS(const FReplayFileLayout& Layout, int32 NumChunks);
+}
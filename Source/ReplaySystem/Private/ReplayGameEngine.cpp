@@ -0,0 +1,21 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayGameEngine.h"
+
+#include "Misc/PackageName.h"
+
+bool UReplayGameEngine::Experimental_ShouldPreDuplicateMap(const FName MapName) const
+{
+	if (bInstantReplayOnAllMaps)
+	{
+		return true;
+	}
+
+	const FString LongName = MapName.ToString();
+	const FString ShortName = FPackageName::GetShortName(LongName);
+
+	return InstantReplayMaps.ContainsByPredicate([&](const FString& Map)
+	{
+		return Map.Equals(LongName, ESearchCase::IgnoreCase) || Map.Equals(ShortName, ESearchCase::IgnoreCase);
+	});
+}
@@ -0,0 +1,331 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayGhostSubsystem.h"
+
+#include "EngineUtils.h"
+#include "ReplayStateSubsystem.h"
+#include "Engine/DemoNetDriver.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerState.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace ReplayGhosts
+{
+	const TCHAR* EventGroup = TEXT("ReplayGhosts");
+}
+
+void UReplayGhostSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	ActorSpawnedHandle = GetWorld()->AddOnActorSpawnedHandler(
+		FOnActorSpawned::FDelegate::CreateUObject(this, &UReplayGhostSubsystem::OnActorSpawned));
+
+	// However the recording stops, the positions since the last flush are written while the replay still takes them
+	if (UReplayStateSubsystem* StateSubsystem = Collection.InitializeDependency<UReplayStateSubsystem>())
+	{
+		RecordingStoppingHandle = StateSubsystem->OnRecordingStopping.AddUObject(
+			this, &UReplayGhostSubsystem::FlushGhosts);
+	}
+}
+
+void UReplayGhostSubsystem::Deinitialize()
+{
+	FlushGhosts();
+
+	GetWorld()->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+
+	if (UReplayStateSubsystem* StateSubsystem = GetWorld()->GetSubsystem<UReplayStateSubsystem>())
+	{
+		StateSubsystem->OnRecordingStopping.Remove(RecordingStoppingHandle);
+	}
+	RecordingStoppingHandle.Reset();
+
+	GhostActors.Reset();
+	RecordingGhosts.Reset();
+	PresentGhosts.Reset();
+	SampledGhosts.Reset();
+	LoadedGhosts.Reset();
+	MemoryCounter.Set(0);
+
+	Super::Deinitialize();
+}
+
+void UReplayGhostSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	LLM_SCOPE_BYTAG(ReplaySystem_Tracks);
+
+	MemoryCounter.Set(RecordingGhosts.GetAllocatedSize() + LoadedGhosts.GetAllocatedSize());
+
+	const UDemoNetDriver* DemoDriver = GetWorld()->GetDemoNetDriver();
+
+	if (DemoDriver && DemoDriver->IsPlaying() && bLoadOnPlayback)
+	{
+		const FString& ActiveReplayName = DemoDriver->GetActiveReplayName();
+
+		if (ActiveReplayName != PlayingReplayName)
+		{
+			PlayingReplayName = ActiveReplayName;
+			LoadGhosts(ActiveReplayName, FOnLoadReplayTracksComplete());
+		}
+	}
+
+	// The ghosts of a recording that stopped were flushed by OnRecordingStopping
+	if (!DemoDriver || !DemoDriver->IsRecording())
+	{
+		RecordingGhosts.Reset();
+		PresentGhosts.Reset();
+		RecordingReplayName.Reset();
+		return;
+	}
+
+	const FString& ActiveReplayName = DemoDriver->GetActiveReplayName();
+
+	if (ActiveReplayName != RecordingReplayName)
+	{
+		RecordingReplayName = ActiveReplayName;
+		RecordingGhosts.Reset();
+		PresentGhosts.Reset();
+		NextChunkIndex = 0;
+		LastFlushTime = 0.0f;
+		LastSampleTime = -SampleInterval;
+
+		// Actors spawned while nothing was recorded were not picked up by OnActorSpawned
+		if (!GhostActorTag.IsNone())
+		{
+			for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+			{
+				if (It->ActorHasTag(GhostActorTag))
+				{
+					AddGhostActor(*It);
+				}
+			}
+		}
+	}
+
+	const float Time = DemoDriver->GetDemoCurrentTime();
+
+	if (Time - LastSampleTime >= SampleInterval)
+	{
+		SampleGhosts(Time);
+	}
+
+	if (Time - LastFlushTime >= UReplayStateSubsystem::GetFlushInterval(FlushInterval))
+	{
+		FlushGhosts();
+	}
+}
+
+TStatId UReplayGhostSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UReplayGhostSubsystem, STATGROUP_Tickables);
+}
+
+UReplayGhostSubsystem* UReplayGhostSubsystem::Get(const UObject* WorldContextObject)
+{
+	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
+	{
+		return World->GetSubsystem<UReplayGhostSubsystem>();
+	}
+
+	return nullptr;
+}
+
+void UReplayGhostSubsystem::AddGhostActor(AActor* Actor, const FString& Name)
+{
+	if (!Actor)
+	{
+		return;
+	}
+
+	const FName GhostName(Name.IsEmpty() ? *Actor->GetName() : *Name);
+
+	for (FGhostActor& Ghost : GhostActors)
+	{
+		if (Ghost.Actor == Actor)
+		{
+			Ghost.Name = GhostName;
+			return;
+		}
+	}
+
+	GhostActors.Add({Actor, GhostName});
+}
+
+void UReplayGhostSubsystem::RemoveGhostActor(AActor* Actor)
+{
+	GhostActors.RemoveAllSwap([Actor](const FGhostActor& Ghost) { return Ghost.Actor == Actor; });
+}
+
+void UReplayGhostSubsystem::FlushGhosts()
+{
+	const UWorld* World = GetWorld();
+	UDemoNetDriver* DemoDriver = World ? World->GetDemoNetDriver() : nullptr;
+
+	if (!DemoDriver || !DemoDriver->IsRecording())
+	{
+		return;
+	}
+
+	LastFlushTime = DemoDriver->GetDemoCurrentTime();
+
+	if (RecordingGhosts.IsEmpty())
+	{
+		return;
+	}
+
+	LLM_SCOPE_BYTAG(ReplaySystem_Tracks);
+
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+	RecordingGhosts.Serialize(Writer);
+
+	const int32 ChunkIndex = NextChunkIndex++;
+
+	DemoDriver->AddOrUpdateEvent(FString::Printf(TEXT("Ghosts_%06d"), ChunkIndex), ReplayGhosts::EventGroup,
+	                             FString::FromInt(ChunkIndex), Data);
+
+	RecordingGhosts.Reset();
+}
+
+void UReplayGhostSubsystem::LoadGhosts(const FString& ReplayName, FOnLoadReplayTracksComplete OnComplete)
+{
+	const int32 Serial = ++LoadSerial;
+
+	TWeakObjectPtr<UReplayGhostSubsystem> WeakThis = this;
+
+	ReplayTracks::LoadChunks(ReplayName, ReplayGhosts::EventGroup,
+	                         [WeakThis, Serial, ReplayName, OnComplete](bool bWasSuccessful, FReplayTrackSet&& Tracks)
+	                         {
+		                         UReplayGhostSubsystem* This = WeakThis.Get();
+
+		                         if (!This || This->LoadSerial != Serial)
+		                         {
+			                         return;
+		                         }
+
+		                         This->LoadedGhosts = MoveTemp(Tracks);
+		                         This->LoadedReplayName = ReplayName;
+
+		                         OnComplete.ExecuteIfBound(bWasSuccessful);
+	                         });
+}
+
+void UReplayGhostSubsystem::GetGhostPositions(float Time, TArray<FReplayGhostPosition>& OutPositions) const
+{
+	OutPositions.Reset();
+
+	const TReplayNamedColumn<TReplayTrack<FVector>>& Tracks = LoadedGhosts.GetTracks<FVector>();
+	const TReplayNamedColumn<TReplayTrack<bool>>& States = LoadedGhosts.GetTracks<bool>();
+	const TConstArrayView<FName> Names = Tracks.GetNames();
+	const TConstArrayView<TReplayTrack<FVector>> Ghosts = Tracks.GetValues();
+
+	for (int32 Index = 0; Index < Ghosts.Num(); ++Index)
+	{
+		const TReplayTrack<FVector>& Ghost = Ghosts[Index];
+		const int32 Key = Ghost.FindKeyIndexCached(Time);
+
+		if (Key < 0)
+		{
+			continue;
+		}
+
+		// Samples can be far apart after a hitch, only the marks tell whether the ghost was gone in between
+		const TReplayTrack<bool>* State = States.Find(Names[Index]);
+		const int32 StateKey = State ? State->FindKeyIndexCached(Time) : INDEX_NONE;
+
+		if (State && (StateKey < 0 || !State->Values[StateKey]))
+		{
+			continue;
+		}
+
+		FVector Location;
+
+		if (Key + 1 < Ghost.Num() && (!State || State->FindKeyIndex(Ghost.Times[Key + 1]) == StateKey))
+		{
+			Ghost.Evaluate(Time, Location);
+		}
+		else
+		{
+			Location = Ghost.Values[Key];
+		}
+
+		FReplayGhostPosition& Position = OutPositions.AddDefaulted_GetRef();
+		Position.Name = Names[Index].ToString();
+		Position.Location = Location;
+	}
+}
+
+void UReplayGhostSubsystem::SampleGhosts(float Time)
+{
+	LastSampleTime = Time;
+
+	LLM_SCOPE_BYTAG(ReplaySystem_Tracks);
+
+	if (bRecordPlayerPawns)
+	{
+		if (const AGameStateBase* GameState = GetWorld()->GetGameState())
+		{
+			for (const APlayerState* PlayerState : GameState->PlayerArray)
+			{
+				const APawn* Pawn = PlayerState ? PlayerState->GetPawn() : nullptr;
+
+				// Keyed by player ID, display names are neither unique nor fixed for a whole match
+				if (Pawn && !PlayerState->IsInactive())
+				{
+					Record(FName(*FString::Printf(TEXT("Player_%d"), PlayerState->GetPlayerId())), Time,
+					       Pawn->GetActorLocation());
+				}
+			}
+		}
+	}
+
+	GhostActors.RemoveAllSwap([](const FGhostActor& Ghost) { return !Ghost.Actor.IsValid(); });
+
+	for (const FGhostActor& Ghost : GhostActors)
+	{
+		Record(Ghost.Name, Time, Ghost.Actor->GetActorLocation());
+	}
+
+	for (const FName Name : PresentGhosts)
+	{
+		if (!SampledGhosts.Contains(Name))
+		{
+			RecordingGhosts.Record(Name, Time, false);
+		}
+	}
+
+	Swap(PresentGhosts, SampledGhosts);
+	SampledGhosts.Reset();
+}
+
+void UReplayGhostSubsystem::Record(FName Name, float Time, const FVector& Location)
+{
+	if (!RecordingGhosts.GetTracks<FVector>().Find(Name))
+	{
+		FReplayTrackPrecision Precision;
+		Precision.Position = PositionPrecision;
+		RecordingGhosts.SetPrecision(Name, Precision);
+	}
+
+	if (!PresentGhosts.Contains(Name))
+	{
+		RecordingGhosts.Record(Name, Time, true);
+	}
+
+	SampledGhosts.Add(Name);
+	RecordingGhosts.Record(Name, Time, Location);
+}
+
+void UReplayGhostSubsystem::OnActorSpawned(AActor* Actor)
+{
+	if (!RecordingReplayName.IsEmpty() && !GhostActorTag.IsNone() && Actor->ActorHasTag(GhostActorTag))
+	{
+		AddGhostActor(Actor);
+	}
+}
@@ -0,0 +1,457 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayIntegrity.h"
+
+#include "ReplayFileUtils.h"
+#include "ReplayMemory.h"
+#include "ReplaySystem.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+
+static TAutoConsoleVariable<bool> CVarReplayRecoverOnStartup(
+	TEXT("ReplaySystem.RecoverOnStartup"), false,
+	TEXT("Finalize the replays left unfinished by a crash while recording when the game starts. Repairing rewrites "
+		"replay files, so it is off unless a project opts in"));
+
+static TAutoConsoleVariable<float> CVarReplayRecoverMinAge(
+	TEXT("ReplaySystem.RecoverMinAgeSeconds"), 120.0f,
+	TEXT("Unfinished replays written to more recently than this are not recovered on startup, another running game "
+		"may still be recording them"));
+
+namespace ReplayIntegrity
+{
+	FCriticalSection Lock;
+
+	//Replays whose checksums are being updated
+	TSet<FString> UpdatingReplays;
+
+	//Replays being recorded by this process
+	TSet<FString> RecordingReplays;
+
+	//Incremented per replay whenever its checksums are dropped or moved, so an update still running does not save the
+	//checksums it read before
+	TMap<FString, uint32> ChecksumGenerations;
+
+	bool IsRecording(const FString& ReplayName)
+	{
+		FScopeLock ScopeLock(&Lock);
+		return RecordingReplays.Contains(ReplayName);
+	}
+
+	/**
+	 *  Only stream data and checkpoints are checksummed, the streamer rewrites header and event chunks in place
+	 */
+	bool IsChecksummed(const ReplayFileUtils::FChunk& Chunk)
+	{
+		return Chunk.ChunkType == ELocalFileChunkType::ReplayData || Chunk.ChunkType == ELocalFileChunkType::Checkpoint;
+	}
+
+	TUniquePtr<IFileHandle> OpenRead(const FString& ReplayName)
+	{
+		return TUniquePtr<IFileHandle>(FPlatformFileManager::Get().GetPlatformFile().OpenRead(
+			*ReplayFileUtils::GetReplayFilename(ReplayName), true));
+	}
+}
+
+void FReplayIntegrity::UpdateChecksums(const FString& ReplayName)
+{
+	uint32 Generation = 0;
+	{
+		FScopeLock ScopeLock(&ReplayIntegrity::Lock);
+		if (ReplayIntegrity::UpdatingReplays.Contains(ReplayName))
+		{
+			return;
+		}
+		ReplayIntegrity::UpdatingReplays.Add(ReplayName);
+		Generation = ReplayIntegrity::ChecksumGenerations.FindRef(ReplayName);
+	}
+
+	Async(EAsyncExecution::ThreadPool, [ReplayName, Generation]()
+	{
+		LLM_SCOPE_BYTAG(ReplaySystem);
+
+		ON_SCOPE_EXIT
+		{
+			FScopeLock ScopeLock(&ReplayIntegrity::Lock);
+			ReplayIntegrity::UpdatingReplays.Remove(ReplayName);
+		};
+
+		const TUniquePtr<IFileHandle> File = ReplayIntegrity::OpenRead(ReplayName);
+		ReplayFileUtils::FReplayFileLayout Layout;
+
+		if (!File.IsValid() || !ReplayFileUtils::ReadLayout(*File, Layout))
+		{
+			return;
+		}
+
+		TArray<ReplayFileUtils::FChunkChecksum> Checksums;
+		ReplayFileUtils::LoadChecksums(ReplayName, Checksums);
+
+		// Keep what was checksummed before, only the chunks written since need reading
+		TSet<int64> Checksummed;
+		for (const ReplayFileUtils::FChunkChecksum& Checksum : Checksums)
+		{
+			Checksummed.Add(Checksum.TypeOffset);
+		}
+
+		const int32 NumChecksums = Checksums.Num();
+
+		for (const ReplayFileUtils::FChunk& Chunk : Layout.Chunks)
+		{
+			if (!ReplayIntegrity::IsChecksummed(Chunk) || Checksummed.Contains(Chunk.TypeOffset))
+			{
+				continue;
+			}
+
+			ReplayFileUtils::FChunkChecksum& Checksum = Checksums.AddDefaulted_GetRef();
+			Checksum.TypeOffset = Chunk.TypeOffset;
+			Checksum.SizeInBytes = Chunk.SizeInBytes;
+
+			if (!ReplayFileUtils::ChecksumChunk(*File, Chunk, Checksum.Crc))
+			{
+				Checksums.Pop();
+				break;
+			}
+		}
+
+		if (Checksums.Num() == NumChecksums)
+		{
+			return;
+		}
+
+		// Saved under the lock so the checksums cannot be dropped or moved in between
+		FScopeLock ScopeLock(&ReplayIntegrity::Lock);
+
+		if (Generation != ReplayIntegrity::ChecksumGenerations.FindRef(ReplayName))
+		{
+			return;
+		}
+
+		if (!ReplayFileUtils::SaveChecksums(ReplayName, Checksums))
+		{
+			UE_LOG(LogReplaySystem, Warning, TEXT("Could not save the chunk checksums of replay %s"), *ReplayName);
+		}
+	});
+}
+
+void FReplayIntegrity::SetRecording(const FString& ReplayName, bool bIsRecording)
+{
+	FScopeLock ScopeLock(&ReplayIntegrity::Lock);
+
+	if (bIsRecording)
+	{
+		ReplayIntegrity::RecordingReplays.Add(ReplayName);
+
+		// Recording over a replay replaces its file, checksums of the old chunks would fail the new ones
+		DeleteChecksums(ReplayName);
+	}
+	else
+	{
+		ReplayIntegrity::RecordingReplays.Remove(ReplayName);
+	}
+}
+
+void FReplayIntegrity::DeleteChecksums(const FString& ReplayName)
+{
+	FScopeLock ScopeLock(&ReplayIntegrity::Lock);
+
+	++ReplayIntegrity::ChecksumGenerations.FindOrAdd(ReplayName);
+	IFileManager::Get().Delete(*ReplayFileUtils::GetChecksumFilename(ReplayName), false, true, true);
+}
+
+void FReplayIntegrity::RenameChecksums(const FString& ReplayName, const FString& NewReplayName)
+{
+	FScopeLock ScopeLock(&ReplayIntegrity::Lock);
+
+	++ReplayIntegrity::ChecksumGenerations.FindOrAdd(ReplayName);
+	++ReplayIntegrity::ChecksumGenerations.FindOrAdd(NewReplayName);
+
+	const FString Filename = ReplayFileUtils::GetChecksumFilename(ReplayName);
+	const FString NewFilename = ReplayFileUtils::GetChecksumFilename(NewReplayName);
+
+	if (IFileManager::Get().FileExists(*Filename))
+	{
+		IFileManager::Get().Move(*NewFilename, *Filename, true, true);
+	}
+	else
+	{
+		IFileManager::Get().Delete(*NewFilename, false, true, true);
+	}
+}
+
+void FReplayIntegrity::VerifyReplays(const TArray<FString>& ReplayNames, bool bRepair,
+                                     TFunction<void(const TArray<FReplayIntegrityResult>&)> OnComplete)
+{
+	TArray<FString> Names = ReplayNames;
+
+	if (Names.Num() == 0)
+	{
+		TArray<FString> Filenames;
+		IFileManager::Get().FindFiles(Filenames, *FLocalFileNetworkReplayStreamer::GetDefaultDemoSavePath(),
+		                              TEXT(".replay"));
+		for (const FString& Filename : Filenames)
+		{
+			Names.Add(FPaths::GetBaseFilename(Filename));
+		}
+	}
+
+	Async(EAsyncExecution::ThreadPool, [Names = MoveTemp(Names), bRepair, OnComplete = MoveTemp(OnComplete)]()
+	{
+		LLM_SCOPE_BYTAG(ReplaySystem);
+
+		TArray<FReplayIntegrityResult> Results;
+		Results.SetNum(Names.Num());
+
+		ParallelFor(Names.Num(), [&Names, &Results, bRepair](int32 Index)
+		{
+			Results[Index] = VerifyReplay(Names[Index], bRepair);
+		});
+
+		AsyncTask(ENamedThreads::GameThread, [Results = MoveTemp(Results), OnComplete]()
+		{
+			OnComplete(Results);
+		});
+	});
+}
+
+void FReplayIntegrity::RecoverReplays(float MinAgeSeconds,
+                                      TFunction<void(const TArray<FReplayIntegrityResult>&)> OnComplete)
+{
+	Async(EAsyncExecution::ThreadPool, [MinAgeSeconds, OnComplete = MoveTemp(OnComplete)]()
+	{
+		LLM_SCOPE_BYTAG(ReplaySystem);
+
+		const FString DemoPath = FLocalFileNetworkReplayStreamer::GetDefaultDemoSavePath();
+		const FDateTime MaxTimestamp = FDateTime::UtcNow() - FTimespan::FromSeconds(MinAgeSeconds);
+
+		TArray<FString> Filenames;
+		IFileManager::Get().FindFiles(Filenames, *DemoPath, TEXT(".replay"));
+
+		// Only the header is read to find the replays that were never finalized
+		TArray<FString> Names;
+		for (const FString& Filename : Filenames)
+		{
+			const FString ReplayName = FPaths::GetBaseFilename(Filename);
+			if (ReplayIntegrity::IsRecording(ReplayName) || IFileManager::Get().GetTimeStamp(
+				*FPaths::Combine(DemoPath, Filename)) > MaxTimestamp)
+			{
+				continue;
+			}
+
+			const TUniquePtr<IFileHandle> File = ReplayIntegrity::OpenRead(ReplayName);
+			ReplayFileUtils::FReplayFileLayout Layout;
+
+			if (File.IsValid() && ReplayFileUtils::ReadLayout(*File, Layout) && (Layout.bIsLive || Layout.bTruncated))
+			{
+				Names.Add(ReplayName);
+			}
+		}
+
+		TArray<FReplayIntegrityResult> Results;
+		Results.SetNum(Names.Num());
+
+		ParallelFor(Names.Num(), [&Names, &Results](int32 Index)
+		{
+			Results[Index] = VerifyReplay(Names[Index], true);
+		});
+
+		for (const FReplayIntegrityResult& Result : Results)
+		{
+			UE_LOG(LogReplaySystem, Log, TEXT("Recovered replay %s: %s (%s)"), *Result.ReplayName,
+			       *UEnum::GetValueAsString(Result.Status), *Result.Error);
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [Results = MoveTemp(Results), OnComplete]()
+		{
+			OnComplete(Results);
+		});
+	});
+}
+
+void FReplayIntegrity::RecoverOnStartup()
+{
+	if (!CVarReplayRecoverOnStartup.GetValueOnGameThread() || IsRunningCommandlet())
+	{
+		return;
+	}
+
+	RecoverReplays(CVarReplayRecoverMinAge.GetValueOnGameThread(), [](const TArray<FReplayIntegrityResult>& Results)
+	{
+		if (Results.Num() > 0)
+		{
+			UE_LOG(LogReplaySystem, Display, TEXT("Recovered %d unfinished replay(s)"), Results.Num());
+		}
+	});
+}
+
+FReplayIntegrityResult FReplayIntegrity::VerifyReplay(const FString& ReplayName, bool bRepair)
+{
+	FReplayIntegrityResult Result;
+	Result.ReplayName = ReplayName;
+
+	ReplayFileUtils::FReplayFileLayout Layout;
+	{
+		const TUniquePtr<IFileHandle> File = ReplayIntegrity::OpenRead(ReplayName);
+
+		if (!File.IsValid())
+		{
+			Result.Error = TEXT("The replay file does not exist");
+			return Result;
+		}
+
+		if (!ReplayFileUtils::ReadLayout(*File, Layout))
+		{
+			Result.Error = TEXT("The replay header is unreadable");
+			return Result;
+		}
+
+		TArray<ReplayFileUtils::FChunkChecksum> Checksums;
+		ReplayFileUtils::LoadChecksums(ReplayName, Checksums);
+
+		TMap<int64, const ReplayFileUtils::FChunkChecksum*> ChecksumsByOffset;
+		for (const ReplayFileUtils::FChunkChecksum& Checksum : Checksums)
+		{
+			ChecksumsByOffset.Add(Checksum.TypeOffset, &Checksum);
+		}
+
+		Result.NumChunks = Layout.Chunks.Num();
+		Result.NumValidChunks = Layout.Chunks.Num();
+		Result.LengthInMS = Layout.LengthInMS;
+
+		for (int32 Index = 0; Index < Layout.Chunks.Num(); ++Index)
+		{
+			const ReplayFileUtils::FChunk& Chunk = Layout.Chunks[Index];
+			const ReplayFileUtils::FChunkChecksum* const* Checksum = ChecksumsByOffset.Find(Chunk.TypeOffset);
+
+			if (!Checksum || !ReplayIntegrity::IsChecksummed(Chunk))
+			{
+				continue;
+			}
+
+			++Result.NumChecksummedChunks;
+
+			uint32 Crc = 0;
+			if ((*Checksum)->SizeInBytes != Chunk.SizeInBytes || !ReplayFileUtils::ChecksumChunk(*File, Chunk, Crc) ||
+				Crc != (*Checksum)->Crc)
+			{
+				Result.NumValidChunks = Index;
+				Result.Error = FString::Printf(TEXT("Chunk %d does not match its checksum"), Index);
+				break;
+			}
+		}
+	}
+
+	// A replay being recorded is live and may end inside the chunk being written
+	const bool bIsRecording = ReplayIntegrity::IsRecording(ReplayName);
+
+	if (Result.NumValidChunks == Result.NumChunks && (bIsRecording || (!Layout.bTruncated && !Layout.bIsLive)))
+	{
+		Result.Status = EReplayIntegrity::Valid;
+		return Result;
+	}
+
+	if (Result.Error.IsEmpty())
+	{
+		Result.Error = Layout.bTruncated
+			               ? FString::Printf(TEXT("The replay ends inside chunk %d"), Result.NumChunks)
+			               : TEXT("The replay was never finalized");
+	}
+
+	Result.Status = EReplayIntegrity::Damaged;
+
+	bool bHasHeaderChunk = false;
+	for (int32 Index = 0; Index < Result.NumValidChunks; ++Index)
+	{
+		bHasHeaderChunk |= Layout.Chunks[Index].ChunkType == ELocalFileChunkType::Header;
+	}
+
+	if (!bHasHeaderChunk)
+	{
+		Result.Status = EReplayIntegrity::Unreadable;
+		Result.Error += TEXT(", no valid stream header is left");
+		return Result;
+	}
+
+	if (bRepair)
+	{
+		if (bIsRecording)
+		{
+			Result.Error += TEXT(", not repaired while it is being recorded");
+		}
+		else if (Repair(ReplayName, Result.NumValidChunks, Result))
+		{
+			Result.Status = EReplayIntegrity::Repaired;
+		}
+	}
+
+	return Result;
+}
+
+bool FReplayIntegrity::Repair(const FString& ReplayName, int32 NumValidChunks, FReplayIntegrityResult& Result)
+{
+	const FString Filename = ReplayFileUtils::GetReplayFilename(ReplayName);
+	const FString TempFilename = Filename + TEXT(".repair");
+
+	{
+		const TUniquePtr<IFileHandle> File = ReplayIntegrity::OpenRead(ReplayName);
+		ReplayFileUtils::FReplayFileLayout Layout;
+
+		if (!File.IsValid() || !ReplayFileUtils::ReadLayout(*File, Layout) || NumValidChunks <= 0 || NumValidChunks >
+			Layout.Chunks.Num())
+		{
+			Result.Error += TEXT(", the replay changed while it was verified");
+			return false;
+		}
+
+		const ReplayFileUtils::FChunk& LastChunk = Layout.Chunks[NumValidChunks - 1];
+		const int64 End = LastChunk.DataOffset + LastChunk.SizeInBytes;
+
+		// The stream data that is left decides how long the replay is
+		const uint32 DataLengthInMS = ReplayFileUtils::GetDataLengthInMS(Layout, NumValidChunks);
+		const int32 RepairedLengthInMS = DataLengthInMS > 0 ? static_cast<int32>(DataLengthInMS) : Layout.LengthInMS;
+
+		TArray<uint8> Header;
+		if (!ReplayFileUtils::ReadPatchedHeader(*File, Layout, RepairedLengthInMS, false, Header))
+		{
+			Result.Error += TEXT(", the header could not be rewritten");
+			return false;
+		}
+
+		const TUniquePtr<IFileHandle> Repaired(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*TempFilename));
+
+		if (!Repaired.IsValid() || !Repaired->Write(Header.GetData(), Header.Num()) || !ReplayFileUtils::CopyRange(
+			*File, *Repaired, Layout.HeaderSize, End - Layout.HeaderSize))
+		{
+			Result.Error += TEXT(", the repaired replay could not be written");
+			IFileManager::Get().Delete(*TempFilename, false, true, true);
+			return false;
+		}
+
+		Result.LengthInMS = RepairedLengthInMS;
+
+		// Checksums of the chunks that were cut off no longer apply
+		TArray<ReplayFileUtils::FChunkChecksum> Checksums;
+		if (ReplayFileUtils::LoadChecksums(ReplayName, Checksums))
+		{
+			Checksums.RemoveAll([End](const ReplayFileUtils::FChunkChecksum& Checksum)
+			{
+				return Checksum.TypeOffset >= End;
+			});
+			ReplayFileUtils::SaveChecksums(ReplayName, Checksums);
+		}
+	}
+
+	if (!IFileManager::Get().Move(*Filename, *TempFilename, true, true))
+	{
+		Result.Error += TEXT(", the repaired replay could not replace the damaged one");
+		IFileManager::Get().Delete(*TempFilename, false, true, true);
+		return false;
+	}
+
+	UE_LOG(LogReplaySystem, Log, TEXT("Repaired replay %s, kept %d of %d chunks"), *ReplayName, NumValidChunks,
+	       Result.NumChunks);
+	return true;
+}
@@ -0,0 +1,95 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayMemory.h"
+
+#include "ReplaySystem.h"
+
+LLM_DEFINE_TAG(ReplaySystem);
+LLM_DEFINE_TAG(ReplaySystem_Events);
+LLM_DEFINE_TAG(ReplaySystem_Tracks);
+LLM_DEFINE_TAG(ReplaySystem_Index);
+LLM_DEFINE_TAG(ReplaySystem_Cache);
+LLM_DEFINE_TAG(ReplaySystem_Upload);
+LLM_DEFINE_TAG(ReplaySystem_Streaming);
+
+DECLARE_MEMORY_STAT(TEXT("Events Memory"), STAT_ReplayMemoryEvents, STATGROUP_ReplaySystem);
+DECLARE_MEMORY_STAT(TEXT("Tracks Memory"), STAT_ReplayMemoryTracks, STATGROUP_ReplaySystem);
+DECLARE_MEMORY_STAT(TEXT("Index Memory"), STAT_ReplayMemoryIndex, STATGROUP_ReplaySystem);
+DECLARE_MEMORY_STAT(TEXT("Cache Memory"), STAT_ReplayMemoryCache, STATGROUP_ReplaySystem);
+DECLARE_MEMORY_STAT(TEXT("Upload Memory"), STAT_ReplayMemoryUpload, STATGROUP_ReplaySystem);
+
+std::atomic<int64> FReplayMemory::Current[static_cast<int32>(EReplayMemoryCategory::Count)] = {};
+
+std::atomic<int64> FReplayMemory::Peak[static_cast<int32>(EReplayMemoryCategory::Count)] = {};
+
+void FReplayMemory::Add(EReplayMemoryCategory Category, int64 Bytes)
+{
+	const int32 Index = static_cast<int32>(Category);
+	if (Bytes == 0 || Index < 0 || Index >= static_cast<int32>(EReplayMemoryCategory::Count))
+	{
+		return;
+	}
+
+	const int64 NewCurrent = Current[Index].fetch_add(Bytes, std::memory_order_relaxed) + Bytes;
+
+	int64 OldPeak = Peak[Index].load(std::memory_order_relaxed);
+	while (NewCurrent > OldPeak && !Peak[Index].compare_exchange_weak(OldPeak, NewCurrent, std::memory_order_relaxed))
+	{
+	}
+
+#if STATS
+	switch (Category)
+	{
+	case EReplayMemoryCategory::Events:
+		INC_MEMORY_STAT_BY(STAT_ReplayMemoryEvents, Bytes);
+		break;
+	case EReplayMemoryCategory::Tracks:
+		INC_MEMORY_STAT_BY(STAT_ReplayMemoryTracks, Bytes);
+		break;
+	case EReplayMemoryCategory::Index:
+		INC_MEMORY_STAT_BY(STAT_ReplayMemoryIndex, Bytes);
+		break;
+	case EReplayMemoryCategory::Cache:
+		INC_MEMORY_STAT_BY(STAT_ReplayMemoryCache, Bytes);
+		break;
+	case EReplayMemoryCategory::Upload:
+		INC_MEMORY_STAT_BY(STAT_ReplayMemoryUpload, Bytes);
+		break;
+	default:
+		break;
+	}
+#endif
+}
+
+FReplayMemoryUsage FReplayMemory::GetUsage(EReplayMemoryCategory Category)
+{
+	FReplayMemoryUsage Usage;
+	Usage.Category = Category;
+
+	const int32 Index = static_cast<int32>(Category);
+	if (Index >= 0 && Index < static_cast<int32>(EReplayMemoryCategory::Count))
+	{
+		Usage.CurrentBytes = Current[Index].load(std::memory_order_relaxed);
+		Usage.PeakBytes = Peak[Index].load(std::memory_order_relaxed);
+	}
+
+	return Usage;
+}
+
+TArray<FReplayMemoryUsage> FReplayMemory::GetAllUsage()
+{
+	TArray<FReplayMemoryUsage> AllUsage;
+	for (int32 Index = 0; Index < static_cast<int32>(EReplayMemoryCategory::Count); ++Index)
+	{
+		AllUsage.Add(GetUsage(static_cast<EReplayMemoryCategory>(Index)));
+	}
+	return AllUsage;
+}
+
+void FReplayMemory::ResetPeaks()
+{
+	for (int32 Index = 0; Index < static_cast<int32>(EReplayMemoryCategory::Count); ++Index)
+	{
+		Peak[Index].store(Current[Index].load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,393 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayMetricsSubsystem.h"
+
+#include "NetworkReplayStreaming.h"
+#include "ReplayStateSubsystem.h"
+#include "ReplaySystem.h"
+#include "Engine/DemoNetDriver.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Last Seek (ms)"), STAT_ReplayLastSeek, STATGROUP_ReplaySystem);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Last Seek Checkpoint Load (ms)"), STAT_ReplayLastSeekLoad, STATGROUP_ReplaySystem);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Last Seek Actor Restore (ms)"), STAT_ReplayLastSeekRestore, STATGROUP_ReplaySystem);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Last Seek Fast Forward (ms)"), STAT_ReplayLastSeekFastForward,
+                               STATGROUP_ReplaySystem);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Seeks"), STAT_ReplaySeeks, STATGROUP_ReplaySystem);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Stalls"), STAT_ReplayStalls, STATGROUP_ReplaySystem);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Frames Behind"), STAT_ReplayFramesBehind, STATGROUP_ReplaySystem);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Last Checkpoint Game Thread (ms)"), STAT_ReplayLastCheckpoint,
+                               STATGROUP_ReplaySystem);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Last Checkpoint Worst Frame (ms)"), STAT_ReplayLastCheckpointFrame,
+                               STATGROUP_ReplaySystem);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Checkpoints"), STAT_ReplayCheckpoints, STATGROUP_ReplaySystem);
+
+CSV_DEFINE_CATEGORY(ReplaySystem, true);
+
+namespace ReplayMetrics
+{
+	FReplayMetrics MakeEmpty()
+	{
+		const TArray<float> Milliseconds = {10.0f, 25.0f, 50.0f, 100.0f, 250.0f, 500.0f, 1000.0f, 2500.0f, 5000.0f,
+			10000.0f};
+		const TArray<float> Frames = {0.0f, 1.0f, 2.0f, 4.0f, 8.0f, 16.0f, 32.0f, 64.0f};
+		// Checkpoint costs are in the order of a frame, not of a seek
+		const TArray<float> FrameMilliseconds = {1.0f, 2.0f, 4.0f, 8.0f, 16.0f, 33.0f, 50.0f, 100.0f, 250.0f, 500.0f};
+
+		FReplayMetrics Metrics;
+		Metrics.SeekTime = FReplayHistogram(Milliseconds);
+		Metrics.SeekCheckpointLoadTime = FReplayHistogram(Milliseconds);
+		Metrics.SeekActorRestoreTime = FReplayHistogram(Milliseconds);
+		Metrics.SeekFastForwardTime = FReplayHistogram(Milliseconds);
+		Metrics.StallTime = FReplayHistogram(Milliseconds);
+		Metrics.FramesBehind = FReplayHistogram(Frames);
+		Metrics.CheckpointGameThreadTime = FReplayHistogram(FrameMilliseconds);
+		Metrics.CheckpointFrameTime = FReplayHistogram(FrameMilliseconds);
+		return Metrics;
+	}
+
+	void ExportCommand(const TArray<FString>& Args, UWorld* World)
+	{
+		if (const UReplayMetricsSubsystem* MetricsSubsystem = World ? UReplayMetricsSubsystem::Get(World) : nullptr)
+		{
+			MetricsSubsystem->ExportCSV(Args.Num() > 0 ? Args[0] : FString());
+		}
+	}
+
+	FAutoConsoleCommandWithWorldAndArgs ExportMetrics(
+		TEXT("ReplaySystem.ExportMetrics"),
+		TEXT("Writes the replay seek, stall, playback lag and checkpoint cost histograms to a CSV file. Optional argument: the filename"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ExportCommand));
+}
+
+void UReplayMetricsSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Metrics = ReplayMetrics::MakeEmpty();
+
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateUObject(this, &UReplayMetricsSubsystem::Tick));
+
+	PreScrubHandle = FNetworkReplayDelegates::OnPreScrub.AddUObject(this, &UReplayMetricsSubsystem::HandlePreScrub);
+	ScrubCompleteHandle = FNetworkReplayDelegates::OnReplayScrubComplete.AddUObject(
+		this, &UReplayMetricsSubsystem::HandleScrubComplete);
+}
+
+void UReplayMetricsSubsystem::Deinitialize()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	TickerHandle.Reset();
+
+	FNetworkReplayDelegates::OnPreScrub.Remove(PreScrubHandle);
+	FNetworkReplayDelegates::OnReplayScrubComplete.Remove(ScrubCompleteHandle);
+	PreScrubHandle.Reset();
+	ScrubCompleteHandle.Reset();
+
+	if (UWorld* World = SeekWorld.Get())
+	{
+		World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+	}
+	ActorSpawnedHandle.Reset();
+	bSeeking = false;
+
+	Super::Deinitialize();
+}
+
+UReplayMetricsSubsystem* UReplayMetricsSubsystem::Get(const UObject* WorldContextObject)
+{
+	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
+	{
+		if (const UGameInstance* GI = World->GetGameInstance())
+		{
+			return GI->GetSubsystem<UReplayMetricsSubsystem>();
+		}
+	}
+
+	return nullptr;
+}
+
+void UReplayMetricsSubsystem::NotifySeekStarted()
+{
+	// A seek replacing one in flight is timed from here, the one it replaced never finishes
+	bSeeking = true;
+	SeekStartTime = FPlatformTime::Seconds();
+	CheckpointLoadedTime = 0.0;
+	LastRestoreTime = 0.0;
+
+	EndStall();
+}
+
+void UReplayMetricsSubsystem::NotifySeekFinished(bool bWasSuccessful)
+{
+	if (bSeeking)
+	{
+		EndSeek(bWasSuccessful);
+	}
+}
+
+void UReplayMetricsSubsystem::NotifyCheckpointSaved(float GameThreadMS, float MaxFrameMS, int32 Frames)
+{
+	++Metrics.NumCheckpoints;
+	Metrics.CheckpointGameThreadTime.Add(GameThreadMS);
+	Metrics.CheckpointFrameTime.Add(MaxFrameMS);
+
+	SET_DWORD_STAT(STAT_ReplayCheckpoints, Metrics.NumCheckpoints);
+	SET_FLOAT_STAT(STAT_ReplayLastCheckpoint, GameThreadMS);
+	SET_FLOAT_STAT(STAT_ReplayLastCheckpointFrame, MaxFrameMS);
+
+	CSV_CUSTOM_STAT(ReplaySystem, CheckpointGameThreadMS, GameThreadMS, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(ReplaySystem, CheckpointFrameMS, MaxFrameMS, ECsvCustomStatOp::Set);
+
+	UE_LOG(LogReplaySystem, Verbose, TEXT("Checkpoint cost %.2fms of game thread time over %d frames (worst frame %.2fms)"),
+	       GameThreadMS, Frames, MaxFrameMS);
+}
+
+void UReplayMetricsSubsystem::ResetMetrics()
+{
+	Metrics = ReplayMetrics::MakeEmpty();
+}
+
+bool UReplayMetricsSubsystem::ExportCSV(const FString& Filename) const
+{
+	const FString OutFilename = Filename.IsEmpty()
+		                            ? FPaths::Combine(FPaths::ProfilingDir(), TEXT("ReplayMetrics"),
+		                                              FString::Printf(
+			                                              TEXT("ReplayMetrics-%s.csv"),
+			                                              *FDateTime::Now().ToString()))
+		                            : Filename;
+
+	const TArray<TPair<const TCHAR*, const FReplayHistogram*>> Histograms = {
+		{TEXT("SeekMS"), &Metrics.SeekTime},
+		{TEXT("SeekCheckpointLoadMS"), &Metrics.SeekCheckpointLoadTime},
+		{TEXT("SeekActorRestoreMS"), &Metrics.SeekActorRestoreTime},
+		{TEXT("SeekFastForwardMS"), &Metrics.SeekFastForwardTime},
+		{TEXT("StallMS"), &Metrics.StallTime},
+		{TEXT("FramesBehind"), &Metrics.FramesBehind},
+		{TEXT("CheckpointGameThreadMS"), &Metrics.CheckpointGameThreadTime},
+		{TEXT("CheckpointFrameMS"), &Metrics.CheckpointFrameTime},
+	};
+
+	FString Csv = FString::Printf(TEXT("Seeks,FailedSeeks,Stalls,Checkpoints\n%d,%d,%d,%d\n\n"), Metrics.NumSeeks,
+	                              Metrics.NumFailedSeeks, Metrics.NumStalls, Metrics.NumCheckpoints);
+
+	Csv += TEXT("Metric,Count,Mean,Min,P50,P90,P99,Max\n");
+	for (const TPair<const TCHAR*, const FReplayHistogram*>& Pair : Histograms)
+	{
+		const FReplayHistogram& Histogram = *Pair.Value;
+		Csv += FString::Printf(TEXT("%s,%d,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n"), Pair.Key, Histogram.Count,
+		                       Histogram.GetMean(), Histogram.Min, Histogram.GetPercentile(0.5f),
+		                       Histogram.GetPercentile(0.9f), Histogram.GetPercentile(0.99f), Histogram.Max);
+	}
+
+	// The buckets one per line so dashboards can plot them whatever the limits are
+	Csv += TEXT("\nMetric,UpperBound,Count\n");
+	for (const TPair<const TCHAR*, const FReplayHistogram*>& Pair : Histograms)
+	{
+		const FReplayHistogram& Histogram = *Pair.Value;
+		for (int32 Bucket = 0; Bucket < Histogram.BucketCounts.Num(); ++Bucket)
+		{
+			Csv += FString::Printf(TEXT("%s,%s,%d\n"), Pair.Key,
+			                       Histogram.BucketLimits.IsValidIndex(Bucket)
+				                       ? *FString::SanitizeFloat(Histogram.BucketLimits[Bucket])
+				                       : TEXT("Inf"), Histogram.BucketCounts[Bucket]);
+		}
+	}
+
+	if (!FFileHelper::SaveStringToFile(Csv, *OutFilename))
+	{
+		UE_LOG(LogReplaySystem, Warning, TEXT("Could not write replay metrics to %s"), *OutFilename);
+		return false;
+	}
+
+	UE_LOG(LogReplaySystem, Log, TEXT("Replay metrics written to %s"), *OutFilename);
+	return true;
+}
+
+bool UReplayMetricsSubsystem::Tick(float DeltaTime)
+{
+	const UGameInstance* GI = GetGameInstance();
+	const UWorld* World = GI ? GI->GetWorld() : nullptr;
+	const UReplayStateSubsystem* StateSubsystem = World ? World->GetSubsystem<UReplayStateSubsystem>() : nullptr;
+	const UDemoNetDriver* DemoDriver = StateSubsystem ? StateSubsystem->GetDemoDriver() : nullptr;
+
+	if (!DemoDriver || !StateSubsystem->GetPlaybackState().bIsPlaying || StateSubsystem->GetPlaybackState().
+		bIsPaused || bSeeking || DeltaTime <= 0.0f)
+	{
+		EndStall();
+		LastDemoTime = -1.0f;
+		Lag = 0.0f;
+		return true;
+	}
+
+	const float DemoTime = DemoDriver->GetDemoCurrentTime();
+
+	// Playback (re)started or moved back without a seek we saw, start measuring from here
+	if (LastDemoTime < 0.0f || DemoTime < LastDemoTime)
+	{
+		LastDemoTime = DemoTime;
+		Lag = 0.0f;
+		return true;
+	}
+
+	const float Advance = DemoTime - LastDemoTime;
+	const float Expected = DeltaTime * StateSubsystem->GetPlaybackState().PlaybackSpeed;
+	LastDemoTime = DemoTime;
+
+	const TSharedPtr<INetworkReplayStreamer> Streamer = DemoDriver->GetReplayStreamer();
+	const bool bAtEnd = Streamer.IsValid() && !Streamer->IsLive() && DemoTime >= DemoDriver->GetDemoTotalTime();
+	const bool bWaitingForData = Advance <= 0.0f && Expected > 0.0f && Streamer.IsValid() && !Streamer->
+		IsDataAvailable() && !bAtEnd;
+
+	if (bWaitingForData && !bStalled)
+	{
+		bStalled = true;
+		StallStartTime = FPlatformTime::Seconds();
+		++Metrics.NumStalls;
+		SET_DWORD_STAT(STAT_ReplayStalls, Metrics.NumStalls);
+	}
+	else if (!bWaitingForData)
+	{
+		EndStall();
+	}
+
+	CSV_CUSTOM_STAT(ReplaySystem, Stalled, bStalled ? 1 : 0, ECsvCustomStatOp::Set);
+
+	// A stall is counted on its own, it does not also count as falling behind
+	if (bStalled || Expected <= 0.0f)
+	{
+		Lag = 0.0f;
+		return true;
+	}
+
+	Lag = FMath::Max(Lag + Expected - Advance, 0.0f);
+
+	if (StateSubsystem->GetPlaybackState().PlaybackSpeed > 1.0f)
+	{
+		// In frames of playback at the current speed
+		const int32 FramesBehind = FMath::FloorToInt(Lag / Expected);
+
+		Metrics.FramesBehind.Add(FramesBehind);
+		SET_DWORD_STAT(STAT_ReplayFramesBehind, FramesBehind);
+		CSV_CUSTOM_STAT(ReplaySystem, FramesBehind, FramesBehind, ECsvCustomStatOp::Set);
+	}
+
+	return true;
+}
+
+void UReplayMetricsSubsystem::HandlePreScrub(UWorld* InWorld)
+{
+	if (!IsOwnWorld(InWorld))
+	{
+		return;
+	}
+
+	// Scrubs not asked for through the library are timed from the checkpoint on
+	if (!bSeeking)
+	{
+		NotifySeekStarted();
+	}
+
+	CheckpointLoadedTime = LastRestoreTime = FPlatformTime::Seconds();
+
+	if (UWorld* OldWorld = SeekWorld.Get())
+	{
+		OldWorld->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+	}
+
+	SeekWorld = InWorld;
+	ActorSpawnedHandle = InWorld->AddOnActorSpawnedHandler(
+		FOnActorSpawned::FDelegate::CreateUObject(this, &UReplayMetricsSubsystem::HandleActorSpawned));
+}
+
+void UReplayMetricsSubsystem::HandleScrubComplete(UWorld* InWorld)
+{
+	if (bSeeking && IsOwnWorld(InWorld))
+	{
+		EndSeek(true);
+	}
+}
+
+void UReplayMetricsSubsystem::HandleActorSpawned(AActor* Actor)
+{
+	const UWorld* World = SeekWorld.Get();
+	const UReplayStateSubsystem* StateSubsystem = World ? World->GetSubsystem<UReplayStateSubsystem>() : nullptr;
+	const UDemoNetDriver* DemoDriver = StateSubsystem ? StateSubsystem->GetDemoDriver() : nullptr;
+
+	// The demo driver spawns the actors of the checkpoint before it fast forwards to the time asked for
+	if (bSeeking && DemoDriver && DemoDriver->IsFastForwardingForCheckpoint())
+	{
+		LastRestoreTime = FPlatformTime::Seconds();
+	}
+}
+
+void UReplayMetricsSubsystem::EndSeek(bool bWasSuccessful)
+{
+	const double Now = FPlatformTime::Seconds();
+
+	bSeeking = false;
+	LastDemoTime = -1.0f;
+
+	if (UWorld* World = SeekWorld.Get())
+	{
+		World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+	}
+	ActorSpawnedHandle.Reset();
+	SeekWorld.Reset();
+
+	++Metrics.NumSeeks;
+	SET_DWORD_STAT(STAT_ReplaySeeks, Metrics.NumSeeks);
+
+	if (!bWasSuccessful)
+	{
+		++Metrics.NumFailedSeeks;
+		return;
+	}
+
+	// Seeks that did not need a checkpoint only fast forward
+	const float TotalMS = (Now - SeekStartTime) * 1000.0;
+	const float LoadMS = CheckpointLoadedTime > 0.0 ? (CheckpointLoadedTime - SeekStartTime) * 1000.0 : 0.0f;
+	const float RestoreMS = CheckpointLoadedTime > 0.0 ? (LastRestoreTime - CheckpointLoadedTime) * 1000.0 : 0.0f;
+	const float FastForwardMS = FMath::Max(TotalMS - LoadMS - RestoreMS, 0.0f);
+
+	Metrics.SeekTime.Add(TotalMS);
+	Metrics.SeekCheckpointLoadTime.Add(LoadMS);
+	Metrics.SeekActorRestoreTime.Add(RestoreMS);
+	Metrics.SeekFastForwardTime.Add(FastForwardMS);
+
+	SET_FLOAT_STAT(STAT_ReplayLastSeek, TotalMS);
+	SET_FLOAT_STAT(STAT_ReplayLastSeekLoad, LoadMS);
+	SET_FLOAT_STAT(STAT_ReplayLastSeekRestore, RestoreMS);
+	SET_FLOAT_STAT(STAT_ReplayLastSeekFastForward, FastForwardMS);
+
+	CSV_CUSTOM_STAT(ReplaySystem, SeekMS, TotalMS, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(ReplaySystem, SeekCheckpointLoadMS, LoadMS, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(ReplaySystem, SeekActorRestoreMS, RestoreMS, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(ReplaySystem, SeekFastForwardMS, FastForwardMS, ECsvCustomStatOp::Set);
+
+	UE_LOG(LogReplaySystem, Verbose, TEXT("Seek took %.1fms (checkpoint load %.1fms, actor restore %.1fms, fast forward %.1fms)"),
+	       TotalMS, LoadMS, RestoreMS, FastForwardMS);
+}
+
+void UReplayMetricsSubsystem::EndStall()
+{
+	if (!bStalled)
+	{
+		return;
+	}
+
+	bStalled = false;
+	Metrics.StallTime.Add((FPlatformTime::Seconds() - StallStartTime) * 1000.0);
+}
+
+bool UReplayMetricsSubsystem::IsOwnWorld(const UWorld* InWorld) const
+{
+	return InWorld && InWorld->GetGameInstance() == GetGameInstance();
+}
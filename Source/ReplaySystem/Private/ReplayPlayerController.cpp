@@ -1,11 +1,11 @@
-﻿// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
-
-
-#include "ReplayPlayerController.h"
-
-AReplayPlayerController::AReplayPlayerController()
-{
-	bShouldPerformFullTickWhenPaused = true;
-	SetTickableWhenPaused(true);
-}
-
+﻿// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+
+#include "ReplayPlayerController.h"
+
+AReplayPlayerController::AReplayPlayerController()
+{
+	bShouldPerformFullTickWhenPaused = true;
+	SetTickableWhenPaused(true);
+}
+
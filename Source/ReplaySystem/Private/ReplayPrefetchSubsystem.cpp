@@ -0,0 +1,266 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayPrefetchSubsystem.h"
+
+#include "ReplayMemory.h"
+#include "ReplaySystem.h"
+#include "ReplayTypes.h"
+#include "Misc/PackageName.h"
+#include "Net/NetworkVersion.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectGlobals.h"
+
+void UReplayPrefetchSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(
+		this, &UReplayPrefetchSubsystem::OnPostLoadMap);
+}
+
+void UReplayPrefetchSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+	PostLoadMapHandle.Reset();
+
+	CancelPrefetch();
+
+	Super::Deinitialize();
+}
+
+void UReplayPrefetchSubsystem::PrefetchReplay(const FString& ReplayName, FOnPrefetchReplayComplete OnComplete)
+{
+	if (PrefetchInfo.ReplayName == ReplayName && PrefetchInfo.State != EReplayPrefetchState::None)
+	{
+		// Already prefetching or prefetched this one, just hand back what we have when it is ready
+		OnPrefetchComplete = OnComplete;
+		if (PrefetchInfo.State != EReplayPrefetchState::InProgress)
+		{
+			OnPrefetchComplete.ExecuteIfBound(PrefetchInfo);
+		}
+		return;
+	}
+
+	CancelPrefetch();
+
+	LLM_SCOPE_BYTAG(ReplaySystem_Streaming);
+
+	PrefetchInfo.ReplayName = ReplayName;
+	PrefetchInfo.State = EReplayPrefetchState::InProgress;
+	OnPrefetchComplete = OnComplete;
+
+	ReplayStreamer = FNetworkReplayStreaming::Get().GetFactory().CreateReplayStreamer();
+
+	if (!ReplayStreamer.IsValid())
+	{
+		Fail(TEXT("Failed to create a replay streamer"));
+		return;
+	}
+
+	FStartStreamingParameters Params;
+	Params.CustomName = ReplayName;
+	Params.ReplayVersion = FNetworkVersion::GetReplayVersion();
+	Params.bRecord = false;
+
+	const int32 Serial = PrefetchSerial;
+	TWeakObjectPtr<UReplayPrefetchSubsystem> WeakThis = this;
+
+	ReplayStreamer->StartStreaming(Params, FStartStreamingCallback::CreateLambda(
+		                               [WeakThis, Serial](const FStartStreamingResult& Result)
+		                               {
+			                               if (WeakThis.IsValid() && WeakThis->PrefetchSerial == Serial)
+			                               {
+				                               WeakThis->OnStreamingStarted(Result);
+			                               }
+		                               }));
+}
+
+void UReplayPrefetchSubsystem::CancelPrefetch()
+{
+	++PrefetchSerial;
+
+	StopStreamer();
+
+	PrefetchInfo = FReplayPrefetchInfo();
+	OnPrefetchComplete.Unbind();
+	PrefetchedMapPackage = nullptr;
+	bCheckpointDone = false;
+	bMapDone = false;
+}
+
+bool UReplayPrefetchSubsystem::ConsumePrefetch(const FString& ReplayName)
+{
+	if (PrefetchInfo.ReplayName != ReplayName)
+	{
+		// Something else was prefetched, it will not be used
+		CancelPrefetch();
+		return true;
+	}
+
+	if (PrefetchInfo.State == EReplayPrefetchState::Failed)
+	{
+		UE_LOG(LogReplaySystem, Warning, TEXT("Not playing replay %s, prefetch failed: %s"), *ReplayName,
+		       *PrefetchInfo.Error);
+		return false;
+	}
+
+	// The demo driver opens its own streamer, ours would only hold the stream open. Only the map package is kept, a
+	// prefetch of this replay after it has played starts over
+	++PrefetchSerial;
+	StopStreamer();
+	OnPrefetchComplete.Unbind();
+	PrefetchInfo = FReplayPrefetchInfo();
+	bCheckpointDone = false;
+	bMapDone = false;
+
+	return true;
+}
+
+void UReplayPrefetchSubsystem::OnStreamingStarted(const FStartStreamingResult& Result)
+{
+	if (!Result.WasSuccessful())
+	{
+		Fail(TEXT("Failed to open the replay stream"));
+		return;
+	}
+
+	FArchive* HeaderArchive = ReplayStreamer->GetHeaderArchive();
+
+	if (HeaderArchive == nullptr || HeaderArchive->TotalSize() == 0)
+	{
+		Fail(TEXT("Replay has no header"));
+		return;
+	}
+
+	FNetworkDemoHeader DemoHeader;
+	(*HeaderArchive) << DemoHeader;
+
+	if (HeaderArchive->IsError() || DemoHeader.Magic != NETWORK_DEMO_MAGIC)
+	{
+		Fail(TEXT("Replay header is corrupt"));
+		return;
+	}
+
+	if (DemoHeader.LevelNamesAndTimes.Num() == 0)
+	{
+		Fail(TEXT("Replay header does not name a map"));
+		return;
+	}
+
+	PrefetchInfo.MapName = DemoHeader.LevelNamesAndTimes[0].LevelName;
+	PrefetchInfo.LengthInMS = static_cast<int32>(ReplayStreamer->GetTotalDemoTime());
+
+	const int32 Serial = PrefetchSerial;
+	TWeakObjectPtr<UReplayPrefetchSubsystem> WeakThis = this;
+
+	// Reading the first checkpoint pulls it through the streamer (and the OS file cache for local replays)
+	ReplayStreamer->GotoCheckpointIndex(0, FGotoCallback::CreateLambda([WeakThis, Serial](const FGotoResult& GotoResult)
+	{
+		if (WeakThis.IsValid() && WeakThis->PrefetchSerial == Serial)
+		{
+			WeakThis->OnFirstCheckpointLoaded(GotoResult);
+		}
+	}), EReplayCheckpointType::Full);
+
+	// Warming the map is skipped in the editor where PIE worlds are duplicated from the editor world instead
+	if (GIsEditor || !FPackageName::DoesPackageExist(PrefetchInfo.MapName))
+	{
+		bMapDone = true;
+		return;
+	}
+
+	LoadPackageAsync(PrefetchInfo.MapName, FLoadPackageAsyncDelegate::CreateLambda(
+		                 [WeakThis, Serial](const FName& PackageName, UPackage* LoadedPackage,
+		                                    EAsyncLoadingResult::Type LoadResult)
+		                 {
+			                 if (WeakThis.IsValid() && WeakThis->PrefetchSerial == Serial)
+			                 {
+				                 WeakThis->OnMapPackageLoaded(PackageName, LoadedPackage, LoadResult);
+			                 }
+		                 }));
+}
+
+void UReplayPrefetchSubsystem::OnFirstCheckpointLoaded(const FGotoResult& Result)
+{
+	if (Result.WasSuccessful())
+	{
+		if (const FArchive* CheckpointArchive = ReplayStreamer->GetCheckpointArchive())
+		{
+			PrefetchInfo.bHasCheckpoint = CheckpointArchive->TotalSize() > 0;
+		}
+	}
+
+	bCheckpointDone = true;
+	ConditionallyComplete();
+}
+
+void UReplayPrefetchSubsystem::OnMapPackageLoaded(const FName& PackageName, UPackage* LoadedPackage,
+                                                  EAsyncLoadingResult::Type Result)
+{
+	if (Result == EAsyncLoadingResult::Succeeded)
+	{
+		PrefetchedMapPackage = LoadedPackage;
+	}
+	else
+	{
+		UE_LOG(LogReplaySystem, Log, TEXT("Could not warm map %s for replay %s"), *PackageName.ToString(),
+		       *PrefetchInfo.ReplayName);
+	}
+
+	bMapDone = true;
+	ConditionallyComplete();
+}
+
+void UReplayPrefetchSubsystem::OnPostLoadMap(UWorld* LoadedWorld)
+{
+	// Whichever map just loaded, holding the package any longer only costs memory
+	PrefetchedMapPackage = nullptr;
+
+	// A prefetch still streaming carries on, anything else is stale once a map has loaded
+	if (PrefetchInfo.State != EReplayPrefetchState::InProgress || !ReplayStreamer.IsValid())
+	{
+		++PrefetchSerial;
+		PrefetchInfo = FReplayPrefetchInfo();
+		bCheckpointDone = false;
+		bMapDone = false;
+	}
+}
+
+void UReplayPrefetchSubsystem::Fail(const FString& Error)
+{
+	UE_LOG(LogReplaySystem, Warning, TEXT("Prefetch of replay %s failed: %s"), *PrefetchInfo.ReplayName, *Error);
+
+	StopStreamer();
+
+	PrefetchInfo.State = EReplayPrefetchState::Failed;
+	PrefetchInfo.Error = Error;
+
+	const FOnPrefetchReplayComplete Callback = OnPrefetchComplete;
+	OnPrefetchComplete.Unbind();
+	Callback.ExecuteIfBound(PrefetchInfo);
+}
+
+void UReplayPrefetchSubsystem::ConditionallyComplete()
+{
+	if (!bCheckpointDone || !bMapDone || PrefetchInfo.State != EReplayPrefetchState::InProgress)
+	{
+		return;
+	}
+
+	StopStreamer();
+
+	PrefetchInfo.State = EReplayPrefetchState::Ready;
+
+	const FOnPrefetchReplayComplete Callback = OnPrefetchComplete;
+	OnPrefetchComplete.Unbind();
+	Callback.ExecuteIfBound(PrefetchInfo);
+}
+
+void UReplayPrefetchSubsystem::StopStreamer()
+{
+	if (ReplayStreamer.IsValid())
+	{
+		ReplayStreamer->StopStreaming();
+		ReplayStreamer.Reset();
+	}
+}
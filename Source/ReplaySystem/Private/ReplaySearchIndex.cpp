@@ -0,0 +1,408 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplaySearchIndex.h"
+
+#include "ReplayEventIndex.h"
+#include "ReplaySystem.h"
+#include "Async/Async.h"
+#include "Algo/BinarySearch.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace ReplaySearchIndex
+{
+	enum class EVersion : uint8
+	{
+		Initial = 1,
+
+		LatestPlusOne,
+		Latest = LatestPlusOne - 1
+	};
+
+	//Saves from the thread pool are written one at a time
+	FCriticalSection SaveLock;
+}
+
+FReplaySearchIndex& FReplaySearchIndex::Get()
+{
+	static FReplaySearchIndex SearchIndex;
+	SearchIndex.EnsureLoaded();
+	return SearchIndex;
+}
+
+FString FReplaySearchIndex::GetIndexFilename()
+{
+	// Next to the replays of the local file streamer
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Demos"), TEXT("ReplaySearchIndex.dat"));
+}
+
+void FReplaySearchIndex::UpdateReplay(const FString& ReplayName, const FReplayEventIndex& EventIndex,
+                                      const TSet<FName>& IndexedKeys)
+{
+	check(IsInGameThread());
+
+	LLM_SCOPE_BYTAG(ReplaySystem_Index);
+
+	FReplayEntry Entry;
+	Entry.Name = ReplayName;
+	Entry.Events.Reserve(EventIndex.GetEvents().Num());
+
+	for (const FReplayIndexedEvent& Event : EventIndex.GetEvents())
+	{
+		FReplayIndexedEvent& Indexed = Entry.Events.Add_GetRef(Event);
+		Indexed.Metadata.RemoveAll([&IndexedKeys](const FReplayMetadataValue& Value)
+		{
+			return !IndexedKeys.Contains(FName(*Value.Key, FNAME_Find));
+		});
+	}
+
+	int32 Slot = INDEX_NONE;
+	if (const int32* ExistingSlot = ReplaySlots.Find(ReplayName))
+	{
+		Slot = *ExistingSlot;
+		RemovePostings(Slot);
+		Replays[Slot] = MoveTemp(Entry);
+	}
+	else
+	{
+		Slot = Replays.Add(MoveTemp(Entry));
+		ReplaySlots.Add(ReplayName, Slot);
+	}
+
+	AddPostings(Slot);
+	Save();
+}
+
+void FReplaySearchIndex::RemoveReplay(const FString& ReplayName)
+{
+	check(IsInGameThread());
+
+	if (RemoveSlot(ReplayName))
+	{
+		Save();
+	}
+}
+
+void FReplaySearchIndex::RenameReplay(const FString& ReplayName, const FString& NewReplayName)
+{
+	check(IsInGameThread());
+
+	int32 Slot = INDEX_NONE;
+	if (ReplayName == NewReplayName || !ReplaySlots.RemoveAndCopyValue(ReplayName, Slot))
+	{
+		return;
+	}
+
+	// The postings point at the slot, only the name changes. Whatever was indexed under the new name was overwritten
+	RemoveSlot(NewReplayName);
+	Replays[Slot].Name = NewReplayName;
+	ReplaySlots.Add(NewReplayName, Slot);
+	Save();
+}
+
+void FReplaySearchIndex::FindEvents(const FString& Group, const FString& EventId, TArray<FReplaySearchHit>& OutHits)
+{
+	if (const TArray<FHit>* Hits = Terms.Find(EventId.IsEmpty() ? GroupTerm(Group) : EventTerm(Group, EventId)))
+	{
+		AddHits(*Hits, OutHits);
+	}
+}
+
+void FReplaySearchIndex::FindByValue(const FReplayMetadataValue& Value, TArray<FReplaySearchHit>& OutHits)
+{
+	if (Value.Type != EReplayMetadataType::String)
+	{
+		FindInRange(FName(*Value.Key, FNAME_Find), Value.GetNumber(), Value.GetNumber(), OutHits);
+		return;
+	}
+
+	if (const TArray<FHit>* Hits = Terms.Find(ValueTerm(Value.Key, Value.StringValue)))
+	{
+		AddHits(*Hits, OutHits);
+	}
+}
+
+void FReplaySearchIndex::FindInRange(const FName Key, double Min, double Max, TArray<FReplaySearchHit>& OutHits)
+{
+	FNumberColumn* Column = Key.IsNone() ? nullptr : Numbers.Find(Key);
+	if (!Column)
+	{
+		return;
+	}
+
+	if (!Column->bSorted)
+	{
+		Column->Entries.StableSort([](const TPair<double, FHit>& A, const TPair<double, FHit>& B)
+		{
+			return A.Key < B.Key;
+		});
+		Column->bSorted = true;
+	}
+
+	const auto Projection = [](const TPair<double, FHit>& Entry) { return Entry.Key; };
+	const int32 First = Algo::LowerBoundBy(Column->Entries, Min, Projection);
+	const int32 Last = Algo::UpperBoundBy(Column->Entries, Max, Projection);
+
+	TArray<FHit> Hits;
+	Hits.Reserve(FMath::Max(Last - First, 0));
+	for (int32 Index = First; Index < Last; ++Index)
+	{
+		Hits.Add(Column->Entries[Index].Value);
+	}
+
+	AddHits(Hits, OutHits);
+}
+
+TArray<FString> FReplaySearchIndex::GetIndexedReplays()
+{
+	TArray<FString> Names;
+	ReplaySlots.GetKeys(Names);
+	return Names;
+}
+
+void FReplaySearchIndex::EnsureLoaded()
+{
+	if (bLoaded)
+	{
+		return;
+	}
+
+	bLoaded = true;
+
+	LLM_SCOPE_BYTAG(ReplaySystem_Index);
+
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *GetIndexFilename(), FILEREAD_Silent))
+	{
+		return;
+	}
+
+	FMemoryReader Reader(Data);
+
+	uint8 Version = 0;
+	Reader << Version;
+
+	int32 NumReplays = 0;
+	Reader << NumReplays;
+
+	if (Version == 0 || Version > static_cast<uint8>(ReplaySearchIndex::EVersion::Latest) || NumReplays < 0 ||
+		NumReplays > Data.Num())
+	{
+		UE_LOG(LogReplaySystem, Warning, TEXT("Ignoring unreadable replay search index %s"), *GetIndexFilename());
+		return;
+	}
+
+	TArray<FReplayEntry> Loaded;
+	Loaded.SetNum(NumReplays);
+
+	for (FReplayEntry& Entry : Loaded)
+	{
+		Reader << Entry.Name;
+
+		int32 NumEvents = 0;
+		Reader << NumEvents;
+
+		// Every event takes at least a byte, a count larger than what is left to read is corrupt
+		if (NumEvents < 0 || NumEvents > Reader.TotalSize() - Reader.Tell())
+		{
+			Reader.SetError();
+		}
+		else
+		{
+			Entry.Events.SetNum(NumEvents);
+			for (int32 Index = 0; Index < NumEvents && !Reader.IsError(); ++Index)
+			{
+				Reader << Entry.Events[Index];
+			}
+		}
+
+		if (Reader.IsError())
+		{
+			UE_LOG(LogReplaySystem, Warning, TEXT("Ignoring corrupt replay search index %s"), *GetIndexFilename());
+			return;
+		}
+	}
+
+	Replays = MoveTemp(Loaded);
+	for (int32 Slot = 0; Slot < Replays.Num(); ++Slot)
+	{
+		ReplaySlots.Add(Replays[Slot].Name, Slot);
+		AddPostings(Slot);
+	}
+
+	UpdateMemory();
+}
+
+bool FReplaySearchIndex::RemoveSlot(const FString& ReplayName)
+{
+	int32 Slot = INDEX_NONE;
+	if (!ReplaySlots.RemoveAndCopyValue(ReplayName, Slot))
+	{
+		return false;
+	}
+
+	RemovePostings(Slot);
+	Replays[Slot] = FReplayEntry();
+	return true;
+}
+
+void FReplaySearchIndex::AddPostings(int32 ReplaySlot)
+{
+	const TArray<FReplayIndexedEvent>& Events = Replays[ReplaySlot].Events;
+
+	for (int32 EventSlot = 0; EventSlot < Events.Num(); ++EventSlot)
+	{
+		const FReplayIndexedEvent& Event = Events[EventSlot];
+		const FHit Hit{ReplaySlot, EventSlot};
+
+		Terms.FindOrAdd(GroupTerm(Event.Group)).Add(Hit);
+		Terms.FindOrAdd(EventTerm(Event.Group, Event.EventID)).Add(Hit);
+
+		for (const FReplayMetadataValue& Value : Event.Metadata)
+		{
+			if (Value.Type == EReplayMetadataType::String)
+			{
+				Terms.FindOrAdd(ValueTerm(Value.Key, Value.StringValue)).Add(Hit);
+			}
+			else
+			{
+				FNumberColumn& Column = Numbers.FindOrAdd(FName(*Value.Key));
+				Column.Entries.Emplace(Value.GetNumber(), Hit);
+				Column.bSorted = false;
+			}
+		}
+	}
+}
+
+void FReplaySearchIndex::RemovePostings(int32 ReplaySlot)
+{
+	const auto IsInReplay = [ReplaySlot](const FHit& Hit) { return Hit.Replay == ReplaySlot; };
+
+	for (auto It = Terms.CreateIterator(); It; ++It)
+	{
+		It.Value().RemoveAll(IsInReplay);
+		if (It.Value().Num() == 0)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	for (TPair<FName, FNumberColumn>& Column : Numbers)
+	{
+		// Removing keeps the order of the rest
+		Column.Value.Entries.RemoveAll([ReplaySlot](const TPair<double, FHit>& Entry)
+		{
+			return Entry.Value.Replay == ReplaySlot;
+		});
+	}
+}
+
+void FReplaySearchIndex::AddHits(TConstArrayView<FHit> Hits, TArray<FReplaySearchHit>& OutHits) const
+{
+	OutHits.Reserve(OutHits.Num() + Hits.Num());
+
+	for (const FHit& Hit : Hits)
+	{
+		const FReplayEntry& Replay = Replays[Hit.Replay];
+		const FReplayIndexedEvent& Event = Replay.Events[Hit.Event];
+
+		FReplaySearchHit& OutHit = OutHits.AddDefaulted_GetRef();
+		OutHit.ReplayName = Replay.Name;
+		OutHit.EventID = Event.EventID;
+		OutHit.Group = Event.Group;
+		OutHit.TimeInMs = Event.TimeInMs;
+	}
+}
+
+void FReplaySearchIndex::Save()
+{
+	// Every change is saved, so this is where the index has its new size
+	UpdateMemory();
+
+	LLM_SCOPE_BYTAG(ReplaySystem_Index);
+
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+
+	uint8 Version = static_cast<uint8>(ReplaySearchIndex::EVersion::Latest);
+	Writer << Version;
+
+	int32 NumReplays = ReplaySlots.Num();
+	Writer << NumReplays;
+
+	// Written per named slot so the count always matches the entries that follow
+	for (const TPair<FString, int32>& ReplaySlot : ReplaySlots)
+	{
+		FReplayEntry& Entry = Replays[ReplaySlot.Value];
+		Writer << Entry.Name;
+		Writer << Entry.Events;
+	}
+
+	const uint32 Serial = ++(*LatestSave);
+
+	// Writing can take a while with thousands of replays, keep it off the game thread
+	Async(EAsyncExecution::ThreadPool, [Data = MoveTemp(Data), Serial, LatestSave = LatestSave]()
+	{
+		LLM_SCOPE_BYTAG(ReplaySystem_Index);
+		FScopeLock Lock(&ReplaySearchIndex::SaveLock);
+
+		if (Serial != LatestSave->load())
+		{
+			return;
+		}
+
+		const FString Filename = GetIndexFilename();
+		const FString TempFilename = Filename + TEXT(".tmp");
+
+		if (!FFileHelper::SaveArrayToFile(Data, *TempFilename) ||
+			!IFileManager::Get().Move(*Filename, *TempFilename, true, true))
+		{
+			UE_LOG(LogReplaySystem, Warning, TEXT("Could not save the replay search index to %s"), *Filename);
+		}
+	});
+}
+
+void FReplaySearchIndex::UpdateMemory()
+{
+	SIZE_T Size = Replays.GetAllocatedSize() + ReplaySlots.GetAllocatedSize() + Terms.GetAllocatedSize() + Numbers.
+		GetAllocatedSize();
+
+	for (const FReplayEntry& Entry : Replays)
+	{
+		Size += Entry.Name.GetAllocatedSize() + Entry.Events.GetAllocatedSize();
+		for (const FReplayIndexedEvent& Event : Entry.Events)
+		{
+			Size += Event.GetAllocatedSize();
+		}
+	}
+
+	for (const TPair<FString, TArray<FHit>>& Term : Terms)
+	{
+		Size += Term.Key.GetAllocatedSize() + Term.Value.GetAllocatedSize();
+	}
+
+	for (const TPair<FName, FNumberColumn>& Column : Numbers)
+	{
+		Size += Column.Value.Entries.GetAllocatedSize();
+	}
+
+	MemoryCounter.Set(Size);
+}
+
+FString FReplaySearchIndex::GroupTerm(const FString& Group)
+{
+	return TEXT("g:") + Group;
+}
+
+FString FReplaySearchIndex::EventTerm(const FString& Group, const FString& EventId)
+{
+	return FString::Printf(TEXT("e:%s/%s"), *Group, *EventId);
+}
+
+FString FReplaySearchIndex::ValueTerm(const FString& Key, const FString& Value)
+{
+	return FString::Printf(TEXT("v:%s=%s"), *Key, *Value);
+}
@@ -0,0 +1,406 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplaySegmentSubsystem.h"
+
+#include "JsonObjectConverter.h"
+#include "ReplayFileUtils.h"
+#include "ReplayStateSubsystem.h"
+#include "ReplaySystem.h"
+#include "ReplaySystemBPLibrary.h"
+#include "Engine/DemoNetDriver.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/NetConnection.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+void UReplaySegmentSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateUObject(this, &UReplaySegmentSubsystem::Tick));
+
+	PlaybackCompleteHandle = FNetworkReplayDelegates::OnReplayPlaybackComplete.AddUObject(
+		this, &UReplaySegmentSubsystem::HandleReplayPlaybackComplete);
+}
+
+void UReplaySegmentSubsystem::Deinitialize()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	TickerHandle.Reset();
+
+	FNetworkReplayDelegates::OnReplayPlaybackComplete.Remove(PlaybackCompleteHandle);
+	PlaybackCompleteHandle.Reset();
+
+	// The world is going away with the game instance, keep what was recorded so far playable
+	if (bIsRecording && Manifest.Segments.IsValidIndex(CurrentSegment))
+	{
+		Manifest.Segments[CurrentSegment].Length = SegmentTime;
+		Manifest.bIsRecording = false;
+		SaveManifest();
+	}
+
+	bIsRecording = false;
+	bIsPlaying = false;
+
+	Super::Deinitialize();
+}
+
+UReplaySegmentSubsystem* UReplaySegmentSubsystem::Get(const UObject* WorldContextObject)
+{
+	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
+	{
+		if (const UGameInstance* GI = World->GetGameInstance())
+		{
+			return GI->GetSubsystem<UReplaySegmentSubsystem>();
+		}
+	}
+
+	return nullptr;
+}
+
+bool UReplaySegmentSubsystem::StartRecording(const FString& BaseName, const FString& FriendlyName,
+                                             float MaxSegmentMinutes, float MaxSegmentMB)
+{
+	UWorld* World = GetGameInstance()->GetWorld();
+
+	if (!World || BaseName.IsEmpty())
+	{
+		return false;
+	}
+
+	if (bIsRecording)
+	{
+		StopRecording();
+	}
+
+	UReplaySystemBPLibrary::StopRecordingReplay(World);
+
+	bIsPlaying = false;
+	bIsRecording = true;
+
+	Manifest = FReplaySegmentManifest();
+	Manifest.BaseName = BaseName;
+	Manifest.FriendlyName = FriendlyName;
+	Manifest.bIsRecording = true;
+
+	MaxSegmentSeconds = FMath::Max(MaxSegmentMinutes, 0.0f) * 60.0f;
+	MaxSegmentBytes = static_cast<int64>(FMath::Max(MaxSegmentMB, 0.0f) * 1024.0f * 1024.0f);
+
+	StartSegment(World);
+	return true;
+}
+
+void UReplaySegmentSubsystem::StopRecording()
+{
+	if (!bIsRecording)
+	{
+		return;
+	}
+
+	if (UWorld* World = GetGameInstance()->GetWorld())
+	{
+		EndSegment(World);
+	}
+
+	bIsRecording = false;
+	Manifest.bIsRecording = false;
+	SaveManifest();
+
+	UE_LOG(LogReplaySystem, Log, TEXT("Recorded %s in %d segment(s), %.1f seconds"), *Manifest.BaseName,
+	       Manifest.Segments.Num(), Manifest.GetLength());
+}
+
+bool UReplaySegmentSubsystem::Play(const FString& BaseName, float StartTime)
+{
+	FReplaySegmentManifest LoadedManifest;
+
+	if (bIsRecording || !LoadManifest(BaseName, LoadedManifest) || LoadedManifest.Segments.Num() == 0)
+	{
+		return false;
+	}
+
+	Manifest = MoveTemp(LoadedManifest);
+	bIsPlaying = true;
+	bPlayNextSegment = false;
+	PendingSeekComplete.Clear();
+
+	const float Time = FMath::Clamp(StartTime, 0.0f, Manifest.GetLength());
+	const int32 Index = Manifest.FindSegment(Time);
+	PlaySegment(Index, Time - Manifest.Segments[Index].StartTime);
+	return true;
+}
+
+bool UReplaySegmentSubsystem::ResolveSeek(float Time, float& OutLocalTime, FOnGotoTimeComplete OnComplete)
+{
+	OutLocalTime = Time;
+
+	if (!bIsPlaying || !Manifest.Segments.IsValidIndex(CurrentSegment))
+	{
+		return true;
+	}
+
+	const float ClampedTime = FMath::Clamp(Time, 0.0f, Manifest.GetLength());
+	const int32 Index = Manifest.FindSegment(ClampedTime);
+	OutLocalTime = ClampedTime - Manifest.Segments[Index].StartTime;
+
+	if (Index == CurrentSegment)
+	{
+		return true;
+	}
+
+	PendingSeekComplete = OnComplete;
+	PlaySegment(Index, OutLocalTime);
+	return false;
+}
+
+float UReplaySegmentSubsystem::GetPlaybackTimeOffset() const
+{
+	return bIsPlaying && Manifest.Segments.IsValidIndex(CurrentSegment)
+		       ? Manifest.Segments[CurrentSegment].StartTime
+		       : 0.0f;
+}
+
+bool UReplaySegmentSubsystem::LoadManifest(const FString& BaseName, FReplaySegmentManifest& OutManifest)
+{
+	FString Json;
+	return FFileHelper::LoadFileToString(Json, *GetManifestFilename(BaseName)) &&
+		FJsonObjectConverter::JsonObjectStringToUStruct(Json, &OutManifest);
+}
+
+FString UReplaySegmentSubsystem::GetManifestFilename(const FString& BaseName)
+{
+	return FPaths::Combine(FLocalFileNetworkReplayStreamer::GetDefaultDemoSavePath(),
+	                       BaseName + TEXT(".segments.json"));
+}
+
+FString UReplaySegmentSubsystem::GetSegmentName(const FString& BaseName, int32 Index)
+{
+	return FString::Printf(TEXT("%s_%03d"), *BaseName, Index);
+}
+
+bool UReplaySegmentSubsystem::Tick(float DeltaTime)
+{
+	if (UWorld* World = GetGameInstance()->GetWorld())
+	{
+		if (bIsRecording)
+		{
+			TickRecording(World);
+		}
+		else if (bIsPlaying)
+		{
+			TickPlayback(World);
+		}
+	}
+
+	return true;
+}
+
+void UReplaySegmentSubsystem::TickRecording(UWorld* World)
+{
+	const UReplayStateSubsystem* StateSubsystem = World->GetSubsystem<UReplayStateSubsystem>();
+	const FString& SegmentName = Manifest.Segments[CurrentSegment].ReplayName;
+
+	if (!StateSubsystem || !StateSubsystem->GetPlaybackState().bIsRecording ||
+		StateSubsystem->GetPlaybackState().ReplayName != SegmentName)
+	{
+		// The demo driver may take a moment to show up
+		if (!bSegmentStarted)
+		{
+			return;
+		}
+
+		// Recording was stopped or replaced without going through this subsystem, finish with what was recorded
+		bIsRecording = false;
+		Manifest.Segments[CurrentSegment].Length = SegmentTime;
+		Manifest.bIsRecording = false;
+		SaveManifest();
+		return;
+	}
+
+	bSegmentStarted = true;
+	SegmentTime = StateSubsystem->GetPlaybackState().CurrentTime;
+
+	bool bRollOver = MaxSegmentSeconds > 0.0f && SegmentTime >= MaxSegmentSeconds;
+
+	// The size is only known from the file, which is not worth asking for every frame
+	const double Now = FPlatformTime::Seconds();
+	if (!bRollOver && MaxSegmentBytes > 0 && Now - LastSizeCheckTime >= 1.0)
+	{
+		LastSizeCheckTime = Now;
+		bRollOver = IFileManager::Get().FileSize(*ReplayFileUtils::GetReplayFilename(SegmentName)) >= MaxSegmentBytes;
+	}
+
+	if (bRollOver)
+	{
+		EndSegment(World);
+		StartSegment(World);
+	}
+}
+
+void UReplaySegmentSubsystem::TickPlayback(UWorld* World)
+{
+	const UReplayStateSubsystem* StateSubsystem = World->GetSubsystem<UReplayStateSubsystem>();
+
+	if (!StateSubsystem || !Manifest.Segments.IsValidIndex(CurrentSegment))
+	{
+		return;
+	}
+
+	const FReplayPlaybackState& PlaybackState = StateSubsystem->GetPlaybackState();
+	const FReplaySegment& Segment = Manifest.Segments[CurrentSegment];
+
+	if (!PlaybackState.bIsPlaying || PlaybackState.ReplayName != Segment.ReplayName)
+	{
+		// Something other than a segment is playing now, the replay playing while a segment loads does not count
+		if (PlaybackState.bIsPlaying && PendingSeekTime < 0.0f && !Manifest.Segments.ContainsByPredicate(
+			[&PlaybackState](const FReplaySegment& Other)
+			{
+				return Other.ReplayName == PlaybackState.ReplayName;
+			}))
+		{
+			bIsPlaying = false;
+		}
+		return;
+	}
+
+	if (bPlayNextSegment)
+	{
+		bPlayNextSegment = false;
+		PlaySegment(CurrentSegment + 1, 0.0f);
+		return;
+	}
+
+	if (PendingSeekTime < 0.0f)
+	{
+		return;
+	}
+
+	// Seeking needs the spectator the demo driver spawns once the segment has started
+	const UDemoNetDriver* DemoDriver = StateSubsystem->GetDemoDriver();
+	if (!DemoDriver || !DemoDriver->ServerConnection || !DemoDriver->ServerConnection->PlayerController ||
+		!DemoDriver->ServerConnection->PlayerController->PlayerState)
+	{
+		return;
+	}
+
+	const float SeekTime = PendingSeekTime;
+	PendingSeekTime = -1.0f;
+
+	FOnGotoTimeComplete OnComplete = PendingSeekComplete;
+	PendingSeekComplete.Clear();
+
+	if (SeekTime <= 0.0f)
+	{
+		OnComplete.ExecuteIfBound(true);
+		return;
+	}
+
+	// Resolves to this segment now that it is the one playing
+	UReplaySystemBPLibrary::GoToSpecificTime(World, Segment.StartTime + SeekTime, false, OnComplete);
+}
+
+void UReplaySegmentSubsystem::StartSegment(UWorld* World)
+{
+	FReplaySegment& Segment = Manifest.Segments.AddDefaulted_GetRef();
+	Segment.ReplayName = GetSegmentName(Manifest.BaseName, Manifest.Segments.Num() - 1);
+
+	if (Manifest.Segments.Num() > 1)
+	{
+		const FReplaySegment& Previous = Manifest.Segments[Manifest.Segments.Num() - 2];
+		Segment.StartTime = Previous.StartTime + Previous.Length;
+	}
+
+	CurrentSegment = Manifest.Segments.Num() - 1;
+	SegmentTime = 0.0f;
+	bSegmentStarted = false;
+	LastSizeCheckTime = FPlatformTime::Seconds();
+
+	// Written before the segment so a crash still leaves a manifest listing every segment on disk
+	SaveManifest();
+
+	UReplaySystemBPLibrary::RecordReplay(World, Segment.ReplayName, Manifest.FriendlyName);
+
+	UE_LOG(LogReplaySystem, Log, TEXT("Recording segment %s at %.1f seconds"), *Segment.ReplayName,
+	       Segment.StartTime);
+}
+
+void UReplaySegmentSubsystem::EndSegment(UWorld* World)
+{
+	if (const UReplayStateSubsystem* StateSubsystem = World->GetSubsystem<UReplayStateSubsystem>())
+	{
+		if (StateSubsystem->GetPlaybackState().bIsRecording)
+		{
+			SegmentTime = StateSubsystem->GetPlaybackState().CurrentTime;
+		}
+	}
+
+	Manifest.Segments[CurrentSegment].Length = SegmentTime;
+
+	{
+		// Stops the segment itself instead of being routed back to StopRecording
+		TGuardValue<bool> RecordingGuard(bIsRecording, false);
+		UReplaySystemBPLibrary::StopRecordingReplay(World);
+	}
+
+	SaveManifest();
+}
+
+bool UReplaySegmentSubsystem::SaveManifest() const
+{
+	FString Json;
+	if (!FJsonObjectConverter::UStructToJsonObjectString(Manifest, Json))
+	{
+		return false;
+	}
+
+	const FString Filename = GetManifestFilename(Manifest.BaseName);
+	const FString TempFilename = Filename + TEXT(".tmp");
+
+	if (!FFileHelper::SaveStringToFile(Json, *TempFilename) || !IFileManager::Get().Move(
+		*Filename, *TempFilename, true, true))
+	{
+		UE_LOG(LogReplaySystem, Warning, TEXT("Could not save the segment manifest of %s"), *Manifest.BaseName);
+		return false;
+	}
+
+	return true;
+}
+
+void UReplaySegmentSubsystem::PlaySegment(int32 Index, float LocalTime)
+{
+	UWorld* World = GetGameInstance()->GetWorld();
+
+	if (!World || !Manifest.Segments.IsValidIndex(Index))
+	{
+		bIsPlaying = false;
+		return;
+	}
+
+	CurrentSegment = Index;
+	PendingSeekTime = LocalTime;
+
+	if (!UReplaySystemBPLibrary::PlayRecordedReplay(World, Manifest.Segments[Index].ReplayName))
+	{
+		UE_LOG(LogReplaySystem, Warning, TEXT("Could not play segment %s"), *Manifest.Segments[Index].ReplayName);
+		bIsPlaying = false;
+		PendingSeekTime = -1.0f;
+		PendingSeekComplete.ExecuteIfBound(false);
+		PendingSeekComplete.Clear();
+	}
+}
+
+void UReplaySegmentSubsystem::HandleReplayPlaybackComplete(UWorld* InWorld)
+{
+	if (!bIsPlaying || InWorld != GetGameInstance()->GetWorld() || !Manifest.Segments.IsValidIndex(CurrentSegment + 1))
+	{
+		return;
+	}
+
+	// Not from inside the demo driver's tick, the next segment is played on the next tick
+	bPlayNextSegment = true;
+}
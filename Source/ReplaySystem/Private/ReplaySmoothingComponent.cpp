@@ -0,0 +1,172 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplaySmoothingComponent.h"
+
+#include "Engine/DemoNetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/CharacterMovementComponent.h"
+
+namespace ReplaySmoothing
+{
+	//A demo time jump larger than this is a seek, not playback
+	constexpr double MaxTimeStep = 1.0;
+}
+
+UReplaySmoothingComponent::UReplaySmoothingComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = true;
+	// After movement components have applied the replicated movement for this frame
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+}
+
+void UReplaySmoothingComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	const UWorld* World = GetWorld();
+
+	if (!World || !World->IsPlayingReplay())
+	{
+		SetComponentTickEnabled(false);
+		return;
+	}
+
+	if (bDisableMovementComponentSmoothing)
+	{
+		if (UCharacterMovementComponent* CharacterMovement = GetOwner()->FindComponentByClass<
+			UCharacterMovementComponent>())
+		{
+			CharacterMovement->NetworkSmoothingMode = ENetworkSmoothingMode::Disabled;
+		}
+	}
+}
+
+void UReplaySmoothingComponent::TickComponent(float DeltaTime, ELevelTick TickType,
+                                              FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	const UWorld* World = GetWorld();
+	const UDemoNetDriver* DemoDriver = World ? World->GetDemoNetDriver() : nullptr;
+	AActor* Owner = GetOwner();
+
+	if (!DemoDriver || !DemoDriver->IsPlaying() || !Owner)
+	{
+		return;
+	}
+
+	const double DemoTime = DemoDriver->GetDemoCurrentTime();
+
+	if (DemoTime < LastDemoTime || DemoTime - LastDemoTime > ReplaySmoothing::MaxTimeStep)
+	{
+		ResetSmoothing();
+	}
+
+	LastDemoTime = DemoTime;
+
+	ConditionallyAddSample(DemoTime);
+
+	const double RenderTime = DemoTime - InterpolationDelay;
+
+	// Keep a single sample at or before the render time to interpolate from
+	while (Samples.Num() > 2 && Samples[1].Time <= RenderTime)
+	{
+		Samples.RemoveAt(0, 1, EAllowShrinking::No);
+	}
+
+	FVector Location;
+	FQuat Rotation;
+
+	if (Evaluate(RenderTime, Location, Rotation))
+	{
+		Owner->SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::TeleportPhysics);
+	}
+}
+
+void UReplaySmoothingComponent::ResetSmoothing()
+{
+	Samples.Reset();
+	bHasReceived = false;
+}
+
+void UReplaySmoothingComponent::ConditionallyAddSample(double DemoTime)
+{
+	const FRepMovement& ReplicatedMovement = GetOwner()->GetReplicatedMovement();
+
+	// ReplicatedMovement only changes when the replay delivers an update, our own moves never touch it. An actor that
+	// stops only changes its velocity, dropping that update would keep extrapolating it along the old one
+	if (bHasReceived && ReplicatedMovement.Location.Equals(LastReceivedLocation) && ReplicatedMovement.Rotation.Equals(
+		LastReceivedRotation) && ReplicatedMovement.LinearVelocity.Equals(LastReceivedVelocity))
+	{
+		return;
+	}
+
+	bHasReceived = true;
+	LastReceivedLocation = ReplicatedMovement.Location;
+	LastReceivedRotation = ReplicatedMovement.Rotation;
+	LastReceivedVelocity = ReplicatedMovement.LinearVelocity;
+
+	if (Samples.Num() > 0 && FVector::DistSquared(Samples.Last().Location, ReplicatedMovement.Location) > FMath::Square(
+		TeleportDistance))
+	{
+		Samples.Reset();
+	}
+
+	FSample& Sample = Samples.AddDefaulted_GetRef();
+	Sample.Time = DemoTime;
+	Sample.Location = ReplicatedMovement.Location;
+	Sample.Rotation = ReplicatedMovement.Rotation.Quaternion();
+	Sample.Velocity = ReplicatedMovement.LinearVelocity;
+}
+
+bool UReplaySmoothingComponent::Evaluate(double Time, FVector& OutLocation, FQuat& OutRotation) const
+{
+	if (Samples.Num() == 0)
+	{
+		return false;
+	}
+
+	if (Time <= Samples[0].Time)
+	{
+		OutLocation = Samples[0].Location;
+		OutRotation = Samples[0].Rotation;
+		return true;
+	}
+
+	for (int32 Index = 0; Index < Samples.Num() - 1; ++Index)
+	{
+		const FSample& From = Samples[Index];
+		const FSample& To = Samples[Index + 1];
+
+		if (Time >= To.Time)
+		{
+			continue;
+		}
+
+		const double Duration = To.Time - From.Time;
+		const float Alpha = Duration > UE_KINDA_SMALL_NUMBER ? static_cast<float>((Time - From.Time) / Duration) : 1.0f;
+
+		if (bUseHermiteInterpolation)
+		{
+			// Tangents are the velocities scaled to the segment so the curve arrives at each sample at its velocity
+			OutLocation = FMath::CubicInterp(From.Location, From.Velocity * Duration, To.Location,
+			                                 To.Velocity * Duration, Alpha);
+		}
+		else
+		{
+			OutLocation = FMath::Lerp(From.Location, To.Location, Alpha);
+		}
+
+		OutRotation = FQuat::Slerp(From.Rotation, To.Rotation, Alpha);
+		return true;
+	}
+
+	const FSample& Last = Samples.Last();
+	const double ExtrapolationTime = FMath::Min(Time - Last.Time, static_cast<double>(MaxExtrapolationTime));
+
+	OutLocation = Last.Location + Last.Velocity * ExtrapolationTime;
+	OutRotation = Last.Rotation;
+	return true;
+}
@@ -0,0 +1,668 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayStateSubsystem.h"
+
+#include "ReplaySystem.h"
+#include "ReplayClip.h"
+#include "ReplayEventQueue.h"
+#include "ReplayIntegrity.h"
+#include "ReplayMetricsSubsystem.h"
+#include "ReplaySegmentSubsystem.h"
+#include "Async/Async.h"
+#include "Containers/Ticker.h"
+#include "NetworkReplayStreaming.h"
+#include "Engine/DemoNetDriver.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/WorldSettings.h"
+
+static TAutoConsoleVariable<float> CVarReplayChecksumInterval(
+	TEXT("ReplaySystem.ChecksumInterval"), 10.0f,
+	TEXT("Seconds between two updates of the chunk checksums of the replay being recorded, 0 to only write them when recording stops"));
+
+static TAutoConsoleVariable<bool> CVarReplayCrashSafeRecording(
+	TEXT("ReplaySystem.CrashSafeRecording"), false,
+	TEXT("Write recorded replays out every CrashSafeFlushInterval seconds so a crash only loses the last few seconds"));
+
+static TAutoConsoleVariable<float> CVarReplayCrashSafeFlushInterval(
+	TEXT("ReplaySystem.CrashSafeFlushInterval"), 5.0f,
+	TEXT("Seconds between two writes of the replay being recorded in crash safe mode. Every write appends the stream "
+		"data since the last one and rewrites the header, so shorter intervals lose less but write more often"));
+
+static TAutoConsoleVariable<float> CVarReplayCheckpointSaveBudget(
+	TEXT("ReplaySystem.CheckpointSaveBudgetMS"), 0.0f,
+	TEXT("Most milliseconds of game thread time the demo driver spends saving a checkpoint per frame while recording, "
+		"larger checkpoints are spread across frames instead of causing a hitch, e.g. 2. 0 leaves the demo driver's own "
+		"limit. Not applied when demo.CheckpointSaveMaxMSPerFrameOverride was set from an ini, the command line or the "
+		"console"));
+
+namespace ReplayState
+{
+	// The console variables are global, every world that records shares them. The first recording to change one saves
+	// its value and the last one to stop restores it
+
+	int32 NumCrashSafeRecordings = 0;
+
+	float SavedChunkUploadDelay = 0.0f;
+
+	int32 NumBudgetedRecordings = 0;
+
+	float SavedCheckpointBudget = 0.0f;
+
+	//Whether the last recording to stop restored the checkpoint limit, so the value set by code is not someone else's
+	bool bRestoredCheckpointBudget = false;
+}
+
+float UReplayStateSubsystem::GetCrashSafeFlushInterval()
+{
+	return CVarReplayCrashSafeRecording.GetValueOnGameThread()
+		       ? FMath::Max(CVarReplayCrashSafeFlushInterval.GetValueOnGameThread(), 1.0f)
+		       : 0.0f;
+}
+
+float UReplayStateSubsystem::GetFlushInterval(float Interval)
+{
+	const float CrashSafeFlushInterval = GetCrashSafeFlushInterval();
+	return CrashSafeFlushInterval > 0.0f ? FMath::Min(Interval, CrashSafeFlushInterval) : Interval;
+}
+
+void UReplayStateSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PlaybackState = FReplayPlaybackState();
+	BroadcastState = FReplayPlaybackState();
+	CachedDemoDriver.Reset();
+	bReachedEnd = false;
+
+	PlaybackCompleteHandle = FNetworkReplayDelegates::OnReplayPlaybackComplete.AddUObject(
+		this, &UReplayStateSubsystem::HandleReplayPlaybackComplete);
+
+	// Broadcast by the demo driver before it closes the replay, whatever stopped the recording
+	RecordingCompleteHandle = FNetworkReplayDelegates::OnReplayRecordingComplete.AddUObject(
+		this, &UReplayStateSubsystem::HandleReplayRecordingComplete);
+
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(
+		this, &UReplayStateSubsystem::HandlePostActorTick);
+	PostTickFlushHandle = GetWorld()->OnPostTickFlush().AddUObject(this, &UReplayStateSubsystem::HandlePostTickFlush);
+}
+
+void UReplayStateSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	RefreshPlaybackState();
+}
+
+void UReplayStateSubsystem::Deinitialize()
+{
+	bIsPlayingInstantReplay = false;
+	LivePlayerController.Reset();
+
+	FNetworkReplayDelegates::OnReplayPlaybackComplete.Remove(PlaybackCompleteHandle);
+	PlaybackCompleteHandle.Reset();
+
+	FNetworkReplayDelegates::OnReplayRecordingComplete.Remove(RecordingCompleteHandle);
+	RecordingCompleteHandle.Reset();
+
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	GetWorld()->OnPostTickFlush().Remove(PostTickFlushHandle);
+	PostActorTickHandle.Reset();
+	PostTickFlushHandle.Reset();
+
+	CachedDemoDriver.Reset();
+
+	if (bOwnsEventQueue)
+	{
+		FReplayEventQueue::Get().StopRecording();
+		bOwnsEventQueue = false;
+	}
+
+	if (BroadcastState.bIsRecording)
+	{
+		FReplayIntegrity::SetRecording(BroadcastState.ReplayName, false);
+	}
+
+	SetCrashSafeStreaming(false);
+	SetCheckpointBudget(false);
+
+	Super::Deinitialize();
+}
+
+void UReplayStateSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	RefreshPlaybackState();
+	DrainQueuedEvents();
+	BroadcastStateChanges();
+
+	// Checksums are only written for chunks on disk, keep up with the streamer in crash safe mode
+	float ChecksumInterval = CVarReplayChecksumInterval.GetValueOnGameThread();
+	if (bCrashSafeStreaming)
+	{
+		ChecksumInterval = ChecksumInterval > 0.0f
+			                   ? FMath::Min(ChecksumInterval, GetCrashSafeFlushInterval())
+			                   : GetCrashSafeFlushInterval();
+	}
+
+	if (BroadcastState.bIsRecording && ChecksumInterval > 0.0f && FPlatformTime::Seconds() - LastChecksumTime >=
+		ChecksumInterval)
+	{
+		LastChecksumTime = FPlatformTime::Seconds();
+		FReplayIntegrity::UpdateChecksums(BroadcastState.ReplayName);
+	}
+}
+
+void UReplayStateSubsystem::DrainQueuedEvents()
+{
+	FReplayEventQueue& EventQueue = FReplayEventQueue::Get();
+	UDemoNetDriver* DemoDriver = PlaybackState.bIsRecording ? CachedDemoDriver.Get() : nullptr;
+	const TSharedPtr<INetworkReplayStreamer> Streamer = DemoDriver ? DemoDriver->GetReplayStreamer() : nullptr;
+
+	if (!Streamer.IsValid())
+	{
+		if (bOwnsEventQueue)
+		{
+			EventQueue.StopRecording();
+			bOwnsEventQueue = false;
+		}
+		return;
+	}
+
+	const uint32 TimeInMS = DemoDriver->GetDemoCurrentTimeInMS();
+
+	if (!bOwnsEventQueue)
+	{
+		// Only one recording at a time can take events from other threads
+		if (EventQueue.IsRecording())
+		{
+			return;
+		}
+
+		EventQueue.StartRecording(TimeInMS);
+		bOwnsEventQueue = true;
+	}
+
+	EventQueue.Drain(*Streamer);
+	EventQueue.SetRecordingTime(TimeInMS);
+}
+
+TStatId UReplayStateSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UReplayStateSubsystem, STATGROUP_Tickables);
+}
+
+UReplayStateSubsystem* UReplayStateSubsystem::Get(const UObject* WorldContextObject)
+{
+	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
+	{
+		return World->GetSubsystem<UReplayStateSubsystem>();
+	}
+
+	return nullptr;
+}
+
+void UReplayStateSubsystem::RefreshPlaybackState()
+{
+	const UWorld* World = GetWorld();
+
+	if (!World)
+	{
+		return;
+	}
+
+	CachedDemoDriver = World->GetDemoNetDriver();
+
+	if (!CachedDemoDriver.IsValid())
+	{
+		// Instant replays hang the demo driver off the duplicated collection
+		if (const FLevelCollection* DuplicateCollection = World->FindCollectionByType(
+			ELevelCollectionType::DynamicDuplicatedLevels))
+		{
+			CachedDemoDriver = DuplicateCollection->GetDemoNetDriver();
+		}
+	}
+
+	FReplayPlaybackState NewState;
+
+	if (const UDemoNetDriver* DemoDriver = CachedDemoDriver.Get())
+	{
+		NewState.bIsRecording = DemoDriver->IsRecording();
+		NewState.bIsPlaying = DemoDriver->IsPlaying();
+		NewState.CurrentTime = DemoDriver->GetDemoCurrentTime();
+		NewState.ReplayName = DemoDriver->GetActiveReplayName();
+
+		if (NewState.bIsRecording)
+		{
+			NewState.Length = DemoDriver->AccumulatedRecordTime;
+		}
+		else if (NewState.bIsPlaying)
+		{
+			NewState.Length = DemoDriver->GetDemoTotalTime();
+		}
+	}
+
+	NewState.TimelineTime = NewState.CurrentTime;
+	NewState.TimelineLength = NewState.Length;
+
+	// Segments play one at a time, the getters report the time on the whole timeline
+	const UGameInstance* GI = World->GetGameInstance();
+	const UReplaySegmentSubsystem* SegmentSubsystem = GI ? GI->GetSubsystem<UReplaySegmentSubsystem>() : nullptr;
+
+	if (SegmentSubsystem && SegmentSubsystem->IsPlaying())
+	{
+		NewState.TimelineTime += SegmentSubsystem->GetPlaybackTimeOffset();
+		NewState.TimelineLength = SegmentSubsystem->GetManifest().GetLength();
+	}
+
+	if (const AWorldSettings* WorldSettings = World->GetWorldSettings())
+	{
+		NewState.PlaybackSpeed = WorldSettings->DemoPlayTimeDilation;
+		NewState.bIsPaused = NewState.bIsPlaying && WorldSettings->GetPauserPlayerState() != nullptr;
+	}
+
+	PlaybackState = NewState;
+}
+
+void UReplayStateSubsystem::NotifySeekStarted(float TargetTime)
+{
+	bReachedEnd = false;
+
+	if (UReplayMetricsSubsystem* MetricsSubsystem = UReplayMetricsSubsystem::Get(this))
+	{
+		MetricsSubsystem->NotifySeekStarted();
+	}
+
+	OnSeekStarted.Broadcast(TargetTime);
+}
+
+void UReplayStateSubsystem::NotifySeekFinished(bool bWasSuccessful)
+{
+	if (UReplayMetricsSubsystem* MetricsSubsystem = UReplayMetricsSubsystem::Get(this))
+	{
+		MetricsSubsystem->NotifySeekFinished(bWasSuccessful);
+	}
+
+	RefreshPlaybackState();
+	OnSeekFinished.Broadcast(bWasSuccessful, PlaybackState.CurrentTime);
+}
+
+void UReplayStateSubsystem::BroadcastStateChanges()
+{
+	// Copy first so listeners that change the playback state do not affect what is compared below
+	const FReplayPlaybackState OldState = BroadcastState;
+	const FReplayPlaybackState NewState = PlaybackState;
+	BroadcastState = NewState;
+
+	if (OldState.bIsRecording && (!NewState.bIsRecording || OldState.ReplayName != NewState.ReplayName))
+	{
+		FReplayIntegrity::SetRecording(OldState.ReplayName, false);
+		SetCrashSafeStreaming(false);
+		SetCheckpointBudget(false);
+
+		// The streamer finishes writing the replay in the background, checksum it once it is done
+		FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([ReplayName = OldState.ReplayName](float)
+		{
+			FReplayIntegrity::UpdateChecksums(ReplayName);
+			return false;
+		}), 2.0f);
+
+		OnRecordingStopped.Broadcast(OldState.ReplayName);
+	}
+
+	if (NewState.bIsRecording && (!OldState.bIsRecording || OldState.ReplayName != NewState.ReplayName))
+	{
+		FReplayIntegrity::SetRecording(NewState.ReplayName, true);
+		LastChecksumTime = FPlatformTime::Seconds();
+		SetCrashSafeStreaming(GetCrashSafeFlushInterval() > 0.0f);
+		SetCheckpointBudget(CVarReplayCheckpointSaveBudget.GetValueOnGameThread() > 0.0f);
+
+		OnRecordingStarted.Broadcast(NewState.ReplayName);
+	}
+
+	if (!NewState.bIsPlaying)
+	{
+		bReachedEnd = false;
+		return;
+	}
+
+	if (!OldState.bIsPlaying || OldState.ReplayName != NewState.ReplayName)
+	{
+		bReachedEnd = false;
+		SeekToClipStart(NewState.ReplayName);
+		OnPlaybackStarted.Broadcast(NewState.ReplayName);
+	}
+
+	if (NewState.bIsPaused != OldState.bIsPaused)
+	{
+		if (NewState.bIsPaused)
+		{
+			OnPlaybackPaused.Broadcast();
+		}
+		else
+		{
+			OnPlaybackResumed.Broadcast();
+		}
+	}
+
+	if (NewState.PlaybackSpeed != OldState.PlaybackSpeed)
+	{
+		OnPlaybackSpeedChanged.Broadcast(NewState.PlaybackSpeed);
+	}
+}
+
+void UReplayStateSubsystem::SetCrashSafeStreaming(bool bEnable)
+{
+	if (bEnable == bCrashSafeStreaming)
+	{
+		return;
+	}
+
+	// The local file streamer writes the stream data it buffered and the header every time this delay passes
+	IConsoleVariable* ChunkUploadDelay = IConsoleManager::Get().FindConsoleVariable(
+		TEXT("localReplay.ChunkUploadDelayInSeconds"));
+
+	if (!ChunkUploadDelay)
+	{
+		return;
+	}
+
+	if (bEnable)
+	{
+		if (ReplayState::NumCrashSafeRecordings++ == 0)
+		{
+			ReplayState::SavedChunkUploadDelay = ChunkUploadDelay->GetFloat();
+		}
+		ChunkUploadDelay->Set(FMath::Min(ReplayState::SavedChunkUploadDelay, GetCrashSafeFlushInterval()),
+		                      ECVF_SetByCode);
+	}
+	else if (--ReplayState::NumCrashSafeRecordings == 0)
+	{
+		ChunkUploadDelay->Set(ReplayState::SavedChunkUploadDelay, ECVF_SetByCode);
+	}
+
+	bCrashSafeStreaming = bEnable;
+}
+
+void UReplayStateSubsystem::SetCheckpointBudget(bool bEnable)
+{
+	if (bEnable == bCheckpointBudget)
+	{
+		return;
+	}
+
+	// Overrides the demo driver's CheckpointSaveMaxMSPerFrame when not negative
+	IConsoleVariable* MaxMSPerFrame = IConsoleManager::Get().FindConsoleVariable(
+		TEXT("demo.CheckpointSaveMaxMSPerFrameOverride"));
+
+	if (!MaxMSPerFrame)
+	{
+		return;
+	}
+
+	if (bEnable)
+	{
+		if (ReplayState::NumBudgetedRecordings == 0)
+		{
+			// A limit set with a higher priority would silently ignore ours, and one a project tuned is theirs to keep
+			const uint32 SetBy = MaxMSPerFrame->GetFlags() & ECVF_SetByMask;
+			const bool bRestoredByUs = ReplayState::bRestoredCheckpointBudget && SetBy == ECVF_SetByCode &&
+				MaxMSPerFrame->GetFloat() == ReplayState::SavedCheckpointBudget;
+
+			if (SetBy != ECVF_SetByConstructor && !bRestoredByUs)
+			{
+				UE_LOG(LogReplaySystem, Log,
+				       TEXT("ReplaySystem.CheckpointSaveBudgetMS is not applied, demo.CheckpointSaveMaxMSPerFrameOverride "
+					       "is already set to %g"), MaxMSPerFrame->GetFloat());
+				return;
+			}
+
+			ReplayState::SavedCheckpointBudget = MaxMSPerFrame->GetFloat();
+		}
+
+		++ReplayState::NumBudgetedRecordings;
+		MaxMSPerFrame->Set(CVarReplayCheckpointSaveBudget.GetValueOnGameThread(), ECVF_SetByCode);
+	}
+	else if (--ReplayState::NumBudgetedRecordings == 0)
+	{
+		MaxMSPerFrame->Set(ReplayState::SavedCheckpointBudget, ECVF_SetByCode);
+		ReplayState::bRestoredCheckpointBudget = true;
+	}
+
+	bCheckpointBudget = bEnable;
+}
+
+void UReplayStateSubsystem::HandlePostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	const UDemoNetDriver* DemoDriver = CachedDemoDriver.Get();
+
+	FrameStartTime = InWorld == GetWorld() && DemoDriver && DemoDriver->IsRecording() ? FPlatformTime::Seconds() : 0.0;
+}
+
+void UReplayStateSubsystem::HandlePostTickFlush()
+{
+	const UDemoNetDriver* DemoDriver = CachedDemoDriver.Get();
+
+	if (FrameStartTime <= 0.0 || !DemoDriver || !DemoDriver->IsRecording())
+	{
+		FrameStartTime = 0.0;
+		BaselineFrameMS = -1.0f;
+		LastCheckpointTime = -1.0;
+		bWasSavingCheckpoint = false;
+		CheckpointGameThreadMS = CheckpointMaxFrameMS = 0.0f;
+		CheckpointFrames = 0;
+		return;
+	}
+
+	const float FrameMS = (FPlatformTime::Seconds() - FrameStartTime) * 1000.0;
+	FrameStartTime = 0.0;
+
+	// A checkpoint that fits in the budget starts and finishes within one flush, only its time changes
+	const bool bSaving = DemoDriver->IsSavingCheckpoint();
+	const double CheckpointTime = DemoDriver->GetLastCheckpointTime();
+	const bool bStarted = LastCheckpointTime >= 0.0 && CheckpointTime != LastCheckpointTime;
+	LastCheckpointTime = CheckpointTime;
+
+	if (!bSaving && !bWasSavingCheckpoint && !bStarted)
+	{
+		BaselineFrameMS = BaselineFrameMS < 0.0f ? FrameMS : FMath::Lerp(BaselineFrameMS, FrameMS, 0.05f);
+		return;
+	}
+
+	bWasSavingCheckpoint = bSaving;
+
+	// The rest of the flush (replicating to clients, recording the stream) is paid every frame, only the excess counts
+	const float CostMS = FMath::Max(FrameMS - FMath::Max(BaselineFrameMS, 0.0f), 0.0f);
+	CheckpointGameThreadMS += CostMS;
+	CheckpointMaxFrameMS = FMath::Max(CheckpointMaxFrameMS, CostMS);
+	++CheckpointFrames;
+
+	if (bSaving)
+	{
+		return;
+	}
+
+	if (UReplayMetricsSubsystem* MetricsSubsystem = UReplayMetricsSubsystem::Get(this))
+	{
+		MetricsSubsystem->NotifyCheckpointSaved(CheckpointGameThreadMS, CheckpointMaxFrameMS, CheckpointFrames);
+	}
+
+	OnCheckpointSaved.Broadcast(CheckpointGameThreadMS, CheckpointFrames);
+
+	CheckpointGameThreadMS = CheckpointMaxFrameMS = 0.0f;
+	CheckpointFrames = 0;
+}
+
+void UReplayStateSubsystem::SeekToClipStart(const FString& ReplayName)
+{
+	TWeakObjectPtr<UReplayStateSubsystem> WeakThis(this);
+
+	Async(EAsyncExecution::ThreadPool, [WeakThis, ReplayName]()
+	{
+		float StartTime = 0.0f;
+		float EndTime = 0.0f;
+		if (!FReplayClip::GetClipRange(ReplayName, StartTime, EndTime) || StartTime <= 0.0f)
+		{
+			return;
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, ReplayName, StartTime]()
+		{
+			UReplayStateSubsystem* This = WeakThis.Get();
+			UDemoNetDriver* DemoDriver = This ? This->GetDemoDriver() : nullptr;
+
+			// Only if the clip is still the replay playing and nothing moved it yet
+			if (!DemoDriver || !This->PlaybackState.bIsPlaying || This->PlaybackState.ReplayName != ReplayName ||
+				DemoDriver->GetDemoCurrentTime() >= StartTime)
+			{
+				return;
+			}
+
+			This->NotifySeekStarted(StartTime);
+			DemoDriver->GotoTimeInSeconds(StartTime, FOnGotoTimeDelegate::CreateWeakLambda(
+				                              This, [This](bool bWasSuccessful)
+				                              {
+					                              This->NotifySeekFinished(bWasSuccessful);
+				                              }));
+		});
+	});
+}
+
+void UReplayStateSubsystem::HandleReplayPlaybackComplete(UWorld* InWorld)
+{
+	if (InWorld != GetWorld() || bReachedEnd)
+	{
+		return;
+	}
+
+	bReachedEnd = true;
+	RefreshPlaybackState();
+	OnReplayComplete.Broadcast();
+}
+
+void UReplayStateSubsystem::HandleReplayRecordingComplete(UWorld* InWorld)
+{
+	if (InWorld != GetWorld())
+	{
+		return;
+	}
+
+	OnRecordingStopping.Broadcast();
+}
+
+bool UReplayStateSubsystem::CanPlayInstantReplay() const
+{
+	const UWorld* World = GetWorld();
+	return World && World->FindCollectionByType(ELevelCollectionType::DynamicDuplicatedLevels) != nullptr;
+}
+
+bool UReplayStateSubsystem::PlayInstantReplay(const FString& ReplayName, bool bHideLiveLevels)
+{
+	UWorld* World = GetWorld();
+
+	if (!CanPlayInstantReplay())
+	{
+		UE_LOG(LogReplaySystem, Warning,
+		       TEXT("Cannot play instant replay %s, the levels of this map were not duplicated (see UReplayGameEngine)"),
+		       *ReplayName);
+		return false;
+	}
+
+	UGameInstance* GI = World->GetGameInstance();
+
+	if (!GI)
+	{
+		return false;
+	}
+
+	if (!bIsPlayingInstantReplay)
+	{
+		LivePlayerController = World->GetFirstPlayerController();
+	}
+
+	if (FLevelCollection* SourceCollection = World->FindCollectionByType(ELevelCollectionType::DynamicSourceLevels))
+	{
+		SourceCollection->SetIsVisible(!bHideLiveLevels);
+	}
+
+	if (FLevelCollection* DuplicateCollection = World->FindCollectionByType(
+		ELevelCollectionType::DynamicDuplicatedLevels))
+	{
+		DuplicateCollection->SetIsVisible(true);
+	}
+
+	const TArray<FString> Options;
+
+	// Passing our world keeps the demo driver here, with duplicated levels present it plays into them instead of travelling
+	bIsPlayingInstantReplay = GI->PlayReplay(ReplayName, World, Options);
+
+	if (!bIsPlayingInstantReplay)
+	{
+		StopInstantReplay();
+		return false;
+	}
+
+	RefreshPlaybackState();
+	return true;
+}
+
+void UReplayStateSubsystem::StopInstantReplay()
+{
+	UWorld* World = GetWorld();
+
+	if (!World)
+	{
+		return;
+	}
+
+	FLevelCollection* DuplicateCollection = World->FindCollectionByType(ELevelCollectionType::DynamicDuplicatedLevels);
+
+	if (bIsPlayingInstantReplay)
+	{
+		// The duplicated collection holds the instant replay's driver on its own and keeps ticking it, stop that one
+		// too when it is not the world's
+		UDemoNetDriver* CollectionDriver = DuplicateCollection ? DuplicateCollection->GetDemoNetDriver() : nullptr;
+
+		if (CollectionDriver && CollectionDriver != World->GetDemoNetDriver())
+		{
+			const FName DriverName = CollectionDriver->NetDriverName;
+			CollectionDriver->StopDemo();
+			CollectionDriver->SetWorld(nullptr);
+			GEngine->DestroyNamedNetDriver(World, DriverName);
+		}
+
+		World->DestroyDemoNetDriver();
+		bIsPlayingInstantReplay = false;
+	}
+
+	if (DuplicateCollection)
+	{
+		DuplicateCollection->SetDemoNetDriver(nullptr);
+		DuplicateCollection->SetIsVisible(false);
+	}
+
+	if (FLevelCollection* SourceCollection = World->FindCollectionByType(ELevelCollectionType::DynamicSourceLevels))
+	{
+		SourceCollection->SetIsVisible(true);
+	}
+
+	// The replay spectator took over the local player, give it back to the live controller
+	if (APlayerController* LivePC = LivePlayerController.Get())
+	{
+		if (ULocalPlayer* LocalPlayer = World->GetFirstLocalPlayerFromController())
+		{
+			if (LocalPlayer->PlayerController != LivePC)
+			{
+				LivePC->SetPlayer(LocalPlayer);
+			}
+		}
+	}
+
+	LivePlayerController.Reset();
+
+	RefreshPlaybackState();
+}
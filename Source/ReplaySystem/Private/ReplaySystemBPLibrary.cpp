@@ -1,671 +1,1246 @@
-﻿// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
-
-#include "ReplaySystemBPLibrary.h"
-
-#include "EngineUtils.h"
-#include "Engine/World.h"
-#include "GameFramework/WorldSettings.h"
-#include "Engine/DemoNetDriver.h"
-#include "NetworkReplayStreaming.h"
-#include "Engine/GameInstance.h"
-#include "Engine/Engine.h"
-#include "ReplayPlayerController.h"
-#include "Containers/UnrealString.h"
-#include "GameFramework/CharacterMovementComponent.h"
-#include "Kismet/GameplayStatics.h"
-#include "Kismet/KismetMathLibrary.h"
-#include "GameFramework/Pawn.h"
-#include "Serialization/MemoryReader.h"
-
-
-UReplaySystemBPLibrary::UReplaySystemBPLibrary(const FObjectInitializer& ObjectInitializer)
-	: Super(ObjectInitializer)
-{
-}
-
-void UReplaySystemBPLibrary::SetReplaySavePath(const FString& Path)
-{
-	if (const TSharedPtr<INetworkReplayStreamer> EnumerateStreamsPtr = FNetworkReplayStreaming::Get().GetFactory().
-			CreateReplayStreamer())
-	{
-		EnumerateStreamsPtr->SetDemoPath(Path);
-	}
-}
-
-FString UReplaySystemBPLibrary::GetReplaySavePath()
-{
-	FString Path = "";
-	if (const TSharedPtr<INetworkReplayStreamer> EnumerateStreamsPtr = FNetworkReplayStreaming::Get().GetFactory().
-			CreateReplayStreamer())
-	{
-		EnumerateStreamsPtr->GetDemoPath(Path);
-	}
-	return Path;
-}
-
-void UReplaySystemBPLibrary::RecordReplay(UObject* WorldContextObject, const FString& ReplayName,
-                                          const FString& ReplayFriendlyName)
-{
-	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
-	{
-		if (UGameInstance* GI = Cast<UGameInstance>(World->GetGameInstance()))
-		{
-			const TArray<FString> Options;
-
-			GI->StartRecordingReplay(ReplayName, ReplayFriendlyName, Options);
-		}
-	}
-}
-
-void UReplaySystemBPLibrary::StopRecordingReplay(UObject* WorldContextObject)
-{
-	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
-	{
-		if (IsRecordingReplay(WorldContextObject))
-		{
-			if (UGameInstance* GI = Cast<UGameInstance>(World->GetGameInstance()))
-			{
-				GI->StopRecordingReplay();
-			}
-		}
-	}
-}
-
-bool UReplaySystemBPLibrary::IsRecordingReplay(UObject* WorldContextObject)
-{
-	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
-	{
-		if (World != nullptr && GetDemoDriver(World) != nullptr)
-		{
-			return GetDemoDriver(World)->IsRecording();
-		}
-	}
-	return false;
-}
-
-void UReplaySystemBPLibrary::DeleteReplay(const FString& ReplayName,
-                                          FOnDeleteReplayComplete OnDeleteComplete)
-{
-	const auto EnumerateStreamsPtr = FNetworkReplayStreaming::Get().GetFactory().CreateReplayStreamer();
-
-	const auto OnDeleteCompleteDel = FDeleteFinishedStreamCallback::CreateLambda(
-		[OnDeleteComplete](const FDeleteFinishedStreamResult& Result)
-		{
-			OnDeleteComplete.Execute(Result.WasSuccessful());
-		});
-
-	if (EnumerateStreamsPtr.Get())
-	{
-		EnumerateStreamsPtr.Get()->DeleteFinishedStream(ReplayName, OnDeleteCompleteDel);
-	}
-}
-
-void UReplaySystemBPLibrary::RenameReplay(const FString& ReplayName,
-                                          const FString& NewReplayName, const int32 UserIndex,
-                                          FOnRenameReplayComplete OnRenameComplete)
-{
-	const auto EnumerateStreamsPtr = FNetworkReplayStreaming::Get().GetFactory().CreateReplayStreamer();
-
-	const auto Delegate = FRenameReplayCallback::CreateLambda(
-		[OnRenameComplete](const FRenameReplayResult& Result)
-		{
-			OnRenameComplete.Execute(Result.WasSuccessful());
-		});
-
-	if (EnumerateStreamsPtr.Get())
-	{
-		EnumerateStreamsPtr.Get()->RenameReplay(ReplayName, NewReplayName, UserIndex, Delegate);
-	}
-}
-
-void UReplaySystemBPLibrary::RenameReplayFriendly(
-                                                  const FString& ReplayName,
-                                                  const FString& NewFriendlyReplayName,
-                                                  const int32 UserIndex, FOnRenameReplayComplete OnRenameComplete)
-{
-	const auto EnumerateStreamsPtr = FNetworkReplayStreaming::Get().GetFactory().CreateReplayStreamer();
-
-	const auto Delegate = FRenameReplayCallback::CreateLambda([OnRenameComplete](const FRenameReplayResult& Result)
-	{
-		OnRenameComplete.Execute(Result.WasSuccessful());
-	});
-
-	if (EnumerateStreamsPtr.Get())
-	{
-		EnumerateStreamsPtr.Get()->RenameReplayFriendlyName(ReplayName, NewFriendlyReplayName, UserIndex, Delegate);
-	}
-}
-
-void UReplaySystemBPLibrary::GetSavedReplays(FOnGetReplaysComplete OnGetReplaysComplete)
-{
-	const auto EnumerateStreamsPtr = FNetworkReplayStreaming::Get().GetFactory().CreateReplayStreamer();
-
-	const auto Delegate = FEnumerateStreamsCallback::CreateLambda(
-		[OnGetReplaysComplete](const FEnumerateStreamsResult& Result)
-		{
-			TArray<FReplayInfo> Replays;
-
-			TArray<FNetworkReplayStreamInfo> StreamInfos = Result.FoundStreams;
-
-			for (FNetworkReplayStreamInfo StreamInfo : StreamInfos)
-			{
-				FReplayInfo ReplayInfo;
-				ReplayInfo.FriendlyName = StreamInfo.FriendlyName;
-				ReplayInfo.ActualName = StreamInfo.Name;
-				ReplayInfo.RecordDate = StreamInfo.Timestamp;
-				ReplayInfo.LengthInMS = StreamInfo.LengthInMS;
-				const float SizeInKb = StreamInfo.SizeInBytes / 1024.0f;
-				ReplayInfo.SizeInMb = SizeInKb / 1024.0f;
-				
-				Replays.Add(ReplayInfo);
-			}
-
-			OnGetReplaysComplete.Execute(Replays);
-		});
-
-	if (EnumerateStreamsPtr.Get())
-	{
-		EnumerateStreamsPtr.Get()->EnumerateStreams(FNetworkReplayVersion(), INDEX_NONE, FString(),
-													TArray<FString>(), Delegate);
-	}
-}
-
-bool UReplaySystemBPLibrary::PlayRecordedReplay(UObject* WorldContextObject, const FString& ReplayName)
-{
-	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
-	{
-		if (UGameInstance* GI = Cast<UGameInstance>(World->GetGameInstance()))
-		{
-			const TArray<FString> Options;
-
-			return GI->PlayReplay(ReplayName, nullptr, Options);
-		}
-	}
-
-	return false;
-}
-
-void UReplaySystemBPLibrary::RestartReplayPlayback(UObject* WorldContextObject, FOnGotoTimeComplete OnComplete)
-{
-	GoToSpecificTime(WorldContextObject,0.0f,false,OnComplete);
-}
-
-void UReplaySystemBPLibrary::GoToSpecificTime(UObject* WorldContextObject, float TimeToGoTo,
-                                              bool bRetainCurrentPauseState, FOnGotoTimeComplete OnComplete)
-{
-	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
-	{
-		if (const AWorldSettings* WorldSettings = World->GetWorldSettings())
-		{
-			// clamp time just in case
-			const float ClampedTime = UKismetMathLibrary::FClamp(TimeToGoTo, 0.0f,GetReplayLength(
-				                                                     WorldContextObject));
-
-			if (UDemoNetDriver* DemoDriver = GetDemoDriver(World))
-			{
-				if (DemoDriver->ServerConnection->PlayerController->PlayerState)
-				{
-					bool bPauseStateBeforeMove = false;
-					
-					if (const AReplayPlayerController* ReplayPC = Cast<AReplayPlayerController>(
-						DemoDriver->ServerConnection->PlayerController))
-					{
-						if (ReplayPC->bIsSpectating)
-						{
-							if (const AActor* ActorBeingSpectated = Cast<AActor>(ReplayPC->GetViewTarget()))
-							{
-								const FNetworkGUID ActorBeingSpectatedGUID = DemoDriver->GetGUIDForActor(
-									ActorBeingSpectated);
-								DemoDriver->AddNonQueuedGUIDForScrubbing(ActorBeingSpectatedGUID);
-							}
-						}
-
-						if (const AActor* ActorPossessed = Cast<AActor>(ReplayPC->GetPawn()))
-						{
-							const FNetworkGUID SpectatorPawnGUID = DemoDriver->GetGUIDForActor(ActorPossessed);
-							DemoDriver->AddNonQueuedGUIDForScrubbing(SpectatorPawnGUID);
-						}
-					}
-					else
-					{
-						if (const APlayerController* PC = Cast<APlayerController>(
-							DemoDriver->ServerConnection->PlayerController))
-						{
-							if (const AActor* ActorPossessed = Cast<AActor>(PC->GetPawn()))
-							{
-								const FNetworkGUID SpectatorPawnGUID = DemoDriver->GetGUIDForActor(ActorPossessed);
-								DemoDriver->AddNonQueuedGUIDForScrubbing(SpectatorPawnGUID);
-							}
-						}
-					}
-
-					for (FActorIterator It(World->GetWorld()); It; ++It)
-					{
-						if (It->bAlwaysRelevant)
-						{
-							const FNetworkGUID ActorGUID = DemoDriver->GetGUIDForActor(*It);
-							DemoDriver->AddNonQueuedGUIDForScrubbing(ActorGUID);
-						}
-					}
-
-
-					if (WorldSettings->GetPauserPlayerState())
-					{
-						bPauseStateBeforeMove = true;
-					}
-
-					const auto OnGoToTimeDelegate = FOnGotoTimeDelegate::CreateLambda(
-						[OnComplete,bRetainCurrentPauseState,bPauseStateBeforeMove,World,WorldContextObject](bool bWasSuccessful)
-						{
-							OnComplete.Execute(bWasSuccessful);
-
-							if (bRetainCurrentPauseState && !bPauseStateBeforeMove == false)
-							{
-								PausePlayback(WorldContextObject);
-							}
-
-							if (AReplayPlayerController* ReplayPC = Cast<AReplayPlayerController>(
-								UGameplayStatics::GetPlayerController(World, 0)))
-							{
-								ReplayPC->OnGoToTime(GetCurrentReplayTime(WorldContextObject));
-								ReplayPC->OnStopSpectateActor();
-							}
-						});
-
-					DemoDriver->GotoTimeInSeconds(ClampedTime, OnGoToTimeDelegate);
-				}
-			}
-		}
-	}
-}
-
-void UReplaySystemBPLibrary::PausePlayback(UObject* WorldContextObject)
-{
-	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
-	{
-		if (AWorldSettings* WorldSettings = World->GetWorldSettings())
-		{
-			if (const UDemoNetDriver* DemoDriver = GetDemoDriver(World))
-			{
-				if (DemoDriver->ServerConnection->PlayerController->PlayerState)
-				{
-					World->bIsCameraMoveableWhenPaused = true;
-					WorldSettings->SetPauserPlayerState(DemoDriver->ServerConnection->PlayerController->PlayerState);
-					if (AReplayPlayerController* ReplayPC = Cast<AReplayPlayerController>(
-						UGameplayStatics::GetPlayerController(World, 0)))
-					{
-						ReplayPC->OnTogglePause(true);
-					}
-				}
-			}
-		}
-	}
-}
-
-void UReplaySystemBPLibrary::ResumePlayback(UObject* WorldContextObject)
-{
-	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
-	{
-		if (AWorldSettings* WorldSettings = World->GetWorldSettings())
-		{
-			WorldSettings->SetPauserPlayerState(nullptr);
-			if (AReplayPlayerController* ReplayPC = Cast<AReplayPlayerController>(
-				UGameplayStatics::GetPlayerController(World, 0)))
-			{
-				ReplayPC->OnTogglePause(false);
-			}
-		}
-	}
-}
-
-void UReplaySystemBPLibrary::SetPlaybackSpeed(UObject* WorldContextObject, float Speed)
-{
-	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
-	{
-		if (AWorldSettings* WorldSettings = World->GetWorldSettings())
-		{
-			WorldSettings->DemoPlayTimeDilation = Speed;
-		}
-	}
-}
-
-float UReplaySystemBPLibrary::GetPlaybackSpeed(UObject* WorldContextObject)
-{
-	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
-	{
-		if (const AWorldSettings* WorldSettings = World->GetWorldSettings())
-		{
-			return WorldSettings->DemoPlayTimeDilation;
-		}
-	}
-	return 1.0f;
-}
-
-float UReplaySystemBPLibrary::GetCurrentReplayTime(UObject* WorldContextObject)
-{
-	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
-	{
-		if (const UDemoNetDriver* DemoDriver = GetDemoDriver(World))
-		{
-			return DemoDriver->GetDemoCurrentTime();
-		}
-		else
-		{
-			return 0.0f;
-		}
-	}
-	return 0.0f;
-}
-
-float UReplaySystemBPLibrary::GetReplayLength(UObject* WorldContextObject)
-{
-	if (auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
-	{
-		if (const UDemoNetDriver* DemoDriver = GetDemoDriver(World))
-		{
-			if (IsRecordingReplay(WorldContextObject))
-			{
-				return DemoDriver->AccumulatedRecordTime;
-			}
-
-			if (IsPlayingReplay(WorldContextObject))
-			{
-				return DemoDriver->GetDemoTotalTime();
-			}
-		}
-	}
-	return 0.0f;
-}
-
-bool UReplaySystemBPLibrary::IsPlayingReplay(UObject* WorldContextObject)
-{
-	if (auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
-	{
-		if (const UDemoNetDriver* DemoDriver = GetDemoDriver(World))
-		{
-			return DemoDriver->IsPlaying();
-		}
-	}
-	return false;
-}
-
-bool UReplaySystemBPLibrary::IsReplayPlaybackPaused(UObject* WorldContextObject)
-{
-	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
-	{
-		if (IsPlayingReplay(WorldContextObject))
-		{
-			if (const AWorldSettings* WorldSettings = World->GetWorldSettings())
-			{
-				return WorldSettings->GetPauserPlayerState() != nullptr;
-			}
-		}
-	}
-	return false;
-}
-
-FString UReplaySystemBPLibrary::GetActiveReplayName(UObject* WorldContextObject)
-{
-	if (auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
-	{
-		if (World != nullptr && GetDemoDriver(World) != nullptr)
-		{
-			return GetDemoDriver(World)->GetActiveReplayName();
-		}
-	}
-	return "None";
-}
-
-bool UReplaySystemBPLibrary::AddEventToActiveReplay(UObject* WorldContextObject, const FString& EventId,
-                                                    const FString& Group, FString Metadata, TArray<uint8> Data)
-{
-	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
-	{
-		if (IsRecordingReplay(WorldContextObject))
-		{
-			if (World != nullptr && GetDemoDriver(World) != nullptr)
-			{
-				GetDemoDriver(World)->AddOrUpdateEvent(EventId, Group, Metadata, Data);
-
-				return true;
-			}
-		}
-	}
-	return false;
-}
-
-void UReplaySystemBPLibrary::GetActiveReplayEvents(UObject* WorldContextObject, FString Group,
-                                                       int UserIndex, FOnRequestEventsComplete OnRequestEventsComplete)
-{
-	if (!IsRecordingReplay(WorldContextObject) && IsPlayingReplay(WorldContextObject))
-	{
-		const TSharedPtr<INetworkReplayStreamer> EnumerateStreamsPtr = FNetworkReplayStreaming::Get().GetFactory().
-			CreateReplayStreamer();
-
-
-		const auto EnumerateEventsDel = FEnumerateEventsCallback::CreateLambda(
-			[OnRequestEventsComplete](const FEnumerateEventsResult& Results)
-			{
-				TArray<FReplayEvent> ReplayEvents;
-				if (Results.WasSuccessful())
-				{
-					for (FReplayEventListItem EventItem : Results.ReplayEventList.ReplayEvents)
-					{
-						FReplayEvent ReplayEventTemp;
-						ReplayEventTemp.EventID = EventItem.ID;
-
-						ReplayEventTemp.Group = EventItem.Group;
-						ReplayEventTemp.TimeInMs = static_cast<int32>(EventItem.Time1);
-						ReplayEventTemp.Metadata = EventItem.Metadata;
-
-						ReplayEvents.Add(ReplayEventTemp);
-					}
-				}
-				OnRequestEventsComplete.Execute(ReplayEvents);
-			});
-
-		if (EnumerateStreamsPtr.Get())
-		{
-			EnumerateStreamsPtr.Get()->EnumerateEvents(GetActiveReplayName(WorldContextObject), Group, UserIndex,
-													   EnumerateEventsDel);
-		}
-	}
-}
-
-void UReplaySystemBPLibrary::GetDataForEvent(FString ReplayActualName, FString EventId,
-                                             int UserIndex, FOnGetEventDataComplete OnGetEventDataComplete)
-{
-	const TSharedPtr<INetworkReplayStreamer> EnumerateStreamsPtr = FNetworkReplayStreaming::Get().GetFactory().
-			CreateReplayStreamer();
-
-
-	const auto RequestEventsDataDel = FRequestEventDataCallback::CreateLambda(
-		[OnGetEventDataComplete](const FRequestEventDataResult& Result)
-		{
-			TArray<uint8> Data;
-			if (Result.WasSuccessful())
-			{
-				Data = Result.ReplayEventListItem;
-			}
-			OnGetEventDataComplete.Execute(Data);
-		});
-
-	if (EnumerateStreamsPtr.Get())
-	{
-		EnumerateStreamsPtr.Get()->RequestEventData(ReplayActualName, EventId, UserIndex, RequestEventsDataDel);
-	}
-}
-
-void UReplaySystemBPLibrary::GetEvents(FString ReplayActualName, FString Group, int UserIndex,
-	FOnRequestEventsComplete OnRequestEventsComplete)
-{
-	const TSharedPtr<INetworkReplayStreamer> EnumerateStreamsPtr = FNetworkReplayStreaming::Get().GetFactory().
-		CreateReplayStreamer();
-
-	const auto EnumerateEventsDel = FEnumerateEventsCallback::CreateLambda(
-		[OnRequestEventsComplete](const FEnumerateEventsResult& Results)
-		{
-			TArray<FReplayEvent> ReplayEvents;
-			if (Results.WasSuccessful())
-			{
-				for (FReplayEventListItem EventItem : Results.ReplayEventList.ReplayEvents)
-				{
-					FReplayEvent ReplayEventTemp;
-					ReplayEventTemp.EventID = EventItem.ID;
-
-					ReplayEventTemp.Group = EventItem.Group;
-					ReplayEventTemp.TimeInMs = static_cast<int32>(EventItem.Time1);
-					ReplayEventTemp.Metadata = EventItem.Metadata;
-					ReplayEvents.Add(ReplayEventTemp);
-				}
-			}
-
-			OnRequestEventsComplete.Execute(ReplayEvents);
-		});
-
-	if (EnumerateStreamsPtr.Get())
-	{
-		EnumerateStreamsPtr.Get()->EnumerateEvents(ReplayActualName, Group, UserIndex, EnumerateEventsDel);
-	}
-}
-
-float UReplaySystemBPLibrary::MsToSeconds(const int32 MS)
-{
-#if  ENGINE_MAJOR_VERSION <= 4
-	const float MsAsFloat = UKismetMathLibrary::Conv_IntToFloat(MS);
-#else
-	const float MsAsFloat = UKismetMathLibrary::Conv_IntToDouble(MS);
-#endif
-
-	const float MsAsSeconds = MsAsFloat / 1000;
-	return MsAsSeconds;
-}
-
-void UReplaySystemBPLibrary::SpectateActor(UObject* WorldContextObject, AActor* Actor, FBlendSettings BlendSettings)
-{
-	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
-	{
-		if (!Actor)
-		{
-			return;
-		}
-
-		if (UGameplayStatics::GetPlayerController(World, 0))
-		{
-			if (APlayerController* PC = UGameplayStatics::GetPlayerController(World, 0))
-			{
-				if (!PC->IsLocalController())
-				{
-					return;
-				}
-
-				//Everything from here is happening only locally/on the client
-				PC->SetViewTargetWithBlend(Actor, BlendSettings.BlendTime, BlendSettings.BlendFunction,
-				                           BlendSettings.BlendExponent, BlendSettings.bLockOutgoing);
-				if (AReplayPlayerController* ReplayPC = Cast<AReplayPlayerController>(
-					UGameplayStatics::GetPlayerController(World, 0)))
-				{
-					ReplayPC->OnSpectateActor(Actor);
-					ReplayPC->bIsSpectating = true;
-				}
-			}
-		}
-	}
-}
-
-void UReplaySystemBPLibrary::StopSpectating(UObject* WorldContextObject, FBlendSettings BlendSettings)
-{
-	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
-	{
-		if (UGameplayStatics::GetPlayerController(World, 0))
-		{
-			if (APlayerController* PC = UGameplayStatics::GetPlayerController(World, 0))
-			{
-				if (!PC->IsLocalController())
-				{
-					return;
-				}
-
-				//Everything from here is happening only locally/on the client
-
-				auto Target = PC->GetPawn();
-				PC->SetViewTargetWithBlend(Target, BlendSettings.BlendTime, BlendSettings.BlendFunction,
-				                           BlendSettings.BlendExponent, BlendSettings.bLockOutgoing);
-
-				if (AReplayPlayerController* ReplayPC = Cast<AReplayPlayerController>(
-					UGameplayStatics::GetPlayerController(World, 0)))
-				{
-					ReplayPC->OnStopSpectateActor();
-					ReplayPC->bIsSpectating = false;
-				}
-			}
-		}
-	}
-}
-
-UDemoNetDriver* UReplaySystemBPLibrary::GetDemoDriver(const UObject* WorldContextObject)
-{
-	if (auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
-	{
-#if  ENGINE_MAJOR_VERSION > 4
-		return World->GetDemoNetDriver();
-#elif ENGINE_MINOR_VERSION >= 26
-		return World->GetDemoNetDriver();
-#elif ENGINE_MINOR_VERSION < 26
-		return World->DemoNetDriver;
-#endif
-	}
-
-	return nullptr;
-}
-
-void UReplaySystemBPLibrary::SetMaxRecordHz(UObject* WorldContextObject, float Hz)
-{
-	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
-	{
-		if (UGameplayStatics::GetPlayerController(World, 0))
-		{
-#if  ENGINE_MAJOR_VERSION <= 4
-			FString Command = "demo.recordhz " + UKismetStringLibrary::Conv_FloatToString(Hz);
-#else
-			FString Command = "demo.recordhz " + FString::SanitizeFloat(Hz);
-#endif
-
-
-			UGameplayStatics::GetPlayerController(World, 0)->ConsoleCommand(Command);
-		}
-	}
-}
-
-
-float UReplaySystemBPLibrary::GetMaxRecordHz()
-{
-	static const auto CVar = IConsoleManager::Get().FindConsoleVariable(TEXT("demo.recordhz"));
-	const float value = CVar->GetFloat();
-	return value;
-}
-
-void UReplaySystemBPLibrary::SerializeStruct(UStruct* Struct, TArray<uint8>& Data)
-{
-}
-
-void UReplaySystemBPLibrary::DeSerializeStruct(TArray<uint8> Data, UStruct*& Struct)
-{
-}
-
-TArray<uint8> UReplaySystemBPLibrary::StringToBytes(FString Data)
-{
-	TArray<uint8> Result;
-	FMemoryWriter Ar(Result);
-	Ar << Data;
-	return Result;
-}
-
-FString UReplaySystemBPLibrary::BytesToString(TArray<uint8> Data)
-{
-	FString Result;
-	FMemoryReader Ar(Data);
-	Ar << Result;
-	return Result;
-}
-
+﻿// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplaySystemBPLibrary.h"
+
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "Engine/DemoNetDriver.h"
+#include "NetworkReplayStreaming.h"
+#include "Engine/GameInstance.h"
+#include "Engine/Engine.h"
+#include "ReplayPlayerController.h"
+#include "ReplayCacheSubsystem.h"
+#include "ReplayClip.h"
+#include "ReplayEventBatch.h"
+#include "ReplayEventIndexSubsystem.h"
+#include "ReplayGhostSubsystem.h"
+#include "ReplayIntegrity.h"
+#include "ReplayMemory.h"
+#include "ReplayMetricsSubsystem.h"
+#include "ReplayPrefetchSubsystem.h"
+#include "ReplaySegmentSubsystem.h"
+#include "ReplaySearchIndex.h"
+#include "ReplayStateSubsystem.h"
+#include "ReplayTrackSubsystem.h"
+#include "ReplayUploadSubsystem.h"
+#include "Containers/UnrealString.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "Kismet/KismetMathLibrary.h"
+#include "GameFramework/Pawn.h"
+#include "Serialization/MemoryReader.h"
+
+
+UReplaySystemBPLibrary::UReplaySystemBPLibrary(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+}
+
+void UReplaySystemBPLibrary::SetReplaySavePath(const FString& Path)
+{
+	if (const TSharedPtr<INetworkReplayStreamer> EnumerateStreamsPtr = FNetworkReplayStreaming::Get().GetFactory().
+			CreateReplayStreamer())
+	{
+		EnumerateStreamsPtr->SetDemoPath(Path);
+	}
+}
+
+FString UReplaySystemBPLibrary::GetReplaySavePath()
+{
+	FString Path = "";
+	if (const TSharedPtr<INetworkReplayStreamer> EnumerateStreamsPtr = FNetworkReplayStreaming::Get().GetFactory().
+			CreateReplayStreamer())
+	{
+		EnumerateStreamsPtr->GetDemoPath(Path);
+	}
+	return Path;
+}
+
+void UReplaySystemBPLibrary::RecordReplay(UObject* WorldContextObject, const FString& ReplayName,
+                                          const FString& ReplayFriendlyName)
+{
+	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
+	{
+		if (UGameInstance* GI = Cast<UGameInstance>(World->GetGameInstance()))
+		{
+			// The demo driver and its streamer are created here
+			LLM_SCOPE_BYTAG(ReplaySystem_Streaming);
+
+			const TArray<FString> Options;
+
+			GI->StartRecordingReplay(ReplayName, ReplayFriendlyName, Options);
+		}
+
+		if (UReplayStateSubsystem* StateSubsystem = World->GetSubsystem<UReplayStateSubsystem>())
+		{
+			StateSubsystem->RefreshPlaybackState();
+		}
+	}
+}
+
+void UReplaySystemBPLibrary::StopRecordingReplay(UObject* WorldContextObject)
+{
+	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
+	{
+		UReplaySegmentSubsystem* SegmentSubsystem = UReplaySegmentSubsystem::Get(WorldContextObject);
+		if (SegmentSubsystem && SegmentSubsystem->IsRecording())
+		{
+			SegmentSubsystem->StopRecording();
+			return;
+		}
+
+		if (IsRecordingReplay(WorldContextObject))
+		{
+			if (UGameInstance* GI = Cast<UGameInstance>(World->GetGameInstance()))
+			{
+				GI->StopRecordingReplay();
+			}
+
+			if (UReplayStateSubsystem* StateSubsystem = World->GetSubsystem<UReplayStateSubsystem>())
+			{
+				StateSubsystem->RefreshPlaybackState();
+			}
+		}
+	}
+}
+
+void UReplaySystemBPLibrary::RecordSegmentedReplay(UObject* WorldContextObject, const FString& BaseName,
+                                                   const FString& ReplayFriendlyName, float MaxSegmentMinutes,
+                                                   float MaxSegmentMB)
+{
+	if (UReplaySegmentSubsystem* SegmentSubsystem = UReplaySegmentSubsystem::Get(WorldContextObject))
+	{
+		SegmentSubsystem->StartRecording(BaseName, ReplayFriendlyName, MaxSegmentMinutes, MaxSegmentMB);
+	}
+}
+
+bool UReplaySystemBPLibrary::PlaySegmentedReplay(UObject* WorldContextObject, const FString& BaseName,
+                                                 float StartTime)
+{
+	if (UReplaySegmentSubsystem* SegmentSubsystem = UReplaySegmentSubsystem::Get(WorldContextObject))
+	{
+		return SegmentSubsystem->Play(BaseName, StartTime);
+	}
+	return false;
+}
+
+bool UReplaySystemBPLibrary::GetSegmentedReplayManifest(const FString& BaseName, FReplaySegmentManifest& OutManifest)
+{
+	return UReplaySegmentSubsystem::LoadManifest(BaseName, OutManifest);
+}
+
+bool UReplaySystemBPLibrary::IsRecordingReplay(UObject* WorldContextObject)
+{
+	if (const UReplayStateSubsystem* StateSubsystem = UReplayStateSubsystem::Get(WorldContextObject))
+	{
+		return StateSubsystem->GetPlaybackState().bIsRecording;
+	}
+	return false;
+}
+
+void UReplaySystemBPLibrary::DeleteReplay(const FString& ReplayName,
+                                          FOnDeleteReplayComplete OnDeleteComplete)
+{
+	const auto EnumerateStreamsPtr = FNetworkReplayStreaming::Get().GetFactory().CreateReplayStreamer();
+
+	const auto OnDeleteCompleteDel = FDeleteFinishedStreamCallback::CreateLambda(
+		[OnDeleteComplete, ReplayName](const FDeleteFinishedStreamResult& Result)
+		{
+			if (Result.WasSuccessful())
+			{
+				FReplaySearchIndex::Get().RemoveReplay(ReplayName);
+				FReplayIntegrity::DeleteChecksums(ReplayName);
+			}
+
+			OnDeleteComplete.Execute(Result.WasSuccessful());
+		});
+
+	if (EnumerateStreamsPtr.Get())
+	{
+		EnumerateStreamsPtr.Get()->DeleteFinishedStream(ReplayName, OnDeleteCompleteDel);
+	}
+}
+
+void UReplaySystemBPLibrary::RenameReplay(const FString& ReplayName,
+                                          const FString& NewReplayName, const int32 UserIndex,
+                                          FOnRenameReplayComplete OnRenameComplete)
+{
+	const auto EnumerateStreamsPtr = FNetworkReplayStreaming::Get().GetFactory().CreateReplayStreamer();
+
+	const auto Delegate = FRenameReplayCallback::CreateLambda(
+		[OnRenameComplete, ReplayName, NewReplayName](const FRenameReplayResult& Result)
+		{
+			if (Result.WasSuccessful())
+			{
+				FReplaySearchIndex::Get().RenameReplay(ReplayName, NewReplayName);
+				FReplayIntegrity::RenameChecksums(ReplayName, NewReplayName);
+			}
+
+			OnRenameComplete.Execute(Result.WasSuccessful());
+		});
+
+	if (EnumerateStreamsPtr.Get())
+	{
+		EnumerateStreamsPtr.Get()->RenameReplay(ReplayName, NewReplayName, UserIndex, Delegate);
+	}
+}
+
+void UReplaySystemBPLibrary::RenameReplayFriendly(
+                                                  const FString& ReplayName,
+                                                  const FString& NewFriendlyReplayName,
+                                                  const int32 UserIndex, FOnRenameReplayComplete OnRenameComplete)
+{
+	const auto EnumerateStreamsPtr = FNetworkReplayStreaming::Get().GetFactory().CreateReplayStreamer();
+
+	const auto Delegate = FRenameReplayCallback::CreateLambda([OnRenameComplete](const FRenameReplayResult& Result)
+	{
+		OnRenameComplete.Execute(Result.WasSuccessful());
+	});
+
+	if (EnumerateStreamsPtr.Get())
+	{
+		EnumerateStreamsPtr.Get()->RenameReplayFriendlyName(ReplayName, NewFriendlyReplayName, UserIndex, Delegate);
+	}
+}
+
+void UReplaySystemBPLibrary::GetSavedReplays(FOnGetReplaysComplete OnGetReplaysComplete)
+{
+	const auto EnumerateStreamsPtr = FNetworkReplayStreaming::Get().GetFactory().CreateReplayStreamer();
+
+	const auto Delegate = FEnumerateStreamsCallback::CreateLambda(
+		[OnGetReplaysComplete](const FEnumerateStreamsResult& Result)
+		{
+			TArray<FReplayInfo> Replays;
+
+			TArray<FNetworkReplayStreamInfo> StreamInfos = Result.FoundStreams;
+
+			for (FNetworkReplayStreamInfo StreamInfo : StreamInfos)
+			{
+				FReplayInfo ReplayInfo;
+				ReplayInfo.FriendlyName = StreamInfo.FriendlyName;
+				ReplayInfo.ActualName = StreamInfo.Name;
+				ReplayInfo.RecordDate = StreamInfo.Timestamp;
+				ReplayInfo.LengthInMS = StreamInfo.LengthInMS;
+				const float SizeInKb = StreamInfo.SizeInBytes / 1024.0f;
+				ReplayInfo.SizeInMb = SizeInKb / 1024.0f;
+				
+				Replays.Add(ReplayInfo);
+			}
+
+			OnGetReplaysComplete.Execute(Replays);
+		});
+
+	if (EnumerateStreamsPtr.Get())
+	{
+		EnumerateStreamsPtr.Get()->EnumerateStreams(FNetworkReplayVersion(), INDEX_NONE, FString(),
+													TArray<FString>(), Delegate);
+	}
+}
+
+bool UReplaySystemBPLibrary::PlayRecordedReplay(UObject* WorldContextObject, const FString& ReplayName)
+{
+	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
+	{
+		if (UGameInstance* GI = Cast<UGameInstance>(World->GetGameInstance()))
+		{
+			if (UReplayPrefetchSubsystem* PrefetchSubsystem = GI->GetSubsystem<UReplayPrefetchSubsystem>())
+			{
+				if (!PrefetchSubsystem->ConsumePrefetch(ReplayName))
+				{
+					return false;
+				}
+			}
+
+			LLM_SCOPE_BYTAG(ReplaySystem_Streaming);
+
+			const TArray<FString> Options;
+
+			return GI->PlayReplay(ReplayName, nullptr, Options);
+		}
+	}
+
+	return false;
+}
+
+void UReplaySystemBPLibrary::PrefetchReplay(UObject* WorldContextObject, const FString& ReplayName,
+                                            FOnPrefetchReplayComplete OnPrefetchComplete)
+{
+	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
+	{
+		if (const UGameInstance* GI = World->GetGameInstance())
+		{
+			if (UReplayPrefetchSubsystem* PrefetchSubsystem = GI->GetSubsystem<UReplayPrefetchSubsystem>())
+			{
+				PrefetchSubsystem->PrefetchReplay(ReplayName, OnPrefetchComplete);
+			}
+		}
+	}
+}
+
+void UReplaySystemBPLibrary::CancelReplayPrefetch(UObject* WorldContextObject)
+{
+	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
+	{
+		if (const UGameInstance* GI = World->GetGameInstance())
+		{
+			if (UReplayPrefetchSubsystem* PrefetchSubsystem = GI->GetSubsystem<UReplayPrefetchSubsystem>())
+			{
+				PrefetchSubsystem->CancelPrefetch();
+			}
+		}
+	}
+}
+
+bool UReplaySystemBPLibrary::PlayInstantReplay(UObject* WorldContextObject, const FString& ReplayName,
+                                               bool bHideLiveLevels)
+{
+	if (UReplayStateSubsystem* StateSubsystem = UReplayStateSubsystem::Get(WorldContextObject))
+	{
+		return StateSubsystem->PlayInstantReplay(ReplayName, bHideLiveLevels);
+	}
+	return false;
+}
+
+void UReplaySystemBPLibrary::StopInstantReplay(UObject* WorldContextObject)
+{
+	if (UReplayStateSubsystem* StateSubsystem = UReplayStateSubsystem::Get(WorldContextObject))
+	{
+		StateSubsystem->StopInstantReplay();
+	}
+}
+
+bool UReplaySystemBPLibrary::CanPlayInstantReplay(UObject* WorldContextObject)
+{
+	if (const UReplayStateSubsystem* StateSubsystem = UReplayStateSubsystem::Get(WorldContextObject))
+	{
+		return StateSubsystem->CanPlayInstantReplay();
+	}
+	return false;
+}
+
+void UReplaySystemBPLibrary::RestartReplayPlayback(UObject* WorldContextObject, FOnGotoTimeComplete OnComplete)
+{
+	GoToSpecificTime(WorldContextObject,0.0f,false,OnComplete);
+}
+
+void UReplaySystemBPLibrary::GoToSpecificTime(UObject* WorldContextObject, float TimeToGoTo,
+                                              bool bRetainCurrentPauseState, FOnGotoTimeComplete OnComplete)
+{
+	// A segmented recording may have to switch to the segment covering the time first
+	if (UReplaySegmentSubsystem* SegmentSubsystem = UReplaySegmentSubsystem::Get(WorldContextObject))
+	{
+		if (!SegmentSubsystem->ResolveSeek(TimeToGoTo, TimeToGoTo, OnComplete))
+		{
+			return;
+		}
+	}
+
+	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
+	{
+		if (const AWorldSettings* WorldSettings = World->GetWorldSettings())
+		{
+			// clamp time just in case
+			const float ClampedTime = UKismetMathLibrary::FClamp(TimeToGoTo, 0.0f,GetReplayLength(
+				                                                     WorldContextObject));
+
+			if (UDemoNetDriver* DemoDriver = GetDemoDriver(World))
+			{
+				if (DemoDriver->ServerConnection->PlayerController->PlayerState)
+				{
+					bool bPauseStateBeforeMove = false;
+					
+					if (const AReplayPlayerController* ReplayPC = Cast<AReplayPlayerController>(
+						DemoDriver->ServerConnection->PlayerController))
+					{
+						if (ReplayPC->bIsSpectating)
+						{
+							if (const AActor* ActorBeingSpectated = Cast<AActor>(ReplayPC->GetViewTarget()))
+							{
+								const FNetworkGUID ActorBeingSpectatedGUID = DemoDriver->GetGUIDForActor(
+									ActorBeingSpectated);
+								DemoDriver->AddNonQueuedGUIDForScrubbing(ActorBeingSpectatedGUID);
+							}
+						}
+
+						if (const AActor* ActorPossessed = Cast<AActor>(ReplayPC->GetPawn()))
+						{
+							const FNetworkGUID SpectatorPawnGUID = DemoDriver->GetGUIDForActor(ActorPossessed);
+							DemoDriver->AddNonQueuedGUIDForScrubbing(SpectatorPawnGUID);
+						}
+					}
+					else
+					{
+						if (const APlayerController* PC = Cast<APlayerController>(
+							DemoDriver->ServerConnection->PlayerController))
+						{
+							if (const AActor* ActorPossessed = Cast<AActor>(PC->GetPawn()))
+							{
+								const FNetworkGUID SpectatorPawnGUID = DemoDriver->GetGUIDForActor(ActorPossessed);
+								DemoDriver->AddNonQueuedGUIDForScrubbing(SpectatorPawnGUID);
+							}
+						}
+					}
+
+					for (FActorIterator It(World->GetWorld()); It; ++It)
+					{
+						if (It->bAlwaysRelevant)
+						{
+							const FNetworkGUID ActorGUID = DemoDriver->GetGUIDForActor(*It);
+							DemoDriver->AddNonQueuedGUIDForScrubbing(ActorGUID);
+						}
+					}
+
+
+					if (WorldSettings->GetPauserPlayerState())
+					{
+						bPauseStateBeforeMove = true;
+					}
+
+					TWeakObjectPtr<UReplayStateSubsystem> WeakStateSubsystem =
+						World->GetSubsystem<UReplayStateSubsystem>();
+
+					const auto OnGoToTimeDelegate = FOnGotoTimeDelegate::CreateLambda(
+						[OnComplete,bRetainCurrentPauseState,bPauseStateBeforeMove,World,WorldContextObject,WeakStateSubsystem](bool bWasSuccessful)
+						{
+							if (UReplayStateSubsystem* StateSubsystem = WeakStateSubsystem.Get())
+							{
+								StateSubsystem->NotifySeekFinished(bWasSuccessful);
+							}
+
+							OnComplete.Execute(bWasSuccessful);
+
+							if (bRetainCurrentPauseState && !bPauseStateBeforeMove == false)
+							{
+								PausePlayback(WorldContextObject);
+							}
+
+							if (AReplayPlayerController* ReplayPC = Cast<AReplayPlayerController>(
+								UGameplayStatics::GetPlayerController(World, 0)))
+							{
+								ReplayPC->OnGoToTime(GetCurrentReplayTime(WorldContextObject));
+								ReplayPC->OnStopSpectateActor();
+							}
+						});
+
+					if (UReplayStateSubsystem* StateSubsystem = WeakStateSubsystem.Get())
+					{
+						StateSubsystem->NotifySeekStarted(ClampedTime);
+					}
+
+					DemoDriver->GotoTimeInSeconds(ClampedTime, OnGoToTimeDelegate);
+				}
+			}
+		}
+	}
+}
+
+void UReplaySystemBPLibrary::ExtractReplayClip(const FString& ReplayName, const FString& ClipName, float StartTime,
+                                               float EndTime, FOnExtractReplayClipComplete OnComplete)
+{
+	FReplayClip::Extract(ReplayName, ClipName, StartTime, EndTime, [OnComplete, ClipName](bool bWasSuccessful)
+	{
+		OnComplete.ExecuteIfBound(bWasSuccessful, ClipName);
+	});
+}
+
+void UReplaySystemBPLibrary::PausePlayback(UObject* WorldContextObject)
+{
+	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
+	{
+		if (AWorldSettings* WorldSettings = World->GetWorldSettings())
+		{
+			if (const UDemoNetDriver* DemoDriver = GetDemoDriver(World))
+			{
+				if (DemoDriver->ServerConnection->PlayerController->PlayerState)
+				{
+					World->bIsCameraMoveableWhenPaused = true;
+					WorldSettings->SetPauserPlayerState(DemoDriver->ServerConnection->PlayerController->PlayerState);
+					if (UReplayStateSubsystem* StateSubsystem = World->GetSubsystem<UReplayStateSubsystem>())
+					{
+						StateSubsystem->RefreshPlaybackState();
+					}
+					if (AReplayPlayerController* ReplayPC = Cast<AReplayPlayerController>(
+						UGameplayStatics::GetPlayerController(World, 0)))
+					{
+						ReplayPC->OnTogglePause(true);
+					}
+				}
+			}
+		}
+	}
+}
+
+void UReplaySystemBPLibrary::ResumePlayback(UObject* WorldContextObject)
+{
+	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
+	{
+		if (AWorldSettings* WorldSettings = World->GetWorldSettings())
+		{
+			WorldSettings->SetPauserPlayerState(nullptr);
+			if (UReplayStateSubsystem* StateSubsystem = World->GetSubsystem<UReplayStateSubsystem>())
+			{
+				StateSubsystem->RefreshPlaybackState();
+			}
+			if (AReplayPlayerController* ReplayPC = Cast<AReplayPlayerController>(
+				UGameplayStatics::GetPlayerController(World, 0)))
+			{
+				ReplayPC->OnTogglePause(false);
+			}
+		}
+	}
+}
+
+void UReplaySystemBPLibrary::SetPlaybackSpeed(UObject* WorldContextObject, float Speed)
+{
+	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
+	{
+		if (AWorldSettings* WorldSettings = World->GetWorldSettings())
+		{
+			WorldSettings->DemoPlayTimeDilation = Speed;
+			if (UReplayStateSubsystem* StateSubsystem = World->GetSubsystem<UReplayStateSubsystem>())
+			{
+				StateSubsystem->RefreshPlaybackState();
+			}
+		}
+	}
+}
+
+float UReplaySystemBPLibrary::GetPlaybackSpeed(UObject* WorldContextObject)
+{
+	if (const UReplayStateSubsystem* StateSubsystem = UReplayStateSubsystem::Get(WorldContextObject))
+	{
+		return StateSubsystem->GetPlaybackState().PlaybackSpeed;
+	}
+	return 1.0f;
+}
+
+float UReplaySystemBPLibrary::GetCurrentReplayTime(UObject* WorldContextObject)
+{
+	if (const UReplayStateSubsystem* StateSubsystem = UReplayStateSubsystem::Get(WorldContextObject))
+	{
+		return StateSubsystem->GetPlaybackState().TimelineTime;
+	}
+	return 0.0f;
+}
+
+float UReplaySystemBPLibrary::GetReplayLength(UObject* WorldContextObject)
+{
+	if (const UReplayStateSubsystem* StateSubsystem = UReplayStateSubsystem::Get(WorldContextObject))
+	{
+		return StateSubsystem->GetPlaybackState().TimelineLength;
+	}
+	return 0.0f;
+}
+
+bool UReplaySystemBPLibrary::IsPlayingReplay(UObject* WorldContextObject)
+{
+	if (const UReplayStateSubsystem* StateSubsystem = UReplayStateSubsystem::Get(WorldContextObject))
+	{
+		return StateSubsystem->GetPlaybackState().bIsPlaying;
+	}
+	return false;
+}
+
+bool UReplaySystemBPLibrary::IsReplayPlaybackPaused(UObject* WorldContextObject)
+{
+	if (const UReplayStateSubsystem* StateSubsystem = UReplayStateSubsystem::Get(WorldContextObject))
+	{
+		return StateSubsystem->GetPlaybackState().bIsPaused;
+	}
+	return false;
+}
+
+FString UReplaySystemBPLibrary::GetActiveReplayName(UObject* WorldContextObject)
+{
+	if (const UReplayStateSubsystem* StateSubsystem = UReplayStateSubsystem::Get(WorldContextObject))
+	{
+		return StateSubsystem->GetPlaybackState().ReplayName;
+	}
+	return "None";
+}
+
+bool UReplaySystemBPLibrary::AddEventToActiveReplay(UObject* WorldContextObject, const FString& EventId,
+                                                    const FString& Group, FString Metadata, TArray<uint8> Data)
+{
+	if (const UReplayStateSubsystem* StateSubsystem = UReplayStateSubsystem::Get(WorldContextObject))
+	{
+		if (StateSubsystem->GetPlaybackState().bIsRecording)
+		{
+			if (UDemoNetDriver* DemoDriver = StateSubsystem->GetDemoDriver())
+			{
+				DemoDriver->AddOrUpdateEvent(EventId, Group, Metadata, Data);
+
+				if (UReplayEventIndexSubsystem* EventIndexSubsystem = UReplayEventIndexSubsystem::Get(WorldContextObject))
+				{
+					EventIndexSubsystem->IndexEvent(EventId, Group);
+				}
+
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool UReplaySystemBPLibrary::AddIndexedEventToActiveReplay(UObject* WorldContextObject, const FString& EventId,
+                                                           const FString& Group,
+                                                           const TArray<FReplayMetadataValue>& Metadata,
+                                                           TArray<uint8> Data)
+{
+	if (UReplayEventIndexSubsystem* EventIndexSubsystem = UReplayEventIndexSubsystem::Get(WorldContextObject))
+	{
+		return EventIndexSubsystem->AddEvent(EventId, Group, Metadata, Data);
+	}
+	return false;
+}
+
+void UReplaySystemBPLibrary::SetIndexedReplayMetadataKeys(UObject* WorldContextObject, const TArray<FName>& Keys)
+{
+	if (UReplayEventIndexSubsystem* EventIndexSubsystem = UReplayEventIndexSubsystem::Get(WorldContextObject))
+	{
+		EventIndexSubsystem->SetIndexedKeys(Keys);
+	}
+}
+
+void UReplaySystemBPLibrary::FindReplayEventsByValue(UObject* WorldContextObject, const FString& ReplayName,
+                                                     const FReplayMetadataValue& Value,
+                                                     FOnQueryReplayEventsComplete OnQueryComplete)
+{
+	if (UReplayEventIndexSubsystem* EventIndexSubsystem = UReplayEventIndexSubsystem::Get(WorldContextObject))
+	{
+		EventIndexSubsystem->FindEvents(ReplayName, Value, OnQueryComplete);
+	}
+}
+
+void UReplaySystemBPLibrary::FindReplayEventsInRange(UObject* WorldContextObject, const FString& ReplayName, FName Key,
+                                                     double Min, double Max,
+                                                     FOnQueryReplayEventsComplete OnQueryComplete)
+{
+	if (UReplayEventIndexSubsystem* EventIndexSubsystem = UReplayEventIndexSubsystem::Get(WorldContextObject))
+	{
+		EventIndexSubsystem->FindEventsInRange(ReplayName, Key, Min, Max, OnQueryComplete);
+	}
+}
+
+TArray<FReplaySearchHit> UReplaySystemBPLibrary::SearchReplayEvents(const FString& Group, const FString& EventId)
+{
+	TArray<FReplaySearchHit> Hits;
+	FReplaySearchIndex::Get().FindEvents(Group, EventId, Hits);
+	return Hits;
+}
+
+TArray<FReplaySearchHit> UReplaySystemBPLibrary::SearchReplayEventsByValue(const FReplayMetadataValue& Value)
+{
+	TArray<FReplaySearchHit> Hits;
+	FReplaySearchIndex::Get().FindByValue(Value, Hits);
+	return Hits;
+}
+
+TArray<FReplaySearchHit> UReplaySystemBPLibrary::SearchReplayEventsInRange(FName Key, double Min, double Max)
+{
+	TArray<FReplaySearchHit> Hits;
+	FReplaySearchIndex::Get().FindInRange(Key, Min, Max, Hits);
+	return Hits;
+}
+
+bool UReplaySystemBPLibrary::DecodeReplayEventMetadata(const FString& Metadata, TArray<FReplayMetadataValue>& Values)
+{
+	return ReplayEventMetadata::Decode(Metadata, Values);
+}
+
+void UReplaySystemBPLibrary::GetActiveReplayEvents(UObject* WorldContextObject, FString Group,
+                                                       int UserIndex, FOnRequestEventsComplete OnRequestEventsComplete)
+{
+	if (!IsRecordingReplay(WorldContextObject) && IsPlayingReplay(WorldContextObject))
+	{
+		const TSharedPtr<INetworkReplayStreamer> EnumerateStreamsPtr = FNetworkReplayStreaming::Get().GetFactory().
+			CreateReplayStreamer();
+
+
+		const auto EnumerateEventsDel = FEnumerateEventsCallback::CreateLambda(
+			[OnRequestEventsComplete](const FEnumerateEventsResult& Results)
+			{
+				TArray<FReplayEvent> ReplayEvents;
+				if (Results.WasSuccessful())
+				{
+					for (FReplayEventListItem EventItem : Results.ReplayEventList.ReplayEvents)
+					{
+						FReplayEvent ReplayEventTemp;
+						ReplayEventTemp.EventID = EventItem.ID;
+
+						ReplayEventTemp.Group = EventItem.Group;
+						ReplayEventTemp.TimeInMs = static_cast<int32>(EventItem.Time1);
+						ReplayEventTemp.Metadata = EventItem.Metadata;
+
+						ReplayEvents.Add(ReplayEventTemp);
+					}
+				}
+				OnRequestEventsComplete.Execute(ReplayEvents);
+			});
+
+		if (EnumerateStreamsPtr.Get())
+		{
+			EnumerateStreamsPtr.Get()->EnumerateEvents(GetActiveReplayName(WorldContextObject), Group, UserIndex,
+													   EnumerateEventsDel);
+		}
+	}
+}
+
+void UReplaySystemBPLibrary::GetDataForEvent(FString ReplayActualName, FString EventId,
+                                             int UserIndex, FOnGetEventDataComplete OnGetEventDataComplete)
+{
+	const TSharedPtr<INetworkReplayStreamer> EnumerateStreamsPtr = FNetworkReplayStreaming::Get().GetFactory().
+			CreateReplayStreamer();
+
+
+	const auto RequestEventsDataDel = FRequestEventDataCallback::CreateLambda(
+		[OnGetEventDataComplete](const FRequestEventDataResult& Result)
+		{
+			TArray<uint8> Data;
+			if (Result.WasSuccessful())
+			{
+				Data = Result.ReplayEventListItem;
+			}
+			OnGetEventDataComplete.Execute(Data);
+		});
+
+	if (EnumerateStreamsPtr.Get())
+	{
+		EnumerateStreamsPtr.Get()->RequestEventData(ReplayActualName, EventId, UserIndex, RequestEventsDataDel);
+	}
+}
+
+void UReplaySystemBPLibrary::GetEvents(FString ReplayActualName, FString Group, int UserIndex,
+	FOnRequestEventsComplete OnRequestEventsComplete)
+{
+	const TSharedPtr<INetworkReplayStreamer> EnumerateStreamsPtr = FNetworkReplayStreaming::Get().GetFactory().
+		CreateReplayStreamer();
+
+	const auto EnumerateEventsDel = FEnumerateEventsCallback::CreateLambda(
+		[OnRequestEventsComplete](const FEnumerateEventsResult& Results)
+		{
+			TArray<FReplayEvent> ReplayEvents;
+			if (Results.WasSuccessful())
+			{
+				for (FReplayEventListItem EventItem : Results.ReplayEventList.ReplayEvents)
+				{
+					FReplayEvent ReplayEventTemp;
+					ReplayEventTemp.EventID = EventItem.ID;
+
+					ReplayEventTemp.Group = EventItem.Group;
+					ReplayEventTemp.TimeInMs = static_cast<int32>(EventItem.Time1);
+					ReplayEventTemp.Metadata = EventItem.Metadata;
+					ReplayEvents.Add(ReplayEventTemp);
+				}
+			}
+
+			OnRequestEventsComplete.Execute(ReplayEvents);
+		});
+
+	if (EnumerateStreamsPtr.Get())
+	{
+		EnumerateStreamsPtr.Get()->EnumerateEvents(ReplayActualName, Group, UserIndex, EnumerateEventsDel);
+	}
+}
+
+void UReplaySystemBPLibrary::VerifyReplays(const TArray<FString>& ReplayNames, bool bRepair,
+                                           FOnVerifyReplaysComplete OnVerifyComplete)
+{
+	FReplayIntegrity::VerifyReplays(ReplayNames, bRepair, [OnVerifyComplete](const TArray<FReplayIntegrityResult>& Results)
+	{
+		OnVerifyComplete.ExecuteIfBound(Results);
+	});
+}
+
+void UReplaySystemBPLibrary::RecoverReplays(FOnVerifyReplaysComplete OnRecoverComplete)
+{
+	// Replays recorded by this process are skipped by the recovery itself, the age keeps other processes' recordings safe
+	const IConsoleVariable* MinAge = IConsoleManager::Get().FindConsoleVariable(
+		TEXT("ReplaySystem.RecoverMinAgeSeconds"));
+
+	FReplayIntegrity::RecoverReplays(MinAge ? MinAge->GetFloat() : 0.0f, [OnRecoverComplete](const TArray<FReplayIntegrityResult>& Results)
+	{
+		OnRecoverComplete.ExecuteIfBound(Results);
+	});
+}
+
+void UReplaySystemBPLibrary::SetCrashSafeRecording(bool bEnabled, float FlushInterval)
+{
+	IConsoleManager& ConsoleManager = IConsoleManager::Get();
+
+	if (IConsoleVariable* CrashSafeRecording = ConsoleManager.FindConsoleVariable(
+		TEXT("ReplaySystem.CrashSafeRecording")))
+	{
+		CrashSafeRecording->Set(bEnabled, ECVF_SetByCode);
+	}
+
+	if (IConsoleVariable* CrashSafeFlushInterval = ConsoleManager.FindConsoleVariable(
+		TEXT("ReplaySystem.CrashSafeFlushInterval")))
+	{
+		CrashSafeFlushInterval->Set(FlushInterval, ECVF_SetByCode);
+	}
+}
+
+bool UReplaySystemBPLibrary::UploadReplay(UObject* WorldContextObject, const FString& ReplayName)
+{
+	if (UReplayUploadSubsystem* UploadSubsystem = UReplayUploadSubsystem::Get(WorldContextObject))
+	{
+		return UploadSubsystem->UploadReplay(ReplayName);
+	}
+	return false;
+}
+
+void UReplaySystemBPLibrary::CancelReplayUpload(UObject* WorldContextObject, const FString& ReplayName)
+{
+	if (UReplayUploadSubsystem* UploadSubsystem = UReplayUploadSubsystem::Get(WorldContextObject))
+	{
+		UploadSubsystem->CancelUpload(ReplayName);
+	}
+}
+
+bool UReplaySystemBPLibrary::GetReplayUploadStatus(UObject* WorldContextObject, const FString& ReplayName,
+                                                   FReplayUploadStatus& OutStatus)
+{
+	if (const UReplayUploadSubsystem* UploadSubsystem = UReplayUploadSubsystem::Get(WorldContextObject))
+	{
+		return UploadSubsystem->GetUploadStatus(ReplayName, OutStatus);
+	}
+	return false;
+}
+
+FString UReplaySystemBPLibrary::GetReplayCacheURL(UObject* WorldContextObject)
+{
+	if (const UReplayCacheSubsystem* CacheSubsystem = UReplayCacheSubsystem::Get(WorldContextObject))
+	{
+		return CacheSubsystem->GetProxyURL();
+	}
+	return FString();
+}
+
+void UReplaySystemBPLibrary::ClearReplayCache(UObject* WorldContextObject)
+{
+	if (UReplayCacheSubsystem* CacheSubsystem = UReplayCacheSubsystem::Get(WorldContextObject))
+	{
+		CacheSubsystem->ClearCache();
+	}
+}
+
+FReplayMetrics UReplaySystemBPLibrary::GetReplayMetrics(UObject* WorldContextObject)
+{
+	if (const UReplayMetricsSubsystem* MetricsSubsystem = UReplayMetricsSubsystem::Get(WorldContextObject))
+	{
+		return MetricsSubsystem->GetMetrics();
+	}
+	return FReplayMetrics();
+}
+
+void UReplaySystemBPLibrary::ResetReplayMetrics(UObject* WorldContextObject)
+{
+	if (UReplayMetricsSubsystem* MetricsSubsystem = UReplayMetricsSubsystem::Get(WorldContextObject))
+	{
+		MetricsSubsystem->ResetMetrics();
+	}
+}
+
+bool UReplaySystemBPLibrary::ExportReplayMetrics(UObject* WorldContextObject, const FString& Filename)
+{
+	if (const UReplayMetricsSubsystem* MetricsSubsystem = UReplayMetricsSubsystem::Get(WorldContextObject))
+	{
+		return MetricsSubsystem->ExportCSV(Filename);
+	}
+	return false;
+}
+
+FReplayMemoryUsage UReplaySystemBPLibrary::GetReplayMemoryUsage(EReplayMemoryCategory Category)
+{
+	return FReplayMemory::GetUsage(Category);
+}
+
+TArray<FReplayMemoryUsage> UReplaySystemBPLibrary::GetAllReplayMemoryUsage()
+{
+	return FReplayMemory::GetAllUsage();
+}
+
+void UReplaySystemBPLibrary::ResetReplayMemoryPeaks()
+{
+	FReplayMemory::ResetPeaks();
+}
+
+void UReplaySystemBPLibrary::GetEventsForReplays(const TArray<FString>& ReplayNames, const FString& Group,
+                                                 int32 MaxConcurrent, FOnReplayEventListReady OnEventListReady,
+                                                 FOnRequestReplayEventListsComplete OnRequestComplete)
+{
+	FReplayEventBatch::Start(ReplayNames, Group, MaxConcurrent,
+	                         FReplayEventBatch::FOnEventListReady::CreateLambda(
+		                         [OnEventListReady](const FReplayEventList& EventList)
+		                         {
+			                         OnEventListReady.ExecuteIfBound(EventList);
+		                         }),
+	                         FReplayEventBatch::FOnComplete::CreateLambda(
+		                         [OnRequestComplete](const TArray<FReplayEventList>& EventLists)
+		                         {
+			                         OnRequestComplete.ExecuteIfBound(EventLists);
+		                         }));
+}
+
+void UReplaySystemBPLibrary::LoadReplayTracks(UObject* WorldContextObject, const FString& ReplayName,
+                                              FOnLoadReplayTracksComplete OnLoadComplete)
+{
+	if (UReplayTrackSubsystem* TrackSubsystem = UReplayTrackSubsystem::Get(WorldContextObject))
+	{
+		TrackSubsystem->LoadTracks(ReplayName.IsEmpty() ? GetActiveReplayName(WorldContextObject) : ReplayName,
+		                           OnLoadComplete);
+	}
+}
+
+void UReplaySystemBPLibrary::LoadReplayGhosts(UObject* WorldContextObject, const FString& ReplayName,
+                                              FOnLoadReplayTracksComplete OnLoadComplete)
+{
+	if (UReplayGhostSubsystem* GhostSubsystem = UReplayGhostSubsystem::Get(WorldContextObject))
+	{
+		GhostSubsystem->LoadGhosts(ReplayName.IsEmpty() ? GetActiveReplayName(WorldContextObject) : ReplayName,
+		                           OnLoadComplete);
+	}
+}
+
+void UReplaySystemBPLibrary::GetReplayGhostPositions(UObject* WorldContextObject, float Time,
+                                                     TArray<FReplayGhostPosition>& Positions)
+{
+	Positions.Reset();
+
+	if (const UReplayGhostSubsystem* GhostSubsystem = UReplayGhostSubsystem::Get(WorldContextObject))
+	{
+		GhostSubsystem->GetGhostPositions(Time, Positions);
+	}
+}
+
+void UReplaySystemBPLibrary::AddReplayGhostActor(AActor* Actor, const FString& Name)
+{
+	if (UReplayGhostSubsystem* GhostSubsystem = Actor ? UReplayGhostSubsystem::Get(Actor) : nullptr)
+	{
+		GhostSubsystem->AddGhostActor(Actor, Name);
+	}
+}
+
+void UReplaySystemBPLibrary::RemoveReplayGhostActor(AActor* Actor)
+{
+	if (UReplayGhostSubsystem* GhostSubsystem = Actor ? UReplayGhostSubsystem::Get(Actor) : nullptr)
+	{
+		GhostSubsystem->RemoveGhostActor(Actor);
+	}
+}
+
+void UReplaySystemBPLibrary::SetReplayTrackPrecision(UObject* WorldContextObject, const FString& Name,
+                                                     const FReplayTrackPrecision& Precision)
+{
+	if (UReplayTrackSubsystem* TrackSubsystem = UReplayTrackSubsystem::Get(WorldContextObject))
+	{
+		TrackSubsystem->SetTrackPrecision(Name, Precision);
+	}
+}
+
+bool UReplaySystemBPLibrary::AddReplayCurveProperty(UObject* WorldContextObject, UObject* Object, FName PropertyName,
+                                                    const FString& TrackName, float Tolerance)
+{
+	if (UReplayTrackSubsystem* TrackSubsystem = UReplayTrackSubsystem::Get(WorldContextObject))
+	{
+		return TrackSubsystem->AddCurveProperty(Object, PropertyName, TrackName, Tolerance);
+	}
+	return false;
+}
+
+void UReplaySystemBPLibrary::RemoveReplayCurveProperty(UObject* WorldContextObject, const FString& TrackName)
+{
+	if (UReplayTrackSubsystem* TrackSubsystem = UReplayTrackSubsystem::Get(WorldContextObject))
+	{
+		TrackSubsystem->RemoveCurveProperty(TrackName);
+	}
+}
+
+UCurveFloat* UReplaySystemBPLibrary::GetReplayFloatCurve(UObject* WorldContextObject, const FString& Name)
+{
+	if (UReplayTrackSubsystem* TrackSubsystem = UReplayTrackSubsystem::Get(WorldContextObject))
+	{
+		return TrackSubsystem->GetFloatCurve(Name);
+	}
+	return nullptr;
+}
+
+UCurveVector* UReplaySystemBPLibrary::GetReplayVectorCurve(UObject* WorldContextObject, const FString& Name)
+{
+	if (UReplayTrackSubsystem* TrackSubsystem = UReplayTrackSubsystem::Get(WorldContextObject))
+	{
+		return TrackSubsystem->GetVectorCurve(Name);
+	}
+	return nullptr;
+}
+
+bool UReplaySystemBPLibrary::RecordBoolTrack(UObject* WorldContextObject, const FReplayBoolData& Data)
+{
+	if (UReplayTrackSubsystem* TrackSubsystem = UReplayTrackSubsystem::Get(WorldContextObject))
+	{
+		return TrackSubsystem->Record<bool>(Data.Name, Data.Value);
+	}
+	return false;
+}
+
+bool UReplaySystemBPLibrary::GetBoolTrackValue(UObject* WorldContextObject, const FString& Name, float Time, bool& Value)
+{
+	if (const UReplayTrackSubsystem* TrackSubsystem = UReplayTrackSubsystem::Get(WorldContextObject))
+	{
+		return TrackSubsystem->Evaluate(Name, Time, Value);
+	}
+	return false;
+}
+
+bool UReplaySystemBPLibrary::RecordIntTrack(UObject* WorldContextObject, const FReplayIntData& Data)
+{
+	if (UReplayTrackSubsystem* TrackSubsystem = UReplayTrackSubsystem::Get(WorldContextObject))
+	{
+		return TrackSubsystem->Record<int32>(Data.Name, Data.Value);
+	}
+	return false;
+}
+
+bool UReplaySystemBPLibrary::GetIntTrackValue(UObject* WorldContextObject, const FString& Name, float Time, int32& Value)
+{
+	if (const UReplayTrackSubsystem* TrackSubsystem = UReplayTrackSubsystem::Get(WorldContextObject))
+	{
+		return TrackSubsystem->Evaluate(Name, Time, Value);
+	}
+	return false;
+}
+
+bool UReplaySystemBPLibrary::RecordFloatTrack(UObject* WorldContextObject, const FReplayFloatData& Data)
+{
+	if (UReplayTrackSubsystem* TrackSubsystem = UReplayTrackSubsystem::Get(WorldContextObject))
+	{
+		return TrackSubsystem->Record<float>(Data.Name, Data.Value);
+	}
+	return false;
+}
+
+bool UReplaySystemBPLibrary::GetFloatTrackValue(UObject* WorldContextObject, const FString& Name, float Time, float& Value)
+{
+	if (const UReplayTrackSubsystem* TrackSubsystem = UReplayTrackSubsystem::Get(WorldContextObject))
+	{
+		return TrackSubsystem->Evaluate(Name, Time, Value);
+	}
+	return false;
+}
+
+bool UReplaySystemBPLibrary::RecordVectorTrack(UObject* WorldContextObject, const FReplayVectorData& Data)
+{
+	if (UReplayTrackSubsystem* TrackSubsystem = UReplayTrackSubsystem::Get(WorldContextObject))
+	{
+		return TrackSubsystem->Record<FVector>(Data.Name, Data.Value);
+	}
+	return false;
+}
+
+bool UReplaySystemBPLibrary::GetVectorTrackValue(UObject* WorldContextObject, const FString& Name, float Time, FVector& Value)
+{
+	if (const UReplayTrackSubsystem* TrackSubsystem = UReplayTrackSubsystem::Get(WorldContextObject))
+	{
+		return TrackSubsystem->Evaluate(Name, Time, Value);
+	}
+	return false;
+}
+
+bool UReplaySystemBPLibrary::RecordRotatorTrack(UObject* WorldContextObject, const FReplayRotatorData& Data)
+{
+	if (UReplayTrackSubsystem* TrackSubsystem = UReplayTrackSubsystem::Get(WorldContextObject))
+	{
+		return TrackSubsystem->Record<FRotator>(Data.Name, Data.Value);
+	}
+	return false;
+}
+
+bool UReplaySystemBPLibrary::GetRotatorTrackValue(UObject* WorldContextObject, const FString& Name, float Time, FRotator& Value)
+{
+	if (const UReplayTrackSubsystem* TrackSubsystem = UReplayTrackSubsystem::Get(WorldContextObject))
+	{
+		return TrackSubsystem->Evaluate(Name, Time, Value);
+	}
+	return false;
+}
+
+bool UReplaySystemBPLibrary::RecordTransformTrack(UObject* WorldContextObject, const FReplayTransformData& Data)
+{
+	if (UReplayTrackSubsystem* TrackSubsystem = UReplayTrackSubsystem::Get(WorldContextObject))
+	{
+		return TrackSubsystem->Record<FTransform>(Data.Name, Data.Value);
+	}
+	return false;
+}
+
+bool UReplaySystemBPLibrary::GetTransformTrackValue(UObject* WorldContextObject, const FString& Name, float Time, FTransform& Value)
+{
+	if (const UReplayTrackSubsystem* TrackSubsystem = UReplayTrackSubsystem::Get(WorldContextObject))
+	{
+		return TrackSubsystem->Evaluate(Name, Time, Value);
+	}
+	return false;
+}
+
+void UReplaySystemBPLibrary::GetFloatTrackValues(UObject* WorldContextObject, const TArray<FString>& Names, float Time,
+                                                 TArray<float>& Values)
+{
+	Values.Init(0.0f, Names.Num());
+	if (const UReplayTrackSubsystem* TrackSubsystem = UReplayTrackSubsystem::Get(WorldContextObject))
+	{
+		TrackSubsystem->EvaluateBatch<float>(Names, Time, Values);
+	}
+}
+
+void UReplaySystemBPLibrary::GetVectorTrackValues(UObject* WorldContextObject, const TArray<FString>& Names, float Time,
+                                                  TArray<FVector>& Values)
+{
+	Values.Init(FVector::ZeroVector, Names.Num());
+	if (const UReplayTrackSubsystem* TrackSubsystem = UReplayTrackSubsystem::Get(WorldContextObject))
+	{
+		TrackSubsystem->EvaluateBatch<FVector>(Names, Time, Values);
+	}
+}
+
+float UReplaySystemBPLibrary::MsToSeconds(const int32 MS)
+{
+#if  ENGINE_MAJOR_VERSION <= 4
+	const float MsAsFloat = UKismetMathLibrary::Conv_IntToFloat(MS);
+#else
+	const float MsAsFloat = UKismetMathLibrary::Conv_IntToDouble(MS);
+#endif
+
+	const float MsAsSeconds = MsAsFloat / 1000;
+	return MsAsSeconds;
+}
+
+void UReplaySystemBPLibrary::SpectateActor(UObject* WorldContextObject, AActor* Actor, FBlendSettings BlendSettings)
+{
+	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
+	{
+		if (!Actor)
+		{
+			return;
+		}
+
+		if (UGameplayStatics::GetPlayerController(World, 0))
+		{
+			if (APlayerController* PC = UGameplayStatics::GetPlayerController(World, 0))
+			{
+				if (!PC->IsLocalController())
+				{
+					return;
+				}
+
+				//Everything from here is happening only locally/on the client
+				PC->SetViewTargetWithBlend(Actor, BlendSettings.BlendTime, BlendSettings.BlendFunction,
+				                           BlendSettings.BlendExponent, BlendSettings.bLockOutgoing);
+				if (AReplayPlayerController* ReplayPC = Cast<AReplayPlayerController>(
+					UGameplayStatics::GetPlayerController(World, 0)))
+				{
+					ReplayPC->OnSpectateActor(Actor);
+					ReplayPC->bIsSpectating = true;
+				}
+			}
+		}
+	}
+}
+
+void UReplaySystemBPLibrary::StopSpectating(UObject* WorldContextObject, FBlendSettings BlendSettings)
+{
+	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
+	{
+		if (UGameplayStatics::GetPlayerController(World, 0))
+		{
+			if (APlayerController* PC = UGameplayStatics::GetPlayerController(World, 0))
+			{
+				if (!PC->IsLocalController())
+				{
+					return;
+				}
+
+				//Everything from here is happening only locally/on the client
+
+				auto Target = PC->GetPawn();
+				PC->SetViewTargetWithBlend(Target, BlendSettings.BlendTime, BlendSettings.BlendFunction,
+				                           BlendSettings.BlendExponent, BlendSettings.bLockOutgoing);
+
+				if (AReplayPlayerController* ReplayPC = Cast<AReplayPlayerController>(
+					UGameplayStatics::GetPlayerController(World, 0)))
+				{
+					ReplayPC->OnStopSpectateActor();
+					ReplayPC->bIsSpectating = false;
+				}
+			}
+		}
+	}
+}
+
+UDemoNetDriver* UReplaySystemBPLibrary::GetDemoDriver(const UObject* WorldContextObject)
+{
+	if (auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
+	{
+#if  ENGINE_MAJOR_VERSION > 4
+		return World->GetDemoNetDriver();
+#elif ENGINE_MINOR_VERSION >= 26
+		return World->GetDemoNetDriver();
+#elif ENGINE_MINOR_VERSION < 26
+		return World->DemoNetDriver;
+#endif
+	}
+
+	return nullptr;
+}
+
+void UReplaySystemBPLibrary::SetMaxRecordHz(UObject* WorldContextObject, float Hz)
+{
+	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
+	{
+		if (UGameplayStatics::GetPlayerController(World, 0))
+		{
+#if  ENGINE_MAJOR_VERSION <= 4
+			FString Command = "demo.recordhz " + UKismetStringLibrary::Conv_FloatToString(Hz);
+#else
+			FString Command = "demo.recordhz " + FString::SanitizeFloat(Hz);
+#endif
+
+
+			UGameplayStatics::GetPlayerController(World, 0)->ConsoleCommand(Command);
+		}
+	}
+}
+
+
+float UReplaySystemBPLibrary::GetMaxRecordHz()
+{
+	static const auto CVar = IConsoleManager::Get().FindConsoleVariable(TEXT("demo.recordhz"));
+	const float value = CVar->GetFloat();
+	return value;
+}
+
+void UReplaySystemBPLibrary::SerializeStruct(UStruct* Struct, TArray<uint8>& Data)
+{
+}
+
+void UReplaySystemBPLibrary::DeSerializeStruct(TArray<uint8> Data, UStruct*& Struct)
+{
+}
+
+TArray<uint8> UReplaySystemBPLibrary::StringToBytes(FString Data)
+{
+	TArray<uint8> Result;
+	FMemoryWriter Ar(Result);
+	Ar << Data;
+	return Result;
+}
+
+FString UReplaySystemBPLibrary::BytesToString(TArray<uint8> Data)
+{
+	FString Result;
+	FMemoryReader Ar(Data);
+	Ar << Result;
+	return Result;
+}
+
@@ -0,0 +1,321 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayTrackSubsystem.h"
+
+#include "ReplayStateSubsystem.h"
+#include "ReplaySystem.h"
+#include "Curves/CurveFloat.h"
+#include "Curves/CurveVector.h"
+#include "GameFramework/Actor.h"
+#include "Components/SceneComponent.h"
+#include "Engine/DemoNetDriver.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Serialization/MemoryWriter.h"
+
+void UReplayTrackSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// However the recording stops, the tracks since the last flush are written while the replay still takes them
+	if (UReplayStateSubsystem* StateSubsystem = Collection.InitializeDependency<UReplayStateSubsystem>())
+	{
+		RecordingStoppingHandle = StateSubsystem->OnRecordingStopping.AddUObject(
+			this, &UReplayTrackSubsystem::FlushTracks);
+	}
+}
+
+void UReplayTrackSubsystem::Deinitialize()
+{
+	// The demo driver may still be around while the world is torn down, give the last few seconds a chance
+	FlushTracks();
+
+	if (UReplayStateSubsystem* StateSubsystem = GetWorld()->GetSubsystem<UReplayStateSubsystem>())
+	{
+		StateSubsystem->OnRecordingStopping.Remove(RecordingStoppingHandle);
+	}
+	RecordingStoppingHandle.Reset();
+
+	RecordingTracks.Reset();
+	LoadedTracks.Reset();
+	CurveSamplers.Reset();
+	FloatCurves.Reset();
+	VectorCurves.Reset();
+	MemoryCounter.Set(0);
+
+	Super::Deinitialize();
+}
+
+void UReplayTrackSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	LLM_SCOPE_BYTAG(ReplaySystem_Tracks);
+
+	MemoryCounter.Set(RecordingTracks.GetAllocatedSize() + LoadedTracks.GetAllocatedSize());
+
+	const UDemoNetDriver* DemoDriver = GetWorld()->GetDemoNetDriver();
+
+	// The tracks of a recording that stopped were flushed by OnRecordingStopping
+	if (!DemoDriver || !DemoDriver->IsRecording())
+	{
+		RecordingTracks.Reset();
+		RecordingReplayName.Reset();
+		return;
+	}
+
+	const FString& ActiveReplayName = DemoDriver->GetActiveReplayName();
+
+	if (ActiveReplayName != RecordingReplayName)
+	{
+		// Values recorded before the first tick of a recording belong to it, only those of an earlier one are dropped
+		if (!RecordingReplayName.IsEmpty())
+		{
+			RecordingTracks.Reset();
+		}
+
+		RecordingReplayName = ActiveReplayName;
+		NextChunkIndex = 0;
+		LastFlushTime = 0.0f;
+		LastCurveSampleTime = -CurveSampleInterval;
+	}
+
+	if (CurveSamplers.Num() > 0 && DemoDriver->GetDemoCurrentTime() - LastCurveSampleTime >= CurveSampleInterval)
+	{
+		SampleCurves(DemoDriver->GetDemoCurrentTime());
+	}
+
+	// Tracks are written as new chunks, flushing them more often does not rewrite earlier ones
+	if (DemoDriver->GetDemoCurrentTime() - LastFlushTime >= UReplayStateSubsystem::GetFlushInterval(FlushInterval))
+	{
+		FlushTracks();
+	}
+}
+
+TStatId UReplayTrackSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UReplayTrackSubsystem, STATGROUP_Tickables);
+}
+
+UReplayTrackSubsystem* UReplayTrackSubsystem::Get(const UObject* WorldContextObject)
+{
+	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
+	{
+		return World->GetSubsystem<UReplayTrackSubsystem>();
+	}
+
+	return nullptr;
+}
+
+void UReplayTrackSubsystem::SetTrackPrecision(const FString& Name, const FReplayTrackPrecision& Precision)
+{
+	RecordingTracks.SetPrecision(FName(*Name), Precision);
+}
+
+bool UReplayTrackSubsystem::AddCurveProperty(UObject* Object, FName PropertyName, const FString& TrackName,
+                                             float Tolerance)
+{
+	if (!Object)
+	{
+		return false;
+	}
+
+	const auto IsSampleable = [](const FProperty* Property)
+	{
+		if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+		{
+			return StructProperty->Struct == TBaseStructure<FVector>::Get();
+		}
+		return Property && Property->IsA<FNumericProperty>() && !CastField<FNumericProperty>(Property)->IsEnum();
+	};
+
+	UObject* Container = Object;
+	const FProperty* Property = FindFProperty<FProperty>(Object->GetClass(), PropertyName);
+
+	if (!IsSampleable(Property))
+	{
+		const AActor* Actor = Cast<AActor>(Object);
+		Container = Actor ? Actor->GetRootComponent() : nullptr;
+		Property = Container ? FindFProperty<FProperty>(Container->GetClass(), PropertyName) : nullptr;
+	}
+
+	if (!IsSampleable(Property))
+	{
+		UE_LOG(LogReplaySystem, Warning, TEXT("%s has no numeric or vector property %s to record"), *Object->GetName(),
+		       *PropertyName.ToString());
+		return false;
+	}
+
+	const FName Name(*TrackName);
+
+	FReplayTrackPrecision Precision = RecordingTracks.GetPrecision(Name);
+	Precision.Tolerance = Tolerance;
+	RecordingTracks.SetPrecision(Name, Precision);
+
+	CurveSamplers.RemoveAllSwap([Name](const FCurveSampler& Sampler) { return Sampler.TrackName == Name; });
+	CurveSamplers.Add({Container, Property, Name});
+	return true;
+}
+
+void UReplayTrackSubsystem::RemoveCurveProperty(const FString& TrackName)
+{
+	const FName Name = ReplayNamedColumn::FindName(TrackName);
+	CurveSamplers.RemoveAllSwap([Name](const FCurveSampler& Sampler) { return Sampler.TrackName == Name; });
+}
+
+UCurveFloat* UReplayTrackSubsystem::GetFloatCurve(const FString& Name)
+{
+	const FName Key = ReplayNamedColumn::FindName(Name);
+	const TReplayTrack<float>* Track = Key.IsNone() ? nullptr : LoadedTracks.GetTracks<float>().Find(Key);
+
+	if (!Track)
+	{
+		return nullptr;
+	}
+
+	if (UCurveFloat* Curve = FloatCurves.FindRef(Key))
+	{
+		return Curve;
+	}
+
+	TArray<FRichCurveKey> Keys;
+	Keys.Reserve(Track->Num());
+	for (int32 Index = 0; Index < Track->Num(); ++Index)
+	{
+		Keys.Emplace(Track->Times[Index], Track->Values[Index]);
+	}
+
+	UCurveFloat* Curve = NewObject<UCurveFloat>(this, NAME_None, RF_Transient);
+	Curve->FloatCurve.SetKeys(Keys);
+	FloatCurves.Add(Key, Curve);
+	return Curve;
+}
+
+UCurveVector* UReplayTrackSubsystem::GetVectorCurve(const FString& Name)
+{
+	const FName Key = ReplayNamedColumn::FindName(Name);
+	const TReplayTrack<FVector>* Track = Key.IsNone() ? nullptr : LoadedTracks.GetTracks<FVector>().Find(Key);
+
+	if (!Track)
+	{
+		return nullptr;
+	}
+
+	if (UCurveVector* Curve = VectorCurves.FindRef(Key))
+	{
+		return Curve;
+	}
+
+	TArray<FRichCurveKey> Keys[3];
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Keys[Axis].Reserve(Track->Num());
+		for (int32 Index = 0; Index < Track->Num(); ++Index)
+		{
+			Keys[Axis].Emplace(Track->Times[Index], static_cast<float>(Track->Values[Index][Axis]));
+		}
+	}
+
+	UCurveVector* Curve = NewObject<UCurveVector>(this, NAME_None, RF_Transient);
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Curve->FloatCurves[Axis].SetKeys(Keys[Axis]);
+	}
+	VectorCurves.Add(Key, Curve);
+	return Curve;
+}
+
+void UReplayTrackSubsystem::FlushTracks()
+{
+	const UWorld* World = GetWorld();
+	UDemoNetDriver* DemoDriver = World ? World->GetDemoNetDriver() : nullptr;
+
+	if (!DemoDriver || !DemoDriver->IsRecording())
+	{
+		return;
+	}
+
+	LastFlushTime = DemoDriver->GetDemoCurrentTime();
+
+	if (RecordingTracks.IsEmpty())
+	{
+		return;
+	}
+
+	LLM_SCOPE_BYTAG(ReplaySystem_Tracks);
+
+	RecordingTracks.Simplify();
+
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+	RecordingTracks.Serialize(Writer);
+
+	const int32 ChunkIndex = NextChunkIndex++;
+
+	DemoDriver->AddOrUpdateEvent(FString::Printf(TEXT("Tracks_%06d"), ChunkIndex), ReplayTracks::EventGroup,
+	                             FString::FromInt(ChunkIndex), Data);
+
+	RecordingTracks.Reset();
+}
+
+void UReplayTrackSubsystem::LoadTracks(const FString& ReplayName, FOnLoadReplayTracksComplete OnComplete)
+{
+	const int32 Serial = ++LoadSerial;
+
+	TWeakObjectPtr<UReplayTrackSubsystem> WeakThis = this;
+
+	ReplayTracks::LoadChunks(ReplayName, ReplayTracks::EventGroup,
+	                         [WeakThis, Serial, ReplayName, OnComplete](bool bWasSuccessful, FReplayTrackSet&& Tracks)
+	                         {
+		                         UReplayTrackSubsystem* This = WeakThis.Get();
+
+		                         if (!This || This->LoadSerial != Serial)
+		                         {
+			                         return;
+		                         }
+
+		                         This->LoadedTracks = MoveTemp(Tracks);
+		                         This->LoadedReplayName = ReplayName;
+		                         This->FloatCurves.Reset();
+		                         This->VectorCurves.Reset();
+
+		                         OnComplete.ExecuteIfBound(bWasSuccessful);
+	                         });
+}
+
+bool UReplayTrackSubsystem::GetRecordTime(float& OutTime) const
+{
+	const UDemoNetDriver* DemoDriver = GetWorld()->GetDemoNetDriver();
+
+	if (!DemoDriver || !DemoDriver->IsRecording())
+	{
+		return false;
+	}
+
+	OutTime = DemoDriver->GetDemoCurrentTime();
+	return true;
+}
+
+void UReplayTrackSubsystem::SampleCurves(float Time)
+{
+	LastCurveSampleTime = Time;
+
+	CurveSamplers.RemoveAllSwap([](const FCurveSampler& Sampler) { return !Sampler.Container.IsValid(); });
+
+	for (const FCurveSampler& Sampler : CurveSamplers)
+	{
+		const void* Value = Sampler.Property->ContainerPtrToValuePtr<void>(Sampler.Container.Get());
+
+		if (const FNumericProperty* NumericProperty = CastField<FNumericProperty>(Sampler.Property))
+		{
+			const float Sample = NumericProperty->IsFloatingPoint()
+				                     ? static_cast<float>(NumericProperty->GetFloatingPointPropertyValue(Value))
+				                     : static_cast<float>(NumericProperty->GetSignedIntPropertyValue(Value));
+			RecordingTracks.Record(Sampler.TrackName, Time, Sample);
+		}
+		else
+		{
+			RecordingTracks.Record(Sampler.TrackName, Time, *static_cast<const FVector*>(Value));
+		}
+	}
+}
@@ -0,0 +1,517 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayTracks.h"
+
+#include "NetworkReplayStreaming.h"
+#include "ReplayMemory.h"
+#include "ReplaySystem.h"
+#include "Containers/Ticker.h"
+#include "Serialization/MemoryReader.h"
+
+namespace ReplayTracks
+{
+	namespace Codec
+	{
+		uint64 ZigZag(int64 Value)
+		{
+			return (static_cast<uint64>(Value) << 1) ^ static_cast<uint64>(Value >> 63);
+		}
+
+		int64 UnZigZag(uint64 Value)
+		{
+			return static_cast<int64>(Value >> 1) ^ -static_cast<int64>(Value & 1);
+		}
+
+		//Shortest signed distance around a circle of Range steps
+		int64 WrapDelta(int64 Delta, int64 Range)
+		{
+			Delta %= Range;
+			if (Delta >= Range / 2)
+			{
+				Delta -= Range;
+			}
+			else if (Delta < -(Range / 2))
+			{
+				Delta += Range;
+			}
+			return Delta;
+		}
+
+		/**
+		 *  Serializes keys of NumComponents quantized integers each. Every KeyframeInterval keys a key is stored absolute,
+		 *  the others as the difference to the previous key. Components with a wrap range are angles whose differences
+		 *  are taken the short way around.
+		 */
+		void SerializeQuantized(FArchive& Ar, TArray<int64>& Quantized, int32 NumComponents, int32 KeyframeInterval,
+		                        TConstArrayView<int64> WrapRanges)
+		{
+			int32 NumKeys = Quantized.Num() / NumComponents;
+			Ar << NumKeys;
+
+			if (Ar.IsLoading())
+			{
+				// Every component takes at least a byte, anything claiming more than what is left is corrupt
+				if (NumKeys < 0 || static_cast<int64>(NumKeys) * NumComponents > Ar.TotalSize() - Ar.Tell())
+				{
+					Ar.SetError();
+					return;
+				}
+
+				Quantized.SetNumUninitialized(NumKeys * NumComponents);
+			}
+
+			const int32 Interval = FMath::Max(1, KeyframeInterval);
+
+			for (int32 Key = 0; Key < NumKeys && !Ar.IsError(); ++Key)
+			{
+				const bool bKeyframe = Key % Interval == 0;
+
+				for (int32 Component = 0; Component < NumComponents; ++Component)
+				{
+					int64& Value = Quantized[Key * NumComponents + Component];
+					const int64 Previous = bKeyframe ? 0 : Quantized[(Key - 1) * NumComponents + Component];
+					const int64 WrapRange = WrapRanges.IsValidIndex(Component) ? WrapRanges[Component] : 0;
+
+					uint64 Packed = 0;
+
+					if (Ar.IsSaving())
+					{
+						int64 Delta = Value - Previous;
+						if (!bKeyframe && WrapRange > 0)
+						{
+							Delta = WrapDelta(Delta, WrapRange);
+						}
+						Packed = ZigZag(Delta);
+					}
+
+					Ar.SerializeIntPacked64(Packed);
+
+					if (Ar.IsLoading())
+					{
+						Value = Previous + UnZigZag(Packed);
+					}
+				}
+			}
+		}
+
+		int64 Quantize(double Value, float Precision)
+		{
+			return FMath::RoundToInt64(Value / Precision);
+		}
+
+		int64 QuantizeAngle(double Degrees, float Precision)
+		{
+			return FMath::RoundToInt64(FRotator::NormalizeAxis(Degrees) / Precision);
+		}
+
+		int64 AngleRange(float Precision)
+		{
+			return FMath::Max<int64>(1, FMath::RoundToInt64(360.0 / Precision));
+		}
+	}
+
+	void SerializeTimes(FArchive& Ar, TArray<float>& Times, const FReplayTrackPrecision& Precision)
+	{
+		TArray<int64> Milliseconds;
+
+		if (Ar.IsSaving())
+		{
+			Milliseconds.Reserve(Times.Num());
+			for (const float Time : Times)
+			{
+				Milliseconds.Add(FMath::RoundToInt64(Time * 1000.0));
+			}
+		}
+
+		Codec::SerializeQuantized(Ar, Milliseconds, 1, Precision.KeyframeInterval, {});
+
+		if (Ar.IsLoading())
+		{
+			Times.Reset(Milliseconds.Num());
+			for (const int64 Millisecond : Milliseconds)
+			{
+				Times.Add(static_cast<float>(Millisecond / 1000.0));
+			}
+		}
+	}
+
+	void SerializeValues(FArchive& Ar, TArray<FVector>& Values, const FReplayTrackPrecision& Precision)
+	{
+		if (Precision.Position <= 0.0f)
+		{
+			Ar << Values;
+			return;
+		}
+
+		TArray<int64> Quantized;
+
+		if (Ar.IsSaving())
+		{
+			Quantized.Reserve(Values.Num() * 3);
+			for (const FVector& Value : Values)
+			{
+				Quantized.Add(Codec::Quantize(Value.X, Precision.Position));
+				Quantized.Add(Codec::Quantize(Value.Y, Precision.Position));
+				Quantized.Add(Codec::Quantize(Value.Z, Precision.Position));
+			}
+		}
+
+		Codec::SerializeQuantized(Ar, Quantized, 3, Precision.KeyframeInterval, {});
+
+		if (Ar.IsLoading())
+		{
+			Values.Reset(Quantized.Num() / 3);
+			for (int32 Index = 0; Index + 2 < Quantized.Num(); Index += 3)
+			{
+				Values.Emplace(Quantized[Index] * Precision.Position, Quantized[Index + 1] * Precision.Position,
+				               Quantized[Index + 2] * Precision.Position);
+			}
+		}
+	}
+
+	void SerializeValues(FArchive& Ar, TArray<FRotator>& Values, const FReplayTrackPrecision& Precision)
+	{
+		if (Precision.Rotation <= 0.0f)
+		{
+			Ar << Values;
+			return;
+		}
+
+		const int64 Range = Codec::AngleRange(Precision.Rotation);
+		const int64 WrapRanges[] = {Range, Range, Range};
+		TArray<int64> Quantized;
+
+		if (Ar.IsSaving())
+		{
+			Quantized.Reserve(Values.Num() * 3);
+			for (const FRotator& Value : Values)
+			{
+				Quantized.Add(Codec::QuantizeAngle(Value.Pitch, Precision.Rotation));
+				Quantized.Add(Codec::QuantizeAngle(Value.Yaw, Precision.Rotation));
+				Quantized.Add(Codec::QuantizeAngle(Value.Roll, Precision.Rotation));
+			}
+		}
+
+		Codec::SerializeQuantized(Ar, Quantized, 3, Precision.KeyframeInterval, WrapRanges);
+
+		if (Ar.IsLoading())
+		{
+			Values.Reset(Quantized.Num() / 3);
+			for (int32 Index = 0; Index + 2 < Quantized.Num(); Index += 3)
+			{
+				Values.Emplace(FRotator::NormalizeAxis(Quantized[Index] * Precision.Rotation),
+				               FRotator::NormalizeAxis(Quantized[Index + 1] * Precision.Rotation),
+				               FRotator::NormalizeAxis(Quantized[Index + 2] * Precision.Rotation));
+			}
+		}
+	}
+
+	void SerializeValues(FArchive& Ar, TArray<FTransform>& Values, const FReplayTrackPrecision& Precision)
+	{
+		if (Precision.Position <= 0.0f || Precision.Rotation <= 0.0f || Precision.Scale <= 0.0f)
+		{
+			Ar << Values;
+			return;
+		}
+
+		// Translation, rotation as pitch/yaw/roll, scale
+		const int64 Range = Codec::AngleRange(Precision.Rotation);
+		const int64 WrapRanges[] = {0, 0, 0, Range, Range, Range, 0, 0, 0};
+		TArray<int64> Quantized;
+
+		if (Ar.IsSaving())
+		{
+			Quantized.Reserve(Values.Num() * 9);
+			for (const FTransform& Value : Values)
+			{
+				const FVector Translation = Value.GetTranslation();
+				const FRotator Rotation = Value.Rotator();
+				const FVector Scale = Value.GetScale3D();
+
+				Quantized.Add(Codec::Quantize(Translation.X, Precision.Position));
+				Quantized.Add(Codec::Quantize(Translation.Y, Precision.Position));
+				Quantized.Add(Codec::Quantize(Translation.Z, Precision.Position));
+				Quantized.Add(Codec::QuantizeAngle(Rotation.Pitch, Precision.Rotation));
+				Quantized.Add(Codec::QuantizeAngle(Rotation.Yaw, Precision.Rotation));
+				Quantized.Add(Codec::QuantizeAngle(Rotation.Roll, Precision.Rotation));
+				Quantized.Add(Codec::Quantize(Scale.X, Precision.Scale));
+				Quantized.Add(Codec::Quantize(Scale.Y, Precision.Scale));
+				Quantized.Add(Codec::Quantize(Scale.Z, Precision.Scale));
+			}
+		}
+
+		Codec::SerializeQuantized(Ar, Quantized, 9, Precision.KeyframeInterval, WrapRanges);
+
+		if (Ar.IsLoading())
+		{
+			Values.Reset(Quantized.Num() / 9);
+			for (int32 Index = 0; Index + 8 < Quantized.Num(); Index += 9)
+			{
+				const FVector Translation(Quantized[Index] * Precision.Position,
+				                          Quantized[Index + 1] * Precision.Position,
+				                          Quantized[Index + 2] * Precision.Position);
+				const FRotator Rotation(Quantized[Index + 3] * Precision.Rotation,
+				                        Quantized[Index + 4] * Precision.Rotation,
+				                        Quantized[Index + 5] * Precision.Rotation);
+				const FVector Scale(Quantized[Index + 6] * Precision.Scale, Quantized[Index + 7] * Precision.Scale,
+				                    Quantized[Index + 8] * Precision.Scale);
+
+				Values.Emplace(Rotation, Translation, Scale);
+			}
+		}
+	}
+
+	template <typename ValueType>
+	void AppendTracks(TReplayNamedColumn<TReplayTrack<ValueType>>& Into,
+	                  const TReplayNamedColumn<TReplayTrack<ValueType>>& From)
+	{
+		for (int32 Slot = 0; Slot < From.Num(); ++Slot)
+		{
+			TReplayTrack<ValueType>& Track = Into.FindOrAdd(From.GetName(Slot));
+			if (Track.Num() == 0)
+			{
+				Track.Precision = From.GetValues()[Slot].Precision;
+			}
+			Track.Append(From.GetValues()[Slot]);
+		}
+	}
+
+	template <typename ValueType>
+	void SerializeTracks(FArchive& Ar, TReplayNamedColumn<TReplayTrack<ValueType>>& Tracks, uint8 Version)
+	{
+		int32 NumTracks = Tracks.Num();
+		Ar << NumTracks;
+
+		if (Ar.IsSaving())
+		{
+			for (int32 Slot = 0; Slot < NumTracks; ++Slot)
+			{
+				// Written as a string, name indices are only meaningful inside this process
+				FString Name = Tracks.GetName(Slot).ToString();
+				Ar << Name;
+				Tracks.GetValues()[Slot].Serialize(Ar, Version);
+			}
+			return;
+		}
+
+		if (NumTracks < 0)
+		{
+			Ar.SetError();
+			return;
+		}
+
+		Tracks.Reset();
+		Tracks.Reserve(FMath::Min(NumTracks, 1024));
+		for (int32 Index = 0; Index < NumTracks && !Ar.IsError(); ++Index)
+		{
+			FString Name;
+			Ar << Name;
+			Tracks.FindOrAdd(FName(*Name)).Serialize(Ar, Version);
+		}
+	}
+}
+
+void FReplayTrackSet::Append(const FReplayTrackSet& Other)
+{
+	ReplayTracks::AppendTracks(BoolTracks, Other.BoolTracks);
+	ReplayTracks::AppendTracks(IntTracks, Other.IntTracks);
+	ReplayTracks::AppendTracks(FloatTracks, Other.FloatTracks);
+	ReplayTracks::AppendTracks(VectorTracks, Other.VectorTracks);
+	ReplayTracks::AppendTracks(RotatorTracks, Other.RotatorTracks);
+	ReplayTracks::AppendTracks(TransformTracks, Other.TransformTracks);
+}
+
+void FReplayTrackSet::Serialize(FArchive& Ar)
+{
+	uint8 Version = static_cast<uint8>(ReplayTracks::EChunkVersion::Latest);
+	Ar << Version;
+
+	if (Ar.IsLoading() && Version > static_cast<uint8>(ReplayTracks::EChunkVersion::Latest))
+	{
+		Ar.SetError();
+		return;
+	}
+
+	ReplayTracks::SerializeTracks(Ar, BoolTracks, Version);
+	ReplayTracks::SerializeTracks(Ar, IntTracks, Version);
+	ReplayTracks::SerializeTracks(Ar, FloatTracks, Version);
+	ReplayTracks::SerializeTracks(Ar, VectorTracks, Version);
+	ReplayTracks::SerializeTracks(Ar, RotatorTracks, Version);
+	ReplayTracks::SerializeTracks(Ar, TransformTracks, Version);
+}
+
+bool FReplayTrackSet::IsEmpty() const
+{
+	return BoolTracks.Num() == 0 && IntTracks.Num() == 0 && FloatTracks.Num() == 0 && VectorTracks.Num() == 0 &&
+		RotatorTracks.Num() == 0 && TransformTracks.Num() == 0;
+}
+
+void FReplayTrackSet::Reset()
+{
+	BoolTracks.Reset();
+	IntTracks.Reset();
+	FloatTracks.Reset();
+	VectorTracks.Reset();
+	RotatorTracks.Reset();
+	TransformTracks.Reset();
+}
+
+SIZE_T FReplayTrackSet::GetAllocatedSize() const
+{
+	SIZE_T Size = Precisions.GetAllocatedSize();
+
+	auto AddColumn = [&Size](const auto& Tracks)
+	{
+		Size += Tracks.GetAllocatedSize();
+		for (const auto& Track : Tracks.GetValues())
+		{
+			Size += Track.GetAllocatedSize();
+		}
+	};
+
+	AddColumn(BoolTracks);
+	AddColumn(IntTracks);
+	AddColumn(FloatTracks);
+	AddColumn(VectorTracks);
+	AddColumn(RotatorTracks);
+	AddColumn(TransformTracks);
+
+	return Size;
+}
+
+void FReplayTrackSet::SetPrecision(const FName Name, const FReplayTrackPrecision& Precision)
+{
+	Precisions.Add(Name, Precision);
+}
+
+FReplayTrackPrecision FReplayTrackSet::GetPrecision(const FName Name) const
+{
+	const FReplayTrackPrecision* Precision = Precisions.Find(Name);
+	return Precision ? *Precision : FReplayTrackPrecision();
+}
+
+void FReplayTrackSet::Simplify()
+{
+	for (TReplayTrack<float>& Track : FloatTracks.GetValues())
+	{
+		Track.Simplify(Track.Precision.Tolerance);
+	}
+
+	for (TReplayTrack<FVector>& Track : VectorTracks.GetValues())
+	{
+		Track.Simplify(Track.Precision.Tolerance);
+	}
+}
+
+namespace ReplayTracks
+{
+	struct FPendingLoad
+	{
+		TSharedPtr<INetworkReplayStreamer> Streamer;
+		TArray<TPair<int32, TArray<uint8>>> Chunks;
+		int32 NumPending = 0;
+		bool bFailed = false;
+	};
+
+	void LoadChunks(const FString& ReplayName, const FString& Group,
+	                TFunction<void(bool bWasSuccessful, FReplayTrackSet&& Tracks)> OnComplete)
+	{
+		LLM_SCOPE_BYTAG(ReplaySystem_Tracks);
+
+		const TSharedRef<FPendingLoad> Load = MakeShared<FPendingLoad>();
+		Load->Streamer = FNetworkReplayStreaming::Get().GetFactory().CreateReplayStreamer();
+
+		if (!Load->Streamer.IsValid())
+		{
+			OnComplete(false, FReplayTrackSet());
+			return;
+		}
+
+		const auto Finish = [ReplayName, OnComplete = MoveTemp(OnComplete)](const TSharedRef<FPendingLoad>& Load)
+		{
+			// The streamer holds the callbacks that hold the load, release it once we are out of its callback
+			FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([Load](float)
+			{
+				Load->Streamer.Reset();
+				return false;
+			}));
+
+			LLM_SCOPE_BYTAG(ReplaySystem_Tracks);
+
+			Load->Chunks.Sort([](const TPair<int32, TArray<uint8>>& A, const TPair<int32, TArray<uint8>>& B)
+			{
+				return A.Key < B.Key;
+			});
+
+			FReplayTrackSet Tracks;
+
+			for (const TPair<int32, TArray<uint8>>& Chunk : Load->Chunks)
+			{
+				FReplayTrackSet ChunkTracks;
+				FMemoryReader Reader(Chunk.Value);
+				ChunkTracks.Serialize(Reader);
+
+				if (Reader.IsError())
+				{
+					UE_LOG(LogReplaySystem, Warning, TEXT("Skipping corrupt track chunk %d of replay %s"), Chunk.Key,
+					       *ReplayName);
+					Load->bFailed = true;
+					continue;
+				}
+
+				Tracks.Append(ChunkTracks);
+			}
+
+			OnComplete(!Load->bFailed, MoveTemp(Tracks));
+		};
+
+		Load->Streamer->EnumerateEvents(ReplayName, Group, INDEX_NONE, FEnumerateEventsCallback::CreateLambda(
+			                                [Load, ReplayName, Finish](const FEnumerateEventsResult& Results)
+			                                {
+				                                if (!Results.WasSuccessful())
+				                                {
+					                                Load->bFailed = true;
+					                                Finish(Load);
+					                                return;
+				                                }
+
+				                                Load->NumPending = Results.ReplayEventList.ReplayEvents.Num();
+
+				                                if (Load->NumPending == 0)
+				                                {
+					                                Finish(Load);
+					                                return;
+				                                }
+
+				                                for (const FReplayEventListItem& EventItem : Results.ReplayEventList.
+				                                     ReplayEvents)
+				                                {
+					                                const int32 ChunkIndex = FCString::Atoi(*EventItem.Metadata);
+
+					                                Load->Streamer->RequestEventData(
+						                                ReplayName, EventItem.ID, INDEX_NONE,
+						                                FRequestEventDataCallback::CreateLambda(
+							                                [Load, ChunkIndex, Finish](
+							                                const FRequestEventDataResult& Result)
+							                                {
+								                                LLM_SCOPE_BYTAG(ReplaySystem_Tracks);
+
+								                                if (Result.WasSuccessful())
+								                                {
+									                                Load->Chunks.Emplace(
+										                                ChunkIndex, Result.ReplayEventListItem);
+								                                }
+								                                else
+								                                {
+									                                Load->bFailed = true;
+								                                }
+
+								                                if (--Load->NumPending == 0)
+								                                {
+									                                Finish(Load);
+								                                }
+							                                }));
+				                                }
+			                                }));
+	}
+}
@@ -0,0 +1,560 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayUploadSubsystem.h"
+
+#include "HttpModule.h"
+#include "ReplayFileUtils.h"
+#include "ReplayMemory.h"
+#include "ReplayStateSubsystem.h"
+#include "ReplaySystem.h"
+#include "Async/Async.h"
+#include "Dom/JsonObject.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GenericPlatform/GenericPlatformHttp.h"
+#include "HAL/PlatformFileManager.h"
+#include "Interfaces/IHttpRequest.h"
+#include "Interfaces/IHttpResponse.h"
+#include "Misc/Compression.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+void UReplayUploadSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateUObject(this, &UReplayUploadSubsystem::Tick));
+}
+
+void UReplayUploadSubsystem::Deinitialize()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	TickerHandle.Reset();
+
+	// Responses still on their way are dropped, the server keeps the parts it got for a resume
+	for (const TPair<FString, TSharedRef<FUpload>>& Pair : Uploads)
+	{
+		++Pair.Value->Serial;
+	}
+	Uploads.Empty();
+
+	Super::Deinitialize();
+}
+
+UReplayUploadSubsystem* UReplayUploadSubsystem::Get(const UObject* WorldContextObject)
+{
+	if (const auto World = GEngine->GetWorldFromContextObjectChecked(WorldContextObject))
+	{
+		if (const UGameInstance* GI = World->GetGameInstance())
+		{
+			return GI->GetSubsystem<UReplayUploadSubsystem>();
+		}
+	}
+
+	return nullptr;
+}
+
+bool UReplayUploadSubsystem::UploadReplay(const FString& ReplayName)
+{
+	if (Endpoint.IsEmpty() || ReplayName.IsEmpty())
+	{
+		return false;
+	}
+
+	if (const TSharedRef<FUpload>* Existing = Uploads.Find(ReplayName))
+	{
+		const EReplayUploadState State = (*Existing)->Status.State;
+		if (State != EReplayUploadState::Complete && State != EReplayUploadState::Failed)
+		{
+			return false;
+		}
+	}
+
+	const TSharedRef<FUpload> Upload = MakeShared<FUpload>();
+	Upload->Status.ReplayName = ReplayName;
+	Upload->Status.State = EReplayUploadState::Resuming;
+	Uploads.Add(ReplayName, Upload);
+
+	RequestReceivedParts(Upload);
+	return true;
+}
+
+void UReplayUploadSubsystem::CancelUpload(const FString& ReplayName)
+{
+	if (const TSharedRef<FUpload>* Upload = Uploads.Find(ReplayName))
+	{
+		++(*Upload)->Serial;
+		Uploads.Remove(ReplayName);
+	}
+}
+
+bool UReplayUploadSubsystem::GetUploadStatus(const FString& ReplayName, FReplayUploadStatus& OutStatus) const
+{
+	if (const TSharedRef<FUpload>* Upload = Uploads.Find(ReplayName))
+	{
+		OutStatus = (*Upload)->Status;
+		return true;
+	}
+
+	return false;
+}
+
+bool UReplayUploadSubsystem::Tick(float DeltaTime)
+{
+	WatchRecording();
+
+	const double Now = FPlatformTime::Seconds();
+
+	// Copied since finishing an upload broadcasts and listeners may start or cancel uploads
+	TArray<TSharedRef<FUpload>> Active;
+	Uploads.GenerateValueArray(Active);
+
+	for (const TSharedRef<FUpload>& Upload : Active)
+	{
+		const EReplayUploadState State = Upload->Status.State;
+		if (State != EReplayUploadState::Live && State != EReplayUploadState::Finishing)
+		{
+			continue;
+		}
+
+		if (!Upload->bFinalized && !Upload->bScanning && Now - Upload->LastScanTime >= ScanInterval)
+		{
+			Scan(Upload);
+		}
+
+		Pump(Upload);
+	}
+
+	return true;
+}
+
+void UReplayUploadSubsystem::WatchRecording()
+{
+	if (!bUploadWhileRecording || Endpoint.IsEmpty())
+	{
+		return;
+	}
+
+	const UWorld* World = GetGameInstance()->GetWorld();
+	const UReplayStateSubsystem* StateSubsystem = World ? World->GetSubsystem<UReplayStateSubsystem>() : nullptr;
+
+	if (!StateSubsystem || !StateSubsystem->GetPlaybackState().bIsRecording)
+	{
+		return;
+	}
+
+	// The upload finishes on its own once the streamer has finalized the replay
+	const FString& ReplayName = StateSubsystem->GetPlaybackState().ReplayName;
+	if (ReplayName != RecordingReplayName)
+	{
+		RecordingReplayName = ReplayName;
+		UploadReplay(ReplayName);
+	}
+}
+
+void UReplayUploadSubsystem::RequestReceivedParts(const TSharedRef<FUpload>& Upload)
+{
+	const TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = CreateRequest(
+		Upload->Status.ReplayName, TEXT("parts"), TEXT("GET"));
+
+	const int32 Serial = Upload->Serial;
+	TWeakObjectPtr<UReplayUploadSubsystem> WeakThis(this);
+
+	Request->OnProcessRequestComplete().BindLambda(
+		[WeakThis, Upload, Serial](FHttpRequestPtr, FHttpResponsePtr Response, bool bConnectedSuccessfully)
+		{
+			if (!WeakThis.IsValid() || Upload->Serial != Serial)
+			{
+				return;
+			}
+
+			const int32 ResponseCode = Response.IsValid() ? Response->GetResponseCode() : 0;
+
+			if (!bConnectedSuccessfully || (!EHttpResponseCodes::IsOk(ResponseCode) && ResponseCode !=
+				EHttpResponseCodes::NotFound))
+			{
+				WeakThis->Finish(Upload, false, FString::Printf(
+					                 TEXT("Could not ask the server for the parts it has (%d)"), ResponseCode));
+				return;
+			}
+
+			// A server that has never seen the replay answers 404
+			TSharedPtr<FJsonObject> Json;
+			const TArray<TSharedPtr<FJsonValue>>* Parts = nullptr;
+
+			if (EHttpResponseCodes::IsOk(ResponseCode) && FJsonSerializer::Deserialize(
+				TJsonReaderFactory<>::Create(Response->GetContentAsString()), Json) && Json.IsValid() && Json->
+				TryGetArrayField(TEXT("parts"), Parts))
+			{
+				for (const TSharedPtr<FJsonValue>& Part : *Parts)
+				{
+					int64 Offset = 0;
+					if (Part.IsValid() && Part->TryGetNumber(Offset))
+					{
+						Upload->Received.Add(Offset);
+					}
+				}
+			}
+
+			UE_LOG(LogReplaySystem, Log, TEXT("Uploading replay %s, the server has %d part(s)"),
+			       *Upload->Status.ReplayName, Upload->Received.Num());
+
+			Upload->Status.State = EReplayUploadState::Live;
+			WeakThis->Scan(Upload);
+		});
+
+	Request->ProcessRequest();
+}
+
+void UReplayUploadSubsystem::Scan(const TSharedRef<FUpload>& Upload)
+{
+	Upload->bScanning = true;
+	Upload->LastScanTime = FPlatformTime::Seconds();
+
+	const FString ReplayName = Upload->Status.ReplayName;
+	const int64 PartSize = FMath::Max(MaxPartSize, 64 * 1024);
+	const int32 Serial = Upload->Serial;
+	TWeakObjectPtr<UReplayUploadSubsystem> WeakThis(this);
+
+	Async(EAsyncExecution::ThreadPool, [WeakThis, Upload, Serial, ReplayName, PartSize]()
+	{
+		LLM_SCOPE_BYTAG(ReplaySystem_Upload);
+
+		const TUniquePtr<IFileHandle> File(FPlatformFileManager::Get().GetPlatformFile().OpenRead(
+			*ReplayFileUtils::GetReplayFilename(ReplayName), true));
+
+		ReplayFileUtils::FReplayFileLayout Layout;
+		const bool bReadable = File.IsValid() && ReplayFileUtils::ReadLayout(*File, Layout);
+
+		// Once finalized nothing changes anymore and everything can be sent, before that only what is never rewritten
+		const bool bIsFinalized = bReadable && !Layout.bIsLive && !Layout.bTruncated;
+
+		TArray<FPart> Parts;
+		auto AddRange = [&Parts, PartSize](int64 Offset, int64 Size)
+		{
+			for (int64 PartOffset = Offset; PartOffset < Offset + Size; PartOffset += PartSize)
+			{
+				FPart& Part = Parts.AddDefaulted_GetRef();
+				Part.Offset = PartOffset;
+				Part.Size = FMath::Min(PartSize, Offset + Size - PartOffset);
+			}
+		};
+
+		if (bIsFinalized)
+		{
+			AddRange(0, Layout.HeaderSize);
+		}
+
+		for (const ReplayFileUtils::FChunk& Chunk : Layout.Chunks)
+		{
+			if (bIsFinalized || Chunk.ChunkType == ELocalFileChunkType::ReplayData || Chunk.ChunkType ==
+				ELocalFileChunkType::Checkpoint)
+			{
+				AddRange(Chunk.TypeOffset, Chunk.DataOffset + Chunk.SizeInBytes - Chunk.TypeOffset);
+			}
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Upload, Serial, bReadable, bIsFinalized,
+			          FileSize = Layout.FileSize, Parts = MoveTemp(Parts)]() mutable
+		          {
+			          if (!WeakThis.IsValid() || Upload->Serial != Serial)
+			          {
+				          return;
+			          }
+
+			          if (!bReadable)
+			          {
+				          WeakThis->Finish(Upload, false, TEXT("The replay file could not be read"));
+				          return;
+			          }
+
+			          WeakThis->OnScanned(Upload, bIsFinalized, FileSize, MoveTemp(Parts));
+		          });
+	});
+}
+
+void UReplayUploadSubsystem::OnScanned(const TSharedRef<FUpload>& Upload, bool bIsFinalized, int64 FileSize,
+                                       TArray<FPart>&& Parts)
+{
+	Upload->bScanning = false;
+
+	for (const FPart& Part : Parts)
+	{
+		if (Upload->Received.Contains(Part.Offset))
+		{
+			++Upload->Status.PartsUploaded;
+			Upload->Status.BytesUploaded += Part.Size;
+
+			// Counted once
+			Upload->Received.Remove(Part.Offset);
+			Upload->Known.Add(Part.Offset);
+		}
+		else if (!Upload->Known.Contains(Part.Offset))
+		{
+			Upload->Known.Add(Part.Offset);
+			Upload->Queue.Add(Part);
+		}
+	}
+
+	if (bIsFinalized)
+	{
+		Upload->bFinalized = true;
+		Upload->FileSize = FileSize;
+		Upload->FinalParts = MoveTemp(Parts);
+		Upload->Status.State = EReplayUploadState::Finishing;
+	}
+
+	Upload->Status.PartsPending = Upload->Queue.Num() + Upload->NumInFlight;
+	Pump(Upload);
+}
+
+void UReplayUploadSubsystem::Pump(const TSharedRef<FUpload>& Upload)
+{
+	if (Upload->Status.State != EReplayUploadState::Live && Upload->Status.State != EReplayUploadState::Finishing)
+	{
+		return;
+	}
+
+	if (Upload->bFinalized && !Upload->bCompleting && Upload->Queue.Num() == 0 && Upload->NumInFlight == 0)
+	{
+		Complete(Upload);
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	const FString ReplayName = Upload->Status.ReplayName;
+	const int32 Serial = Upload->Serial;
+	TWeakObjectPtr<UReplayUploadSubsystem> WeakThis(this);
+
+	// A part is only read once a slot is free, so parts wait on disk rather than in memory while the server is slow
+	while (Upload->NumInFlight < FMath::Max(MaxConcurrentUploads, 1))
+	{
+		const int32 Index = Upload->Queue.IndexOfByPredicate([Now](const FPart& Part)
+		{
+			return Part.RetryTime <= Now;
+		});
+
+		if (Index == INDEX_NONE)
+		{
+			break;
+		}
+
+		const FPart Part = Upload->Queue[Index];
+		Upload->Queue.RemoveAt(Index);
+		++Upload->NumInFlight;
+
+		Async(EAsyncExecution::ThreadPool, [WeakThis, Upload, Serial, ReplayName, Part]()
+		{
+			LLM_SCOPE_BYTAG(ReplaySystem_Upload);
+
+			TArray<uint8> Data;
+			uint32 Crc = 0;
+			FReplayMemory::FCounter RawCounter(EReplayMemoryCategory::Upload);
+
+			const TUniquePtr<IFileHandle> File(FPlatformFileManager::Get().GetPlatformFile().OpenRead(
+				*ReplayFileUtils::GetReplayFilename(ReplayName), true));
+
+			TArray<uint8> Raw;
+			Raw.SetNumUninitialized(static_cast<int32>(Part.Size));
+			RawCounter.Set(Raw.GetAllocatedSize());
+
+			if (File.IsValid() && File->Seek(Part.Offset) && File->Read(Raw.GetData(), Raw.Num()))
+			{
+				Crc = FCrc::MemCrc32(Raw.GetData(), Raw.Num());
+
+				int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Gzip, Raw.Num());
+				Data.SetNumUninitialized(CompressedSize);
+
+				if (FCompression::CompressMemory(NAME_Gzip, Data.GetData(), CompressedSize, Raw.GetData(), Raw.Num()))
+				{
+					Data.SetNum(CompressedSize);
+				}
+				else
+				{
+					Data.Reset();
+				}
+			}
+
+			// The compressed part is held until the request for it completes
+			FReplayMemory::Add(EReplayMemoryCategory::Upload, Data.GetAllocatedSize());
+
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, Upload, Serial, Part, Data = MoveTemp(Data), Crc]() mutable
+			{
+				if (!WeakThis.IsValid() || Upload->Serial != Serial)
+				{
+					FReplayMemory::Add(EReplayMemoryCategory::Upload, -static_cast<int64>(Data.GetAllocatedSize()));
+					return;
+				}
+
+				if (Data.Num() == 0)
+				{
+					FReplayMemory::Add(EReplayMemoryCategory::Upload, -static_cast<int64>(Data.GetAllocatedSize()));
+					WeakThis->OnPartSent(Upload, Part, false);
+					return;
+				}
+
+				WeakThis->SendPart(Upload, Part, MoveTemp(Data), Crc);
+			});
+		});
+	}
+
+	Upload->Status.PartsPending = Upload->Queue.Num() + Upload->NumInFlight;
+}
+
+void UReplayUploadSubsystem::SendPart(const TSharedRef<FUpload>& Upload, FPart Part, TArray<uint8>&& Data, uint32 Crc)
+{
+	LLM_SCOPE_BYTAG(ReplaySystem_Upload);
+
+	const TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = CreateRequest(
+		Upload->Status.ReplayName, FString::Printf(TEXT("parts/%lld"), Part.Offset), TEXT("PUT"));
+
+	Request->SetHeader(TEXT("Content-Type"), TEXT("application/octet-stream"));
+	Request->SetHeader(TEXT("Content-Encoding"), TEXT("gzip"));
+	Request->SetHeader(TEXT("X-Replay-Part-Size"), LexToString(Part.Size));
+	Request->SetHeader(TEXT("X-Replay-Part-Crc"), FString::Printf(TEXT("%08x"), Crc));
+
+	const int64 SentBytes = Data.Num();
+	const int64 HeldBytes = Data.GetAllocatedSize();
+	Request->SetContent(MoveTemp(Data));
+
+	const int32 Serial = Upload->Serial;
+	TWeakObjectPtr<UReplayUploadSubsystem> WeakThis(this);
+
+	Request->OnProcessRequestComplete().BindLambda(
+		[WeakThis, Upload, Serial, Part, SentBytes, HeldBytes](FHttpRequestPtr, FHttpResponsePtr Response,
+		                                                       bool bConnectedSuccessfully)
+		{
+			FReplayMemory::Add(EReplayMemoryCategory::Upload, -HeldBytes);
+
+			if (!WeakThis.IsValid() || Upload->Serial != Serial)
+			{
+				return;
+			}
+
+			Upload->Status.BytesSent += SentBytes;
+			WeakThis->OnPartSent(Upload, Part, bConnectedSuccessfully && Response.IsValid() &&
+			                     EHttpResponseCodes::IsOk(Response->GetResponseCode()));
+		});
+
+	Request->ProcessRequest();
+}
+
+void UReplayUploadSubsystem::OnPartSent(const TSharedRef<FUpload>& Upload, FPart Part, bool bWasSuccessful)
+{
+	--Upload->NumInFlight;
+
+	if (bWasSuccessful)
+	{
+		++Upload->Status.PartsUploaded;
+		Upload->Status.BytesUploaded += Part.Size;
+	}
+	else if (++Part.Attempts >= MaxAttempts)
+	{
+		Finish(Upload, false, FString::Printf(TEXT("The part at %lld could not be uploaded"), Part.Offset));
+		return;
+	}
+	else
+	{
+		// Back off so a struggling server is not hammered
+		Part.RetryTime = FPlatformTime::Seconds() + FMath::Pow(2.0, Part.Attempts);
+		Upload->Queue.Add(Part);
+	}
+
+	Pump(Upload);
+}
+
+void UReplayUploadSubsystem::Complete(const TSharedRef<FUpload>& Upload)
+{
+	Upload->bCompleting = true;
+
+	const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+	Json->SetNumberField(TEXT("size"), static_cast<double>(Upload->FileSize));
+
+	TArray<TSharedPtr<FJsonValue>> Parts;
+	for (const FPart& Part : Upload->FinalParts)
+	{
+		const TSharedRef<FJsonObject> PartJson = MakeShared<FJsonObject>();
+		PartJson->SetNumberField(TEXT("offset"), static_cast<double>(Part.Offset));
+		PartJson->SetNumberField(TEXT("size"), static_cast<double>(Part.Size));
+		Parts.Add(MakeShared<FJsonValueObject>(PartJson));
+	}
+	Json->SetArrayField(TEXT("parts"), Parts);
+
+	FString Body;
+	FJsonSerializer::Serialize(Json, TJsonWriterFactory<>::Create(&Body));
+
+	const TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = CreateRequest(
+		Upload->Status.ReplayName, TEXT("complete"), TEXT("POST"));
+	Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
+	Request->SetContentAsString(Body);
+
+	const int32 Serial = Upload->Serial;
+	TWeakObjectPtr<UReplayUploadSubsystem> WeakThis(this);
+
+	Request->OnProcessRequestComplete().BindLambda(
+		[WeakThis, Upload, Serial](FHttpRequestPtr, FHttpResponsePtr Response, bool bConnectedSuccessfully)
+		{
+			if (!WeakThis.IsValid() || Upload->Serial != Serial)
+			{
+				return;
+			}
+
+			const int32 ResponseCode = Response.IsValid() ? Response->GetResponseCode() : 0;
+			if (bConnectedSuccessfully && EHttpResponseCodes::IsOk(ResponseCode))
+			{
+				WeakThis->Finish(Upload, true, FString());
+			}
+			else
+			{
+				WeakThis->Finish(Upload, false, FString::Printf(
+					                 TEXT("The server did not complete the replay (%d)"), ResponseCode));
+			}
+		});
+
+	Request->ProcessRequest();
+}
+
+void UReplayUploadSubsystem::Finish(const TSharedRef<FUpload>& Upload, bool bWasSuccessful, const FString& Error)
+{
+	// Responses still in flight are ignored from here on
+	++Upload->Serial;
+
+	Upload->Queue.Reset();
+	Upload->NumInFlight = 0;
+	Upload->Status.PartsPending = 0;
+	Upload->Status.State = bWasSuccessful ? EReplayUploadState::Complete : EReplayUploadState::Failed;
+	Upload->Status.Error = Error;
+
+	if (bWasSuccessful)
+	{
+		UE_LOG(LogReplaySystem, Log, TEXT("Uploaded replay %s, %lld bytes sent for %lld"), *Upload->Status.ReplayName,
+		       Upload->Status.BytesSent, Upload->FileSize);
+	}
+	else
+	{
+		UE_LOG(LogReplaySystem, Warning, TEXT("Upload of replay %s failed: %s"), *Upload->Status.ReplayName, *Error);
+	}
+
+	OnUploadFinished.Broadcast(Upload->Status);
+}
+
+TSharedRef<IHttpRequest, ESPMode::ThreadSafe> UReplayUploadSubsystem::CreateRequest(
+	const FString& ReplayName, const FString& Path, const FString& Verb) const
+{
+	const TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+
+	FString Url = Endpoint;
+	Url.RemoveFromEnd(TEXT("/"));
+
+	Request->SetURL(FString::Printf(TEXT("%s/%s/%s"), *Url, *FGenericPlatformHttp::UrlEncode(ReplayName), *Path));
+	Request->SetVerb(Verb);
+
+	if (!Authorization.IsEmpty())
+	{
+		Request->SetHeader(TEXT("Authorization"), Authorization);
+	}
+
+	return Request;
+}
@@ -0,0 +1,284 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayTestServer.h"
+#include "ReplayCacheProxy.h"
+#include "HttpModule.h"
+#include "HttpServerRequest.h"
+#include "HttpServerResponse.h"
+#include "GenericPlatform/GenericPlatformHttp.h"
+#include "HAL/FileManager.h"
+#include "Interfaces/IHttpRequest.h"
+#include "Interfaces/IHttpResponse.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ReplayCacheProxyTest
+{
+	const int32 UpstreamPort = 18251;
+
+	const int32 ProxyPort = 18252;
+
+	const double Timeout = 10.0;
+
+	const TCHAR* Authorization = TEXT("Bearer replay-cache-test");
+
+	//Needs encoding in a query, the proxy gets it decoded
+	const TCHAR* Token = TEXT("a b&c=d/e");
+
+	struct FUpstreamRequest
+	{
+		FString Path;
+
+		TMap<FString, FString> QueryParams;
+
+		FString Authorization;
+	};
+
+	struct FState
+	{
+		//Every request the stand-in replay server got, in order
+		TArray<FUpstreamRequest> UpstreamRequests;
+
+		//The response to the last request through the proxy, 0 while it is on its way
+		int32 ResponseCode = 0;
+
+		FString ResponseBody;
+
+		int32 CountUpstream(const FString& File) const
+		{
+			return UpstreamRequests.FilterByPredicate([&File](const FUpstreamRequest& Request)
+			{
+				return Request.Path.EndsWith(File);
+			}).Num();
+		}
+
+		const FUpstreamRequest* FindLastUpstream(const FString& File) const
+		{
+			for (int32 Index = UpstreamRequests.Num() - 1; Index >= 0; --Index)
+			{
+				if (UpstreamRequests[Index].Path.EndsWith(File))
+				{
+					return &UpstreamRequests[Index];
+				}
+			}
+
+			return nullptr;
+		}
+	};
+
+	/**
+	 *  Answers every stream chunk with its own path, so the test can tell which one came back
+	 */
+	FHttpRequestHandler MakeUpstreamHandler(const TSharedRef<FState>& State)
+	{
+		return FHttpRequestHandler::CreateLambda(
+			[State](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+			{
+				FUpstreamRequest& Upstream = State->UpstreamRequests.AddDefaulted_GetRef();
+				Upstream.Path = Request.RelativePath.GetPath();
+				Upstream.QueryParams = Request.QueryParams;
+				Upstream.Authorization = FReplayTestServer::FindHeader(Request, TEXT("Authorization"));
+
+				OnComplete(FHttpServerResponse::Create(TEXT("chunk ") + FPaths::GetCleanFilename(Upstream.Path),
+				                                       TEXT("application/octet-stream")));
+				return true;
+			});
+	}
+
+	/**
+	 *  Sends a request for a path of the test session through the proxy
+	 */
+	void Send(const TSharedRef<FState>& State, const FString& Verb, const FString& Path)
+	{
+		State->ResponseCode = 0;
+		State->ResponseBody.Reset();
+
+		const TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+		Request->SetURL(FString::Printf(TEXT("http://127.0.0.1:%d/replay/TestSession%s"), ProxyPort, *Path));
+		Request->SetVerb(Verb);
+		Request->SetHeader(TEXT("Authorization"), Authorization);
+		Request->OnProcessRequestComplete().BindLambda(
+			[State](FHttpRequestPtr, FHttpResponsePtr Response, bool bConnectedSuccessfully)
+			{
+				State->ResponseCode = bConnectedSuccessfully && Response.IsValid() ? Response->GetResponseCode() : -1;
+				State->ResponseBody = Response.IsValid() ? Response->GetContentAsString() : FString();
+			});
+		Request->ProcessRequest();
+	}
+
+	/**
+	 *  Requests a stream chunk of the test session through the proxy
+	 */
+	void Get(const TSharedRef<FState>& State, int32 ChunkIndex, bool bWithToken)
+	{
+		FString Path = FString::Printf(TEXT("/file/stream.%d"), ChunkIndex);
+		if (bWithToken)
+		{
+			Path += TEXT("?token=") + FGenericPlatformHttp::UrlEncode(Token);
+		}
+
+		Send(State, TEXT("GET"), Path);
+	}
+
+	int32 CountCacheFiles(const FString& CacheDirectory)
+	{
+		TArray<FString> Filenames;
+		IFileManager::Get().FindFiles(Filenames, *CacheDirectory, TEXT(".cache"));
+		return Filenames.Num();
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FReplayCacheProxyTest, "ReplaySystem.CacheProxy.CacheReadAheadAndRefetch",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FReplayCacheProxyTest::RunTest(const FString& Parameters)
+{
+	using namespace ReplayCacheProxyTest;
+
+	const TSharedRef<FState> State = MakeShared<FState>();
+	const TSharedRef<FReplayTestServer> Upstream = MakeShared<FReplayTestServer>(
+		UpstreamPort, MakeUpstreamHandler(State));
+
+	if (!TestTrue(TEXT("The stand-in replay server listens"), Upstream->IsListening()))
+	{
+		return false;
+	}
+
+	const FString CacheDirectory = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("ReplayCacheProxyTest"));
+	IFileManager::Get().DeleteDirectory(*CacheDirectory, false, true);
+	IFileManager::Get().MakeDirectory(*CacheDirectory, true);
+
+	FReplayCacheProxy::FSettings Settings;
+	Settings.UpstreamURL = Upstream->GetURL();
+	Settings.ListenPort = ProxyPort;
+	Settings.MaxCacheBytes = 1024 * 1024;
+	Settings.ReadAheadChunks = 2;
+	Settings.MaxConcurrentReadAheads = 1;
+	Settings.CacheDirectory = CacheDirectory;
+
+	const TSharedRef<FReplayCacheProxy> Proxy = MakeShared<FReplayCacheProxy>(MoveTemp(Settings));
+
+	if (!TestTrue(TEXT("The proxy listens"), Proxy->Start()))
+	{
+		return false;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	const auto TimedOut = [this, StartTime](const TCHAR* What)
+	{
+		if (FPlatformTime::Seconds() - StartTime < Timeout)
+		{
+			return false;
+		}
+
+		AddError(FString::Printf(TEXT("Timed out waiting for %s"), What));
+		return true;
+	};
+
+	// The first request goes to the server with its headers and query, the next chunks are read ahead
+	Get(State, 0, true);
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, State, CacheDirectory, TimedOut]()
+	{
+		if ((State->ResponseCode == 0 || State->CountUpstream(TEXT("stream.2")) == 0 || CountCacheFiles(
+			CacheDirectory) < 3) && !TimedOut(TEXT("the first chunk and its read ahead")))
+		{
+			return false;
+		}
+
+		TestEqual(TEXT("The first chunk is answered"), State->ResponseCode, 200);
+		TestEqual(TEXT("The first chunk is the one asked for"), State->ResponseBody, FString(TEXT("chunk stream.0")));
+
+		if (const FUpstreamRequest* Request = State->FindLastUpstream(TEXT("stream.0")))
+		{
+			TestEqual(TEXT("The query value reaches the server intact"), Request->QueryParams.FindRef(TEXT("token")),
+			          FString(Token));
+			TestEqual(TEXT("The headers reach the server"), Request->Authorization, FString(Authorization));
+		}
+		else
+		{
+			AddError(TEXT("The first chunk was not asked of the server"));
+		}
+
+		for (const TCHAR* File : {TEXT("stream.1"), TEXT("stream.2")})
+		{
+			const FUpstreamRequest* Request = State->FindLastUpstream(File);
+			TestTrue(FString::Printf(TEXT("%s is read ahead with the request's headers"), File),
+			         Request && Request->Authorization == Authorization);
+		}
+
+		TestEqual(TEXT("Read ahead stops after ReadAheadChunks"), State->CountUpstream(TEXT("stream.3")), 0);
+
+		Get(State, 1, false);
+		return true;
+	}));
+
+	// A chunk that was read ahead comes from the cache
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, State, CacheDirectory, TimedOut]()
+	{
+		if (State->ResponseCode == 0 && !TimedOut(TEXT("a cached chunk")))
+		{
+			return false;
+		}
+
+		TestEqual(TEXT("The cached chunk is answered"), State->ResponseCode, 200);
+		TestEqual(TEXT("The cached chunk is the one asked for"), State->ResponseBody,
+		          FString(TEXT("chunk stream.1")));
+		TestEqual(TEXT("The cached chunk is not asked of the server again"), State->CountUpstream(TEXT("stream.1")),
+		          1);
+
+		// Losing the cache files has the proxy fetch the chunk again, with the headers of the request that wants it
+		TArray<FString> Filenames;
+		IFileManager::Get().FindFiles(Filenames, *CacheDirectory, TEXT(".cache"));
+		for (const FString& Filename : Filenames)
+		{
+			IFileManager::Get().Delete(*FPaths::Combine(CacheDirectory, Filename), false, true, true);
+		}
+
+		Get(State, 2, false);
+		return true;
+	}));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, State, TimedOut]()
+	{
+		if (State->ResponseCode == 0 && !TimedOut(TEXT("a chunk whose cache file is gone")))
+		{
+			return false;
+		}
+
+		TestEqual(TEXT("The chunk whose cache file is gone is answered"), State->ResponseCode, 200);
+		TestEqual(TEXT("The chunk is asked of the server again"), State->CountUpstream(TEXT("stream.2")), 2);
+
+		const FUpstreamRequest* Request = State->FindLastUpstream(TEXT("stream.2"));
+		TestTrue(TEXT("The chunk is asked again with the request's headers"),
+		         Request && Request->Authorization == Authorization);
+
+		// Only playback requests are passed on, the proxy is not a way to change replays on the server
+		Send(State, TEXT("POST"), TEXT("/file/replay.header"));
+		return true;
+	}));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, State, Upstream, Proxy, CacheDirectory, TimedOut]()
+	{
+		if (State->ResponseCode == 0 && !TimedOut(TEXT("a request that is not for playback")))
+		{
+			return false;
+		}
+
+		TestEqual(TEXT("A request that is not for playback is refused"), State->ResponseCode, 403);
+		TestEqual(TEXT("A request that is not for playback does not reach the server"),
+		          State->CountUpstream(TEXT("replay.header")), 0);
+
+		Proxy->Stop();
+		Proxy->ClearCache();
+		IFileManager::Get().DeleteDirectory(*CacheDirectory, false, true);
+		return true;
+	}));
+
+	return true;
+}
+
+#endif
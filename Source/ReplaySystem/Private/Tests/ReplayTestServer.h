@@ -0,0 +1,83 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "HttpPath.h"
+#include "HttpRouteHandle.h"
+#include "HttpServerModule.h"
+#include "HttpServerRequest.h"
+#include "IHttpRouter.h"
+
+/**
+ *  A stand-in replay server for the automation tests. Every request to a local port goes to one handler, which sees
+ *  the full path of the request
+ */
+class FReplayTestServer
+{
+public:
+	FReplayTestServer(int32 InPort, const FHttpRequestHandler& Handler)
+		: Port(InPort)
+	{
+		Router = FHttpServerModule::Get().GetHttpRouter(Port, true);
+
+		if (Router.IsValid())
+		{
+			RouteHandle = Router->BindRoute(FHttpPath(TEXT("/")),
+			                                EHttpServerRequestVerbs::VERB_GET | EHttpServerRequestVerbs::VERB_POST |
+			                                EHttpServerRequestVerbs::VERB_PUT | EHttpServerRequestVerbs::VERB_DELETE,
+			                                Handler);
+			FHttpServerModule::Get().StartAllListeners();
+		}
+	}
+
+	~FReplayTestServer()
+	{
+		if (Router.IsValid() && RouteHandle.IsValid())
+		{
+			Router->UnbindRoute(RouteHandle);
+		}
+	}
+
+	bool IsListening() const { return Router.IsValid() && RouteHandle.IsValid(); }
+
+	FString GetURL() const { return FString::Printf(TEXT("http://127.0.0.1:%d/"), Port); }
+
+	/**
+	 *  A header of a request, whatever case the client sent its name in
+	 */
+	static FString FindHeader(const FHttpServerRequest& Request, const FString& Name)
+	{
+		for (const TPair<FString, TArray<FString>>& Header : Request.Headers)
+		{
+			if (Header.Key.Equals(Name, ESearchCase::IgnoreCase) && Header.Value.Num() > 0)
+			{
+				return Header.Value[0];
+			}
+		}
+
+		return FString();
+	}
+
+	/**
+	 *  The segments of a request's path, e.g. {"replays", "Name", "parts"}
+	 */
+	static TArray<FString> GetPathSegments(const FHttpServerRequest& Request)
+	{
+		TArray<FString> Segments;
+		Request.RelativePath.GetPath().ParseIntoArray(Segments, TEXT("/"));
+		return Segments;
+	}
+
+private:
+	int32 Port = 0;
+
+	TSharedPtr<IHttpRouter> Router;
+
+	FHttpRouteHandle RouteHandle;
+};
+
+#endif
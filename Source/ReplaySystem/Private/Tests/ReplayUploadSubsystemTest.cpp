@@ -0,0 +1,354 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#include "ReplayTestServer.h"
+#include "ReplayFileUtils.h"
+#include "ReplayUploadSubsystem.h"
+#include "Dom/JsonObject.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HttpServerRequest.h"
+#include "HttpServerResponse.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/MemoryWriter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ReplayUploadTest
+{
+	const TCHAR* ReplayName = TEXT("ReplayUploadTest");
+
+	const int32 Port = 18241;
+
+	//Upper bound on the whole upload, the retry alone waits two seconds
+	const double Timeout = 30.0;
+
+	//What the stand-in server has and has seen
+	struct FServerState
+	{
+		//Uncompressed parts by offset
+		TMap<int64, TArray<uint8>> Parts;
+
+		//Uploads per part offset, failed ones included
+		TMap<int64, int32> Puts;
+
+		int32 NumPartListRequests = 0;
+
+		//The part whose first upload is answered with an error
+		int64 FailOffset = INDEX_NONE;
+
+		double FailTime = 0.0;
+
+		double RetryTime = 0.0;
+
+		int32 NumCompletes = 0;
+
+		//The replay put together from the parts the completion listed
+		TArray<uint8> Assembled;
+
+		bool bAssembled = false;
+
+		FString Error;
+	};
+
+	/**
+	 *  A finalized local file replay: the header, a header chunk and two stream data chunks, the first one larger than
+	 *  a part
+	 * @param OutChunkOffsets Where each chunk starts
+	 */
+	TArray<uint8> MakeReplay(TArray<int64>& OutChunkOffsets)
+	{
+		TArray<uint8> Replay;
+		FMemoryWriter Writer(Replay);
+
+		uint32 MagicNumber = FLocalFileNetworkReplayStreamer::FileMagic;
+		uint32 FileVersion = static_cast<uint32>(ELocalFileVersionHistory::HISTORY_INITIAL);
+		int32 LengthInMS = 10000;
+		uint32 NetworkVersion = 1;
+		uint32 Changelist = 1;
+		FString FriendlyName = TEXT("Upload test");
+		uint32 IsLive = 0;
+
+		Writer << MagicNumber << FileVersion << LengthInMS << NetworkVersion << Changelist << FriendlyName << IsLive;
+
+		const ELocalFileChunkType ChunkTypes[] = {
+			ELocalFileChunkType::Header, ELocalFileChunkType::ReplayData, ELocalFileChunkType::ReplayData
+		};
+		const int32 ChunkSizes[] = {256, 100 * 1024, 20 * 1024};
+
+		FRandomStream Random(1234);
+
+		for (int32 Index = 0; Index < UE_ARRAY_COUNT(ChunkTypes); ++Index)
+		{
+			OutChunkOffsets.Add(Writer.Tell());
+
+			uint32 ChunkType = static_cast<uint32>(ChunkTypes[Index]);
+			int32 SizeInBytes = ChunkSizes[Index];
+			Writer << ChunkType << SizeInBytes;
+
+			for (int32 Byte = 0; Byte < SizeInBytes; ++Byte)
+			{
+				uint8 Value = static_cast<uint8>(Random.RandRange(0, 255));
+				Writer << Value;
+			}
+		}
+
+		return Replay;
+	}
+
+	bool HandlePartList(FServerState& State, const FHttpResultCallback& OnComplete)
+	{
+		++State.NumPartListRequests;
+
+		TArray<TSharedPtr<FJsonValue>> Offsets;
+		for (const TPair<int64, TArray<uint8>>& Part : State.Parts)
+		{
+			Offsets.Add(MakeShared<FJsonValueNumber>(static_cast<double>(Part.Key)));
+		}
+
+		const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+		Json->SetArrayField(TEXT("parts"), Offsets);
+
+		FString Body;
+		FJsonSerializer::Serialize(Json, TJsonWriterFactory<>::Create(&Body));
+
+		OnComplete(FHttpServerResponse::Create(Body, TEXT("application/json")));
+		return true;
+	}
+
+	bool HandlePart(FServerState& State, const FHttpServerRequest& Request, int64 Offset,
+	                const FHttpResultCallback& OnComplete)
+	{
+		++State.Puts.FindOrAdd(Offset);
+
+		if (Offset == State.FailOffset)
+		{
+			if (State.FailTime == 0.0)
+			{
+				State.FailTime = FPlatformTime::Seconds();
+				OnComplete(FHttpServerResponse::Error(EHttpServerResponseCodes::ServerError));
+				return true;
+			}
+
+			State.RetryTime = FPlatformTime::Seconds();
+		}
+
+		int32 Size = 0;
+		LexFromString(Size, *FReplayTestServer::FindHeader(Request, TEXT("X-Replay-Part-Size")));
+
+		TArray<uint8> Part;
+		Part.SetNumUninitialized(Size);
+
+		if (Size <= 0 || !FCompression::UncompressMemory(NAME_Gzip, Part.GetData(), Size, Request.Body.GetData(),
+		                                                 Request.Body.Num()))
+		{
+			State.Error = FString::Printf(TEXT("The part at %lld is not gzip compressed"), Offset);
+			OnComplete(FHttpServerResponse::Error(EHttpServerResponseCodes::BadRequest));
+			return true;
+		}
+
+		const FString Crc = FString::Printf(TEXT("%08x"), FCrc::MemCrc32(Part.GetData(), Part.Num()));
+		if (!Crc.Equals(FReplayTestServer::FindHeader(Request, TEXT("X-Replay-Part-Crc")), ESearchCase::IgnoreCase))
+		{
+			State.Error = FString::Printf(TEXT("The part at %lld does not match its CRC"), Offset);
+			OnComplete(FHttpServerResponse::Error(EHttpServerResponseCodes::BadRequest));
+			return true;
+		}
+
+		State.Parts.Add(Offset, MoveTemp(Part));
+		OnComplete(FHttpServerResponse::Ok());
+		return true;
+	}
+
+	bool HandleComplete(FServerState& State, const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+	{
+		++State.NumCompletes;
+
+		const FString Body = FString(FUTF8ToTCHAR(reinterpret_cast<const ANSICHAR*>(Request.Body.GetData()),
+		                                          Request.Body.Num()));
+
+		TSharedPtr<FJsonObject> Json;
+		int64 Size = 0;
+		const TArray<TSharedPtr<FJsonValue>>* Parts = nullptr;
+
+		if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Body), Json) || !Json.IsValid() || !Json->
+			TryGetNumberField(TEXT("size"), Size) || !Json->TryGetArrayField(TEXT("parts"), Parts))
+		{
+			State.Error = TEXT("The completion is not the expected JSON");
+			OnComplete(FHttpServerResponse::Error(EHttpServerResponseCodes::BadRequest));
+			return true;
+		}
+
+		// Put the replay together the way a real server would, from the parts the completion lists
+		State.Assembled.SetNumZeroed(static_cast<int32>(Size));
+		State.bAssembled = true;
+
+		for (const TSharedPtr<FJsonValue>& Value : *Parts)
+		{
+			const TSharedPtr<FJsonObject>* PartJson = nullptr;
+			int64 Offset = 0;
+			int64 PartSize = 0;
+
+			const TArray<uint8>* Part = Value.IsValid() && Value->TryGetObject(PartJson) && (*PartJson)->
+			                            TryGetNumberField(TEXT("offset"), Offset) && (*PartJson)->TryGetNumberField(
+				                            TEXT("size"), PartSize)
+				                            ? State.Parts.Find(Offset)
+				                            : nullptr;
+
+			if (!Part || Part->Num() != PartSize || Offset + PartSize > Size)
+			{
+				State.Error = FString::Printf(TEXT("The completion lists a part at %lld the server does not have"),
+				                              Offset);
+				State.bAssembled = false;
+				break;
+			}
+
+			FMemory::Memcpy(State.Assembled.GetData() + Offset, Part->GetData(), PartSize);
+		}
+
+		OnComplete(State.bAssembled
+			           ? FHttpServerResponse::Ok()
+			           : FHttpServerResponse::Error(EHttpServerResponseCodes::BadRequest));
+		return true;
+	}
+
+	/**
+	 *  Answers the requests of UReplayUploadSubsystem under <Endpoint>/<Name>/...
+	 */
+	FHttpRequestHandler MakeHandler(const TSharedRef<FServerState>& State)
+	{
+		return FHttpRequestHandler::CreateLambda(
+			[State](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+			{
+				const TArray<FString> Segments = FReplayTestServer::GetPathSegments(Request);
+				const FString Last = Segments.Num() > 0 ? Segments.Last() : FString();
+
+				if (Request.Verb == EHttpServerRequestVerbs::VERB_GET && Last == TEXT("parts"))
+				{
+					return HandlePartList(*State, OnComplete);
+				}
+
+				int64 Offset = 0;
+				if (Request.Verb == EHttpServerRequestVerbs::VERB_PUT && Segments.Num() >= 2 && Segments.Last(1) ==
+					TEXT("parts") && LexTryParseString(Offset, *Last))
+				{
+					return HandlePart(*State, Request, Offset, OnComplete);
+				}
+
+				if (Request.Verb == EHttpServerRequestVerbs::VERB_POST && Last == TEXT("complete"))
+				{
+					return HandleComplete(*State, Request, OnComplete);
+				}
+
+				OnComplete(FHttpServerResponse::Error(EHttpServerResponseCodes::NotFound));
+				return true;
+			});
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FReplayUploadResumeTest, "ReplaySystem.Upload.ResumeRetryComplete",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FReplayUploadResumeTest::RunTest(const FString& Parameters)
+{
+	using namespace ReplayUploadTest;
+
+	TArray<int64> ChunkOffsets;
+	const TArray<uint8> Replay = MakeReplay(ChunkOffsets);
+	const FString Filename = ReplayFileUtils::GetReplayFilename(ReplayName);
+
+	if (!TestTrue(TEXT("The test replay is written"), FFileHelper::SaveArrayToFile(Replay, *Filename)))
+	{
+		return false;
+	}
+
+	// An earlier upload got the file header and the header chunk across before it stopped
+	const TSharedRef<FServerState> State = MakeShared<FServerState>();
+	State->Parts.Add(0, TArray<uint8>(Replay.GetData(), static_cast<int32>(ChunkOffsets[0])));
+	State->Parts.Add(ChunkOffsets[0], TArray<uint8>(Replay.GetData() + ChunkOffsets[0],
+	                                                static_cast<int32>(ChunkOffsets[1] - ChunkOffsets[0])));
+	State->FailOffset = ChunkOffsets[2];
+
+	const TSharedRef<FReplayTestServer> Server = MakeShared<FReplayTestServer>(Port, MakeHandler(State));
+
+	if (!TestTrue(TEXT("The stand-in server listens"), Server->IsListening()))
+	{
+		IFileManager::Get().Delete(*Filename, false, true, true);
+		return false;
+	}
+
+	UGameInstance* GameInstance = NewObject<UGameInstance>(GEngine);
+	GameInstance->AddToRoot();
+	GameInstance->InitializeStandalone();
+
+	UReplayUploadSubsystem* Upload = GameInstance->GetSubsystem<UReplayUploadSubsystem>();
+	Upload->Endpoint = Server->GetURL() + TEXT("replays");
+	Upload->MaxPartSize = 64 * 1024;
+	Upload->MaxAttempts = 3;
+	Upload->bUploadWhileRecording = false;
+
+	TestTrue(TEXT("The upload starts"), Upload->UploadReplay(ReplayName));
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand(
+		[this, State, Server, GameInstance, Upload, Replay, ChunkOffsets, Filename, StartTime]()
+		{
+			FReplayUploadStatus Status;
+			const bool bHasStatus = Upload->GetUploadStatus(ReplayName, Status);
+			const bool bFinished = bHasStatus && (Status.State == EReplayUploadState::Complete || Status.State ==
+				EReplayUploadState::Failed);
+
+			if (!bFinished && FPlatformTime::Seconds() - StartTime < Timeout)
+			{
+				return false;
+			}
+
+			if (!TestTrue(TEXT("The upload completes"), Status.State == EReplayUploadState::Complete))
+			{
+				AddInfo(Status.Error);
+			}
+
+			if (!State->Error.IsEmpty())
+			{
+				AddError(State->Error);
+			}
+
+			// Resume
+			TestEqual(TEXT("The parts the server has are asked for once"), State->NumPartListRequests, 1);
+			TestEqual(TEXT("The file header part is not sent again"), State->Puts.FindRef(0), 0);
+			TestEqual(TEXT("The header chunk part is not sent again"), State->Puts.FindRef(ChunkOffsets[0]), 0);
+			TestEqual(TEXT("Every part is counted, resumed ones included"), Status.PartsUploaded, 5);
+
+			// Retry with backoff
+			TestEqual(TEXT("The failed part is sent twice"), State->Puts.FindRef(ChunkOffsets[2]), 2);
+			TestTrue(TEXT("The failed part is retried after the backoff"),
+			         State->RetryTime - State->FailTime >= 1.9);
+
+			// Completion
+			TestEqual(TEXT("The replay is completed once"), State->NumCompletes, 1);
+			TestTrue(TEXT("The completion lists parts the server has"), State->bAssembled);
+			TestTrue(TEXT("The assembled replay matches the file"), State->Assembled == Replay);
+
+			UWorld* World = GameInstance->GetWorld();
+			GameInstance->Shutdown();
+			if (World)
+			{
+				GEngine->DestroyWorldContext(World);
+				World->DestroyWorld(false);
+			}
+			GameInstance->RemoveFromRoot();
+
+			IFileManager::Get().Delete(*Filename, false, true, true);
+			return true;
+		}));
+
+	return true;
+}
+
+#endif
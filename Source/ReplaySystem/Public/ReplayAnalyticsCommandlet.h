@@ -0,0 +1,27 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ReplayAnalyticsCommandlet.generated.h"
+
+/**
+ *  Runs the replay analytics hooks over many replays in parallel. Every replay is played by its own headless game
+ *  process (-nullrhi, fixed time step, see UReplayAnalyticsSubsystem) so the work scales across cores.
+ *
+ *  UnrealEditor-Cmd <Project> -run=ReplayAnalytics [-Replays=A+B] [-Jobs=N] [-Speed=64] [-Fps=30] [-Map=<Map>]
+ *		[-Hooks=<ClassPath>+<ClassPath>] [-Out=<Dir>] [-Timeout=<Seconds>]
+ *
+ *  Without -Replays every replay in the replay save path is processed.
+ */
+UCLASS()
+class REPLAYSYSTEM_API UReplayAnalyticsCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UReplayAnalyticsCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,52 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "ReplayAnalyticsHook.generated.h"
+
+/**
+ *  Base class for analytics run over replays by the headless replay analytics runner (see UReplayAnalyticsCommandlet).
+ *  One instance is created per replay once it starts playing. Use GetWorld() or bind to the UReplayStateSubsystem
+ *  events of the replay world in OnReplayStarted to sample actor state.
+ */
+UCLASS(Abstract, Blueprintable, BlueprintType)
+class REPLAYSYSTEM_API UReplayAnalyticsHook : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual UWorld* GetWorld() const override;
+
+	/**
+	 *  Called once the replay has started playing
+	 * @param ReplayName The name the replay is saved as on disk
+	 */
+	UFUNCTION(BlueprintNativeEvent, Category = "ReplaySystem|Analytics")
+	void OnReplayStarted(const FString& ReplayName);
+
+	/**
+	 *  Called every SampleInterval seconds of replay time
+	 * @param ReplayTime The current time in seconds of the replay
+	 */
+	UFUNCTION(BlueprintNativeEvent, Category = "ReplaySystem|Analytics")
+	void OnSample(float ReplayTime);
+
+	/**
+	 *  Called when the replay has finished playing (or the runner gave up on it)
+	 * @param ReplayName The name the replay is saved as on disk
+	 * @return The result of this hook, written to the replay's result file (json is a good fit)
+	 */
+	UFUNCTION(BlueprintNativeEvent, Category = "ReplaySystem|Analytics")
+	FString OnReplayFinished(const FString& ReplayName);
+
+	//How often, in seconds of replay time, OnSample is called. 0 calls it every frame
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "ReplaySystem|Analytics")
+	float SampleInterval = 1.0f;
+
+	//The replay time at which OnSample is next due
+	float NextSampleTime = 0.0f;
+
+	TWeakObjectPtr<UWorld> ReplayWorld;
+};
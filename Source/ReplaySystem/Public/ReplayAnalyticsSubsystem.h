@@ -0,0 +1,74 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "ReplayAnalyticsSubsystem.generated.h"
+
+class UReplayAnalyticsHook;
+
+/**
+ *  Worker side of the headless replay analytics runner. Only created when the game is started with
+ *  -ReplayAnalytics=<ReplayName>: plays that replay as fast as possible with world rendering disabled, drives the
+ *  configured UReplayAnalyticsHook classes, writes their results to -ReplayAnalyticsOut=<Dir> and exits.
+ *  UReplayAnalyticsCommandlet launches one of these per replay.
+ */
+UCLASS(config = Game)
+class REPLAYSYSTEM_API UReplayAnalyticsSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	//Hooks run over every replay, -ReplayAnalyticsHooks=<Path>+<Path> on the command line replaces these
+	UPROPERTY(Config)
+	TArray<TSoftClassPtr<UReplayAnalyticsHook>> HookClasses;
+
+	//Playback speed used when -ReplayAnalyticsSpeed is not given
+	UPROPERTY(Config)
+	float PlaybackSpeed = 64.0f;
+
+	//Give up on a replay that has not started playing after this many seconds
+	UPROPERTY(Config)
+	float LoadTimeoutSeconds = 120.0f;
+
+protected:
+	enum class EState : uint8
+	{
+		WaitingForWorld,
+		Loading,
+		Playing,
+		Finished
+	};
+
+	bool Tick(float DeltaTime);
+
+	void StartPlaying(UWorld* World);
+
+	void Finish(bool bWasSuccessful);
+
+	UFUNCTION()
+	void HandleReplayComplete();
+
+	EState State = EState::WaitingForWorld;
+
+	FString ReplayName;
+
+	FString OutputDirectory;
+
+	double StartTime = 0.0;
+
+	double LoadStartTime = 0.0;
+
+	bool bReachedEnd = false;
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UReplayAnalyticsHook>> Hooks;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+};
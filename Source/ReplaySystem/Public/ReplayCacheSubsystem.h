@@ -0,0 +1,69 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "ReplayCacheSubsystem.generated.h"
+
+class FReplayCacheProxy;
+
+/**
+ *  Runs a local caching proxy in front of a remote replay server for the HTTP replay streamer. Point the streamer's
+ *  server URL at GetProxyURL() for playback and its requests are forwarded to UpstreamURL; requests to record, change
+ *  or delete replays are refused since anyone who can reach the port could send them. Stream chunks and event data
+ *  (checkpoints included) of finished replays never change, so those responses are kept in an LRU cache on disk and
+ *  seeking back to a part played before does not download it again. When a stream chunk is asked for, the chunks
+ *  after it are fetched ahead of playback, more of them the faster the replay is played.
+ */
+UCLASS(config = Game)
+class REPLAYSYSTEM_API UReplayCacheSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	static UReplayCacheSubsystem* Get(const UObject* WorldContextObject);
+
+	/**
+	 *  The URL to give the HTTP replay streamer as its server, empty if the proxy is not running
+	 */
+	FString GetProxyURL() const;
+
+	/**
+	 *  Deletes every cached response
+	 */
+	void ClearCache();
+
+	/**
+	 *  Size of the cache on disk in bytes
+	 */
+	int64 GetCacheSize() const;
+
+	//The replay server requests are forwarded to, the proxy is off while empty
+	UPROPERTY(Config)
+	FString UpstreamURL;
+
+	//Local port the proxy listens on
+	UPROPERTY(Config)
+	int32 ListenPort = 19410;
+
+	//Largest size of the cache on disk, the least recently used responses are deleted past it
+	UPROPERTY(Config)
+	int32 MaxCacheMB = 1024;
+
+	//Stream chunks fetched ahead of the one asked for at normal speed, scaled by the playback speed
+	UPROPERTY(Config)
+	int32 ReadAheadChunks = 2;
+
+	//Read ahead requests in flight at the same time
+	UPROPERTY(Config)
+	int32 MaxConcurrentReadAheads = 4;
+
+protected:
+	float GetPlaybackSpeed() const;
+
+	TSharedPtr<FReplayCacheProxy> Proxy;
+};
@@ -0,0 +1,42 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ *  Cuts a time range out of a replay saved by the local file streamer into a standalone replay, copying the recorded
+ *  chunks as they are instead of playing the replay back. The clip keeps the stream data up to the end of the range
+ *  (checkpoints point into the stream by offset, so it cannot be cut at the front), the last checkpoint before the
+ *  start of the range and every checkpoint and event inside it. A marker event records the range so playing the clip
+ *  goes straight to its start.
+ */
+class REPLAYSYSTEM_API FReplayClip
+{
+public:
+	/**
+	 *  Writes a clip on a worker thread
+	 * @param ReplayName The name the replay is saved as on disk
+	 * @param ClipName The name the clip is saved as, an existing replay of that name is replaced
+	 * @param StartTime Start of the range in seconds
+	 * @param EndTime End of the range in seconds
+	 * @param OnComplete Called on the game thread
+	 */
+	static void Extract(const FString& ReplayName, const FString& ClipName, float StartTime, float EndTime,
+	                    TFunction<void(bool)> OnComplete);
+
+	/**
+	 *  Writes a clip on the calling thread. Unlike Extract it leaves the search index and the cached event indexes of a
+	 *  replay the clip replaced to the caller
+	 */
+	static bool ExtractClip(const FString& ReplayName, const FString& ClipName, float StartTime, float EndTime);
+
+	/**
+	 *  Reads the range a clip was cut from. Safe on any thread
+	 * @return False if the replay is not a clip
+	 */
+	static bool GetClipRange(const FString& ReplayName, float& OutStartTime, float& OutEndTime);
+
+	//Group of the marker event written into clips
+	static const FString ClipGroup;
+};
@@ -1,29 +1,71 @@
-﻿// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.   
-#pragma once
-
-#include "CoreMinimal.h"
-#include "ReplayStructs.h"
-#include "ReplayDelegates.generated.h"
-
-class APawn;
-
-UDELEGATE()
-DECLARE_DYNAMIC_DELEGATE_OneParam(FOnRequestEventsComplete,const TArray<FReplayEvent>&, Events);
-
-UDELEGATE()
-DECLARE_DYNAMIC_DELEGATE_OneParam(FOnRenameReplayComplete, bool, bWasSuccessful);
-
-UDELEGATE()
-DECLARE_DYNAMIC_DELEGATE_OneParam(FOnGetReplaysComplete,const TArray<FReplayInfo> &, Replays);
-
-UDELEGATE()
-DECLARE_DYNAMIC_DELEGATE_OneParam(FOnGetEventDataComplete,const TArray<uint8> &, Data);
-
-UDELEGATE()
-DECLARE_DYNAMIC_DELEGATE_OneParam(FOnDeleteReplayComplete, bool, bWasSuccessful);
-
-UDELEGATE()
-DECLARE_DYNAMIC_DELEGATE_OneParam(FOnGotoTimeComplete, const bool ,bWasSuccessful);
-
-UDELEGATE()
-DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnReplayComplete);
+﻿// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.   
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplayStructs.h"
+#include "ReplayDelegates.generated.h"
+
+class APawn;
+
+UDELEGATE()
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnRequestEventsComplete,const TArray<FReplayEvent>&, Events);
+
+UDELEGATE()
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnRenameReplayComplete, bool, bWasSuccessful);
+
+UDELEGATE()
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnGetReplaysComplete,const TArray<FReplayInfo> &, Replays);
+
+UDELEGATE()
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnGetEventDataComplete,const TArray<uint8> &, Data);
+
+UDELEGATE()
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnDeleteReplayComplete, bool, bWasSuccessful);
+
+UDELEGATE()
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnGotoTimeComplete, const bool ,bWasSuccessful);
+
+UDELEGATE()
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnPrefetchReplayComplete, const FReplayPrefetchInfo&, Info);
+
+UDELEGATE()
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnLoadReplayTracksComplete, bool, bWasSuccessful);
+
+UDELEGATE()
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FOnQueryReplayEventsComplete, bool, bWasSuccessful, const TArray<FReplayIndexedEvent>&, Events);
+
+UDELEGATE()
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnReplayEventListReady, const FReplayEventList&, EventList);
+
+UDELEGATE()
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnRequestReplayEventListsComplete, const TArray<FReplayEventList>&, EventLists);
+
+UDELEGATE()
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnVerifyReplaysComplete, const TArray<FReplayIntegrityResult>&, Results);
+
+UDELEGATE()
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FOnExtractReplayClipComplete, bool, bWasSuccessful, const FString&, ClipName);
+
+UDELEGATE()
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnReplayUploadFinished, const FReplayUploadStatus&, Status);
+
+UDELEGATE()
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnReplayComplete);
+
+UDELEGATE()
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnReplayPlaybackEvent);
+
+UDELEGATE()
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnReplayStreamEvent, const FString&, ReplayName);
+
+UDELEGATE()
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnReplaySpeedChanged, float, Speed);
+
+UDELEGATE()
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnReplaySeekStarted, float, TargetTime);
+
+UDELEGATE()
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnReplaySeekFinished, bool, bWasSuccessful, float, CurrentTime);
+
+UDELEGATE()
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnReplayCheckpointSaved, float, GameThreadMS, int32, Frames);
@@ -0,0 +1,52 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplayStructs.h"
+
+class INetworkReplayStreamer;
+
+/**
+ *  Enumerates the events of many replays at once. Up to MaxConcurrent replays are enumerated at the same time, each
+ *  lane reusing one streamer for the replays it works through. Results are handed out per replay as they finish and
+ *  merged, in the order the replays were asked for, once all are done.
+ */
+class REPLAYSYSTEM_API FReplayEventBatch : public TSharedFromThis<FReplayEventBatch>
+{
+public:
+	DECLARE_DELEGATE_OneParam(FOnEventListReady, const FReplayEventList&);
+	DECLARE_DELEGATE_OneParam(FOnComplete, const TArray<FReplayEventList>&);
+
+	/**
+	 *  Starts enumerating the events of every replay
+	 * @param ReplayNames The names the replays are saved as on disk
+	 * @param Group Only events of this group, empty for every event
+	 * @param MaxConcurrent How many replays are enumerated at the same time
+	 * @param OnEventListReady Called for every replay as soon as its events are known
+	 * @param OnComplete Called once with the events of every replay
+	 */
+	static void Start(const TArray<FString>& ReplayNames, const FString& Group, int32 MaxConcurrent,
+	                  FOnEventListReady OnEventListReady, FOnComplete OnComplete);
+
+private:
+	void StartNext(int32 Lane);
+
+	void HandleEnumerated(int32 Lane, int32 ReplayIndex, bool bWasSuccessful, const TArray<FReplayEvent>& Events);
+
+	void Finish();
+
+	FString Group;
+
+	TArray<FReplayEventList> Results;
+
+	TArray<TSharedPtr<INetworkReplayStreamer>> Streamers;
+
+	int32 NextReplay = 0;
+
+	int32 NumRemaining = 0;
+
+	FOnEventListReady OnEventListReady;
+
+	FOnComplete OnComplete;
+};
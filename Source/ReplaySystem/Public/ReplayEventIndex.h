@@ -0,0 +1,84 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplayStructs.h"
+
+namespace ReplayEventMetadata
+{
+	//Marks event metadata written by Encode, metadata without it is a plain string
+	inline const TCHAR* Prefix = TEXT("RSM1:");
+
+	/**
+	 *  Packs typed metadata into the string stored with a replay event
+	 */
+	REPLAYSYSTEM_API FString Encode(TConstArrayView<FReplayMetadataValue> Values);
+
+	/**
+	 *  Unpacks metadata written by Encode
+	 * @return False if the metadata was not written by Encode or is corrupt
+	 */
+	REPLAYSYSTEM_API bool Decode(const FString& Metadata, TArray<FReplayMetadataValue>& OutValues);
+}
+
+/**
+ *  A secondary index over the events of one replay. Chosen metadata keys are indexed by value so events can be found
+ *  by equality or range without fetching every event. The index is written into the replay as a single event.
+ */
+class REPLAYSYSTEM_API FReplayEventIndex
+{
+public:
+	/**
+	 *  Adds an event, replacing an earlier event of the same ID. Only the values of IndexedKeys are indexed
+	 */
+	void Add(const FReplayIndexedEvent& Event, const TSet<FName>& IndexedKeys);
+
+	/**
+	 *  Adds every event of another index, replacing earlier events of the same ID. The keys the other index indexed are
+	 *  indexed for them
+	 */
+	void Append(const FReplayEventIndex& Other);
+
+	/**
+	 *  Events whose metadata has Value under its key. Ints and floats compare by value
+	 */
+	void FindEqual(const FReplayMetadataValue& Value, TArray<FReplayIndexedEvent>& OutEvents) const;
+
+	/**
+	 *  Events with an int or float value within [Min, Max] under Key
+	 */
+	void FindInRange(const FName Key, double Min, double Max, TArray<FReplayIndexedEvent>& OutEvents) const;
+
+	TConstArrayView<FReplayIndexedEvent> GetEvents() const { return Events; }
+
+	void Serialize(FArchive& Ar);
+
+	bool IsEmpty() const { return Events.Num() == 0; }
+
+	void Reset();
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	struct FKeyIndex
+	{
+		//Sorted by value
+		TArray<TPair<double, int32>> Numbers;
+
+		//Sorted by value
+		TArray<TPair<FString, int32>> Strings;
+
+		bool bSorted = true;
+	};
+
+	void SortKeys();
+
+	void AddSlots(const TArray<int32>& Slots, TArray<FReplayIndexedEvent>& OutEvents) const;
+
+	TArray<FReplayIndexedEvent> Events;
+
+	TMap<FString, int32> EventSlots;
+
+	TMap<FName, FKeyIndex> Keys;
+};
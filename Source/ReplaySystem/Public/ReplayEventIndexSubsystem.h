@@ -0,0 +1,130 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ReplayDelegates.h"
+#include "ReplayEventIndex.h"
+#include "ReplayMemory.h"
+#include "ReplayEventIndexSubsystem.generated.h"
+
+/**
+ *  Adds events with typed metadata to the replay being recorded and keeps a secondary index over the values of the
+ *  IndexedKeys. Every FlushInterval seconds and when recording stops, the events added or updated since the last write
+ *  are written into the replay as an index chunk (group "ReplayEventIndex"), so finding events by metadata only has to
+ *  fetch those few events. Once a recording stops its index is also merged into FReplaySearchIndex to search across
+ *  replays.
+ */
+UCLASS(config = Game)
+class REPLAYSYSTEM_API UReplayEventIndexSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	static UReplayEventIndexSubsystem* Get(const UObject* WorldContextObject);
+
+	/**
+	 *  Adds an event to the replay being recorded with its metadata encoded by ReplayEventMetadata::Encode
+	 * @return False if no replay is being recorded
+	 */
+	bool AddEvent(const FString& EventId, const FString& Group, const TArray<FReplayMetadataValue>& Metadata,
+	              const TArray<uint8>& Data);
+
+	/**
+	 *  Indexes an event added to the replay being recorded without typed metadata, so it can be found by group and ID.
+	 *  An event indexed before under the same ID is replaced
+	 */
+	void IndexEvent(const FString& EventId, const FString& Group);
+
+	/**
+	 *  Sets the metadata keys indexed for events added from now on
+	 */
+	void SetIndexedKeys(const TArray<FName>& Keys);
+
+	/**
+	 *  Writes the events indexed since the last write into the replay being recorded
+	 */
+	void FlushIndex();
+
+	/**
+	 *  Finds the events of a replay whose metadata has a value
+	 * @param ReplayName The name the replay is saved as on disk
+	 * @param Value The key and value to match, ints and floats compare by value
+	 * @param OnComplete 
+	 */
+	void FindEvents(const FString& ReplayName, const FReplayMetadataValue& Value, FOnQueryReplayEventsComplete OnComplete);
+
+	/**
+	 *  Finds the events of a replay whose metadata has an int or float value within [Min, Max]
+	 * @param ReplayName The name the replay is saved as on disk
+	 * @param Key The metadata key
+	 * @param Min 
+	 * @param Max 
+	 * @param OnComplete 
+	 */
+	void FindEventsInRange(const FString& ReplayName, FName Key, double Min, double Max,
+	                       FOnQueryReplayEventsComplete OnComplete);
+
+	/**
+	 *  Loads the event index of a replay, cached after the first load
+	 * @param ReplayName The name the replay is saved as on disk
+	 * @param OnComplete Called with null if the replay has no readable index
+	 */
+	void LoadIndex(const FString& ReplayName, TFunction<void(TSharedPtr<const FReplayEventIndex>)> OnComplete);
+
+	/**
+	 *  Forgets the cached index of a replay, e.g. after it was deleted or recorded again
+	 */
+	void InvalidateIndex(const FString& ReplayName);
+
+	//The metadata keys whose values are indexed
+	UPROPERTY(Config)
+	TArray<FName> IndexedKeys;
+
+	//Seconds of replay time between two updates of the index written into the replay
+	UPROPERTY(Config)
+	float FlushInterval = 30.0f;
+
+protected:
+	/**
+	 *  Hands the index of the recording that just stopped to FReplaySearchIndex
+	 */
+	void PublishRecordingIndex();
+
+	/**
+	 *  Reports the memory held by the recording and loaded indexes, at most once a second since it visits every event
+	 */
+	void UpdateMemory();
+
+	//Every event of the replay being recorded
+	FReplayEventIndex RecordingIndex;
+
+	//The events added or updated since the index was last written
+	FReplayEventIndex PendingIndex;
+
+	TSet<FName> IndexedKeySet;
+
+	FString RecordingReplayName;
+
+	int32 NextChunkIndex = 0;
+
+	float LastFlushTime = 0.0f;
+
+	FDelegateHandle RecordingStoppingHandle;
+
+	TMap<FString, TSharedPtr<const FReplayEventIndex>> LoadedIndexes;
+
+	FReplayMemory::FCounter MemoryCounter{EReplayMemoryCategory::Index};
+
+	//Whether the indexes changed since the memory was last reported
+	bool bMemoryDirty = false;
+
+	double LastMemoryUpdateTime = 0.0;
+};
@@ -0,0 +1,90 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include <atomic>
+
+class INetworkReplayStreamer;
+
+struct FQueuedReplayEvent
+{
+	//Demo time the event was submitted at
+	uint32 TimeInMS = 0;
+
+	//The recording the event was submitted to, events of an earlier recording are dropped
+	uint32 RecordingSerial = 0;
+
+	FString EventId;
+
+	FString Group;
+
+	FString Metadata;
+
+	TArray<uint8> Data;
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return sizeof(FQueuedReplayEvent) + EventId.GetAllocatedSize() + Group.GetAllocatedSize() + Metadata.
+			GetAllocatedSize() + Data.GetAllocatedSize();
+	}
+};
+
+/**
+ *  Lets any thread add events to the replay being recorded. Events are pushed into a lock free multi producer queue,
+ *  tagged with the demo time of the last game thread frame, and written into the replay when the game thread drains
+ *  the queue once per frame (UReplayStateSubsystem does this for the world that records).
+ */
+class REPLAYSYSTEM_API FReplayEventQueue
+{
+public:
+	static FReplayEventQueue& Get();
+
+	/**
+	 *  Queues an event for the replay being recorded. Safe to call from any thread
+	 * @return False if no replay is being recorded
+	 */
+	bool Enqueue(FString EventId, FString Group, FString Metadata, TArray<uint8> Data);
+
+	bool IsRecording() const
+	{
+		return bIsRecording.load(std::memory_order_acquire);
+	}
+
+	//Demo time of the last frame published by the game thread
+	uint32 GetRecordingTimeInMS() const
+	{
+		return RecordingTimeInMS.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 *  Starts accepting events for a new recording. Game thread only
+	 */
+	void StartRecording(uint32 TimeInMS);
+
+	/**
+	 *  Publishes the demo time new events are tagged with. Game thread only
+	 */
+	void SetRecordingTime(uint32 TimeInMS);
+
+	/**
+	 *  Stops accepting events and drops the ones not written yet. Game thread only
+	 */
+	void StopRecording();
+
+	/**
+	 *  Writes every queued event of the current recording into the streamer. Game thread only
+	 * @return The number of events written
+	 */
+	int32 Drain(INetworkReplayStreamer& Streamer);
+
+private:
+	TQueue<FQueuedReplayEvent, EQueueMode::Mpsc> Events;
+
+	std::atomic<uint32> RecordingTimeInMS{0};
+
+	std::atomic<uint32> RecordingSerial{0};
+
+	std::atomic<bool> bIsRecording{false};
+};
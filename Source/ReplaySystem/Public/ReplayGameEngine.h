@@ -0,0 +1,29 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/GameEngine.h"
+#include "ReplayGameEngine.generated.h"
+
+/**
+ *  Game engine that duplicates the dynamic levels of chosen maps when they load, which is what lets a replay play inside
+ *  the live world (see PlayInstantReplay). Enable it with GameEngine=/Script/ReplaySystem.ReplayGameEngine under
+ *  [/Script/Engine.Engine] in DefaultEngine.ini.
+ */
+UCLASS(config = Engine)
+class REPLAYSYSTEM_API UReplayGameEngine : public UGameEngine
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool Experimental_ShouldPreDuplicateMap(const FName MapName) const override;
+
+	//Maps (short or long package names) whose levels are duplicated on load so they can play instant replays
+	UPROPERTY(Config, EditAnywhere, Category = "Replay")
+	TArray<FString> InstantReplayMaps;
+
+	//Duplicate the levels of every map, doubles the memory used by dynamic levels
+	UPROPERTY(Config, EditAnywhere, Category = "Replay")
+	bool bInstantReplayOnAllMaps = false;
+};
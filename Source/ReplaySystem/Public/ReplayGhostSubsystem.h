@@ -0,0 +1,136 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ReplayDelegates.h"
+#include "ReplayMemory.h"
+#include "ReplayStructs.h"
+#include "ReplayTracks.h"
+#include "ReplayGhostSubsystem.generated.h"
+
+/**
+ *  Records where the key actors of a match are (every player pawn, named "Player_<PlayerId>", and the actors tagged
+ *  GhostActorTag or added with AddGhostActor) a few times a second into a small side track of the replay, so a timeline can show everyone's
+ *  position at any time without seeking. Positions are quantized to PositionPrecision and written as chunks of their
+ *  own event group ("ReplayGhosts"), loading them reads a few small events instead of the replay stream. Next to its
+ *  positions every ghost has a bool track of the same name marking when it appeared and went away, so a late sample
+ *  is not mistaken for a ghost that was gone.
+ */
+UCLASS(config = Game)
+class REPLAYSYSTEM_API UReplayGhostSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	static UReplayGhostSubsystem* Get(const UObject* WorldContextObject);
+
+	/**
+	 *  Records the position of an actor while it exists
+	 * @param Actor
+	 * @param Name The name it is shown with, the actor name if empty
+	 */
+	void AddGhostActor(AActor* Actor, const FString& Name = FString());
+
+	void RemoveGhostActor(AActor* Actor);
+
+	/**
+	 *  Writes the positions sampled since the last flush into the replay
+	 */
+	void FlushGhosts();
+
+	/**
+	 *  Loads the ghost positions of a replay, replacing the ones loaded before
+	 * @param ReplayName The name the replay is saved as on disk
+	 * @param OnComplete
+	 */
+	void LoadGhosts(const FString& ReplayName, FOnLoadReplayTracksComplete OnComplete);
+
+	/**
+	 *  The position of every loaded ghost that existed at a time, interpolated between samples
+	 * @param Time The replay time in seconds
+	 * @param OutPositions
+	 */
+	void GetGhostPositions(float Time, TArray<FReplayGhostPosition>& OutPositions) const;
+
+	const FString& GetLoadedReplayName() const { return LoadedReplayName; }
+
+	//Seconds of replay time between two samples of the ghost positions
+	UPROPERTY(Config)
+	float SampleInterval = 0.5f;
+
+	//Precision of the recorded positions in cm
+	UPROPERTY(Config)
+	float PositionPrecision = 10.0f;
+
+	//Seconds of replay time between two chunks written into the replay
+	UPROPERTY(Config)
+	float FlushInterval = 10.0f;
+
+	//Record the pawn of every player
+	UPROPERTY(Config)
+	bool bRecordPlayerPawns = true;
+
+	//Actors with this tag are recorded, e.g. objectives
+	UPROPERTY(Config)
+	FName GhostActorTag = TEXT("ReplayGhost");
+
+	//Load the ghosts of a replay as soon as it starts playing
+	UPROPERTY(Config)
+	bool bLoadOnPlayback = true;
+
+protected:
+	struct FGhostActor
+	{
+		TWeakObjectPtr<AActor> Actor;
+
+		FName Name;
+	};
+
+	void SampleGhosts(float Time);
+
+	void Record(FName Name, float Time, const FVector& Location);
+
+	void OnActorSpawned(AActor* Actor);
+
+	TArray<FGhostActor> GhostActors;
+
+	FReplayTrackSet RecordingGhosts;
+
+	//The ghosts recorded by the last sample and the one being taken
+	TSet<FName> PresentGhosts;
+
+	TSet<FName> SampledGhosts;
+
+	FReplayTrackSet LoadedGhosts;
+
+	FString RecordingReplayName;
+
+	FString LoadedReplayName;
+
+	//The replay whose ghosts were last loaded on playback, so they are loaded once per replay
+	FString PlayingReplayName;
+
+	int32 NextChunkIndex = 0;
+
+	float LastFlushTime = 0.0f;
+
+	float LastSampleTime = 0.0f;
+
+	//Incremented whenever a load starts so a stale load does not overwrite a newer one
+	int32 LoadSerial = 0;
+
+	FDelegateHandle ActorSpawnedHandle;
+
+	FDelegateHandle RecordingStoppingHandle;
+
+	//The recording and loaded ghosts, updated every tick
+	FReplayMemory::FCounter MemoryCounter{EReplayMemoryCategory::Tracks};
+};
@@ -0,0 +1,69 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplayStructs.h"
+
+/**
+ *  Checks replays written by the local file streamer for damage, e.g. from a crash while recording. A checksum of every
+ *  chunk is written next to the replay while it is recorded; verifying checks that every chunk is complete and still
+ *  matches its checksum, and repairing cuts a damaged replay back to the chunks before the first damaged one so it
+ *  stays playable up to there.
+ */
+class REPLAYSYSTEM_API FReplayIntegrity
+{
+public:
+	/**
+	 *  Checksums the chunks written to a replay since the last update on a worker thread. Does nothing if an update of
+	 *  that replay is still running
+	 */
+	static void UpdateChecksums(const FString& ReplayName);
+
+	/**
+	 *  Marks a replay as being recorded by this process so it is never repaired while written. A recording that starts
+	 *  drops the checksums left by an earlier replay of the same name
+	 */
+	static void SetRecording(const FString& ReplayName, bool bIsRecording);
+
+	/**
+	 *  Drops the chunk checksums of a replay, called when it is deleted or recorded again
+	 */
+	static void DeleteChecksums(const FString& ReplayName);
+
+	/**
+	 *  Moves the chunk checksums of a replay along with it when it is renamed
+	 */
+	static void RenameChecksums(const FString& ReplayName, const FString& NewReplayName);
+
+	/**
+	 *  Verifies replays in parallel on worker threads
+	 * @param ReplayNames The names the replays are saved as on disk, empty for every saved replay
+	 * @param bRepair Whether damaged replays are cut back to their valid chunks
+	 * @param OnComplete Called on the game thread with a result per replay
+	 */
+	static void VerifyReplays(const TArray<FString>& ReplayNames, bool bRepair,
+	                          TFunction<void(const TArray<FReplayIntegrityResult>&)> OnComplete);
+
+	/**
+	 *  Finalizes the replays left unfinished by a process that stopped while recording them, cutting each back to its
+	 *  last complete chunk. Replays written to within MinAgeSeconds are left alone as another process may still be
+	 *  recording them
+	 * @param OnComplete Called on the game thread with a result per replay that needed recovering
+	 */
+	static void RecoverReplays(float MinAgeSeconds, TFunction<void(const TArray<FReplayIntegrityResult>&)> OnComplete);
+
+	/**
+	 *  Recovers unfinished replays if ReplaySystem.RecoverOnStartup is set (off by default), called once the engine has
+	 *  started
+	 */
+	static void RecoverOnStartup();
+
+	/**
+	 *  Verifies a single replay on the calling thread
+	 */
+	static FReplayIntegrityResult VerifyReplay(const FString& ReplayName, bool bRepair);
+
+private:
+	static bool Repair(const FString& ReplayName, int32 NumValidChunks, FReplayIntegrityResult& Result);
+};
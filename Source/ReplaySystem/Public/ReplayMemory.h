@@ -0,0 +1,79 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "ReplayStructs.h"
+#include <atomic>
+
+// Low level memory tracker tags, everything the plugin allocates shows up under ReplaySystem in -llm reports
+LLM_DECLARE_TAG_API(ReplaySystem, REPLAYSYSTEM_API);
+LLM_DECLARE_TAG_API(ReplaySystem_Events, REPLAYSYSTEM_API);
+LLM_DECLARE_TAG_API(ReplaySystem_Tracks, REPLAYSYSTEM_API);
+LLM_DECLARE_TAG_API(ReplaySystem_Index, REPLAYSYSTEM_API);
+LLM_DECLARE_TAG_API(ReplaySystem_Cache, REPLAYSYSTEM_API);
+LLM_DECLARE_TAG_API(ReplaySystem_Upload, REPLAYSYSTEM_API);
+LLM_DECLARE_TAG_API(ReplaySystem_Streaming, REPLAYSYSTEM_API);
+
+/**
+ *  Current and peak bytes held per part of the plugin. Unlike the LLM tags this works in every build configuration,
+ *  so budgets can be checked in shipping and server builds. The owners report what they hold, see FCounter.
+ */
+class REPLAYSYSTEM_API FReplayMemory
+{
+public:
+	/**
+	 *  Adds to the bytes held by a category, negative to release. Safe to call from any thread
+	 */
+	static void Add(EReplayMemoryCategory Category, int64 Bytes);
+
+	static FReplayMemoryUsage GetUsage(EReplayMemoryCategory Category);
+
+	static TArray<FReplayMemoryUsage> GetAllUsage();
+
+	/**
+	 *  Sets the peak of every category to its current bytes
+	 */
+	static void ResetPeaks();
+
+	/**
+	 *  The bytes one owner holds in a category. Set it to what the owner holds whenever that changes and only the
+	 *  difference is reported; whatever is still set is released when the counter is destroyed. Not thread safe, an
+	 *  owner sets its counter from one thread.
+	 */
+	class FCounter : public FNoncopyable
+	{
+	public:
+		explicit FCounter(EReplayMemoryCategory InCategory)
+			: Category(InCategory)
+		{
+		}
+
+		~FCounter()
+		{
+			Set(0);
+		}
+
+		void Set(int64 Bytes)
+		{
+			if (Bytes != Reported)
+			{
+				Add(Category, Bytes - Reported);
+				Reported = Bytes;
+			}
+		}
+
+		int64 Get() const { return Reported; }
+
+	private:
+		EReplayMemoryCategory Category;
+
+		int64 Reported = 0;
+	};
+
+private:
+	static std::atomic<int64> Current[static_cast<int32>(EReplayMemoryCategory::Count)];
+
+	static std::atomic<int64> Peak[static_cast<int32>(EReplayMemoryCategory::Count)];
+};
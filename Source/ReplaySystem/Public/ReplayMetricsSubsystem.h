@@ -0,0 +1,107 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "ReplayStructs.h"
+#include "ReplayMetricsSubsystem.generated.h"
+
+class AActor;
+
+/**
+ *  Measures how replay playback behaves. Every seek is timed from the request until the demo driver has the time and
+ *  split into loading the checkpoint (waiting on the streamer), restoring its actors and fast forwarding the stream to
+ *  the time asked for. While playing, stalls on missing stream data and how far fast playback falls behind are sampled
+ *  every frame. While recording, the game thread cost of every checkpoint is reported by the replay state subsystem.
+ *  Everything is kept in histograms for the API, published to "stat ReplaySystem" and the CSV profiler, and can be
+ *  exported to a CSV file with ReplaySystem.ExportMetrics.
+ */
+UCLASS()
+class REPLAYSYSTEM_API UReplayMetricsSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	static UReplayMetricsSubsystem* Get(const UObject* WorldContextObject);
+
+	/**
+	 *  Called by the replay state subsystem right before the demo driver is asked to go to a time
+	 */
+	void NotifySeekStarted();
+
+	/**
+	 *  Called by the replay state subsystem once the demo driver has finished going to a time
+	 */
+	void NotifySeekFinished(bool bWasSuccessful);
+
+	/**
+	 *  Called by the replay state subsystem once the demo driver has finished saving a checkpoint of the recording
+	 * @param GameThreadMS The game thread time the checkpoint cost over every frame it was saved in
+	 * @param MaxFrameMS The game thread time of the most expensive of those frames
+	 * @param Frames How many frames the checkpoint was spread across
+	 */
+	void NotifyCheckpointSaved(float GameThreadMS, float MaxFrameMS, int32 Frames);
+
+	const FReplayMetrics& GetMetrics() const { return Metrics; }
+
+	void ResetMetrics();
+
+	/**
+	 *  Writes a summary and the buckets of every histogram to a CSV file
+	 * @param Filename Where to write, a timestamped file in the profiling directory if empty
+	 * @return False if the file could not be written
+	 */
+	bool ExportCSV(const FString& Filename) const;
+
+protected:
+	bool Tick(float DeltaTime);
+
+	void HandlePreScrub(UWorld* InWorld);
+
+	void HandleScrubComplete(UWorld* InWorld);
+
+	void HandleActorSpawned(AActor* Actor);
+
+	void EndSeek(bool bWasSuccessful);
+
+	void EndStall();
+
+	bool IsOwnWorld(const UWorld* InWorld) const;
+
+	FReplayMetrics Metrics;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+
+	FDelegateHandle PreScrubHandle;
+
+	FDelegateHandle ScrubCompleteHandle;
+
+	FDelegateHandle ActorSpawnedHandle;
+
+	TWeakObjectPtr<UWorld> SeekWorld;
+
+	bool bSeeking = false;
+
+	double SeekStartTime = 0.0;
+
+	//When the checkpoint was handed to the demo driver, 0 until then
+	double CheckpointLoadedTime = 0.0;
+
+	//When the demo driver last spawned an actor of the checkpoint
+	double LastRestoreTime = 0.0;
+
+	bool bStalled = false;
+
+	double StallStartTime = 0.0;
+
+	//Demo time as of the last tick, negative while not playing
+	float LastDemoTime = -1.0f;
+
+	//Seconds of replay time playback is behind what the playback speed asks for
+	float Lag = 0.0f;
+};
@@ -0,0 +1,132 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace ReplayNamedColumn
+{
+	/**
+	 *  The interned name for a string key, NAME_None if the name was never interned (so nothing can be stored under it).
+	 *  Does not allocate.
+	 */
+	inline FName FindName(const FString& Name)
+	{
+		return FName(*Name, FNAME_Find);
+	}
+}
+
+/**
+ *  Values keyed by interned name, stored as a column of names and a column of values with a hash index from name to
+ *  slot. Lookups hash an FName (an integer compare) instead of comparing strings, reads never allocate and the values
+ *  stay contiguous for bulk processing. Removal swaps the last value into the freed slot.
+ */
+template <typename ValueType>
+class TReplayNamedColumn
+{
+public:
+	int32 Num() const
+	{
+		return Values.Num();
+	}
+
+	int32 IndexOf(const FName Name) const
+	{
+		const int32* Slot = Index.Find(Name);
+		return Slot ? *Slot : INDEX_NONE;
+	}
+
+	ValueType* Find(const FName Name)
+	{
+		const int32 Slot = IndexOf(Name);
+		return Slot != INDEX_NONE ? &Values[Slot] : nullptr;
+	}
+
+	const ValueType* Find(const FName Name) const
+	{
+		const int32 Slot = IndexOf(Name);
+		return Slot != INDEX_NONE ? &Values[Slot] : nullptr;
+	}
+
+	ValueType& FindOrAdd(const FName Name)
+	{
+		if (const int32* Slot = Index.Find(Name))
+		{
+			return Values[*Slot];
+		}
+
+		Index.Add(Name, Values.Num());
+		Names.Add(Name);
+		return Values.AddDefaulted_GetRef();
+	}
+
+	void Set(const FName Name, const ValueType& Value)
+	{
+		FindOrAdd(Name) = Value;
+	}
+
+	bool Remove(const FName Name)
+	{
+		int32 Slot = INDEX_NONE;
+		if (!Index.RemoveAndCopyValue(Name, Slot))
+		{
+			return false;
+		}
+
+		const int32 LastSlot = Values.Num() - 1;
+		if (Slot != LastSlot)
+		{
+			Index[Names[LastSlot]] = Slot;
+		}
+
+		Names.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+		Values.RemoveAtSwap(Slot, 1, EAllowShrinking::No);
+		return true;
+	}
+
+	void Reset()
+	{
+		Names.Reset();
+		Values.Reset();
+		Index.Reset();
+	}
+
+	void Reserve(int32 Number)
+	{
+		Names.Reserve(Number);
+		Values.Reserve(Number);
+		Index.Reserve(Number);
+	}
+
+	FName GetName(int32 Slot) const
+	{
+		return Names[Slot];
+	}
+
+	TConstArrayView<FName> GetNames() const
+	{
+		return Names;
+	}
+
+	TArrayView<ValueType> GetValues()
+	{
+		return Values;
+	}
+
+	TConstArrayView<ValueType> GetValues() const
+	{
+		return Values;
+	}
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Names.GetAllocatedSize() + Values.GetAllocatedSize() + Index.GetAllocatedSize();
+	}
+
+private:
+	TArray<FName> Names;
+
+	TArray<ValueType> Values;
+
+	TMap<FName, int32> Index;
+};
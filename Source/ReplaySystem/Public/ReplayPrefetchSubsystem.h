@@ -0,0 +1,82 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NetworkReplayStreaming.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "ReplayDelegates.h"
+#include "ReplayStructs.h"
+#include "ReplayPrefetchSubsystem.generated.h"
+
+class UPackage;
+
+/**
+ *  Warms up a replay before it is played. The header is read and validated, the first checkpoint is read and the map
+ *  package is loaded in the background and kept in memory so the map load done by PlayRecordedReplay finds it resident.
+ *  Lives on the game instance so the prefetched map survives until the replay world has been loaded.
+ */
+UCLASS()
+class REPLAYSYSTEM_API UReplayPrefetchSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/**
+	 *  Starts prefetching a replay, cancelling any other prefetch in progress
+	 * @param ReplayName The name the replay is saved as on disk
+	 * @param OnComplete Called once the header and first checkpoint have been read and the map has loaded (or on failure)
+	 */
+	void PrefetchReplay(const FString& ReplayName, FOnPrefetchReplayComplete OnComplete);
+
+	/**
+	 *  Stops the prefetch in progress and releases anything it was holding on to
+	 */
+	void CancelPrefetch();
+
+	/**
+	 *  Called right before a replay is played. Stops the prefetch streamer but keeps the map package around until the
+	 *  replay map has loaded.
+	 * @param ReplayName The replay about to be played
+	 * @return False if this replay was prefetched and found to be invalid
+	 */
+	bool ConsumePrefetch(const FString& ReplayName);
+
+	const FReplayPrefetchInfo& GetPrefetchInfo() const { return PrefetchInfo; }
+
+protected:
+	void OnStreamingStarted(const FStartStreamingResult& Result);
+
+	void OnFirstCheckpointLoaded(const FGotoResult& Result);
+
+	void OnMapPackageLoaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result);
+
+	void OnPostLoadMap(UWorld* LoadedWorld);
+
+	void Fail(const FString& Error);
+
+	void ConditionallyComplete();
+
+	void StopStreamer();
+
+	FReplayPrefetchInfo PrefetchInfo;
+
+	FOnPrefetchReplayComplete OnPrefetchComplete;
+
+	TSharedPtr<INetworkReplayStreamer> ReplayStreamer;
+
+	UPROPERTY(Transient)
+	TObjectPtr<UPackage> PrefetchedMapPackage;
+
+	bool bCheckpointDone = false;
+
+	bool bMapDone = false;
+
+	//Incremented whenever a prefetch is started or cancelled so stale callbacks can be ignored
+	int32 PrefetchSerial = 0;
+
+	FDelegateHandle PostLoadMapHandle;
+};
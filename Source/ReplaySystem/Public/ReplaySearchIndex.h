@@ -0,0 +1,115 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplayMemory.h"
+#include "ReplayStructs.h"
+#include <atomic>
+
+class FReplayEventIndex;
+
+/**
+ *  An inverted index over the events of every recorded replay, from event group, event ID and indexed metadata values
+ *  to the replays and times they occur at. Kept in memory and saved next to the replays; updated per replay when a
+ *  recording stops, is deleted or renamed so queries never have to open a replay. Game thread only.
+ */
+class REPLAYSYSTEM_API FReplaySearchIndex
+{
+public:
+	static FReplaySearchIndex& Get();
+
+	/**
+	 *  Replaces everything indexed for a replay with the events of its event index
+	 * @param ReplayName The name the replay is saved as on disk
+	 * @param EventIndex The replay's event index
+	 * @param IndexedKeys The metadata keys whose values are searchable
+	 */
+	void UpdateReplay(const FString& ReplayName, const FReplayEventIndex& EventIndex, const TSet<FName>& IndexedKeys);
+
+	void RemoveReplay(const FString& ReplayName);
+
+	void RenameReplay(const FString& ReplayName, const FString& NewReplayName);
+
+	/**
+	 *  Events of a group, optionally only those of one ID
+	 */
+	void FindEvents(const FString& Group, const FString& EventId, TArray<FReplaySearchHit>& OutHits);
+
+	/**
+	 *  Events with a metadata value, ints and floats compare by value
+	 */
+	void FindByValue(const FReplayMetadataValue& Value, TArray<FReplaySearchHit>& OutHits);
+
+	/**
+	 *  Events with an int or float metadata value within [Min, Max]
+	 */
+	void FindInRange(const FName Key, double Min, double Max, TArray<FReplaySearchHit>& OutHits);
+
+	TArray<FString> GetIndexedReplays();
+
+	//Where the index is saved
+	static FString GetIndexFilename();
+
+private:
+	struct FHit
+	{
+		int32 Replay = INDEX_NONE;
+
+		int32 Event = INDEX_NONE;
+	};
+
+	struct FReplayEntry
+	{
+		FString Name;
+
+		//Only the searchable metadata of every event is kept
+		TArray<FReplayIndexedEvent> Events;
+	};
+
+	struct FNumberColumn
+	{
+		TArray<TPair<double, FHit>> Entries;
+
+		bool bSorted = true;
+	};
+
+	void EnsureLoaded();
+
+	//Drops everything indexed for a replay without saving, false if it was not indexed
+	bool RemoveSlot(const FString& ReplayName);
+
+	void AddPostings(int32 ReplaySlot);
+
+	void RemovePostings(int32 ReplaySlot);
+
+	void AddHits(TConstArrayView<FHit> Hits, TArray<FReplaySearchHit>& OutHits) const;
+
+	void Save();
+
+	void UpdateMemory();
+
+	static FString GroupTerm(const FString& Group);
+
+	static FString EventTerm(const FString& Group, const FString& EventId);
+
+	static FString ValueTerm(const FString& Key, const FString& Value);
+
+	bool bLoaded = false;
+
+	//Removed replays leave an empty entry behind so the slots of the others stay valid
+	TArray<FReplayEntry> Replays;
+
+	TMap<FString, int32> ReplaySlots;
+
+	//Group, event ID and string value terms
+	TMap<FString, TArray<FHit>> Terms;
+
+	//Int and float values per key
+	TMap<FName, FNumberColumn> Numbers;
+
+	//Incremented per save so an older save that finishes late never overwrites a newer one
+	TSharedRef<std::atomic<uint32>> LatestSave = MakeShared<std::atomic<uint32>>(0);
+
+	FReplayMemory::FCounter MemoryCounter{EReplayMemoryCategory::Index};
+};
@@ -0,0 +1,135 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "ReplayDelegates.h"
+#include "ReplayStructs.h"
+#include "ReplaySegmentSubsystem.generated.h"
+
+/**
+ *  Records a long session as a series of replays (segments) instead of one large file. Recording rolls over to a new
+ *  segment once the current one reaches a length or size limit; every segment starts with the full state of the world
+ *  like a checkpoint, so each can be played on its own. A JSON manifest next to the segments ties them into one
+ *  timeline, and playback and seeking through the library use that timeline, only opening the segment they need.
+ *  Lives on the game instance since moving to another segment loads a new replay world.
+ */
+UCLASS()
+class REPLAYSYSTEM_API UReplaySegmentSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	static UReplaySegmentSubsystem* Get(const UObject* WorldContextObject);
+
+	/**
+	 *  Starts recording segments, stopping any recording in progress
+	 * @param BaseName The manifest is saved as <BaseName>.segments.json and the segments as <BaseName>_<Index>
+	 * @param FriendlyName The UI friendly name given to every segment
+	 * @param MaxSegmentMinutes Length of replay time after which a new segment is started, 0 for no limit
+	 * @param MaxSegmentMB Size on disk after which a new segment is started, 0 for no limit
+	 * @return False if there is no world to record
+	 */
+	bool StartRecording(const FString& BaseName, const FString& FriendlyName, float MaxSegmentMinutes,
+	                    float MaxSegmentMB);
+
+	/**
+	 *  Stops recording the current segment and finalizes the manifest
+	 */
+	void StopRecording();
+
+	bool IsRecording() const { return bIsRecording; }
+
+	/**
+	 *  Plays a segmented recording from a time of its whole timeline
+	 * @return False if the manifest is missing or has no segments
+	 */
+	bool Play(const FString& BaseName, float StartTime);
+
+	bool IsPlaying() const { return bIsPlaying; }
+
+	/**
+	 *  Maps a time of the whole timeline onto the segment being played. A time in another segment plays that segment
+	 *  and goes to the time once it has loaded
+	 * @param Time Time of the whole timeline in seconds
+	 * @param OutLocalTime The time within the segment being played, if that segment covers Time
+	 * @param OnComplete Called once a seek into another segment has finished
+	 * @return True if the segment being played covers Time (or no segmented recording is playing)
+	 */
+	bool ResolveSeek(float Time, float& OutLocalTime, FOnGotoTimeComplete OnComplete);
+
+	/**
+	 *  Where the segment being played starts on the whole timeline, 0 if no segmented recording is playing
+	 */
+	float GetPlaybackTimeOffset() const;
+
+	/**
+	 *  The manifest of the recording being recorded or played
+	 */
+	const FReplaySegmentManifest& GetManifest() const { return Manifest; }
+
+	static bool LoadManifest(const FString& BaseName, FReplaySegmentManifest& OutManifest);
+
+	static FString GetManifestFilename(const FString& BaseName);
+
+	static FString GetSegmentName(const FString& BaseName, int32 Index);
+
+protected:
+	bool Tick(float DeltaTime);
+
+	void TickRecording(UWorld* World);
+
+	void TickPlayback(UWorld* World);
+
+	void StartSegment(UWorld* World);
+
+	/**
+	 *  Stops recording the current segment and records its length in the manifest
+	 */
+	void EndSegment(UWorld* World);
+
+	bool SaveManifest() const;
+
+	void PlaySegment(int32 Index, float LocalTime);
+
+	void HandleReplayPlaybackComplete(UWorld* InWorld);
+
+	FReplaySegmentManifest Manifest;
+
+	bool bIsRecording = false;
+
+	bool bIsPlaying = false;
+
+	//Limits of the segments being recorded, 0 for no limit
+	float MaxSegmentSeconds = 0.0f;
+
+	int64 MaxSegmentBytes = 0;
+
+	//The segment being recorded or played
+	int32 CurrentSegment = INDEX_NONE;
+
+	//Replay time of the segment being recorded as of the last tick
+	float SegmentTime = 0.0f;
+
+	//Whether the segment being recorded has been seen recording yet
+	bool bSegmentStarted = false;
+
+	double LastSizeCheckTime = 0.0;
+
+	//Time within the segment being loaded to go to once it plays, negative if none
+	float PendingSeekTime = -1.0f;
+
+	FOnGotoTimeComplete PendingSeekComplete;
+
+	//Set when a segment finished playing so the next one is played on the next tick
+	bool bPlayNextSegment = false;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+
+	FDelegateHandle PlaybackCompleteHandle;
+};
@@ -0,0 +1,80 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "ReplaySmoothingComponent.generated.h"
+
+/**
+ *  Smooths the motion of a replicated actor during replay playback so replays can be recorded at a low record rate.
+ *  Every replicated movement update received from the replay is buffered and the actor is placed at the transform
+ *  interpolated between the buffered updates, a small delay behind the replay time. Location uses hermite
+ *  interpolation with the replicated velocities as tangents, rotation is slerped. When the buffer runs dry the last
+ *  update is extrapolated along its velocity for a short while. Does nothing outside of replay playback.
+ */
+UCLASS(ClassGroup = (Replay), meta = (BlueprintSpawnableComponent))
+class REPLAYSYSTEM_API UReplaySmoothingComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UReplaySmoothingComponent();
+
+	virtual void BeginPlay() override;
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType,
+	                           FActorComponentTickFunction* ThisTickFunction) override;
+
+	/**
+	 *  Forgets every buffered update, the next update received snaps the actor
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Smoothing")
+	void ResetSmoothing();
+
+	//How far behind the replay time the actor is shown. Should cover the time between two recorded frames (1 / record hz)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ReplaySystem|Smoothing")
+	float InterpolationDelay = 0.15f;
+
+	//How long the last update may be extrapolated once the buffer runs dry
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ReplaySystem|Smoothing")
+	float MaxExtrapolationTime = 0.25f;
+
+	//Updates further apart than this in distance are treated as a teleport and snapped to
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ReplaySystem|Smoothing")
+	float TeleportDistance = 1000.0f;
+
+	//Use the replicated velocities as tangents, otherwise location is interpolated linearly
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ReplaySystem|Smoothing")
+	bool bUseHermiteInterpolation = true;
+
+	//Hand smoothing of characters over to this component instead of the character movement component
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ReplaySystem|Smoothing")
+	bool bDisableMovementComponentSmoothing = true;
+
+protected:
+	struct FSample
+	{
+		double Time = 0.0;
+		FVector Location = FVector::ZeroVector;
+		FQuat Rotation = FQuat::Identity;
+		FVector Velocity = FVector::ZeroVector;
+	};
+
+	void ConditionallyAddSample(double DemoTime);
+
+	bool Evaluate(double Time, FVector& OutLocation, FQuat& OutRotation) const;
+
+	//Buffered updates ordered by time
+	TArray<FSample> Samples;
+
+	FVector LastReceivedLocation = FVector::ZeroVector;
+
+	FRotator LastReceivedRotation = FRotator::ZeroRotator;
+
+	FVector LastReceivedVelocity = FVector::ZeroVector;
+
+	double LastDemoTime = -1.0;
+
+	bool bHasReceived = false;
+};
@@ -0,0 +1,229 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ReplayStructs.h"
+#include "ReplayDelegates.h"
+#include "ReplayStateSubsystem.generated.h"
+
+class APlayerController;
+class UDemoNetDriver;
+
+/**
+ *  Per world replay state. Caches the demo driver and refreshes a snapshot of the playback state once per tick so
+ *  the library getters (which UI tends to poll every frame) can answer without touching the demo driver.
+ *  Changes between snapshots are pushed through the events below so UI does not have to poll at all.
+ */
+UCLASS()
+class REPLAYSYSTEM_API UReplayStateSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual bool IsTickableWhenPaused() const override { return IsInitialized(); }
+
+	/**
+	 *  Finds the replay state subsystem of the world the context object lives in
+	 * @param WorldContextObject
+	 * @return The subsystem or nullptr if the world does not have one
+	 */
+	static UReplayStateSubsystem* Get(const UObject* WorldContextObject);
+
+	/**
+	 *  Re-reads the playback state from the demo driver. Called every tick and after anything in the library changes the state
+	 */
+	void RefreshPlaybackState();
+
+	/**
+	 *  The playback state as of the last refresh
+	 */
+	const FReplayPlaybackState& GetPlaybackState() const { return PlaybackState; }
+
+	/**
+	 *  The demo driver as of the last refresh
+	 */
+	UDemoNetDriver* GetDemoDriver() const { return CachedDemoDriver.Get(); }
+
+	/**
+	 *  Called by the library right before it asks the demo driver to go to a time
+	 */
+	void NotifySeekStarted(float TargetTime);
+
+	/**
+	 *  Called by the library once the demo driver has finished going to a time
+	 */
+	void NotifySeekFinished(bool bWasSuccessful);
+
+	/**
+	 *  True if this world has duplicated dynamic levels a replay can be played into without travelling
+	 */
+	bool CanPlayInstantReplay() const;
+
+	/**
+	 *  Plays a replay into the duplicated dynamic levels of this world while the live game keeps running in the source
+	 *  levels. Any replay recording in this world is stopped since a world only has one demo driver.
+	 * @param ReplayName The name the replay is saved as on disk
+	 * @param bHideLiveLevels Hide the live levels while the replay plays
+	 * @return True if playback was started
+	 */
+	bool PlayInstantReplay(const FString& ReplayName, bool bHideLiveLevels);
+
+	/**
+	 *  Stops the instant replay, shows the live levels again and hands the local player back to its live controller
+	 */
+	void StopInstantReplay();
+
+	bool IsPlayingInstantReplay() const { return bIsPlayingInstantReplay; }
+
+	/**
+	 *  Seconds between two writes of the replay being recorded when ReplaySystem.CrashSafeRecording is on, 0 if it is off
+	 */
+	static float GetCrashSafeFlushInterval();
+
+	/**
+	 *  Seconds between two writes of data a subsystem records into the replay, shortened to the crash safe flush
+	 *  interval when that is on so the data is not lost with the stream
+	 * @param Interval The subsystem's own flush interval
+	 */
+	static float GetFlushInterval(float Interval);
+
+	//Called when a replay starts playing in this world
+	UPROPERTY(BlueprintAssignable, Category = "ReplaySystem|Events")
+	FOnReplayStreamEvent OnPlaybackStarted;
+
+	//Called when the replay playback is paused
+	UPROPERTY(BlueprintAssignable, Category = "ReplaySystem|Events")
+	FOnReplayPlaybackEvent OnPlaybackPaused;
+
+	//Called when the replay playback is resumed
+	UPROPERTY(BlueprintAssignable, Category = "ReplaySystem|Events")
+	FOnReplayPlaybackEvent OnPlaybackResumed;
+
+	//Called when the playback speed changes
+	UPROPERTY(BlueprintAssignable, Category = "ReplaySystem|Events")
+	FOnReplaySpeedChanged OnPlaybackSpeedChanged;
+
+	//Called when a seek is requested
+	UPROPERTY(BlueprintAssignable, Category = "ReplaySystem|Events")
+	FOnReplaySeekStarted OnSeekStarted;
+
+	//Called when a seek completes
+	UPROPERTY(BlueprintAssignable, Category = "ReplaySystem|Events")
+	FOnReplaySeekFinished OnSeekFinished;
+
+	//Called when the replay playback reaches the end
+	UPROPERTY(BlueprintAssignable, Category = "ReplaySystem|Events")
+	FOnReplayComplete OnReplayComplete;
+
+	//Called when a replay starts recording in this world
+	UPROPERTY(BlueprintAssignable, Category = "ReplaySystem|Events")
+	FOnReplayStreamEvent OnRecordingStarted;
+
+	//Called when a replay stops recording in this world
+	UPROPERTY(BlueprintAssignable, Category = "ReplaySystem|Events")
+	FOnReplayStreamEvent OnRecordingStopped;
+
+	//Called when the recording in this world has saved a checkpoint, with the game thread time it cost
+	UPROPERTY(BlueprintAssignable, Category = "ReplaySystem|Events")
+	FOnReplayCheckpointSaved OnCheckpointSaved;
+
+	//Called while the demo driver of this world stops recording, however it was stopped. The replay still takes
+	//events, anything buffered for it has to be written here
+	FSimpleMulticastDelegate OnRecordingStopping;
+
+protected:
+	void BroadcastStateChanges();
+
+	/**
+	 *  Publishes the demo time to FReplayEventQueue and writes the events queued from other threads into the replay
+	 */
+	void DrainQueuedEvents();
+
+	void HandleReplayPlaybackComplete(UWorld* InWorld);
+
+	void HandleReplayRecordingComplete(UWorld* InWorld);
+
+	/**
+	 *  Goes to the start of the range a clip was cut from once a clip starts playing
+	 */
+	void SeekToClipStart(const FString& ReplayName);
+
+	/**
+	 *  Has the streamer write the recording out every crash safe flush interval, or restores its own interval
+	 */
+	void SetCrashSafeStreaming(bool bEnable);
+
+	/**
+	 *  Limits the game thread time the demo driver spends on a checkpoint per frame, or restores its own limit. Leaves
+	 *  a limit that was set from an ini, the command line or the console alone
+	 */
+	void SetCheckpointBudget(bool bEnable);
+
+	void HandlePostActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+
+	/**
+	 *  Measures the frames the demo driver spent saving a checkpoint, from the end of the actor ticks to the end of the
+	 *  net drivers' flush where the checkpoint is saved
+	 */
+	void HandlePostTickFlush();
+
+	FReplayPlaybackState PlaybackState;
+
+	//The state the events were last broadcast for
+	FReplayPlaybackState BroadcastState;
+
+	bool bReachedEnd = false;
+
+	FDelegateHandle PlaybackCompleteHandle;
+
+	FDelegateHandle RecordingCompleteHandle;
+
+	bool bIsPlayingInstantReplay = false;
+
+	TWeakObjectPtr<APlayerController> LivePlayerController;
+
+	TWeakObjectPtr<UDemoNetDriver> CachedDemoDriver;
+
+	//Whether this world's recording owns FReplayEventQueue
+	bool bOwnsEventQueue = false;
+
+	//When the checksums of the replay being recorded were last updated
+	double LastChecksumTime = 0.0;
+
+	//Whether the streamer's write interval was lowered for the recording in this world
+	bool bCrashSafeStreaming = false;
+
+	//Whether the demo driver's checkpoint time per frame was limited for the recording in this world
+	bool bCheckpointBudget = false;
+
+	FDelegateHandle PostActorTickHandle;
+
+	FDelegateHandle PostTickFlushHandle;
+
+	//When the actors of this frame were done ticking, 0 if the frame is not measured
+	double FrameStartTime = 0.0;
+
+	//Average cost of the measured part of frames without a checkpoint, negative until there is one
+	float BaselineFrameMS = -1.0f;
+
+	//The demo driver's last checkpoint time as of the previous frame, negative while not recording
+	double LastCheckpointTime = -1.0;
+
+	bool bWasSavingCheckpoint = false;
+
+	//The checkpoint being saved, over the cost of a frame without one
+	float CheckpointGameThreadMS = 0.0f;
+
+	float CheckpointMaxFrameMS = 0.0f;
+
+	int32 CheckpointFrames = 0;
+};
@@ -1,367 +1,885 @@
-// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.   
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "Camera/PlayerCameraManager.h"
-#include "ReplayStructs.generated.h"
-
-class UCurveVector;
-
-USTRUCT(BlueprintType)
-struct FReplayInfo
-{
-	GENERATED_USTRUCT_BODY()
-
-public:
-	//The UI name of the replay
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		FString FriendlyName;
-	//The actual name of the replay on disk
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		FString ActualName;
-	//The date the replay was recorded
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		FDateTime RecordDate;
-	//The length of the replay in milliseconds
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-	    int32 LengthInMS;
-	//The size of the replay in Mb
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		float SizeInMb;
-
-};
-
-
-
-USTRUCT(BlueprintType)
-struct FBlendSettings
-{
-	GENERATED_USTRUCT_BODY()
-
-public:
-	//The time taken to blend
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-	float BlendTime = 0.2;
-	//Cubic, Linear etc functions for blending
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-	TEnumAsByte<EViewTargetBlendFunction> BlendFunction = EViewTargetBlendFunction::VTBlend_Linear;
-	///Exponent used by certain blend functions to control the blend
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-	float BlendExponent = 0;
-	//If true, lock outgoing view target to last frame's camera position for the remainder of the blend
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-	bool bLockOutgoing = false;
-
-};
-
-USTRUCT(BlueprintType)
-struct FReplayEvent
-{
-	GENERATED_USTRUCT_BODY()
-
-public:
-	//The Event ID
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-	FString EventID;
-	//The group this event belongs to 
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-	FString Group;
-	// The time the event was added at in milliseconds
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-	int32 TimeInMs;
-	//The event metadata
-	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = Replay)
-	FString Metadata;
-
-};
-
-USTRUCT(BlueprintType)
-struct FReplayBoolData
-{
-	GENERATED_USTRUCT_BODY()
-
-public:
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		FString Name{};
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		bool Value = false;
-
-	FORCEINLINE bool operator<(const FReplayBoolData& Other) const
-	{
-		return Name < Other.Name;
-	}
-
-	FORCEINLINE bool operator==(const FReplayBoolData& Other) const
-	{
-		return Name == Other.Name;
-	}
-};
-
-USTRUCT(BlueprintType)
-struct FReplayByteData
-{
-	GENERATED_USTRUCT_BODY()
-
-public:
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		FString Name{};
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		TArray<uint8> Value{};
-
-	FORCEINLINE bool operator<(const FReplayByteData& Other) const
-	{
-		return Name < Other.Name;
-	}
-
-	FORCEINLINE bool operator==(const FReplayByteData& Other) const
-	{
-		return Name == Other.Name;
-	}
-};
-
-USTRUCT(BlueprintType)
-struct FReplayIntData
-{
-	GENERATED_USTRUCT_BODY()
-
-public:
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		FString Name{};
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		int Value = 0;
-
-	FORCEINLINE bool operator<(const FReplayIntData& Other) const
-	{
-		return Name < Other.Name;
-	}
-
-	FORCEINLINE bool operator==(const FReplayIntData& Other) const
-	{
-		return Name == Other.Name;
-	}
-};
-
-USTRUCT(BlueprintType)
-struct FReplayInt64Data
-{
-	GENERATED_USTRUCT_BODY()
-
-public:
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		FString Name{};
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		int64 Value = 0;
-
-	FORCEINLINE bool operator<(const FReplayInt64Data& Other) const
-	{
-		return Name < Other.Name;
-	}
-
-	FORCEINLINE bool operator==(const FReplayInt64Data& Other) const
-	{
-		return Name == Other.Name;
-	}
-};
-
-USTRUCT(BlueprintType)
-struct FReplayFloatData
-{
-	GENERATED_USTRUCT_BODY()
-
-public:
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		FString Name{};
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		float Value = 0.0f;
-
-	FORCEINLINE bool operator<(const FReplayFloatData& Other) const
-	{
-		return Name < Other.Name;
-	}
-
-	FORCEINLINE bool operator==(const FReplayFloatData& Other) const
-	{
-		return Name == Other.Name;
-	}
-};
-
-USTRUCT(BlueprintType)
-struct FReplayNameData
-{
-	GENERATED_USTRUCT_BODY()
-
-public:
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		FString Name{};
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		FName Value{};
-
-	FORCEINLINE bool operator<(const FReplayNameData& Other) const
-	{
-		return Name < Other.Name;
-	}
-
-	FORCEINLINE bool operator==(const FReplayNameData& Other) const
-	{
-		return Name == Other.Name;
-	}
-};
-
-USTRUCT(BlueprintType)
-struct FReplayStringData
-{
-	GENERATED_USTRUCT_BODY()
-
-public:
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		FString Name{};
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		FString Value{};
-
-	FORCEINLINE bool operator<(const FReplayStringData& Other) const
-	{
-		return Name < Other.Name;
-	}
-
-	FORCEINLINE bool operator==(const FReplayStringData& Other) const
-	{
-		return Name == Other.Name;
-	}
-};
-
-USTRUCT(BlueprintType)
-struct FReplayTextData
-{
-	GENERATED_USTRUCT_BODY()
-
-public:
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		FString Name{};
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		FText Value{};
-
-	FORCEINLINE bool operator<(const FReplayTextData& Other) const
-	{
-		return Name < Other.Name;
-	}
-
-	FORCEINLINE bool operator==(const FReplayTextData& Other) const
-	{
-		return Name == Other.Name;
-	}
-};
-
-USTRUCT(BlueprintType)
-struct FReplayVectorData
-{
-	GENERATED_USTRUCT_BODY()
-
-public:
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		FString Name{};
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		FVector Value{};
-
-	FORCEINLINE bool operator<(const FReplayVectorData& Other) const
-	{
-		return Name < Other.Name;
-	}
-
-	FORCEINLINE bool operator==(const FReplayVectorData& Other) const
-	{
-		return Name == Other.Name;
-	}
-};
-
-USTRUCT(BlueprintType)
-struct FReplayRotatorData
-{
-	GENERATED_USTRUCT_BODY()
-
-public:
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		FString Name;
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		FRotator Value;
-
-	FORCEINLINE bool operator<(const FReplayRotatorData& Other) const
-	{
-		return Name < Other.Name;
-	}
-
-	FORCEINLINE bool operator==(const FReplayRotatorData& Other) const
-	{
-		return Name == Other.Name;
-	}
-};
-
-USTRUCT(BlueprintType)
-struct FReplayTransformData
-{
-	GENERATED_USTRUCT_BODY()
-
-public:
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		FString Name;
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		FTransform Value;
-
-	FORCEINLINE bool operator<(const FReplayTransformData& Other) const
-	{
-		return Name < Other.Name;
-	}
-
-	FORCEINLINE bool operator==(const FReplayTransformData& Other) const
-	{
-		return Name == Other.Name;
-	}
-	
-};
-
-USTRUCT(BlueprintType)
-struct FReplayObjectData
-{
-	GENERATED_USTRUCT_BODY()
-
-public:
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		FString Name;
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
-		UObject* Value;
-
-	FORCEINLINE bool operator<(const FReplayObjectData& Other) const
-	{
-		return Name < Other.Name;
-	}
-
-	FORCEINLINE bool operator==(const FReplayObjectData& Other) const
-	{
-		return Name == Other.Name;
-	}
-	
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.   
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Camera/PlayerCameraManager.h"
+#include "ReplayStructs.generated.h"
+
+class UCurveFloat;
+class UCurveVector;
+
+USTRUCT(BlueprintType)
+struct FReplayInfo
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	//The UI name of the replay
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		FString FriendlyName;
+	//The actual name of the replay on disk
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		FString ActualName;
+	//The date the replay was recorded
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		FDateTime RecordDate;
+	//The length of the replay in milliseconds
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	    int32 LengthInMS;
+	//The size of the replay in Mb
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		float SizeInMb;
+
+};
+
+
+
+USTRUCT(BlueprintType)
+struct FBlendSettings
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	//The time taken to blend
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	float BlendTime = 0.2;
+	//Cubic, Linear etc functions for blending
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	TEnumAsByte<EViewTargetBlendFunction> BlendFunction = EViewTargetBlendFunction::VTBlend_Linear;
+	///Exponent used by certain blend functions to control the blend
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	float BlendExponent = 0;
+	//If true, lock outgoing view target to last frame's camera position for the remainder of the blend
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	bool bLockOutgoing = false;
+
+};
+
+USTRUCT(BlueprintType)
+struct FReplayEvent
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	//The Event ID
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	FString EventID;
+	//The group this event belongs to 
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	FString Group;
+	// The time the event was added at in milliseconds
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	int32 TimeInMs;
+	//The event metadata
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = Replay)
+	FString Metadata;
+
+};
+
+UENUM(BlueprintType)
+enum class EReplayMetadataType : uint8
+{
+	Int,
+	Float,
+	String
+};
+
+USTRUCT(BlueprintType)
+struct FReplayMetadataValue
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	//The metadata key
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	FString Key;
+	//Which of the values is used
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	EReplayMetadataType Type = EReplayMetadataType::String;
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	int64 IntValue = 0;
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	double FloatValue = 0.0;
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	FString StringValue;
+
+	//The value as a number, ints and floats compare with each other
+	double GetNumber() const
+	{
+		return Type == EReplayMetadataType::Int ? static_cast<double>(IntValue) : FloatValue;
+	}
+
+	friend REPLAYSYSTEM_API FArchive& operator<<(FArchive& Ar, FReplayMetadataValue& Value);
+};
+
+USTRUCT(BlueprintType)
+struct FReplayIndexedEvent
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	//The Event ID the event was added with
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	FString EventID;
+	//The group this event belongs to 
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	FString Group;
+	// The time the event was added at in milliseconds
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	int32 TimeInMs = 0;
+	//The event metadata
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	TArray<FReplayMetadataValue> Metadata;
+
+	//Heap bytes held by the strings and metadata, not counting the struct itself
+	SIZE_T GetAllocatedSize() const
+	{
+		SIZE_T Size = EventID.GetAllocatedSize() + Group.GetAllocatedSize() + Metadata.GetAllocatedSize();
+		for (const FReplayMetadataValue& Value : Metadata)
+		{
+			Size += Value.Key.GetAllocatedSize() + Value.StringValue.GetAllocatedSize();
+		}
+		return Size;
+	}
+
+	friend REPLAYSYSTEM_API FArchive& operator<<(FArchive& Ar, FReplayIndexedEvent& Event);
+};
+
+USTRUCT(BlueprintType)
+struct FReplaySearchHit
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	//The actual name of the replay on disk
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	FString ReplayName;
+	//The Event ID
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	FString EventID;
+	//The group this event belongs to 
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	FString Group;
+	// The time the event was added at in milliseconds
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	int32 TimeInMs = 0;
+};
+
+USTRUCT(BlueprintType)
+struct FReplayEventList
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	//The actual name of the replay on disk
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	FString ReplayName;
+	//False if the events of the replay could not be enumerated
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	bool bWasSuccessful = false;
+	//The events of the replay
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	TArray<FReplayEvent> Events;
+};
+
+UENUM(BlueprintType)
+enum class EReplayIntegrity : uint8
+{
+	//Every chunk is complete and matches its checksum
+	Valid,
+	//The replay was damaged and has been cut back to its last valid chunk
+	Repaired,
+	//The replay is damaged, verify it with repair to make it playable again
+	Damaged,
+	//The replay is missing or its header is unreadable, it cannot be repaired
+	Unreadable
+};
+
+USTRUCT(BlueprintType)
+struct FReplayIntegrityResult
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	//The actual name of the replay on disk
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	FString ReplayName;
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	EReplayIntegrity Status = EReplayIntegrity::Unreadable;
+	//The number of complete chunks in the file
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	int32 NumChunks = 0;
+	//The number of chunks before the first damaged one
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	int32 NumValidChunks = 0;
+	//The number of chunks a checksum was recorded for
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	int32 NumChecksummedChunks = 0;
+	//The length of the replay in milliseconds, after the repair if it was repaired
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	int32 LengthInMS = 0;
+	//What is wrong with the replay
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	FString Error;
+};
+
+USTRUCT(BlueprintType)
+struct FReplaySegment
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	//The actual name of the segment's replay on disk
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	FString ReplayName;
+	//Where the segment starts on the timeline of the whole recording, in seconds
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	float StartTime = 0.0f;
+	//Length of the segment in seconds, 0 while it is being recorded
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	float Length = 0.0f;
+};
+
+USTRUCT(BlueprintType)
+struct FReplaySegmentManifest
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	//The name the recording was started with, segments are saved as <BaseName>_<Index>
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	FString BaseName;
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	FString FriendlyName;
+	//True until the last segment has been recorded
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	bool bIsRecording = false;
+	//The segments in recording order
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	TArray<FReplaySegment> Segments;
+
+	float GetLength() const
+	{
+		return Segments.Num() > 0 ? Segments.Last().StartTime + Segments.Last().Length : 0.0f;
+	}
+
+	/**
+	 *  The segment covering a time of the whole recording, the last one for times past the end
+	 */
+	int32 FindSegment(float Time) const
+	{
+		for (int32 Index = 0; Index < Segments.Num() - 1; ++Index)
+		{
+			if (Time < Segments[Index + 1].StartTime)
+			{
+				return Index;
+			}
+		}
+		return Segments.Num() - 1;
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FReplayPlaybackState
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	//True if a replay is being recorded
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	bool bIsRecording = false;
+	//True if a replay is being played
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	bool bIsPlaying = false;
+	//True if the replay being played is paused
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	bool bIsPaused = false;
+	//The current time in seconds of the replay
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	float CurrentTime = 0.0f;
+	//The total length in seconds of the replay being played or recorded
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	float Length = 0.0f;
+	//The current time in seconds on the whole timeline of a segmented recording being played, CurrentTime otherwise
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	float TimelineTime = 0.0f;
+	//The length in seconds of the whole timeline of a segmented recording being played, Length otherwise
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	float TimelineLength = 0.0f;
+	//The playback speed (time dilation) of the replay
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	float PlaybackSpeed = 1.0f;
+	//The name on disk/memory of the replay being played or recorded
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	FString ReplayName = TEXT("None");
+
+};
+
+UENUM(BlueprintType)
+enum class EReplayPrefetchState : uint8
+{
+	None,
+	InProgress,
+	Ready,
+	Failed
+};
+
+USTRUCT(BlueprintType)
+struct FReplayPrefetchInfo
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	//The actual name of the prefetched replay
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	FString ReplayName;
+	//How far the prefetch has gotten
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	EReplayPrefetchState State = EReplayPrefetchState::None;
+	//The map the replay was recorded on
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	FString MapName;
+	//The length of the replay in milliseconds
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	int32 LengthInMS = 0;
+	//True if the first checkpoint was read
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	bool bHasCheckpoint = false;
+	//Why the prefetch failed, empty otherwise
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	FString Error;
+
+};
+
+UENUM(BlueprintType)
+enum class EReplayMemoryCategory : uint8
+{
+	//Events queued from other threads for the replay being recorded
+	Events,
+	//Tracks being recorded and tracks loaded for playback
+	Tracks,
+	//Event indexes of the recording and of loaded replays, and the search index across replays
+	Index,
+	//Responses read or written by the remote replay cache
+	Cache,
+	//Parts of replays being uploaded
+	Upload,
+
+	Count UMETA(Hidden)
+};
+
+USTRUCT(BlueprintType)
+struct FReplayMemoryUsage
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	EReplayMemoryCategory Category = EReplayMemoryCategory::Events;
+	//Bytes held right now
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	int64 CurrentBytes = 0;
+	//Most bytes held at once since the game started or the peak was last reset
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	int64 PeakBytes = 0;
+};
+
+USTRUCT(BlueprintType)
+struct FReplayGhostPosition
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	//"Player_<PlayerId>" for player pawns, the actor name or the name it was added with otherwise
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	FString Name;
+
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	FVector Location = FVector::ZeroVector;
+};
+
+UENUM(BlueprintType)
+enum class EReplayUploadState : uint8
+{
+	None,
+	//Finding out which parts the server already has
+	Resuming,
+	//Uploading parts as the replay is recorded
+	Live,
+	//Uploading the rest of the finished replay
+	Finishing,
+	Complete,
+	Failed
+};
+
+USTRUCT(BlueprintType)
+struct FReplayUploadStatus
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	//The actual name of the uploaded replay
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	FString ReplayName;
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	EReplayUploadState State = EReplayUploadState::None;
+	//Parts the server has confirmed, including those it had before a resume
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	int32 PartsUploaded = 0;
+	//Parts known to still need uploading
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	int32 PartsPending = 0;
+	//Uncompressed bytes the server has confirmed
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	int64 BytesUploaded = 0;
+	//Bytes sent over the wire after compression
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	int64 BytesSent = 0;
+	//Why the upload failed, empty otherwise
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	FString Error;
+};
+
+USTRUCT(BlueprintType)
+struct FReplayHistogram
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	FReplayHistogram() = default;
+
+	explicit FReplayHistogram(const TArray<float>& InBucketLimits)
+		: BucketLimits(InBucketLimits)
+	{
+		BucketCounts.SetNumZeroed(BucketLimits.Num() + 1);
+	}
+
+	//Upper bound of every bucket, values past the last one go into an extra last bucket
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	TArray<float> BucketLimits;
+	//Values per bucket, one more than there are limits
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	TArray<int32> BucketCounts;
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	int32 Count = 0;
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	float Sum = 0.0f;
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	float Min = 0.0f;
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	float Max = 0.0f;
+
+	void Add(float Value)
+	{
+		int32 Bucket = 0;
+		while (Bucket < BucketLimits.Num() && Value > BucketLimits[Bucket])
+		{
+			++Bucket;
+		}
+
+		if (BucketCounts.IsValidIndex(Bucket))
+		{
+			++BucketCounts[Bucket];
+		}
+
+		Min = Count > 0 ? FMath::Min(Min, Value) : Value;
+		Max = Count > 0 ? FMath::Max(Max, Value) : Value;
+		Sum += Value;
+		++Count;
+	}
+
+	void Reset()
+	{
+		BucketCounts.Init(0, BucketLimits.Num() + 1);
+		Count = 0;
+		Sum = Min = Max = 0.0f;
+	}
+
+	float GetMean() const { return Count > 0 ? Sum / Count : 0.0f; }
+
+	/**
+	 *  The upper bound of the bucket the given fraction of values falls in, Max for the last bucket
+	 * @param Fraction 0.5 for the median, 0.95 for the 95th percentile
+	 */
+	float GetPercentile(float Fraction) const
+	{
+		const int32 Target = FMath::CeilToInt(FMath::Clamp(Fraction, 0.0f, 1.0f) * Count);
+		int32 Seen = 0;
+
+		for (int32 Bucket = 0; Bucket < BucketCounts.Num(); ++Bucket)
+		{
+			Seen += BucketCounts[Bucket];
+			if (Seen >= Target && Seen > 0)
+			{
+				return BucketLimits.IsValidIndex(Bucket) ? FMath::Min(BucketLimits[Bucket], Max) : Max;
+			}
+		}
+		return Max;
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FReplayMetrics
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	//Milliseconds from asking for a time to the demo driver having it
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	FReplayHistogram SeekTime;
+	//Milliseconds the streamer took to deliver the checkpoint and stream data for a seek
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	FReplayHistogram SeekCheckpointLoadTime;
+	//Milliseconds spent recreating the actors of the checkpoint
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	FReplayHistogram SeekActorRestoreTime;
+	//Milliseconds spent playing the stream from the checkpoint to the time asked for
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	FReplayHistogram SeekFastForwardTime;
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	int32 NumSeeks = 0;
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	int32 NumFailedSeeks = 0;
+	//Times playback stopped advancing because the streamer ran out of data
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	int32 NumStalls = 0;
+	//Milliseconds every stall lasted
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	FReplayHistogram StallTime;
+	//Frames the replay was behind the time the playback speed asks for, sampled every frame of fast playback
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	FReplayHistogram FramesBehind;
+	//Checkpoints saved while recording
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	int32 NumCheckpoints = 0;
+	//Milliseconds of game thread time every checkpoint of the recording cost, over all the frames it was spread across
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	FReplayHistogram CheckpointGameThreadTime;
+	//Milliseconds the most expensive frame of every checkpoint cost, the hitch it caused
+	UPROPERTY(BlueprintReadOnly, Category = Replay)
+	FReplayHistogram CheckpointFrameTime;
+};
+
+USTRUCT(BlueprintType)
+struct FReplayTrackPrecision
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	//Precision of positions and vector values in cm, 0 stores them at full precision
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	float Position = 1.0f;
+	//Precision of rotations in degrees, 0 stores them at full precision
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	float Rotation = 0.1f;
+	//Precision of scales, 0 stores them at full precision
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	float Scale = 0.001f;
+	//Every this many keys one is stored as an absolute value instead of a delta to the previous key
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	int32 KeyframeInterval = 64;
+	//Float and vector keys closer than this to the line between their neighbours are dropped, 0 keeps every key. Only used while recording
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+	float Tolerance = 0.0f;
+
+	friend FArchive& operator<<(FArchive& Ar, FReplayTrackPrecision& Precision)
+	{
+		Ar << Precision.Position;
+		Ar << Precision.Rotation;
+		Ar << Precision.Scale;
+		Ar << Precision.KeyframeInterval;
+		return Ar;
+	}
+
+};
+
+USTRUCT(BlueprintType)
+struct FReplayBoolData
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		FString Name{};
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		bool Value = false;
+
+	FORCEINLINE bool operator<(const FReplayBoolData& Other) const
+	{
+		return Name < Other.Name;
+	}
+
+	FORCEINLINE bool operator==(const FReplayBoolData& Other) const
+	{
+		return Name == Other.Name;
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FReplayByteData
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		FString Name{};
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		TArray<uint8> Value{};
+
+	FORCEINLINE bool operator<(const FReplayByteData& Other) const
+	{
+		return Name < Other.Name;
+	}
+
+	FORCEINLINE bool operator==(const FReplayByteData& Other) const
+	{
+		return Name == Other.Name;
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FReplayIntData
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		FString Name{};
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		int Value = 0;
+
+	FORCEINLINE bool operator<(const FReplayIntData& Other) const
+	{
+		return Name < Other.Name;
+	}
+
+	FORCEINLINE bool operator==(const FReplayIntData& Other) const
+	{
+		return Name == Other.Name;
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FReplayInt64Data
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		FString Name{};
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		int64 Value = 0;
+
+	FORCEINLINE bool operator<(const FReplayInt64Data& Other) const
+	{
+		return Name < Other.Name;
+	}
+
+	FORCEINLINE bool operator==(const FReplayInt64Data& Other) const
+	{
+		return Name == Other.Name;
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FReplayFloatData
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		FString Name{};
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		float Value = 0.0f;
+
+	FORCEINLINE bool operator<(const FReplayFloatData& Other) const
+	{
+		return Name < Other.Name;
+	}
+
+	FORCEINLINE bool operator==(const FReplayFloatData& Other) const
+	{
+		return Name == Other.Name;
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FReplayNameData
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		FString Name{};
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		FName Value{};
+
+	FORCEINLINE bool operator<(const FReplayNameData& Other) const
+	{
+		return Name < Other.Name;
+	}
+
+	FORCEINLINE bool operator==(const FReplayNameData& Other) const
+	{
+		return Name == Other.Name;
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FReplayStringData
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		FString Name{};
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		FString Value{};
+
+	FORCEINLINE bool operator<(const FReplayStringData& Other) const
+	{
+		return Name < Other.Name;
+	}
+
+	FORCEINLINE bool operator==(const FReplayStringData& Other) const
+	{
+		return Name == Other.Name;
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FReplayTextData
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		FString Name{};
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		FText Value{};
+
+	FORCEINLINE bool operator<(const FReplayTextData& Other) const
+	{
+		return Name < Other.Name;
+	}
+
+	FORCEINLINE bool operator==(const FReplayTextData& Other) const
+	{
+		return Name == Other.Name;
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FReplayVectorData
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		FString Name{};
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		FVector Value{};
+
+	FORCEINLINE bool operator<(const FReplayVectorData& Other) const
+	{
+		return Name < Other.Name;
+	}
+
+	FORCEINLINE bool operator==(const FReplayVectorData& Other) const
+	{
+		return Name == Other.Name;
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FReplayRotatorData
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		FString Name;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		FRotator Value;
+
+	FORCEINLINE bool operator<(const FReplayRotatorData& Other) const
+	{
+		return Name < Other.Name;
+	}
+
+	FORCEINLINE bool operator==(const FReplayRotatorData& Other) const
+	{
+		return Name == Other.Name;
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FReplayTransformData
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		FString Name;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		FTransform Value;
+
+	FORCEINLINE bool operator<(const FReplayTransformData& Other) const
+	{
+		return Name < Other.Name;
+	}
+
+	FORCEINLINE bool operator==(const FReplayTransformData& Other) const
+	{
+		return Name == Other.Name;
+	}
+	
+};
+
+USTRUCT(BlueprintType)
+struct FReplayObjectData
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		FString Name;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = Replay)
+		UObject* Value;
+
+	FORCEINLINE bool operator<(const FReplayObjectData& Other) const
+	{
+		return Name < Other.Name;
+	}
+
+	FORCEINLINE bool operator==(const FReplayObjectData& Other) const
+	{
+		return Name == Other.Name;
+	}
+	
 };
\ No newline at end of file
@@ -1,19 +1,24 @@
-﻿// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "Modules/ModuleManager.h"
-
-DECLARE_LOG_CATEGORY_EXTERN(LogReplaySystem, Log, All);
-
-
-class FReplaySystemModule : public IModuleInterface
-{
-public:
-
-	/** IModuleInterface implementation */
-	virtual void StartupModule() override;
-	virtual void ShutdownModule() override;
-};
-
+﻿// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Modules/ModuleManager.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogReplaySystem, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("ReplaySystem"), STATGROUP_ReplaySystem, STATCAT_Advanced);
+
+
+class FReplaySystemModule : public IModuleInterface
+{
+public:
+
+	/** IModuleInterface implementation */
+	virtual void StartupModule() override;
+	virtual void ShutdownModule() override;
+
+private:
+	FDelegateHandle PostEngineInitHandle;
+};
+
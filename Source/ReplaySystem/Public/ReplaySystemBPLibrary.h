@@ -1,436 +1,1003 @@
-﻿// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
-
-#pragma once
-
-#include "Runtime/Launch/Resources/Version.h"
-#include "Kismet/BlueprintFunctionLibrary.h"
-#include "CoreMinimal.h"
-#include "JsonObjectConverter.h"
-#include "ReplayDelegates.h"
-#include "ReplayStructs.h"
-#include "ReplaySystemBPLibrary.generated.h"
-
-
-/* 
-*	Function library class.
-*	Each function in it is expected to be static and represents blueprint node that can be called in any blueprint.
-*
-*	When declaring function you can define metadata for the node. Key function specifiers will be BlueprintPure and BlueprintCallable.
-*	BlueprintPure - means the function does not affect the owning object in any way and thus creates a node without Exec pins.
-*	BlueprintCallable - makes a function which can be executed in Blueprints - Thus it has Exec pins.
-*	DisplayName - full name of the node, shown when you mouse over the node and in the blueprint drop down menu.
-*				Its lets you name the node using characters not allowed in C++ function names.
-*	CompactNodeTitle - the word(s) that appear on the node.
-*	Keywords -	the list of keywords that helps you to find node when you search for it using Blueprint drop-down menu. 
-*				Good example is "Print String" node which you can find also by using keyword "log".
-*	Category -	the category your node will be under in the Blueprint drop-down menu.
-*
-*	For more info on custom blueprint nodes visit documentation:
-*	https://wiki.unrealengine.com/Custom_Blueprint_Node_Creation
-*/
-
-class UInstantReplayObject;
-
-UCLASS()
-class UReplaySystemBPLibrary : public UBlueprintFunctionLibrary
-{
-	GENERATED_UCLASS_BODY()
-
-public:
-	/**
-	 *  Sets the path for all replays (Does not copy existing replays over)
-	 * @param Path New path
-	 */
-	UFUNCTION(BlueprintCallable, Category = "ReplaySystem",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static void SetReplaySavePath(const FString& Path);
-
-	/**
-	 *  Gets the current path where replays are stored
-	 * @return Path
-	 */
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static FString GetReplaySavePath();
-
-
-	/**
-	 *  Starts recording a replay
-	 * @param WorldContextObject 
-	 * @param ReplayName The name to save the replay as on disk (Used internally)
-	 * @param ReplayFriendlyName The Ui friendly name of the replay (Used by you or users)
-	 */
-	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Recording",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static void RecordReplay(UObject* WorldContextObject, const FString& ReplayName,
-	                         const FString& ReplayFriendlyName);
-
-	/**
-	 * Stop recording a replay
-	 * @param WorldContextObject 
-	 * @return 
-	 */
-	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Recording",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static void StopRecordingReplay(UObject* WorldContextObject);
-
-
-	/**
-	 *  Finds out if a replay is being recorded
-	 * @param WorldContextObject 
-	 * @return 
-	 */
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static bool IsRecordingReplay(UObject* WorldContextObject);
-
-	/**
-	 *  Delete a replay
-	 * @param ReplayName The name the replay is saved as on disk
-	 * @return 
-	 */
-	UFUNCTION(BlueprintCallable, Category = "ReplaySystem",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static void DeleteReplay( const FString& ReplayName, FOnDeleteReplayComplete OnDeleteComplete);
-
-	/**
-	 *  Changes the name a replay is saved as on the disk
-	 * @param ReplayName The current name on disk of this replay
-	 * @param NewReplayName New name to save as on disk
-	 * @param UserIndex
-	 * @param OnRenameComplete 
-	 * @return 
-	 */
-	UFUNCTION(BlueprintCallable, Category = "ReplaySystem",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static void RenameReplay(const FString& ReplayName,
-	                                         const FString& NewReplayName, const int32 UserIndex,FOnRenameReplayComplete OnRenameComplete);
-
-	/**
-	 *  Changes the friendly name of a replay
-	 * @param ReplayName The current name on disk of this replay
-	 * @param NewFriendlyReplayName New friendly to give it
-	 * @param UserIndex
-	 * @param OnRenameComplete 
-	 * @return 
-	 */
-	UFUNCTION(BlueprintCallable, Category = "ReplaySystem",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static void RenameReplayFriendly(const FString& ReplayName,
-	                                                 const FString& NewFriendlyReplayName, const int32 UserIndex,FOnRenameReplayComplete OnRenameComplete);
-
-	/**
-	 *  Get all the saved replays
-	 * @param WorldContextObject
-	 * @param OnGetReplaysComplete 
-	 * @return 
-	 */
-	UFUNCTION(BlueprintCallable, Category = "ReplaySystem",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static void GetSavedReplays(FOnGetReplaysComplete OnGetReplaysComplete);
-
-	/**
-	 *  Play a recorded replay
-	 * @param WorldContextObject 
-	 * @param ReplayName
-	 * @return 
-	 */
-	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Playback",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static bool PlayRecordedReplay(UObject* WorldContextObject, const FString& ReplayName);
-
-	/**
-	 *  Restart the currently playing replay
-	 * @param WorldContextObject
-	 * @param OnComplete 
-	 */
-	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Playback",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static void RestartReplayPlayback(UObject* WorldContextObject,FOnGotoTimeComplete OnComplete);
-
-	/**
-	 *  Goto a specific time in the replay
-	 * @param WorldContextObject 
-	 * @param TimeToGoTo Time in seconds to goto
-	 * @param bRetainCurrentPauseState Use this on a need basis as it can cause some physics issues
-	 * @param OnComplete
-	 */
-	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Playback",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static void GoToSpecificTime(UObject* WorldContextObject, float TimeToGoTo,
-	                                         bool bRetainCurrentPauseState, FOnGotoTimeComplete OnComplete);
-
-
-	/**
-	 *  Pause the replay playback
-	 * @param WorldContextObject 
-	 */
-	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Playback",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static void PausePlayback(UObject* WorldContextObject);
-
-	/**
-	 *  Resume the replay playback
-	 * @param WorldContextObject 
-	 */
-	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Playback",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static void ResumePlayback(UObject* WorldContextObject);
-
-	/**
-	 *  Sets the Playback speed of the replay
-	 * @param WorldContextObject Set the playback speed of the replay
-	 * @param Speed Like time dilation 0.1,1,10
-	 */
-	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Playback",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static void SetPlaybackSpeed(UObject* WorldContextObject, float Speed);
-
-
-	/**
-	 *  Get the playback speed of the replay
-	 * @param WorldContextObject 
-	 * @return 
-	 */
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem|Playback",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static float GetPlaybackSpeed(UObject* WorldContextObject);
-
-
-	/**
-	 *  Get the current time in seconds of the replay
-	 * @param WorldContextObject 
-	 * @return 
-	 */
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem|Playback",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static float GetCurrentReplayTime(UObject* WorldContextObject);
-
-
-	/**
-	 *  Get the total length in seconds of the replay currently playing or being recorded
-	 * @param WorldContextObject 
-	 * @return 
-	 */
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem|Playback",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static float GetReplayLength(UObject* WorldContextObject);
-
-
-	/**
-	 *  returns true if a replay is being played
-	 * @param WorldContextObject 
-	 * @return 
-	 */
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static bool IsPlayingReplay(UObject* WorldContextObject);
-
-	/**
-	 * Returns true of the replay has been paused
-	 * @param WorldContextObject 
-	 * @return 
-	 */
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static bool IsReplayPlaybackPaused(UObject* WorldContextObject);
-
-	/**
-	 *  Gets the name on disk/memory of the replay currently playing or being recorded
-	 * @param WorldContextObject 
-	 * @return 
-	 */
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static FString GetActiveReplayName(UObject* WorldContextObject);
-
-
-	/**
-	 * Adds or Updates said event in the replay currently being recorded
-	 * @param WorldContextObject 
-	 * @param EventId The id of the event
-	 * @param Group The group this event belongs to 
-	 * @param Metadata Metadata As A String
-	 * @param Data Data To Store for this event
-	 * @return 
-	 */
-	UFUNCTION(BlueprintCallable, Category = "ReplaySystem",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static bool AddEventToActiveReplay(UObject* WorldContextObject, const FString& EventId, const FString& Group,
-	                                   FString Metadata, TArray<uint8> Data);
-
-	/**
-	 *  Gets the Events of the replay currently playing
-	 * @param WorldContextObject 
-	 * @param Group The group name
-	 * @param UserIndex
-	 * @param OnRequestEventsComplete Callback
-	 * @return 
-	 */
-	UFUNCTION(BlueprintCallable, Category = "ReplaySystem",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	void GetActiveReplayEvents(UObject* WorldContextObject, FString Group, int UserIndex,FOnRequestEventsComplete OnRequestEventsComplete);
-
-
-	/**
-	 * @brief 
-	 * @param ReplayActualName The Actual Name Of The Replay
-	 * @param EventId 
-	 * @param UserIndex 
-	 * @param OnGetEventDataComplete 
-	 */
-	UFUNCTION(BlueprintCallable, Category = "ReplaySystem",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static void GetDataForEvent(FString ReplayActualName, FString EventId,
-	int UserIndex, FOnGetEventDataComplete OnGetEventDataComplete);
-
-	/**
-	 *  Gets the events of a replay
-	 * @param ReplayActualName The Actual Name Of The Replay
-	 * @param Group 
-	 * @param UserIndex
-	 * @param OnRequestEventsComplete 
-	 */
-	UFUNCTION(BlueprintCallable, Category = "ReplaySystem")
-	static void GetEvents(FString ReplayActualName,FString Group,int UserIndex,FOnRequestEventsComplete OnRequestEventsComplete);
-	
-	/**
-	 *  Helper function to convert milliseconds to seconds
-	 * @param MS 
-	 * @return 
-	 */
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem|Utilities")
-	static float MsToSeconds(const int32 MS);
-
-	/**
-	 *  Just sets the view target of the controller to the specified actor
-	 * @param WorldContextObject
-	 * @param Actor The pawn to spectate
-	 */
-	UFUNCTION(BlueprintCallable, Category= "ReplaySystem",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static void SpectateActor(UObject* WorldContextObject, AActor* Actor, FBlendSettings BlendSettings);
-
-	/**
-	 *  Just sets the view target of the controller back to the possessed pawn
-	 * @param WorldContextObject 
-	 * @param BlendSettings 
-	 */
-	UFUNCTION(BlueprintCallable, Category= "ReplaySystem",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static void StopSpectating(UObject* WorldContextObject, FBlendSettings BlendSettings);
-
-	UFUNCTION(Category= "ReplaySystem", meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static UDemoNetDriver* GetDemoDriver(const UObject* WorldContextObject);
-
-	/**
-	 *Set the maximum number of frames recorded per second by the replay
-	 */
-	UFUNCTION(BlueprintCallable, Category= "ReplaySystem",
-		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
-	static void SetMaxRecordHz(UObject* WorldContextObject, float Hz = 8.0f);
-
-
-	/**
-	* Get the maximum number of frames recorded per second by the replay
-	*/
-	UFUNCTION(BlueprintCallable, Category= "ReplaySystem")
-	static float GetMaxRecordHz();
-
-	/**
-	* Serializes A Struct
-	*/
-	UFUNCTION(BlueprintCallable, BlueprintPure, CustomThunk, meta = (CustomStructureParam = "Struct"),
-		Category= "ReplaySystem")
-	static void SerializeStruct(UStruct* Struct, TArray<uint8>& Data);
-
-
-	/**
-	* De-Serializes A Struct
-	*/
-	UFUNCTION(BlueprintCallable, BlueprintPure, CustomThunk, meta = (CustomStructureParam = "Struct"),
-		Category= "ReplaySystem")
-	static void DeSerializeStruct(TArray<uint8> Data, UStruct* & Struct);
-
-
-	/**
-	* Converts A String Into Bytes
-	*/
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category= "ReplaySystem")
-	static TArray<uint8> StringToBytes(FString Data);
-
-	/**
-	* Converts Bytes To A String
-	*/
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category= "ReplaySystem")
-	static FString BytesToString(TArray<uint8> Data);
-
-
-	//Convert property into c++ accessible form
-	DECLARE_FUNCTION(execSerializeStruct)
-	{
-		
-		Stack.StepCompiledIn<FStructProperty>(nullptr);
-		const auto Struct = CastField<FStructProperty>(Stack.MostRecentProperty);
-		const void* StructValue = Stack.MostRecentPropertyAddress;
-		
-		// Stack.StepCompiledIn<FStructProperty>(nullptr);
-		// const auto Data = CastField<FArrayProperty>(Stack.MostRecentProperty);
-		// const auto DataValue = Data->ContainerPtrToValuePtr<TArray<uint8>>((void*)Stack.Object);
-		PARAM_PASSED_BY_REF(Data, FArrayProperty,TArray<uint8>);
-		
-		
-		
-		P_FINISH;
-
-		if(!Struct )//|| !Data)
-		{
-			return;
-		}
-
-		P_NATIVE_BEGIN;
-
-		FString asString = FString();
-
-		FJsonObjectConverter::UStructToJsonObjectString(Struct->Struct, StructValue, asString);
-
-		// DataValue = &(StringToBytes(asString));
-		Data = StringToBytes(asString);
-
-		P_NATIVE_END;
-	}
-
-
-	//Convert property into c++ accessible form
-	DECLARE_FUNCTION(execDeSerializeStruct)
-	{
-		// Stack.StepCompiledIn<FStructProperty>(nullptr);
-		// const auto Data = CastField<FArrayProperty>(Stack.MostRecentProperty);
-		// const auto DataValue = Data->ContainerPtrToValuePtr<TArray<uint8>>((void*)Stack.Object);
-		PARAM_PASSED_BY_VAL(Data, FArrayProperty,TArray<uint8>);
-
-		Stack.StepCompiledIn<FStructProperty>(nullptr);
-		const auto Struct = CastField<FStructProperty>(Stack.MostRecentProperty);
-		void* StructValue = Stack.MostRecentPropertyAddress;
-
-		P_FINISH;
-
-		if(!Struct) //|| !Data)
-		{
-			return;
-		}
-
-		P_NATIVE_BEGIN;
-
-		const auto JsonString = BytesToString(Data);//BytesToString(*DataValue);
-
-		FJsonObjectWrapper Wrapper;
-
-		Wrapper.JsonObjectFromString(JsonString);
-
-		FJsonObjectConverter::JsonObjectToUStruct(Wrapper.JsonObject.ToSharedRef(), Struct->Struct, StructValue);
-
-		P_NATIVE_END;
-	}
-};
-
+﻿// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "Runtime/Launch/Resources/Version.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "CoreMinimal.h"
+#include "JsonObjectConverter.h"
+#include "ReplayDelegates.h"
+#include "ReplayStructs.h"
+#include "ReplaySystemBPLibrary.generated.h"
+
+
+/* 
+*	Function library class.
+*	Each function in it is expected to be static and represents blueprint node that can be called in any blueprint.
+*
+*	When declaring function you can define metadata for the node. Key function specifiers will be BlueprintPure and BlueprintCallable.
+*	BlueprintPure - means the function does not affect the owning object in any way and thus creates a node without Exec pins.
+*	BlueprintCallable - makes a function which can be executed in Blueprints - Thus it has Exec pins.
+*	DisplayName - full name of the node, shown when you mouse over the node and in the blueprint drop down menu.
+*				Its lets you name the node using characters not allowed in C++ function names.
+*	CompactNodeTitle - the word(s) that appear on the node.
+*	Keywords -	the list of keywords that helps you to find node when you search for it using Blueprint drop-down menu. 
+*				Good example is "Print String" node which you can find also by using keyword "log".
+*	Category -	the category your node will be under in the Blueprint drop-down menu.
+*
+*	For more info on custom blueprint nodes visit documentation:
+*	https://wiki.unrealengine.com/Custom_Blueprint_Node_Creation
+*/
+
+class UInstantReplayObject;
+
+UCLASS()
+class UReplaySystemBPLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_UCLASS_BODY()
+
+public:
+	/**
+	 *  Sets the path for all replays (Does not copy existing replays over)
+	 * @param Path New path
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void SetReplaySavePath(const FString& Path);
+
+	/**
+	 *  Gets the current path where replays are stored
+	 * @return Path
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static FString GetReplaySavePath();
+
+
+	/**
+	 *  Starts recording a replay
+	 * @param WorldContextObject 
+	 * @param ReplayName The name to save the replay as on disk (Used internally)
+	 * @param ReplayFriendlyName The Ui friendly name of the replay (Used by you or users)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Recording",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void RecordReplay(UObject* WorldContextObject, const FString& ReplayName,
+	                         const FString& ReplayFriendlyName);
+
+	/**
+	 * Stop recording a replay
+	 * @param WorldContextObject 
+	 * @return 
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Recording",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void StopRecordingReplay(UObject* WorldContextObject);
+
+
+	/**
+	 *  Starts recording a replay in segments, rolling over to a new segment whenever a limit is reached.
+	 *  StopRecordingReplay stops it like any other recording
+	 * @param WorldContextObject 
+	 * @param BaseName The name of the recording on disk, segments are saved as <BaseName>_<Index>
+	 * @param ReplayFriendlyName The Ui friendly name of the replay
+	 * @param MaxSegmentMinutes Minutes of replay time per segment, 0 for no limit
+	 * @param MaxSegmentMB Size of a segment on disk, 0 for no limit
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Recording",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void RecordSegmentedReplay(UObject* WorldContextObject, const FString& BaseName,
+	                                  const FString& ReplayFriendlyName, float MaxSegmentMinutes = 30.0f,
+	                                  float MaxSegmentMB = 0.0f);
+
+	/**
+	 *  Plays a segmented recording as one replay. The current time, the length and GoToSpecificTime use the timeline
+	 *  of the whole recording and only the segment needed is opened
+	 * @param WorldContextObject 
+	 * @param BaseName The name the recording was started with
+	 * @param StartTime Time of the whole recording to start at
+	 * @return False if there is no such segmented recording
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Playback",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool PlaySegmentedReplay(UObject* WorldContextObject, const FString& BaseName, float StartTime = 0.0f);
+
+	/**
+	 *  Reads the manifest listing the segments of a segmented recording
+	 * @param BaseName The name the recording was started with
+	 * @param OutManifest 
+	 * @return False if there is no such segmented recording
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem")
+	static bool GetSegmentedReplayManifest(const FString& BaseName, FReplaySegmentManifest& OutManifest);
+
+	/**
+	 *  Finds out if a replay is being recorded
+	 * @param WorldContextObject 
+	 * @return 
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool IsRecordingReplay(UObject* WorldContextObject);
+
+	/**
+	 *  Delete a replay
+	 * @param ReplayName The name the replay is saved as on disk
+	 * @return 
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void DeleteReplay( const FString& ReplayName, FOnDeleteReplayComplete OnDeleteComplete);
+
+	/**
+	 *  Changes the name a replay is saved as on the disk
+	 * @param ReplayName The current name on disk of this replay
+	 * @param NewReplayName New name to save as on disk
+	 * @param UserIndex
+	 * @param OnRenameComplete 
+	 * @return 
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void RenameReplay(const FString& ReplayName,
+	                                         const FString& NewReplayName, const int32 UserIndex,FOnRenameReplayComplete OnRenameComplete);
+
+	/**
+	 *  Changes the friendly name of a replay
+	 * @param ReplayName The current name on disk of this replay
+	 * @param NewFriendlyReplayName New friendly to give it
+	 * @param UserIndex
+	 * @param OnRenameComplete 
+	 * @return 
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void RenameReplayFriendly(const FString& ReplayName,
+	                                                 const FString& NewFriendlyReplayName, const int32 UserIndex,FOnRenameReplayComplete OnRenameComplete);
+
+	/**
+	 *  Get all the saved replays
+	 * @param WorldContextObject
+	 * @param OnGetReplaysComplete 
+	 * @return 
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void GetSavedReplays(FOnGetReplaysComplete OnGetReplaysComplete);
+
+	/**
+	 *  Play a recorded replay
+	 * @param WorldContextObject 
+	 * @param ReplayName
+	 * @return 
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Playback",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool PlayRecordedReplay(UObject* WorldContextObject, const FString& ReplayName);
+
+	/**
+	 *  Reads and validates the header, reads the first checkpoint and loads the map of a replay in the background so a
+	 *  later PlayRecordedReplay of the same replay starts faster. Starting another prefetch cancels the previous one.
+	 * @param WorldContextObject 
+	 * @param ReplayName The name the replay is saved as on disk
+	 * @param OnPrefetchComplete Called when the prefetch is done or has failed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Playback",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void PrefetchReplay(UObject* WorldContextObject, const FString& ReplayName,
+	                           FOnPrefetchReplayComplete OnPrefetchComplete);
+
+	/**
+	 *  Cancels the replay prefetch in progress and releases the prefetched map
+	 * @param WorldContextObject 
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Playback",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void CancelReplayPrefetch(UObject* WorldContextObject);
+
+	/**
+	 *  Plays a replay inside the current world, alongside the live game, without any map travel. Needs the map's levels
+	 *  to have been duplicated on load (see UReplayGameEngine). Stops any replay being recorded in this world.
+	 * @param WorldContextObject 
+	 * @param ReplayName The name the replay is saved as on disk
+	 * @param bHideLiveLevels Hide the live game while the replay plays
+	 * @return True if the replay started playing
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Playback",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool PlayInstantReplay(UObject* WorldContextObject, const FString& ReplayName, bool bHideLiveLevels = true);
+
+	/**
+	 *  Stops the instant replay and returns to the live game
+	 * @param WorldContextObject 
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Playback",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void StopInstantReplay(UObject* WorldContextObject);
+
+	/**
+	 *  Returns true if the current world can play instant replays
+	 * @param WorldContextObject 
+	 * @return 
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem|Playback",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool CanPlayInstantReplay(UObject* WorldContextObject);
+
+	/**
+	 *  Restart the currently playing replay
+	 * @param WorldContextObject
+	 * @param OnComplete 
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Playback",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void RestartReplayPlayback(UObject* WorldContextObject,FOnGotoTimeComplete OnComplete);
+
+	/**
+	 *  Goto a specific time in the replay
+	 * @param WorldContextObject 
+	 * @param TimeToGoTo Time in seconds to goto
+	 * @param bRetainCurrentPauseState Use this on a need basis as it can cause some physics issues
+	 * @param OnComplete
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Playback",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void GoToSpecificTime(UObject* WorldContextObject, float TimeToGoTo,
+	                                         bool bRetainCurrentPauseState, FOnGotoTimeComplete OnComplete);
+
+	/**
+	 *  Cuts a time range out of a saved replay into a new replay by copying its recorded data on a worker thread, the
+	 *  replay is not played back. Playing the clip starts at the start of the range
+	 * @param ReplayName The actual name of the replay to cut from
+	 * @param ClipName The actual name the clip is saved as
+	 * @param StartTime Start of the range in seconds
+	 * @param EndTime End of the range in seconds
+	 * @param OnComplete 
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Playback")
+	static void ExtractReplayClip(const FString& ReplayName, const FString& ClipName, float StartTime, float EndTime,
+	                              FOnExtractReplayClipComplete OnComplete);
+
+
+	/**
+	 *  Pause the replay playback
+	 * @param WorldContextObject 
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Playback",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void PausePlayback(UObject* WorldContextObject);
+
+	/**
+	 *  Resume the replay playback
+	 * @param WorldContextObject 
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Playback",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void ResumePlayback(UObject* WorldContextObject);
+
+	/**
+	 *  Sets the Playback speed of the replay
+	 * @param WorldContextObject Set the playback speed of the replay
+	 * @param Speed Like time dilation 0.1,1,10
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Playback",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void SetPlaybackSpeed(UObject* WorldContextObject, float Speed);
+
+
+	/**
+	 *  Get the playback speed of the replay
+	 * @param WorldContextObject 
+	 * @return 
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem|Playback",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static float GetPlaybackSpeed(UObject* WorldContextObject);
+
+
+	/**
+	 *  Get the current time in seconds of the replay
+	 * @param WorldContextObject 
+	 * @return 
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem|Playback",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static float GetCurrentReplayTime(UObject* WorldContextObject);
+
+
+	/**
+	 *  Get the total length in seconds of the replay currently playing or being recorded
+	 * @param WorldContextObject 
+	 * @return 
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem|Playback",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static float GetReplayLength(UObject* WorldContextObject);
+
+
+	/**
+	 *  returns true if a replay is being played
+	 * @param WorldContextObject 
+	 * @return 
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool IsPlayingReplay(UObject* WorldContextObject);
+
+	/**
+	 * Returns true of the replay has been paused
+	 * @param WorldContextObject 
+	 * @return 
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool IsReplayPlaybackPaused(UObject* WorldContextObject);
+
+	/**
+	 *  Gets the name on disk/memory of the replay currently playing or being recorded
+	 * @param WorldContextObject 
+	 * @return 
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static FString GetActiveReplayName(UObject* WorldContextObject);
+
+
+	/**
+	 * Adds or Updates said event in the replay currently being recorded. Game thread only, other threads can use
+	 * FReplayEventQueue::Get().Enqueue
+	 * @param WorldContextObject 
+	 * @param EventId The id of the event
+	 * @param Group The group this event belongs to 
+	 * @param Metadata Metadata As A String
+	 * @param Data Data To Store for this event
+	 * @return 
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool AddEventToActiveReplay(UObject* WorldContextObject, const FString& EventId, const FString& Group,
+	                                   FString Metadata, TArray<uint8> Data);
+
+	/**
+	 *  Adds or updates an event with typed metadata in the replay currently being recorded. Values of the indexed keys
+	 *  can be searched with FindReplayEventsByValue and FindReplayEventsInRange without fetching the events
+	 * @param WorldContextObject 
+	 * @param EventId The id of the event
+	 * @param Group The group this event belongs to
+	 * @param Metadata The typed metadata, stored compactly in the event's metadata string
+	 * @param Data Data To Store for this event
+	 * @return False if no replay is being recorded
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Events",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool AddIndexedEventToActiveReplay(UObject* WorldContextObject, const FString& EventId, const FString& Group,
+	                                          const TArray<FReplayMetadataValue>& Metadata, TArray<uint8> Data);
+
+	/**
+	 *  Sets the metadata keys whose values are indexed for events added from now on
+	 * @param WorldContextObject 
+	 * @param Keys 
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Events",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void SetIndexedReplayMetadataKeys(UObject* WorldContextObject, const TArray<FName>& Keys);
+
+	/**
+	 *  Finds the events of a replay with a metadata value, using the replay's event index
+	 * @param WorldContextObject 
+	 * @param ReplayName The name the replay is saved as on disk
+	 * @param Value The key and value to match, ints and floats compare by value
+	 * @param OnQueryComplete 
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Events",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void FindReplayEventsByValue(UObject* WorldContextObject, const FString& ReplayName,
+	                                    const FReplayMetadataValue& Value, FOnQueryReplayEventsComplete OnQueryComplete);
+
+	/**
+	 *  Finds the events of a replay with an int or float metadata value within [Min, Max], using the replay's event index
+	 * @param WorldContextObject 
+	 * @param ReplayName The name the replay is saved as on disk
+	 * @param Key The metadata key
+	 * @param Min 
+	 * @param Max 
+	 * @param OnQueryComplete 
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Events",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void FindReplayEventsInRange(UObject* WorldContextObject, const FString& ReplayName, FName Key, double Min,
+	                                    double Max, FOnQueryReplayEventsComplete OnQueryComplete);
+
+	/**
+	 *  Finds the events of a group across every replay recorded with the replay system
+	 * @param Group The event group
+	 * @param EventId Only events of this ID, empty for every event of the group
+	 * @return The replays and times the events were added at
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Events")
+	static TArray<FReplaySearchHit> SearchReplayEvents(const FString& Group, const FString& EventId);
+
+	/**
+	 *  Finds the events with an indexed metadata value across every replay recorded with the replay system
+	 * @param Value The key and value to match, ints and floats compare by value
+	 * @return The replays and times the events were added at
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Events")
+	static TArray<FReplaySearchHit> SearchReplayEventsByValue(const FReplayMetadataValue& Value);
+
+	/**
+	 *  Finds the events with an indexed int or float metadata value within [Min, Max] across every replay recorded with
+	 *  the replay system
+	 * @param Key The metadata key
+	 * @param Min 
+	 * @param Max 
+	 * @return The replays and times the events were added at
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Events")
+	static TArray<FReplaySearchHit> SearchReplayEventsInRange(FName Key, double Min, double Max);
+
+	/**
+	 *  Reads the typed metadata of an event added with AddIndexedEventToActiveReplay
+	 * @param Metadata The event's metadata string
+	 * @param Values 
+	 * @return False if the metadata is a plain string
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem|Events")
+	static bool DecodeReplayEventMetadata(const FString& Metadata, TArray<FReplayMetadataValue>& Values);
+
+	/**
+	 *  Gets the Events of the replay currently playing
+	 * @param WorldContextObject 
+	 * @param Group The group name
+	 * @param UserIndex
+	 * @param OnRequestEventsComplete Callback
+	 * @return 
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	void GetActiveReplayEvents(UObject* WorldContextObject, FString Group, int UserIndex,FOnRequestEventsComplete OnRequestEventsComplete);
+
+
+	/**
+	 * @brief 
+	 * @param ReplayActualName The Actual Name Of The Replay
+	 * @param EventId 
+	 * @param UserIndex 
+	 * @param OnGetEventDataComplete 
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void GetDataForEvent(FString ReplayActualName, FString EventId,
+	int UserIndex, FOnGetEventDataComplete OnGetEventDataComplete);
+
+	/**
+	 *  Gets the events of a replay
+	 * @param ReplayActualName The Actual Name Of The Replay
+	 * @param Group 
+	 * @param UserIndex
+	 * @param OnRequestEventsComplete 
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem")
+	static void GetEvents(FString ReplayActualName,FString Group,int UserIndex,FOnRequestEventsComplete OnRequestEventsComplete);
+
+	/**
+	 *  Checks saved replays for damage, e.g. from a crash while recording, using the chunk checksums written while they
+	 *  were recorded. Runs in parallel on worker threads
+	 * @param ReplayNames The actual names of the replays, empty for every saved replay
+	 * @param bRepair Whether damaged replays are cut back to their last valid chunk so they stay playable
+	 * @param OnVerifyComplete Called with a result per replay
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem")
+	static void VerifyReplays(const TArray<FString>& ReplayNames, bool bRepair, FOnVerifyReplaysComplete OnVerifyComplete);
+
+	/**
+	 *  Finalizes the replays left unfinished by a crash while recording so they play up to their last written chunk.
+	 *  Also done on startup when ReplaySystem.RecoverOnStartup is on
+	 * @param OnRecoverComplete Called with a result per replay that needed recovering
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem")
+	static void RecoverReplays(FOnVerifyReplaysComplete OnRecoverComplete);
+
+	/**
+	 *  Has recordings written out every few seconds so a crash only loses the last few seconds of a replay. Applies
+	 *  from the next recording on
+	 * @param bEnabled 
+	 * @param FlushInterval Seconds between two writes, each appends the data recorded since the last one
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Recording")
+	static void SetCrashSafeRecording(bool bEnabled, float FlushInterval = 5.0f);
+
+	/**
+	 *  Uploads a replay to the replay server configured on UReplayUploadSubsystem, resuming an earlier upload of it.
+	 *  A replay still being recorded is uploaded as it is written
+	 * @param WorldContextObject 
+	 * @param ReplayName The actual name of the replay
+	 * @return False if no server is configured or the replay is already being uploaded
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool UploadReplay(UObject* WorldContextObject, const FString& ReplayName);
+
+	/**
+	 *  Stops uploading a replay, the parts the server has are kept for a later resume
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void CancelReplayUpload(UObject* WorldContextObject, const FString& ReplayName);
+
+	/**
+	 *  Gets the progress of an upload
+	 * @return False if the replay has not been uploaded since the game started
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool GetReplayUploadStatus(UObject* WorldContextObject, const FString& ReplayName,
+	                                  FReplayUploadStatus& OutStatus);
+
+	/**
+	 *  Gets the URL of the local replay cache to give the HTTP replay streamer as its server
+	 * @return Empty if no replay server is configured on UReplayCacheSubsystem
+	 */
+	UFUNCTION(BlueprintPure, Category = "ReplaySystem",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static FString GetReplayCacheURL(UObject* WorldContextObject);
+
+	/**
+	 *  Deletes every replay download kept by the local replay cache
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void ClearReplayCache(UObject* WorldContextObject);
+
+	/**
+	 *  Gets the seek, stall and playback lag histograms measured since the game started or the last reset
+	 */
+	UFUNCTION(BlueprintPure, Category = "ReplaySystem|Metrics",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static FReplayMetrics GetReplayMetrics(UObject* WorldContextObject);
+
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Metrics",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void ResetReplayMetrics(UObject* WorldContextObject);
+
+	/**
+	 *  Writes the replay metrics to a CSV file
+	 * @param WorldContextObject 
+	 * @param Filename Where to write, a timestamped file in the profiling directory if empty
+	 * @return False if the file could not be written
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Metrics",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool ExportReplayMetrics(UObject* WorldContextObject, const FString& Filename);
+
+	/**
+	 *  Gets the bytes a part of the replay system holds right now and at most since the game started
+	 */
+	UFUNCTION(BlueprintPure, Category = "ReplaySystem|Memory")
+	static FReplayMemoryUsage GetReplayMemoryUsage(EReplayMemoryCategory Category);
+
+	/**
+	 *  Gets the memory usage of every part of the replay system
+	 */
+	UFUNCTION(BlueprintPure, Category = "ReplaySystem|Memory")
+	static TArray<FReplayMemoryUsage> GetAllReplayMemoryUsage();
+
+	/**
+	 *  Starts measuring the peaks again from the current usage, e.g. at the start of a match
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Memory")
+	static void ResetReplayMemoryPeaks();
+
+	/**
+	 *  Gets the events of many replays, enumerating several of them at the same time
+	 * @param ReplayNames The actual names of the replays
+	 * @param Group The events group, empty for every event
+	 * @param MaxConcurrent How many replays are enumerated at the same time
+	 * @param OnEventListReady Called for every replay as soon as its events are known
+	 * @param OnRequestComplete Called once with the events of every replay, in the order of ReplayNames
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem")
+	static void GetEventsForReplays(const TArray<FString>& ReplayNames, const FString& Group, int32 MaxConcurrent,
+	                                FOnReplayEventListReady OnEventListReady,
+	                                FOnRequestReplayEventListsComplete OnRequestComplete);
+
+	/**
+	 *  Loads the tracks recorded into a replay so they can be evaluated with the Get*TrackValue functions
+	 * @param WorldContextObject 
+	 * @param ReplayName The name the replay is saved as on disk, empty for the replay currently playing
+	 * @param OnLoadComplete 
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Tracks",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void LoadReplayTracks(UObject* WorldContextObject, const FString& ReplayName,
+	                             FOnLoadReplayTracksComplete OnLoadComplete);
+
+	/**
+	 *  Loads the ghost positions recorded into a replay. The replay currently playing loads them on its own
+	 * @param WorldContextObject 
+	 * @param ReplayName The name the replay is saved as on disk, empty for the replay currently playing
+	 * @param OnLoadComplete 
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Ghosts",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void LoadReplayGhosts(UObject* WorldContextObject, const FString& ReplayName,
+	                             FOnLoadReplayTracksComplete OnLoadComplete);
+
+	/**
+	 *  Gets where every player pawn and ghost actor was at a time of the loaded replay, without seeking, e.g. to show
+	 *  them when hovering the timeline
+	 * @param WorldContextObject 
+	 * @param Time The time in seconds
+	 * @param Positions The ghosts that existed at that time
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem|Ghosts",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void GetReplayGhostPositions(UObject* WorldContextObject, float Time,
+	                                    TArray<FReplayGhostPosition>& Positions);
+
+	/**
+	 *  Records the position of an actor as a ghost while replays are recorded, on top of the player pawns
+	 * @param Actor 
+	 * @param Name The name it is shown with, the actor name if empty
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Ghosts")
+	static void AddReplayGhostActor(AActor* Actor, const FString& Name);
+
+	/**
+	 *  Stops recording the position of an actor added with AddReplayGhostActor
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Ghosts")
+	static void RemoveReplayGhostActor(AActor* Actor);
+
+	/**
+	 *  Sets how precisely the keys of a vector, rotator or transform track are stored in the replay. Coarser steps make
+	 *  the recorded tracks smaller
+	 * @param WorldContextObject 
+	 * @param Name The track name
+	 * @param Precision Quantization steps, a step of zero stores that part losslessly
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Tracks",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void SetReplayTrackPrecision(UObject* WorldContextObject, const FString& Name,
+	                                    const FReplayTrackPrecision& Precision);
+
+	/**
+	 *  Evaluates many loaded float tracks at once, cheaper than getting each value on its own
+	 * @param WorldContextObject 
+	 * @param Names The track names
+	 * @param Time The time in seconds to evaluate the tracks at
+	 * @param Values One value per name, 0 for names without a loaded track
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem|Tracks",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void GetFloatTrackValues(UObject* WorldContextObject, const TArray<FString>& Names, float Time,
+	                                TArray<float>& Values);
+
+	/**
+	 *  Evaluates many loaded vector tracks at once, cheaper than getting each value on its own
+	 * @param WorldContextObject 
+	 * @param Names The track names
+	 * @param Time The time in seconds to evaluate the tracks at
+	 * @param Values One value per name, zero for names without a loaded track
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem|Tracks",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void GetVectorTrackValues(UObject* WorldContextObject, const TArray<FString>& Names, float Time,
+	                                 TArray<FVector>& Values);
+
+	/**
+	 *  Samples a numeric or vector property of an object into a track while recording, keeping only as many samples as
+	 *  needed to stay within Tolerance
+	 * @param WorldContextObject 
+	 * @param Object The object to sample, for actors the property is also looked up on the root component
+	 * @param PropertyName The property to sample, e.g. RelativeLocation for an actor's trajectory
+	 * @param TrackName The track the samples are recorded into
+	 * @param Tolerance The largest error allowed when dropping samples, 0 keeps every sample
+	 * @return False if the object has no numeric or vector property of that name
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Tracks",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool AddReplayCurveProperty(UObject* WorldContextObject, UObject* Object, FName PropertyName,
+	                                   const FString& TrackName, float Tolerance = 1.0f);
+
+	/**
+	 *  Stops sampling the property recorded into a track
+	 * @param WorldContextObject 
+	 * @param TrackName 
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Tracks",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void RemoveReplayCurveProperty(UObject* WorldContextObject, const FString& TrackName);
+
+	/**
+	 *  Gets a loaded float track as a curve
+	 * @param WorldContextObject 
+	 * @param Name The track name
+	 * @return Null if no float track of that name is loaded
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Tracks",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static UCurveFloat* GetReplayFloatCurve(UObject* WorldContextObject, const FString& Name);
+
+	/**
+	 *  Gets a loaded vector track as a curve
+	 * @param WorldContextObject 
+	 * @param Name The track name
+	 * @return Null if no vector track of that name is loaded
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Tracks",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static UCurveVector* GetReplayVectorCurve(UObject* WorldContextObject, const FString& Name);
+
+	/**
+	 *  Records a bool value at the current time into the replay being recorded
+	 * @param WorldContextObject 
+	 * @param Data The track name and value
+	 * @return False if no replay is being recorded
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Tracks",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool RecordBoolTrack(UObject* WorldContextObject, const FReplayBoolData& Data);
+
+	/**
+	 *  Gets the value of a loaded bool track at a time
+	 * @param WorldContextObject 
+	 * @param Name The track name
+	 * @param Time Time in seconds
+	 * @param Value The value at that time
+	 * @return False if no such track is loaded
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem|Tracks",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool GetBoolTrackValue(UObject* WorldContextObject, const FString& Name, float Time, bool& Value);
+
+	/**
+	 *  Records a int value at the current time into the replay being recorded
+	 * @param WorldContextObject 
+	 * @param Data The track name and value
+	 * @return False if no replay is being recorded
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Tracks",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool RecordIntTrack(UObject* WorldContextObject, const FReplayIntData& Data);
+
+	/**
+	 *  Gets the value of a loaded int track at a time
+	 * @param WorldContextObject 
+	 * @param Name The track name
+	 * @param Time Time in seconds
+	 * @param Value The value at that time
+	 * @return False if no such track is loaded
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem|Tracks",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool GetIntTrackValue(UObject* WorldContextObject, const FString& Name, float Time, int32& Value);
+
+	/**
+	 *  Records a float value at the current time into the replay being recorded
+	 * @param WorldContextObject 
+	 * @param Data The track name and value
+	 * @return False if no replay is being recorded
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Tracks",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool RecordFloatTrack(UObject* WorldContextObject, const FReplayFloatData& Data);
+
+	/**
+	 *  Gets the value of a loaded float track at a time
+	 * @param WorldContextObject 
+	 * @param Name The track name
+	 * @param Time Time in seconds
+	 * @param Value The value at that time
+	 * @return False if no such track is loaded
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem|Tracks",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool GetFloatTrackValue(UObject* WorldContextObject, const FString& Name, float Time, float& Value);
+
+	/**
+	 *  Records a vector value at the current time into the replay being recorded
+	 * @param WorldContextObject 
+	 * @param Data The track name and value
+	 * @return False if no replay is being recorded
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Tracks",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool RecordVectorTrack(UObject* WorldContextObject, const FReplayVectorData& Data);
+
+	/**
+	 *  Gets the value of a loaded vector track at a time
+	 * @param WorldContextObject 
+	 * @param Name The track name
+	 * @param Time Time in seconds
+	 * @param Value The value at that time
+	 * @return False if no such track is loaded
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem|Tracks",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool GetVectorTrackValue(UObject* WorldContextObject, const FString& Name, float Time, FVector& Value);
+
+	/**
+	 *  Records a rotator value at the current time into the replay being recorded
+	 * @param WorldContextObject 
+	 * @param Data The track name and value
+	 * @return False if no replay is being recorded
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Tracks",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool RecordRotatorTrack(UObject* WorldContextObject, const FReplayRotatorData& Data);
+
+	/**
+	 *  Gets the value of a loaded rotator track at a time
+	 * @param WorldContextObject 
+	 * @param Name The track name
+	 * @param Time Time in seconds
+	 * @param Value The value at that time
+	 * @return False if no such track is loaded
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem|Tracks",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool GetRotatorTrackValue(UObject* WorldContextObject, const FString& Name, float Time, FRotator& Value);
+
+	/**
+	 *  Records a transform value at the current time into the replay being recorded
+	 * @param WorldContextObject 
+	 * @param Data The track name and value
+	 * @return False if no replay is being recorded
+	 */
+	UFUNCTION(BlueprintCallable, Category = "ReplaySystem|Tracks",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool RecordTransformTrack(UObject* WorldContextObject, const FReplayTransformData& Data);
+
+	/**
+	 *  Gets the value of a loaded transform track at a time
+	 * @param WorldContextObject 
+	 * @param Name The track name
+	 * @param Time Time in seconds
+	 * @param Value The value at that time
+	 * @return False if no such track is loaded
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem|Tracks",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static bool GetTransformTrackValue(UObject* WorldContextObject, const FString& Name, float Time, FTransform& Value);
+	
+	/**
+	 *  Helper function to convert milliseconds to seconds
+	 * @param MS 
+	 * @return 
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ReplaySystem|Utilities")
+	static float MsToSeconds(const int32 MS);
+
+	/**
+	 *  Just sets the view target of the controller to the specified actor
+	 * @param WorldContextObject
+	 * @param Actor The pawn to spectate
+	 */
+	UFUNCTION(BlueprintCallable, Category= "ReplaySystem",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void SpectateActor(UObject* WorldContextObject, AActor* Actor, FBlendSettings BlendSettings);
+
+	/**
+	 *  Just sets the view target of the controller back to the possessed pawn
+	 * @param WorldContextObject 
+	 * @param BlendSettings 
+	 */
+	UFUNCTION(BlueprintCallable, Category= "ReplaySystem",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void StopSpectating(UObject* WorldContextObject, FBlendSettings BlendSettings);
+
+	UFUNCTION(Category= "ReplaySystem", meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static UDemoNetDriver* GetDemoDriver(const UObject* WorldContextObject);
+
+	/**
+	 *Set the maximum number of frames recorded per second by the replay
+	 */
+	UFUNCTION(BlueprintCallable, Category= "ReplaySystem",
+		meta = (HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject"))
+	static void SetMaxRecordHz(UObject* WorldContextObject, float Hz = 8.0f);
+
+
+	/**
+	* Get the maximum number of frames recorded per second by the replay
+	*/
+	UFUNCTION(BlueprintCallable, Category= "ReplaySystem")
+	static float GetMaxRecordHz();
+
+	/**
+	* Serializes A Struct
+	*/
+	UFUNCTION(BlueprintCallable, BlueprintPure, CustomThunk, meta = (CustomStructureParam = "Struct"),
+		Category= "ReplaySystem")
+	static void SerializeStruct(UStruct* Struct, TArray<uint8>& Data);
+
+
+	/**
+	* De-Serializes A Struct
+	*/
+	UFUNCTION(BlueprintCallable, BlueprintPure, CustomThunk, meta = (CustomStructureParam = "Struct"),
+		Category= "ReplaySystem")
+	static void DeSerializeStruct(TArray<uint8> Data, UStruct* & Struct);
+
+
+	/**
+	* Converts A String Into Bytes
+	*/
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category= "ReplaySystem")
+	static TArray<uint8> StringToBytes(FString Data);
+
+	/**
+	* Converts Bytes To A String
+	*/
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category= "ReplaySystem")
+	static FString BytesToString(TArray<uint8> Data);
+
+
+	//Convert property into c++ accessible form
+	DECLARE_FUNCTION(execSerializeStruct)
+	{
+		
+		Stack.StepCompiledIn<FStructProperty>(nullptr);
+		const auto Struct = CastField<FStructProperty>(Stack.MostRecentProperty);
+		const void* StructValue = Stack.MostRecentPropertyAddress;
+		
+		// Stack.StepCompiledIn<FStructProperty>(nullptr);
+		// const auto Data = CastField<FArrayProperty>(Stack.MostRecentProperty);
+		// const auto DataValue = Data->ContainerPtrToValuePtr<TArray<uint8>>((void*)Stack.Object);
+		PARAM_PASSED_BY_REF(Data, FArrayProperty,TArray<uint8>);
+		
+		
+		
+		P_FINISH;
+
+		if(!Struct )//|| !Data)
+		{
+			return;
+		}
+
+		P_NATIVE_BEGIN;
+
+		FString asString = FString();
+
+		FJsonObjectConverter::UStructToJsonObjectString(Struct->Struct, StructValue, asString);
+
+		// DataValue = &(StringToBytes(asString));
+		Data = StringToBytes(asString);
+
+		P_NATIVE_END;
+	}
+
+
+	//Convert property into c++ accessible form
+	DECLARE_FUNCTION(execDeSerializeStruct)
+	{
+		// Stack.StepCompiledIn<FStructProperty>(nullptr);
+		// const auto Data = CastField<FArrayProperty>(Stack.MostRecentProperty);
+		// const auto DataValue = Data->ContainerPtrToValuePtr<TArray<uint8>>((void*)Stack.Object);
+		PARAM_PASSED_BY_VAL(Data, FArrayProperty,TArray<uint8>);
+
+		Stack.StepCompiledIn<FStructProperty>(nullptr);
+		const auto Struct = CastField<FStructProperty>(Stack.MostRecentProperty);
+		void* StructValue = Stack.MostRecentPropertyAddress;
+
+		P_FINISH;
+
+		if(!Struct) //|| !Data)
+		{
+			return;
+		}
+
+		P_NATIVE_BEGIN;
+
+		const auto JsonString = BytesToString(Data);//BytesToString(*DataValue);
+
+		FJsonObjectWrapper Wrapper;
+
+		Wrapper.JsonObjectFromString(JsonString);
+
+		FJsonObjectConverter::JsonObjectToUStruct(Wrapper.JsonObject.ToSharedRef(), Struct->Struct, StructValue);
+
+		P_NATIVE_END;
+	}
+};
+
@@ -0,0 +1,201 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ReplayDelegates.h"
+#include "ReplayMemory.h"
+#include "ReplayTracks.h"
+#include "ReplayTrackSubsystem.generated.h"
+
+class UCurveFloat;
+class UCurveVector;
+
+/**
+ *  Records named typed values (bool, int, float, vector, rotator, transform) over time into the replay being recorded
+ *  and evaluates them again at any time once loaded from a replay. Tracks are collected in memory and flushed into the
+ *  replay every FlushInterval seconds and when recording stops as a compact columnar chunk stored as a replay event
+ *  (group "ReplayTracks").
+ */
+UCLASS(config = Game)
+class REPLAYSYSTEM_API UReplayTrackSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	static UReplayTrackSubsystem* Get(const UObject* WorldContextObject);
+
+	/**
+	 *  Records a value at the current replay time
+	 * @return False if no replay is being recorded
+	 */
+	template <typename ValueType>
+	bool Record(const FString& Name, const ValueType& Value)
+	{
+		float Time = 0.0f;
+		if (!GetRecordTime(Time))
+		{
+			return false;
+		}
+
+		LLM_SCOPE_BYTAG(ReplaySystem_Tracks);
+		RecordingTracks.Record(Name, Time, Value);
+		return true;
+	}
+
+	/**
+	 *  Evaluates a loaded track
+	 * @return False if no track of that name and type is loaded
+	 */
+	template <typename ValueType>
+	bool Evaluate(const FString& Name, float Time, ValueType& OutValue) const
+	{
+		return LoadedTracks.Evaluate(Name, Time, OutValue);
+	}
+
+	/**
+	 *  Sets how precisely the vector, rotator and transform keys of a track are stored from its next chunk on
+	 * @param Name The track name
+	 * @param Precision Quantization steps, a step of zero stores that part losslessly
+	 */
+	void SetTrackPrecision(const FString& Name, const FReplayTrackPrecision& Precision);
+
+	/**
+	 *  Samples a property of an object into a track every CurveSampleInterval seconds while recording. The samples are
+	 *  simplified to the fewest keys that stay within Tolerance before they are written into the replay
+	 * @param Object The object to sample, for actors the property is also looked up on the root component
+	 * @param PropertyName A numeric or FVector property, e.g. RelativeLocation for an actor's trajectory
+	 * @param TrackName The track the samples are recorded into
+	 * @param Tolerance The largest error allowed when dropping samples, 0 keeps every sample
+	 * @return False if the object has no numeric or vector property of that name
+	 */
+	bool AddCurveProperty(UObject* Object, FName PropertyName, const FString& TrackName, float Tolerance);
+
+	void RemoveCurveProperty(const FString& TrackName);
+
+	/**
+	 *  A curve of a loaded float track, created the first time it is asked for
+	 * @return Null if no float track of that name is loaded
+	 */
+	UCurveFloat* GetFloatCurve(const FString& Name);
+
+	/**
+	 *  A curve of a loaded vector track, created the first time it is asked for
+	 * @return Null if no vector track of that name is loaded
+	 */
+	UCurveVector* GetVectorCurve(const FString& Name);
+
+	/**
+	 *  Evaluates many loaded tracks of one type at once
+	 * @param Names The tracks to evaluate
+	 * @param Time The time to evaluate at
+	 * @param OutValues One value per name, left untouched for names without a loaded track
+	 */
+	template <typename ValueType>
+	void EvaluateBatch(TConstArrayView<FString> Names, float Time, TArrayView<ValueType> OutValues) const
+	{
+		check(Names.Num() == OutValues.Num());
+
+		const TReplayNamedColumn<TReplayTrack<ValueType>>& Tracks = LoadedTracks.GetTracks<ValueType>();
+
+		TArray<int32, TInlineAllocator<128>> Slots;
+		TArray<int32, TInlineAllocator<128>> Outputs;
+		TArray<ValueType, TInlineAllocator<128>> Values;
+		for (int32 Index = 0; Index < Names.Num(); ++Index)
+		{
+			const FName Name = ReplayNamedColumn::FindName(Names[Index]);
+			const int32 Slot = Name.IsNone() ? INDEX_NONE : Tracks.IndexOf(Name);
+			if (Slot != INDEX_NONE)
+			{
+				Slots.Add(Slot);
+				Outputs.Add(Index);
+				Values.Add(OutValues[Index]);
+			}
+		}
+
+		LoadedTracks.EvaluateBatch<ValueType>(Time, Slots, Values);
+
+		for (int32 Index = 0; Index < Outputs.Num(); ++Index)
+		{
+			OutValues[Outputs[Index]] = Values[Index];
+		}
+	}
+
+	/**
+	 *  Writes the tracks recorded since the last flush into the replay
+	 */
+	void FlushTracks();
+
+	/**
+	 *  Loads every track chunk of a replay, replacing the tracks loaded before
+	 * @param ReplayName The name the replay is saved as on disk
+	 * @param OnComplete
+	 */
+	void LoadTracks(const FString& ReplayName, FOnLoadReplayTracksComplete OnComplete);
+
+	const FReplayTrackSet& GetLoadedTracks() const { return LoadedTracks; }
+
+	const FString& GetLoadedReplayName() const { return LoadedReplayName; }
+
+	//Seconds of replay time between two chunks written into the replay
+	UPROPERTY(Config)
+	float FlushInterval = 10.0f;
+
+	//Seconds of replay time between two samples of the curve properties
+	UPROPERTY(Config)
+	float CurveSampleInterval = 0.1f;
+
+protected:
+	struct FCurveSampler
+	{
+		//The object owning the property, the root component for actor components' properties
+		TWeakObjectPtr<UObject> Container;
+
+		const FProperty* Property = nullptr;
+
+		FName TrackName;
+	};
+
+	bool GetRecordTime(float& OutTime) const;
+
+	void SampleCurves(float Time);
+
+	TArray<FCurveSampler> CurveSamplers;
+
+	//Curves created from the loaded float tracks
+	UPROPERTY(Transient)
+	TMap<FName, TObjectPtr<UCurveFloat>> FloatCurves;
+
+	//Curves created from the loaded vector tracks, a float and a vector track may share a name
+	UPROPERTY(Transient)
+	TMap<FName, TObjectPtr<UCurveVector>> VectorCurves;
+
+	float LastCurveSampleTime = 0.0f;
+
+	FReplayTrackSet RecordingTracks;
+
+	FReplayTrackSet LoadedTracks;
+
+	FString LoadedReplayName;
+
+	FString RecordingReplayName;
+
+	int32 NextChunkIndex = 0;
+
+	float LastFlushTime = 0.0f;
+
+	//Incremented whenever a load starts so a stale load does not overwrite a newer one
+	int32 LoadSerial = 0;
+
+	FDelegateHandle RecordingStoppingHandle;
+
+	//The recording and loaded tracks, updated every tick
+	FReplayMemory::FCounter MemoryCounter{EReplayMemoryCategory::Tracks};
+};
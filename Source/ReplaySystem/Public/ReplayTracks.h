@@ -0,0 +1,558 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Algo/BinarySearch.h"
+#include "ReplayNamedColumn.h"
+#include "ReplayStructs.h"
+#include <type_traits>
+
+namespace ReplayTracks
+{
+	//The replay event group track chunks are stored under
+	inline const TCHAR* EventGroup = TEXT("ReplayTracks");
+
+	enum class EChunkVersion : uint8
+	{
+		Initial = 1,
+		//Times and vector/rotator/transform values are quantized and delta encoded
+		QuantizedKeys,
+
+		LatestPlusOne,
+		Latest = LatestPlusOne - 1
+	};
+
+	/**
+	 *  Compact key codecs. Times are stored in milliseconds and spatial values quantized to the track precision, both as
+	 *  variable length deltas to the previous key with an absolute key every KeyframeInterval keys.
+	 */
+	REPLAYSYSTEM_API void SerializeTimes(FArchive& Ar, TArray<float>& Times, const FReplayTrackPrecision& Precision);
+	REPLAYSYSTEM_API void SerializeValues(FArchive& Ar, TArray<FVector>& Values, const FReplayTrackPrecision& Precision);
+	REPLAYSYSTEM_API void SerializeValues(FArchive& Ar, TArray<FRotator>& Values, const FReplayTrackPrecision& Precision);
+	REPLAYSYSTEM_API void SerializeValues(FArchive& Ar, TArray<FTransform>& Values, const FReplayTrackPrecision& Precision);
+
+	template <typename ValueType>
+	constexpr bool IsQuantized()
+	{
+		return std::is_same_v<ValueType, FVector> || std::is_same_v<ValueType, FRotator> || std::is_same_v<
+			ValueType, FTransform>;
+	}
+
+	inline double KeyError(float A, float B)
+	{
+		return FMath::Abs(A - B);
+	}
+
+	inline double KeyError(const FVector& A, const FVector& B)
+	{
+		return FVector::Dist(A, B);
+	}
+
+	/**
+	 *  How values of a track type are blended between two keys. Bools and ints hold the previous key.
+	 */
+	template <typename ValueType>
+	struct TTraits
+	{
+		static ValueType Interpolate(const ValueType& A, const ValueType& B, float Alpha)
+		{
+			return FMath::Lerp(A, B, Alpha);
+		}
+	};
+
+	template <>
+	struct TTraits<bool>
+	{
+		static bool Interpolate(bool A, bool B, float Alpha)
+		{
+			return A;
+		}
+	};
+
+	template <>
+	struct TTraits<int32>
+	{
+		static int32 Interpolate(int32 A, int32 B, float Alpha)
+		{
+			return A;
+		}
+	};
+
+	template <>
+	struct TTraits<FRotator>
+	{
+		static FRotator Interpolate(const FRotator& A, const FRotator& B, float Alpha)
+		{
+			return FQuat::Slerp(A.Quaternion(), B.Quaternion(), Alpha).Rotator();
+		}
+	};
+
+	template <>
+	struct TTraits<FTransform>
+	{
+		static FTransform Interpolate(const FTransform& A, const FTransform& B, float Alpha)
+		{
+			FTransform Result;
+			Result.Blend(A, B, Alpha);
+			return Result;
+		}
+	};
+}
+
+/**
+ *  The keys of a single named value over time, stored as a column of times and a column of values.
+ *  Times are in seconds of replay time and never decrease.
+ */
+template <typename ValueType>
+struct TReplayTrack
+{
+	TArray<float> Times;
+
+	TArray<ValueType> Values;
+
+	//How precisely the keys are stored, only vector, rotator and transform values are quantized
+	FReplayTrackPrecision Precision;
+
+	//Last key found by FindKeyIndexCached
+	mutable int32 Cursor = 0;
+
+	int32 Num() const
+	{
+		return Times.Num();
+	}
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Times.GetAllocatedSize() + Values.GetAllocatedSize();
+	}
+
+	void Add(float Time, const ValueType& Value)
+	{
+		if (Times.Num() > 0 && Time <= Times.Last())
+		{
+			// Several updates in one frame, the last one wins
+			Values.Last() = Value;
+			return;
+		}
+
+		Times.Add(Time);
+		Values.Add(Value);
+	}
+
+	/**
+	 *  Appends the keys of a later chunk of the same track
+	 */
+	void Append(const TReplayTrack& Other)
+	{
+		for (int32 Index = 0; Index < Other.Num(); ++Index)
+		{
+			Add(Other.Times[Index], Other.Values[Index]);
+		}
+	}
+
+	/**
+	 *  Drops every key that lies within Tolerance of the line between the keys kept around it (Ramer-Douglas-Peucker),
+	 *  so evaluating the track never moves by more than Tolerance. The first and last keys are always kept.
+	 *  Only float and vector tracks can be simplified.
+	 */
+	void Simplify(float Tolerance)
+	{
+		if (Times.Num() < 3 || Tolerance <= 0.0f)
+		{
+			return;
+		}
+
+		TArray<bool> Keep;
+		Keep.Init(false, Times.Num());
+		Keep[0] = true;
+		Keep.Last() = true;
+
+		TArray<TPair<int32, int32>, TInlineAllocator<64>> Spans;
+		Spans.Emplace(0, Times.Num() - 1);
+
+		while (Spans.Num() > 0)
+		{
+			const TPair<int32, int32> Span = Spans.Pop(EAllowShrinking::No);
+			const float SpanTime = FMath::Max(Times[Span.Value] - Times[Span.Key], UE_SMALL_NUMBER);
+
+			double MaxError = Tolerance;
+			int32 Split = INDEX_NONE;
+
+			for (int32 Index = Span.Key + 1; Index < Span.Value; ++Index)
+			{
+				const float Alpha = (Times[Index] - Times[Span.Key]) / SpanTime;
+				const double Error = ReplayTracks::KeyError(
+					ReplayTracks::TTraits<ValueType>::Interpolate(Values[Span.Key], Values[Span.Value], Alpha),
+					Values[Index]);
+
+				if (Error > MaxError)
+				{
+					MaxError = Error;
+					Split = Index;
+				}
+			}
+
+			if (Split != INDEX_NONE)
+			{
+				Keep[Split] = true;
+				Spans.Emplace(Span.Key, Split);
+				Spans.Emplace(Split, Span.Value);
+			}
+		}
+
+		int32 NumKept = 0;
+		for (int32 Index = 0; Index < Times.Num(); ++Index)
+		{
+			if (Keep[Index])
+			{
+				Times[NumKept] = Times[Index];
+				Values[NumKept] = Values[Index];
+				++NumKept;
+			}
+		}
+
+		Times.SetNum(NumKept, EAllowShrinking::No);
+		Values.SetNum(NumKept, EAllowShrinking::No);
+	}
+
+	/**
+	 *  Index of the last key at or before Time, INDEX_NONE if Time is before the first key
+	 */
+	int32 FindKeyIndex(float Time) const
+	{
+		return Algo::UpperBound(Times, Time) - 1;
+	}
+
+	/**
+	 *  FindKeyIndex that first tries the key found by the previous call and the one after it, so tracks played forward
+	 *  frame by frame skip the binary search. Not thread safe.
+	 */
+	int32 FindKeyIndexCached(float Time) const
+	{
+		const int32 NumKeys = Times.Num();
+
+		for (int32 Index = Cursor; Index <= Cursor + 1 && Index < NumKeys; ++Index)
+		{
+			if (Index >= 0 && Times[Index] <= Time && (Index + 1 == NumKeys || Time < Times[Index + 1]))
+			{
+				Cursor = Index;
+				return Index;
+			}
+		}
+
+		Cursor = FindKeyIndex(Time);
+		return Cursor;
+	}
+
+	/**
+	 *  Evaluates the track at a time, holding the first/last key outside of the track's range
+	 * @return False if the track has no keys
+	 */
+	bool Evaluate(float Time, ValueType& OutValue) const
+	{
+		if (Times.Num() == 0)
+		{
+			return false;
+		}
+
+		const int32 Index = FindKeyIndex(Time);
+
+		if (Index < 0)
+		{
+			OutValue = Values[0];
+		}
+		else if (Index >= Times.Num() - 1)
+		{
+			OutValue = Values.Last();
+		}
+		else
+		{
+			const float Alpha = (Time - Times[Index]) / FMath::Max(Times[Index + 1] - Times[Index], UE_SMALL_NUMBER);
+			OutValue = ReplayTracks::TTraits<ValueType>::Interpolate(Values[Index], Values[Index + 1], Alpha);
+		}
+
+		return true;
+	}
+
+	void Serialize(FArchive& Ar, uint8 Version)
+	{
+		if (Version >= static_cast<uint8>(ReplayTracks::EChunkVersion::QuantizedKeys))
+		{
+			Ar << Precision;
+			ReplayTracks::SerializeTimes(Ar, Times, Precision);
+		}
+		else
+		{
+			Ar << Times;
+		}
+
+		if constexpr (std::is_same_v<ValueType, bool>)
+		{
+			// One byte per key instead of the four FArchive uses for a bool
+			TArray<uint8> Bytes;
+			if (Ar.IsSaving())
+			{
+				Bytes.Reserve(Values.Num());
+				for (const bool bValue : Values)
+				{
+					Bytes.Add(bValue ? 1 : 0);
+				}
+			}
+
+			Ar << Bytes;
+
+			if (Ar.IsLoading())
+			{
+				Values.Reset(Bytes.Num());
+				for (const uint8 Byte : Bytes)
+				{
+					Values.Add(Byte != 0);
+				}
+			}
+		}
+		else if constexpr (ReplayTracks::IsQuantized<ValueType>())
+		{
+			if (Version >= static_cast<uint8>(ReplayTracks::EChunkVersion::QuantizedKeys))
+			{
+				ReplayTracks::SerializeValues(Ar, Values, Precision);
+			}
+			else
+			{
+				Ar << Values;
+			}
+		}
+		else
+		{
+			Ar << Values;
+		}
+
+		if (Ar.IsLoading() && Times.Num() != Values.Num())
+		{
+			Ar.SetError();
+		}
+	}
+};
+
+/**
+ *  A set of named tracks of every supported type. Used both to collect the tracks being recorded (flushed into the
+ *  replay as chunks) and to hold the tracks loaded from a replay for playback. Track names are interned so finding a
+ *  track never compares strings.
+ */
+class REPLAYSYSTEM_API FReplayTrackSet
+{
+public:
+	template <typename ValueType>
+	TReplayNamedColumn<TReplayTrack<ValueType>>& GetTracks()
+	{
+		if constexpr (std::is_same_v<ValueType, bool>)
+		{
+			return BoolTracks;
+		}
+		else if constexpr (std::is_same_v<ValueType, int32>)
+		{
+			return IntTracks;
+		}
+		else if constexpr (std::is_same_v<ValueType, float>)
+		{
+			return FloatTracks;
+		}
+		else if constexpr (std::is_same_v<ValueType, FVector>)
+		{
+			return VectorTracks;
+		}
+		else if constexpr (std::is_same_v<ValueType, FRotator>)
+		{
+			return RotatorTracks;
+		}
+		else
+		{
+			static_assert(std::is_same_v<ValueType, FTransform>, "Unsupported replay track type");
+			return TransformTracks;
+		}
+	}
+
+	template <typename ValueType>
+	const TReplayNamedColumn<TReplayTrack<ValueType>>& GetTracks() const
+	{
+		return const_cast<FReplayTrackSet*>(this)->GetTracks<ValueType>();
+	}
+
+	template <typename ValueType>
+	void Record(const FName Name, float Time, const ValueType& Value)
+	{
+		TReplayTrack<ValueType>& Track = GetTracks<ValueType>().FindOrAdd(Name);
+
+		if (Track.Num() == 0)
+		{
+			if (const FReplayTrackPrecision* TrackPrecision = Precisions.Find(Name))
+			{
+				Track.Precision = *TrackPrecision;
+			}
+		}
+
+		Track.Add(Time, Value);
+	}
+
+	template <typename ValueType>
+	void Record(const FString& Name, float Time, const ValueType& Value)
+	{
+		Record(FName(*Name), Time, Value);
+	}
+
+	template <typename ValueType>
+	bool Evaluate(const FName Name, float Time, ValueType& OutValue) const
+	{
+		if (const TReplayTrack<ValueType>* Track = GetTracks<ValueType>().Find(Name))
+		{
+			return Track->Evaluate(Time, OutValue);
+		}
+		return false;
+	}
+
+	template <typename ValueType>
+	bool Evaluate(const FString& Name, float Time, ValueType& OutValue) const
+	{
+		const FName Key = ReplayNamedColumn::FindName(Name);
+		return !Key.IsNone() && Evaluate(Key, Time, OutValue);
+	}
+
+	/**
+	 *  Evaluates many tracks of one type at the same time into a caller provided buffer. The keys around Time are looked
+	 *  up first, the values are then gathered into contiguous arrays and blended in one tight loop the compiler can
+	 *  vectorize for float and vector tracks.
+	 * @param Time The time to evaluate at
+	 * @param Slots The tracks to evaluate, as indices into GetTracks<ValueType>().GetNames()
+	 * @param OutValues One value per slot, tracks without keys are left untouched
+	 */
+	template <typename ValueType>
+	void EvaluateBatch(float Time, TConstArrayView<int32> Slots, TArrayView<ValueType> OutValues) const
+	{
+		check(Slots.Num() == OutValues.Num());
+
+		const TConstArrayView<TReplayTrack<ValueType>> Tracks = GetTracks<ValueType>().GetValues();
+		const int32 Num = Slots.Num();
+
+		TArray<ValueType, TInlineAllocator<128>> From;
+		TArray<ValueType, TInlineAllocator<128>> To;
+		TArray<float, TInlineAllocator<128>> Alphas;
+		TArray<int32, TInlineAllocator<128>> Outputs;
+		From.Reserve(Num);
+		To.Reserve(Num);
+		Alphas.Reserve(Num);
+		Outputs.Reserve(Num);
+
+		for (int32 Index = 0; Index < Num; ++Index)
+		{
+			const TReplayTrack<ValueType>& Track = Tracks[Slots[Index]];
+			const int32 NumKeys = Track.Num();
+
+			if (NumKeys == 0)
+			{
+				continue;
+			}
+
+			const int32 Key = FMath::Clamp(Track.FindKeyIndexCached(Time), 0, NumKeys - 1);
+			const int32 NextKey = FMath::Min(Key + 1, NumKeys - 1);
+			const float Span = Track.Times[NextKey] - Track.Times[Key];
+
+			From.Add(Track.Values[Key]);
+			To.Add(Track.Values[NextKey]);
+			Alphas.Add(Span > UE_SMALL_NUMBER ? FMath::Clamp((Time - Track.Times[Key]) / Span, 0.0f, 1.0f) : 0.0f);
+			Outputs.Add(Index);
+		}
+
+		const int32 NumBlended = Outputs.Num();
+
+		if constexpr (std::is_same_v<ValueType, float> || std::is_same_v<ValueType, FVector>)
+		{
+			ValueType* RESTRICT FromData = From.GetData();
+			const ValueType* RESTRICT ToData = To.GetData();
+			const float* RESTRICT AlphaData = Alphas.GetData();
+
+			for (int32 Index = 0; Index < NumBlended; ++Index)
+			{
+				FromData[Index] += (ToData[Index] - FromData[Index]) * AlphaData[Index];
+			}
+
+			for (int32 Index = 0; Index < NumBlended; ++Index)
+			{
+				OutValues[Outputs[Index]] = FromData[Index];
+			}
+		}
+		else
+		{
+			for (int32 Index = 0; Index < NumBlended; ++Index)
+			{
+				OutValues[Outputs[Index]] = ReplayTracks::TTraits<ValueType>::Interpolate(From[Index], To[Index],
+					Alphas[Index]);
+			}
+		}
+	}
+
+	/**
+	 *  Evaluates every track of one type, OutValues is resized to and ordered like GetTracks<ValueType>().GetNames()
+	 */
+	template <typename ValueType>
+	void EvaluateBatch(float Time, TArray<ValueType>& OutValues) const
+	{
+		const int32 Num = GetTracks<ValueType>().Num();
+
+		TArray<int32, TInlineAllocator<128>> Slots;
+		Slots.SetNumUninitialized(Num);
+		for (int32 Slot = 0; Slot < Num; ++Slot)
+		{
+			Slots[Slot] = Slot;
+		}
+
+		OutValues.SetNumZeroed(Num);
+		EvaluateBatch<ValueType>(Time, Slots, OutValues);
+	}
+
+	/**
+	 *  Appends the keys of a later chunk to the tracks of this set
+	 */
+	void Append(const FReplayTrackSet& Other);
+
+	void Serialize(FArchive& Ar);
+
+	bool IsEmpty() const;
+
+	void Reset();
+
+	SIZE_T GetAllocatedSize() const;
+
+	/**
+	 *  Sets the precision tracks of this name are stored at from now on. Kept across Reset
+	 */
+	void SetPrecision(const FName Name, const FReplayTrackPrecision& Precision);
+
+	FReplayTrackPrecision GetPrecision(const FName Name) const;
+
+	/**
+	 *  Simplifies the float and vector tracks whose precision has a tolerance
+	 */
+	void Simplify();
+
+private:
+	TMap<FName, FReplayTrackPrecision> Precisions;
+
+	TReplayNamedColumn<TReplayTrack<bool>> BoolTracks;
+	TReplayNamedColumn<TReplayTrack<int32>> IntTracks;
+	TReplayNamedColumn<TReplayTrack<float>> FloatTracks;
+	TReplayNamedColumn<TReplayTrack<FVector>> VectorTracks;
+	TReplayNamedColumn<TReplayTrack<FRotator>> RotatorTracks;
+	TReplayNamedColumn<TReplayTrack<FTransform>> TransformTracks;
+};
+
+namespace ReplayTracks
+{
+	/**
+	 *  Reads every track chunk of a group from a replay and appends them in the order they were written
+	 * @param ReplayName The name the replay is saved as
+	 * @param Group The replay event group the chunks were written under
+	 * @param OnComplete Called on the game thread with the tracks, bWasSuccessful is false if any chunk was missing or corrupt
+	 */
+	REPLAYSYSTEM_API void LoadChunks(const FString& ReplayName, const FString& Group,
+	                                 TFunction<void(bool bWasSuccessful, FReplayTrackSet&& Tracks)> OnComplete);
+}
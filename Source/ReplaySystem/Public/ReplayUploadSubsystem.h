@@ -0,0 +1,158 @@
+// Copyright 2020-Present Oyintare Ebelo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "ReplayDelegates.h"
+#include "ReplayStructs.h"
+#include "ReplayUploadSubsystem.generated.h"
+
+class IHttpRequest;
+
+/**
+ *  Uploads replays saved by the local file streamer to an HTTP server in parts, while they are recorded or once they
+ *  are finished. A part is a byte range of the replay file identified by its offset; stream data and checkpoints are
+ *  sent as soon as they are on disk since the streamer never rewrites them, the header and events once the replay is
+ *  finished. Parts are gzip compressed and at most MaxConcurrentUploads are read and in flight at a time, so a slow
+ *  server holds the upload back instead of filling memory. The server is asked which parts it already has before
+ *  uploading, so an interrupted upload resumes where it stopped.
+ *
+ *  The server is expected to answer, for a replay <Name> under Endpoint:
+ *  GET <Endpoint>/<Name>/parts with {"parts": [offset, ...]} (or 404 for none),
+ *  PUT <Endpoint>/<Name>/parts/<Offset> with the gzip compressed range and its size and CRC in the headers,
+ *  POST <Endpoint>/<Name>/complete with {"size": bytes, "parts": [{"offset": o, "size": s}, ...]} to assemble it.
+ */
+UCLASS(config = Game)
+class REPLAYSYSTEM_API UReplayUploadSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	static UReplayUploadSubsystem* Get(const UObject* WorldContextObject);
+
+	/**
+	 *  Starts or resumes uploading a replay. A replay still being recorded is uploaded as it grows and finished once
+	 *  the streamer has finalized it
+	 * @return False if there is no endpoint or the replay is already being uploaded
+	 */
+	bool UploadReplay(const FString& ReplayName);
+
+	void CancelUpload(const FString& ReplayName);
+
+	/**
+	 *  The state of an upload started since the game started
+	 */
+	bool GetUploadStatus(const FString& ReplayName, FReplayUploadStatus& OutStatus) const;
+
+	//Called when an upload completes or fails
+	UPROPERTY(BlueprintAssignable, Category = "ReplaySystem|Events")
+	FOnReplayUploadFinished OnUploadFinished;
+
+	//Base URL of the replay server, uploads are disabled while empty
+	UPROPERTY(Config)
+	FString Endpoint;
+
+	//Sent as the Authorization header of every request if set
+	UPROPERTY(Config)
+	FString Authorization;
+
+	//Upload every replay recorded by this game while it is recorded
+	UPROPERTY(Config)
+	bool bUploadWhileRecording = false;
+
+	//Parts read and in flight at the same time
+	UPROPERTY(Config)
+	int32 MaxConcurrentUploads = 4;
+
+	//Largest part in bytes, larger chunks are split
+	UPROPERTY(Config)
+	int32 MaxPartSize = 4 * 1024 * 1024;
+
+	//Attempts per part before the upload fails, with doubling delays in between
+	UPROPERTY(Config)
+	int32 MaxAttempts = 5;
+
+	//Seconds between two looks at a growing replay for new parts
+	UPROPERTY(Config)
+	float ScanInterval = 2.0f;
+
+protected:
+	struct FPart
+	{
+		int64 Offset = 0;
+
+		int64 Size = 0;
+
+		int32 Attempts = 0;
+
+		//Not sent again before this time after a failure
+		double RetryTime = 0.0;
+	};
+
+	struct FUpload
+	{
+		FReplayUploadStatus Status;
+
+		//Offsets the server has
+		TSet<int64> Received;
+
+		//Offsets queued or in flight
+		TSet<int64> Known;
+
+		TArray<FPart> Queue;
+
+		int32 NumInFlight = 0;
+
+		bool bScanning = false;
+
+		double LastScanTime = 0.0;
+
+		//Set once a scan found the replay finalized, every part is known from then on
+		bool bFinalized = false;
+
+		int64 FileSize = 0;
+
+		//Every part of the finalized replay, sent with the completion so the server can assemble it
+		TArray<FPart> FinalParts;
+
+		bool bCompleting = false;
+
+		//Incremented on cancel so responses of a cancelled upload are ignored
+		int32 Serial = 0;
+	};
+
+	bool Tick(float DeltaTime);
+
+	void WatchRecording();
+
+	void RequestReceivedParts(const TSharedRef<FUpload>& Upload);
+
+	void Scan(const TSharedRef<FUpload>& Upload);
+
+	void OnScanned(const TSharedRef<FUpload>& Upload, bool bIsFinalized, int64 FileSize, TArray<FPart>&& Parts);
+
+	void Pump(const TSharedRef<FUpload>& Upload);
+
+	void SendPart(const TSharedRef<FUpload>& Upload, FPart Part, TArray<uint8>&& Data, uint32 Crc);
+
+	void OnPartSent(const TSharedRef<FUpload>& Upload, FPart Part, bool bWasSuccessful);
+
+	void Complete(const TSharedRef<FUpload>& Upload);
+
+	void Finish(const TSharedRef<FUpload>& Upload, bool bWasSuccessful, const FString& Error);
+
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> CreateRequest(const FString& ReplayName, const FString& Path,
+	                                                           const FString& Verb) const;
+
+	TMap<FString, TSharedRef<FUpload>> Uploads;
+
+	//The replay being recorded that is uploaded while recording
+	FString RecordingReplayName;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+};